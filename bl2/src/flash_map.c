@@ -193,6 +193,29 @@ int flash_area_read(const struct flash_area *area, uint32_t off, void *dst,
     }
 }
 
+/* Programs a program unit from a buffer on the stack of flash_area_write().
+ * A driver may program in background once ProgramData returns, so it is
+ * waited for before the buffer is reused or released.
+ */
+static int program_padded_unit(const struct flash_area *area, uint32_t off,
+                               const uint8_t *unit, uint8_t data_width)
+{
+    ARM_FLASH_STATUS status;
+    int32_t ret;
+
+    ret = DRV_FLASH_AREA(area)->ProgramData(area->fa_off + off, unit,
+                                            FLASH_PROGRAM_UNIT / data_width);
+    if (ret < 0) {
+        return -1;
+    }
+
+    do {
+        status = DRV_FLASH_AREA(area)->GetStatus();
+    } while (status.busy);
+
+    return status.error ? -1 : 0;
+}
+
 /* Writes `len` bytes of flash memory at `off` from the buffer at `src`.
  * `off` and `len` can be any alignment.
  */
@@ -288,9 +311,8 @@ int flash_area_write(const struct flash_area *area, uint32_t off,
         if (i != FLASH_PROGRAM_UNIT) {
             return -1;
         }
-        if (DRV_FLASH_AREA(area)->ProgramData(area->fa_off + aligned_off,
-                                        add_padding,
-                                        FLASH_PROGRAM_UNIT / data_width) < 0) {
+        if (program_padded_unit(area, aligned_off, add_padding,
+                                data_width) != 0) {
             return -1;
         }
     }
@@ -310,7 +332,7 @@ int flash_area_write(const struct flash_area *area, uint32_t off,
         if (write_size > 0) {
             if (DRV_FLASH_AREA(area)->ProgramData(
                                            area->fa_off + off + src_written_idx,
-                                           src,
+                                           (const uint8_t *)src + src_written_idx,
                                            write_size / data_width) < 0) {
                 return -1;
             }
@@ -340,10 +362,8 @@ int flash_area_write(const struct flash_area *area, uint32_t off,
                 aligned_len != write_size) {
                 return -1;
             }
-            if (DRV_FLASH_AREA(area)->ProgramData(
-                                area->fa_off + off + last_unit_start_off,
-                                add_padding,
-                                FLASH_PROGRAM_UNIT / data_width) < 0) {
+            if (program_padded_unit(area, off + last_unit_start_off,
+                                    add_padding, data_width) != 0) {
                 return -1;
             }
         }
@@ -64,6 +64,8 @@ set(PROJECT_CONFIG_HEADER_FILE          "${CMAKE_SOURCE_DIR}/config/config_base.
 ############################ Platform ##########################################
 
 set(NUM_MAILBOX_QUEUE_SLOT              1           CACHE BOOL      "Number of mailbox queue slots")
+set(NUM_MAILBOX_SHM_REGION              0           CACHE STRING    "Number of shared memory regions NSPE can register for mailbox payloads. 0 to disable")
+set(MAILBOX_COALESCING                  OFF         CACHE BOOL      "Whether to coalesce mailbox notifications of the messages submitted while SPE mailbox is handling NSPE mailbox queue")
 set(TFM_PLAT_SPECIFIC_MULTI_CORE_COMM   OFF         CACHE BOOL      "Whether to use a platform specific inter-core communication instead of mailbox in dual-cpu topology")
 
 set(DEBUG_AUTHENTICATION                CHIP_DEFAULT CACHE STRING   "Debug authentication setting. [CHIP_DEFAULT, NONE, NS_ONLY, FULL")
@@ -110,6 +112,7 @@ set(TFM_PARTITION_INTERNAL_TRUSTED_STORAGE OFF      CACHE BOOL      "Enable Inte
 
 set(TFM_PARTITION_CRYPTO                OFF         CACHE BOOL      "Enable Crypto partition")
 set(CRYPTO_TFM_BUILTIN_KEYS_DRIVER      ON          CACHE BOOL      "Whether to allow crypto service to store builtin keys. Without this, ALL builtin keys must be stored in a platform-specific location")
+set(CRYPTO_ECP_FIXED_POINT_OPTIM        OFF         CACHE BOOL      "Whether to use the precomputed comb tables of the EC generators in Mbed Crypto, which speed up signing and key generation at the cost of flash")
 
 set(TFM_PARTITION_INITIAL_ATTESTATION   OFF         CACHE BOOL      "Enable Initial Attestation partition")
 set(SYMMETRIC_INITIAL_ATTESTATION       OFF         CACHE BOOL      "Use symmetric crypto for inital attestation")
@@ -22,6 +22,9 @@
 /* Disable Non-volatile counter module */
 #define PLATFORM_NV_COUNTER_MODULE_DISABLED    0
 
+/* Disable the debug request for the SPM connection handle statistics */
+#define PLATFORM_SERVICE_CONN_HANDLE_STATS     0
+
 /* Crypto Partition Configs */
 
 /*
@@ -30,9 +33,48 @@
  */
 #define CRYPTO_ENGINE_BUF_SIZE                 0x2080
 
+/*
+ * Bytes of the Crypto backend heap divided into size-class slabs for small
+ * allocations, the rest being a fallback heap. 0 uses a single heap.
+ */
+#define CRYPTO_ENGINE_SLAB_SIZE                0
+
 /* The max number of concurrent operations that can be active (allocated) at any time in Crypto */
 #define CRYPTO_CONC_OPER_NUM                   8
 
+/*
+ * The max number of operations that can be allocated by a single owner in
+ * Crypto at any time. 0 means no quota.
+ */
+#define CRYPTO_CONC_OPER_OWNER_QUOTA           0
+
+/*
+ * The max number of concurrent operations of each type. Each type has its own
+ * pool of contexts of that type's size. The defaults match
+ * CRYPTO_CONC_OPER_NUM, so that no type is more limited than with the single
+ * pool.
+ */
+#define CRYPTO_CIPHER_CONC_OPER_NUM            8
+#define CRYPTO_MAC_CONC_OPER_NUM               8
+#define CRYPTO_HASH_CONC_OPER_NUM              8
+#define CRYPTO_KEY_DERIVATION_CONC_OPER_NUM    8
+#define CRYPTO_AEAD_CONC_OPER_NUM              8
+
+/*
+ * The max number of persistent keys kept loaded in the Crypto key slots, the
+ * least recently used one being evicted first. 0 disables the key cache.
+ */
+#define CRYPTO_KEY_CACHE_SLOTS                 0
+
+/* The max number of keys of the key cache a single owner can pin */
+#define CRYPTO_KEY_CACHE_PIN_QUOTA             1
+
+/*
+ * The max number of per-owner subkeys derived from builtin keys kept cached in
+ * the builtin key driver. 0 disables the derived key cache.
+ */
+#define TFM_BUILTIN_DERIVED_KEY_CACHE_SIZE     0
+
 /* Enable PSA Crypto random number generator module */
 #define CRYPTO_RNG_MODULE_ENABLED              1
 
@@ -63,6 +105,12 @@
 /* Default size of the internal scratch buffer used for PSA FF IOVec allocations */
 #define CRYPTO_IOVEC_BUFFER_SIZE               5120
 
+/*
+ * Stream the input of multi-part update calls through the internal scratch in
+ * bounded windows, instead of copying the whole input into it.
+ */
+#define CRYPTO_STREAM_UPDATE_ENABLED           1
+
 /* Use stored NV seed to provide entropy */
 #define CRYPTO_NV_SEED                         1
 
@@ -72,6 +120,12 @@
  */
 #define CRYPTO_SINGLE_PART_FUNCS_DISABLED      0
 
+/*
+ * Record per-function call counts, processed bytes and cycle counts in the
+ * Crypto dispatcher, readable by secure clients through tfm_crypto_get_stats()
+ */
+#define CRYPTO_STATS_ENABLED                   0
+
 /* The stack size of the Crypto Secure Partition */
 #define CRYPTO_STACK_SIZE                      0x1B00
 
@@ -80,6 +134,30 @@
 /* Size of the FWU internal data transfer buffer */
 #define TFM_FWU_BUF_SIZE                       PSA_FWU_MAX_WRITE_SIZE
 
+/*
+ * Program the FWU data in background while the next part is read from the
+ * client, using the two halves of the transfer buffer in turn
+ */
+#define TFM_FWU_WRITE_PIPELINE                 0
+
+/*
+ * Hash the FWU data as it is written, so that the candidate digest is known
+ * without reading the image back from flash
+ */
+#define TFM_FWU_INCREMENTAL_DIGEST             0
+
+/*
+ * Size of the output buffer of the decoder of compressed and delta FWU image
+ * streams, 0 to accept plain images only
+ */
+#define TFM_FWU_DELTA_BUF_SIZE                 0
+
+/*
+ * Erase the FWU staging area sector by sector as it is written, instead of as
+ * a whole when the update starts
+ */
+#define TFM_FWU_ERASE_AHEAD                    0
+
 /* The stack size of the Firmware Update Secure Partition */
 #define FWU_STACK_SIZE                         0x600
 
@@ -94,6 +172,26 @@
 /* The stack size of the Initial Attestation Secure Partition */
 #define ATTEST_STACK_SIZE                      0x700
 
+/*
+ * Size of the buffer where the claims constant for the boot session are
+ * encoded once at init, instead of for each token. 0 disables the cache.
+ */
+#define ATTEST_CLAIM_CACHE_SIZE                0
+
+/*
+ * Size of the window through which the token is streamed to the client when
+ * the outvec cannot be mapped. It must hold the COSE headers, the signature,
+ * the nonce and the claims which can change during a request, and each claim
+ * not in the claim cache. 0 creates the whole token in a buffer instead.
+ */
+#define ATTEST_TOKEN_STREAM_BUF_SIZE           0
+
+/*
+ * Maximum number of challenges of a batch attestation request. The claims are
+ * encoded once for all the tokens of a batch. 0 disables batch requests.
+ */
+#define ATTEST_TOKEN_BATCH_MAX                 0
+
 /* Set the initial attestation token profile */
 #define ATTEST_TOKEN_PROFILE_PSA_IOT_1         1
 
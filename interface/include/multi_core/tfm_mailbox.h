@@ -33,6 +33,15 @@ extern "C" {
 #define MAILBOX_PSA_CONNECT                 (0x3)
 #define MAILBOX_PSA_CALL                    (0x4)
 #define MAILBOX_PSA_CLOSE                   (0x5)
+#define MAILBOX_SHM_REGISTER                (0x6)
+#define MAILBOX_SHM_UNREGISTER              (0x7)
+
+/* Access attributes of a shared memory region registered by NSPE */
+#define MAILBOX_SHM_ATTR_READ               (0x1)
+#define MAILBOX_SHM_ATTR_WRITE              (0x2)
+
+/* Handle of the shared memory region. The null handle refers to no region. */
+#define MAILBOX_SHM_NULL_HANDLE             (0)
 
 /* Return code of mailbox APIs */
 #define MAILBOX_SUCCESS                     (0)
@@ -66,11 +75,29 @@ struct psa_client_params_t {
             size_t          in_len;
             psa_outvec      *out_vec;
             size_t          out_len;
+#if NUM_MAILBOX_SHM_REGION > 0
+            uint32_t        shm_handle; /* Shared memory region containing
+                                         * all the payloads, or
+                                         * MAILBOX_SHM_NULL_HANDLE.
+                                         */
+#endif
         } psa_call_params;
 
         struct {
             psa_handle_t    handle;
         } psa_close_params;
+
+#if NUM_MAILBOX_SHM_REGION > 0
+        struct {
+            const void      *base;
+            size_t          size;
+            uint32_t        attr;
+        } shm_register_params;
+
+        struct {
+            uint32_t        shm_handle;
+        } shm_unregister_params;
+#endif
     };
 };
 
@@ -120,6 +147,16 @@ struct ns_mailbox_slot_t {
 
 typedef uint32_t   mailbox_queue_status_t;
 
+/* Statistics of mailbox messages and notifications to the peer core */
+struct mailbox_notify_stats_t {
+    uint32_t nr_msg;                        /* The number of mailbox messages
+                                             * transferred.
+                                             */
+    uint32_t nr_notify;                     /* The number of notifications
+                                             * sent to the peer core.
+                                             */
+};
+
 /* NSPE mailbox queue */
 struct ns_mailbox_queue_t {
     mailbox_queue_status_t   empty_slots;       /* Bitmask of empty slots */
@@ -146,6 +183,19 @@ struct ns_mailbox_queue_t {
                                                  */
 #endif
 
+    struct mailbox_notify_stats_t spe_notify_stats; /* Statistics of
+                                                     * mailbox messages handled
+                                                     * and notifications sent
+                                                     * by SPE. Written by SPE.
+                                                     */
+
+#ifdef MAILBOX_COALESCING
+    bool                     is_spe_handling;   /* SPE mailbox is handling
+                                                 * pending slots. NSPE can skip
+                                                 * the notification to SPE.
+                                                 */
+#endif
+
     bool                     is_full;           /* Queue if full */
 };
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019-2021, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2022, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -12,8 +12,12 @@
 extern "C" {
 #endif
 
+#include <stddef.h>
 #include <stdint.h>
 
+#include "psa/client.h"
+#include "tfm_mailbox_config.h"
+
 /**
  * \brief Called on the non-secure CPU.
  *        Flags that the non-secure side has completed its initialization.
@@ -36,6 +40,60 @@ int32_t tfm_ns_wait_for_s_cpu_ready(void);
  */
 int32_t tfm_platform_ns_wait_for_s_cpu_ready(void);
 
+#if NUM_MAILBOX_SHM_REGION > 0
+/**
+ * \brief Register a long-lived shared buffer with SPE. SPE validates the whole
+ *        buffer once. Payloads of \ref tfm_ns_multi_core_psa_call_shm inside
+ *        the buffer are then checked against the buffer bounds only.
+ *
+ * \param[in]  base            The start address of the buffer
+ * \param[in]  size            The size of the buffer
+ * \param[in]  attr            Access attributes of the buffer,
+ *                             MAILBOX_SHM_ATTR_READ and/or
+ *                             MAILBOX_SHM_ATTR_WRITE
+ * \param[out] shm_handle      The handle of the registered buffer
+ *
+ * \retval PSA_SUCCESS         The buffer is registered.
+ * \retval Other return code   Operation failed with an error code.
+ */
+psa_status_t tfm_ns_multi_core_shm_register(const void *base, size_t size,
+                                            uint32_t attr,
+                                            uint32_t *shm_handle);
+
+/**
+ * \brief Unregister a shared buffer registered by
+ *        \ref tfm_ns_multi_core_shm_register.
+ *
+ * \param[in] shm_handle       The handle of the registered buffer
+ *
+ * \retval PSA_SUCCESS         The buffer is unregistered.
+ * \retval Other return code   Operation failed with an error code.
+ */
+psa_status_t tfm_ns_multi_core_shm_unregister(uint32_t shm_handle);
+
+/**
+ * \brief Call a secure service as \ref psa_call, with all the payloads inside
+ *        a registered shared buffer.
+ *
+ * \param[in] handle           A handle to an established connection
+ * \param[in] type             The request type
+ * \param[in] shm_handle       The handle of the registered buffer containing
+ *                             all the payloads of \p in_vec and \p out_vec
+ * \param[in] in_vec           Array of input \ref psa_invec structures
+ * \param[in] in_len           Number of input \ref psa_invec structures
+ * \param[in] out_vec          Array of output \ref psa_outvec structures
+ * \param[in] out_len          Number of output \ref psa_outvec structures
+ *
+ * \return Same as \ref psa_call
+ */
+psa_status_t tfm_ns_multi_core_psa_call_shm(psa_handle_t handle, int32_t type,
+                                            uint32_t shm_handle,
+                                            const psa_invec *in_vec,
+                                            size_t in_len,
+                                            psa_outvec *out_vec,
+                                            size_t out_len);
+#endif /* NUM_MAILBOX_SHM_REGION > 0 */
+
 #ifdef __cplusplus
 }
 #endif
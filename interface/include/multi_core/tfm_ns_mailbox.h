@@ -53,6 +53,24 @@ int32_t tfm_ns_mailbox_client_call(uint32_t call_type,
                                    int32_t client_id,
                                    int32_t *reply);
 
+/**
+ * \brief Get the statistics of mailbox messages and notifications on both
+ *        sides of the mailbox.
+ *
+ * \param[out] ns_stats         The buffer to be written with the number of
+ *                              mailbox messages submitted to SPE and of
+ *                              notifications sent to SPE.
+ * \param[out] spe_stats        The buffer to be written with the number of
+ *                              mailbox messages handled by SPE and of
+ *                              notifications sent by SPE.
+ *
+ * \retval MAILBOX_SUCCESS      Operation succeeded.
+ * \retval Other return code    Operation failed with an error code.
+ */
+int32_t tfm_ns_mailbox_get_notify_stats(
+                                     struct mailbox_notify_stats_t *ns_stats,
+                                     struct mailbox_notify_stats_t *spe_stats);
+
 #ifdef TFM_MULTI_CORE_NS_OS_MAILBOX_THREAD
 /**
  * \brief Handling PSA client calls in a dedicated NS mailbox thread.
@@ -303,6 +321,24 @@ static inline void set_queue_slot_pend(struct ns_mailbox_queue_t *queue_ptr,
     }
 }
 
+/*
+ * Check whether SPE should be notified of the pending slots.
+ * SPE mailbox picks up new messages by itself while it is handling NSPE
+ * mailbox queue. It should be called inside the critical section protecting
+ * the pending status.
+ */
+static inline bool is_queue_notify_required(
+                                     const struct ns_mailbox_queue_t *queue_ptr)
+{
+#ifdef MAILBOX_COALESCING
+    return !queue_ptr->is_spe_handling;
+#else
+    (void)queue_ptr;
+
+    return true;
+#endif
+}
+
 static inline void clear_queue_slot_all_replied(
                                            struct ns_mailbox_queue_t *queue_ptr,
                                            mailbox_queue_status_t status)
@@ -114,6 +114,83 @@ extern "C" {
 
 /**@}*/
 
+/** \addtogroup crypto_compound
+ * @{
+ */
+
+/**
+ * \brief Encrypt a message and compute the MAC of the ciphertext in a single
+ *        call to the Crypto service (Encrypt-then-MAC).
+ *
+ * The ciphertext is produced as by psa_cipher_encrypt(), including the IV if
+ * any, and the MAC is computed as by psa_mac_compute() over that ciphertext.
+ *
+ * \param[in]  cipher_key        Key to use for the cipher operation.
+ * \param[in]  cipher_alg        Cipher algorithm.
+ * \param[in]  mac_key           Key to use for the MAC operation.
+ * \param[in]  mac_alg           MAC algorithm.
+ * \param[in]  input             Plaintext to encrypt.
+ * \param[in]  input_length      Size of the \p input buffer in bytes.
+ * \param[out] output            Buffer where the ciphertext is written.
+ * \param[in]  output_size       Size of the \p output buffer in bytes.
+ * \param[out] output_length     On success, the number of bytes that make
+ *                               up the ciphertext.
+ * \param[out] mac               Buffer where the MAC value is written.
+ * \param[in]  mac_size          Size of the \p mac buffer in bytes.
+ * \param[out] mac_length        On success, the number of bytes that make
+ *                               up the MAC value.
+ *
+ * \return Return values as described in \ref psa_cipher_encrypt and
+ *         \ref psa_mac_compute.
+ */
+psa_status_t tfm_crypto_encrypt_then_mac(psa_key_id_t cipher_key,
+                                         psa_algorithm_t cipher_alg,
+                                         psa_key_id_t mac_key,
+                                         psa_algorithm_t mac_alg,
+                                         const uint8_t *input,
+                                         size_t input_length,
+                                         uint8_t *output,
+                                         size_t output_size,
+                                         size_t *output_length,
+                                         uint8_t *mac,
+                                         size_t mac_size,
+                                         size_t *mac_length);
+
+/**
+ * \brief Verify the MAC of a ciphertext and decrypt it in a single call to the
+ *        Crypto service. The ciphertext is not decrypted if the MAC does not
+ *        match.
+ *
+ * \param[in]  cipher_key        Key to use for the cipher operation.
+ * \param[in]  cipher_alg        Cipher algorithm.
+ * \param[in]  mac_key           Key to use for the MAC operation.
+ * \param[in]  mac_alg           MAC algorithm.
+ * \param[in]  input             Ciphertext to verify and decrypt.
+ * \param[in]  input_length      Size of the \p input buffer in bytes.
+ * \param[in]  mac               Buffer containing the expected MAC value.
+ * \param[in]  mac_length        Size of the \p mac buffer in bytes.
+ * \param[out] output            Buffer where the plaintext is written.
+ * \param[in]  output_size       Size of the \p output buffer in bytes.
+ * \param[out] output_length     On success, the number of bytes that make
+ *                               up the plaintext.
+ *
+ * \return Return values as described in \ref psa_mac_verify and
+ *         \ref psa_cipher_decrypt.
+ */
+psa_status_t tfm_crypto_verify_then_decrypt(psa_key_id_t cipher_key,
+                                            psa_algorithm_t cipher_alg,
+                                            psa_key_id_t mac_key,
+                                            psa_algorithm_t mac_alg,
+                                            const uint8_t *input,
+                                            size_t input_length,
+                                            const uint8_t *mac,
+                                            size_t mac_length,
+                                            uint8_t *output,
+                                            size_t output_size,
+                                            size_t *output_length);
+
+/**@}*/
+
 #ifdef __cplusplus
 }
 #endif
@@ -194,6 +194,34 @@ psa_status_t
 psa_initial_attest_get_token_size(size_t  challenge_size,
                                   size_t *token_size);
 
+/**
+ * \brief Get an initial attestation token for each of several challenges in
+ *        a single request. The claims are encoded once for the whole batch.
+ *
+ * This is a TF-M specific extension of the Initial Attestation API.
+ *
+ * \param[in]  challenges      The challenges, one after the other, all of
+ *                             \p challenge_size bytes
+ * \param[in]  challenge_size  Size of each challenge in bytes
+ * \param[in]  num_challenges  Number of challenges, at most
+ *                             ATTEST_TOKEN_BATCH_MAX
+ * \param[out] token_buf       Buffer where the tokens are written one after
+ *                             the other, in the order of the challenges
+ * \param[in]  token_buf_size  Size of \p token_buf in bytes
+ * \param[out] token_size      Size of each token, they all have the same size
+ *
+ * \return PSA_SUCCESS on success, PSA_ERROR_BUFFER_TOO_SMALL when the tokens
+ *         don't fit in \p token_buf, PSA_ERROR_NOT_SUPPORTED when
+ *         ATTEST_TOKEN_BATCH_MAX is 0 in the Initial Attestation service.
+ */
+psa_status_t
+tfm_initial_attest_get_token_batch(const uint8_t *challenges,
+                                   size_t         challenge_size,
+                                   size_t         num_challenges,
+                                   uint8_t       *token_buf,
+                                   size_t         token_buf_size,
+                                   size_t        *token_size);
+
 #ifdef __cplusplus
 }
 #endif
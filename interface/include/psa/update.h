@@ -147,6 +147,10 @@ typedef struct psa_fwu_image_version_t {
 typedef struct {
     /* The digest of second image when store state is CANDIDATE. */
     uint8_t candidate_digest[TFM_FWU_MAX_DIGEST_SIZE];
+    /* The size of the start of the staging area which is erased, when the
+     * staging area is erased ahead of the writes. 0 otherwise.
+     */
+    uint32_t staging_erased_size;
  } psa_fwu_impl_info_t;
 
 /**
@@ -274,6 +278,23 @@ psa_status_t psa_fwu_reject(psa_status_t error);
  */
 psa_status_t psa_fwu_accept(void);
 
+/**
+ * @brief Erase a part of the staging area of a component in advance, so that
+ *        the writes of the next update don't wait for the flash to be erased.
+ *        This is a TF-M specific extension, only supported when
+ *        TFM_FWU_ERASE_AHEAD is enabled. The progress is reported in the
+ *        staging_erased_size field of the component information.
+ *
+ * @param component Identifier of the firmware component in READY or WRITING
+ *                  state.
+ * @param size      The size to erase in bytes, after the part already erased.
+ *                  0 erases the rest of the staging area.
+ *
+ * @return Result status.
+ */
+psa_status_t tfm_fwu_prepare_staging_area(psa_fwu_component_t component,
+                                          size_t size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -56,10 +56,68 @@ struct tfm_crypto_pack_iovec {
     uint16_t step;           /*!< Key derivation step */
 };
 
+/**
+ * \brief Structure used to pass the MAC key and algorithm of the compound
+ *        cipher and MAC calls in their own input vector, as
+ *        tfm_crypto_pack_iovec only carries the cipher key and algorithm.
+ */
+struct tfm_crypto_mac_pack_input {
+    psa_key_id_t key_id;     /*!< MAC key id */
+    psa_algorithm_t alg;     /*!< MAC algorithm */
+};
+
+/**
+ * \brief Statistics of a Crypto function, as recorded by the dispatcher of the
+ *        Crypto service when CRYPTO_STATS_ENABLED is set. The average cycle
+ *        count of a call is cycles_total / count.
+ */
+struct tfm_crypto_stats_entry_t {
+    uint16_t function_id;    /*!< Function SID, see tfm_crypto_func_sid */
+    uint16_t reserved;       /*!< Reserved for alignment, always 0 */
+    uint32_t count;          /*!< Number of calls */
+    uint64_t bytes;          /*!< Bytes passed as input data by the calls */
+    uint64_t cycles_total;   /*!< Sum of the cycle counts of the calls */
+    uint32_t cycles_min;     /*!< Cycle count of the shortest call */
+    uint32_t cycles_max;     /*!< Cycle count of the longest call */
+};
+
+/**
+ * \brief Usage statistics of the memory used by the Crypto engine, when it is
+ *        split into size-class slabs and a fallback heap
+ *        (CRYPTO_ENGINE_SLAB_SIZE > 0). The fallback heap is fragmented when
+ *        heap_largest_free is much smaller than heap_free.
+ */
+struct tfm_crypto_heap_stats_t {
+    uint32_t slab_allocs;        /*!< Allocations served by the slabs */
+    uint32_t heap_allocs;        /*!< Allocations served by the heap */
+    uint32_t failed_allocs;      /*!< Allocations which failed */
+    uint32_t slab_used;          /*!< Slab blocks currently in use */
+    uint32_t slab_peak;          /*!< Highest number of slab blocks in use */
+    uint32_t heap_used;          /*!< Heap bytes in use, whole blocks */
+    uint32_t heap_peak;          /*!< Highest number of heap bytes in use */
+    uint32_t heap_free;          /*!< Free heap bytes */
+    uint32_t heap_largest_free;  /*!< Largest free contiguous heap area */
+    uint32_t invalid_frees;      /*!< Frees of blocks not allocated */
+};
+
+/**
+ * \brief Statistics of the cache of persistent keys of the Crypto service
+ *        (CRYPTO_KEY_CACHE_SLOTS > 0). A miss is an access to a persistent key
+ *        which is not held by the cache, and which might have been read from
+ *        storage.
+ */
+struct tfm_crypto_key_cache_stats_t {
+    uint32_t hits;          /*!< Accesses to keys held by the cache */
+    uint32_t misses;        /*!< Accesses to keys not held by the cache */
+    uint32_t evictions;     /*!< Keys evicted to make room for another one */
+    uint32_t cached;        /*!< Keys currently held by the cache */
+    uint32_t pinned;        /*!< Keys currently pinned in the cache */
+};
+
 /**
  * \brief Type associated to the group of a function encoding. There can be
- *        nine groups (Random, Key management, Hash, MAC, Cipher, AEAD,
- *        Asym sign, Asym encrypt, Key derivation).
+ *        ten groups (Random, Key management, Hash, MAC, Cipher, AEAD,
+ *        Asym sign, Asym encrypt, Key derivation, Statistics).
  */
 enum tfm_crypto_group_id {
     TFM_CRYPTO_GROUP_ID_RANDOM = 0x0,
@@ -71,6 +129,7 @@ enum tfm_crypto_group_id {
     TFM_CRYPTO_GROUP_ID_ASYM_SIGN,
     TFM_CRYPTO_GROUP_ID_ASYM_ENCRYPT,
     TFM_CRYPTO_GROUP_ID_KEY_DERIVATION,
+    TFM_CRYPTO_GROUP_ID_STATS,
 };
 
 /* X macro describing each of the available PSA Crypto APIs */
@@ -85,7 +144,9 @@ enum tfm_crypto_group_id {
     X(TFM_CRYPTO_EXPORT_PUBLIC_KEY)                \
     X(TFM_CRYPTO_PURGE_KEY)                        \
     X(TFM_CRYPTO_COPY_KEY)                         \
-    X(TFM_CRYPTO_GENERATE_KEY)
+    X(TFM_CRYPTO_GENERATE_KEY)                     \
+    X(TFM_CRYPTO_PIN_KEY)                          \
+    X(TFM_CRYPTO_UNPIN_KEY)
 
 #define HASH_FUNCS                                 \
     X(TFM_CRYPTO_HASH_COMPUTE)                     \
@@ -116,7 +177,9 @@ enum tfm_crypto_group_id {
     X(TFM_CRYPTO_CIPHER_SET_IV)                    \
     X(TFM_CRYPTO_CIPHER_UPDATE)                    \
     X(TFM_CRYPTO_CIPHER_FINISH)                    \
-    X(TFM_CRYPTO_CIPHER_ABORT)
+    X(TFM_CRYPTO_CIPHER_ABORT)                     \
+    X(TFM_CRYPTO_CIPHER_ENCRYPT_THEN_MAC)          \
+    X(TFM_CRYPTO_CIPHER_VERIFY_THEN_DECRYPT)
 
 #define AEAD_FUNCS                                 \
     X(TFM_CRYPTO_AEAD_ENCRYPT)                     \
@@ -157,6 +220,11 @@ enum tfm_crypto_group_id {
 #define RANDOM_FUNCS                               \
     X(TFM_CRYPTO_GENERATE_RANDOM)
 
+#define STATS_FUNCS                                \
+    X(TFM_CRYPTO_GET_STATS)                        \
+    X(TFM_CRYPTO_GET_HEAP_STATS)                   \
+    X(TFM_CRYPTO_GET_KEY_CACHE_STATS)
+
 /*
  * Define function IDs in each group. The function ID will be encoded into
  * tfm_crypto_func_sid below.
@@ -191,6 +259,9 @@ enum tfm_crypto_key_derivation_func_id {
 enum tfm_crypto_random_func_id {
     RANDOM_FUNCS
 };
+enum tfm_crypto_stats_func_id {
+    STATS_FUNCS
+};
 #undef X
 
 #define FUNC_ID(func_id)    (((func_id) & 0xFF) << 8)
@@ -253,6 +324,11 @@ enum tfm_crypto_func_sid {
                                            (TFM_CRYPTO_GROUP_ID_RANDOM & 0xFF)),
     RANDOM_FUNCS
 
+#undef X
+#define X(func_id)      func_id ## _SID = (uint16_t)((FUNC_ID(func_id)) | \
+                                            (TFM_CRYPTO_GROUP_ID_STATS & 0xFF)),
+    STATS_FUNCS
+
 };
 #undef X
 
@@ -277,6 +353,75 @@ enum {
     TFM_CRYPTO_IN_USE = 1
 };
 
+/**
+ * \brief Reads the per-function statistics recorded by the Crypto service.
+ *        Only secure clients are allowed to read them.
+ *
+ * \param[out] entries      Array where the statistics are written, one entry
+ *                          per function called at least once.
+ * \param[in]  max_entries  Number of entries the \p entries array can hold.
+ * \param[out] num_entries  Number of entries written.
+ *
+ * \return PSA_SUCCESS on success, PSA_ERROR_NOT_PERMITTED for a non-secure
+ *         client, PSA_ERROR_NOT_SUPPORTED when CRYPTO_STATS_ENABLED is not
+ *         set in the Crypto service.
+ */
+psa_status_t tfm_crypto_get_stats(struct tfm_crypto_stats_entry_t *entries,
+                                  size_t max_entries,
+                                  size_t *num_entries);
+
+/**
+ * \brief Reads the usage statistics of the memory used by the Crypto engine.
+ *        Only secure clients are allowed to read them.
+ *
+ * \param[out] stats  Statistics of the memory of the Crypto engine
+ *
+ * \return PSA_SUCCESS on success, PSA_ERROR_NOT_PERMITTED for a non-secure
+ *         client, PSA_ERROR_NOT_SUPPORTED when CRYPTO_ENGINE_SLAB_SIZE is 0 in
+ *         the Crypto service.
+ */
+psa_status_t tfm_crypto_get_heap_stats(struct tfm_crypto_heap_stats_t *stats);
+
+/**
+ * \brief Pins a persistent key in the key cache of the Crypto service, so that
+ *        the cache does not evict it until it is unpinned, closed, purged or
+ *        destroyed. The pin is advisory: Mbed Crypto can still unload the
+ *        key when all its key slots are in use, the key is then read again
+ *        from storage on its next use.
+ *
+ * \param[in] key  Identifier of the persistent key to pin
+ *
+ * \return PSA_SUCCESS on success, PSA_ERROR_INSUFFICIENT_MEMORY when all the
+ *         entries of the cache are pinned or when the caller already pinned
+ *         CRYPTO_KEY_CACHE_PIN_QUOTA keys, PSA_ERROR_NOT_SUPPORTED when
+ *         CRYPTO_KEY_CACHE_SLOTS is 0 in the Crypto service.
+ */
+psa_status_t tfm_crypto_pin_key(psa_key_id_t key);
+
+/**
+ * \brief Unpins a persistent key pinned by \ref tfm_crypto_pin_key. The key
+ *        stays in the cache until it is the least recently used one.
+ *
+ * \param[in] key  Identifier of the persistent key to unpin
+ *
+ * \return PSA_SUCCESS on success, PSA_ERROR_NOT_SUPPORTED when
+ *         CRYPTO_KEY_CACHE_SLOTS is 0 in the Crypto service.
+ */
+psa_status_t tfm_crypto_unpin_key(psa_key_id_t key);
+
+/**
+ * \brief Reads the statistics of the cache of persistent keys. Only secure
+ *        clients are allowed to read them.
+ *
+ * \param[out] stats  Statistics of the key cache
+ *
+ * \return PSA_SUCCESS on success, PSA_ERROR_NOT_PERMITTED for a non-secure
+ *         client, PSA_ERROR_NOT_SUPPORTED when CRYPTO_KEY_CACHE_SLOTS is 0 in
+ *         the Crypto service.
+ */
+psa_status_t tfm_crypto_get_key_cache_stats(
+                                    struct tfm_crypto_key_cache_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
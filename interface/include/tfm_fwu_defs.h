@@ -23,6 +23,7 @@ extern "C" {
 #define TFM_FWU_REQUEST_REBOOT       1008
 #define TFM_FWU_ACCEPT               1009
 #define TFM_FWU_QUERY                1010
+#define TFM_FWU_PREPARE_STAGING      1011
 
 #ifdef __cplusplus
 }
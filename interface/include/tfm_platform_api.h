@@ -27,6 +27,7 @@ extern "C" {
 #define TFM_PLATFORM_API_ID_NV_INCREMENT  (1011)
 #define TFM_PLATFORM_API_ID_SYSTEM_RESET  (1012)
 #define TFM_PLATFORM_API_ID_IOCTL         (1013)
+#define TFM_PLATFORM_API_ID_CONN_HANDLE_STATS (1014)
 
 /*!
  * \enum tfm_platform_err_t
@@ -46,6 +47,19 @@ enum tfm_platform_err_t {
 
 typedef int32_t tfm_platform_ioctl_req_t;
 
+/*!
+ * \struct tfm_platform_conn_handle_stats_t
+ *
+ * \brief Usage statistics of the SPM connection handle pool
+ *
+ */
+struct tfm_platform_conn_handle_stats_t {
+    uint32_t total;          /*!< Number of handles in the pool */
+    uint32_t free;           /*!< Number of handles currently free */
+    uint32_t high_watermark; /*!< Max number of handles in use at a time */
+    uint32_t alloc_fails;    /*!< Number of failed allocations */
+};
+
 /*!
  * \brief Resets the system.
  *
@@ -93,6 +107,21 @@ enum tfm_platform_err_t
 tfm_platform_nv_counter_read(uint32_t counter_id,
                              uint32_t size, uint8_t *val);
 
+/*!
+ * \brief Reads the usage statistics of the SPM connection handle pool, for
+ *        debugging purposes. Only available when the platform service is
+ *        built with PLATFORM_SERVICE_CONN_HANDLE_STATS.
+ *
+ * \param[out] stats       Pointer to store the statistics.
+ *
+ * \return  TFM_PLATFORM_ERR_SUCCESS if the statistics are read correctly,
+ *          TFM_PLATFORM_ERR_NOT_SUPPORTED if the request is not built in.
+ *          Otherwise, it returns TFM_PLATFORM_ERR_SYSTEM_ERROR.
+ */
+enum tfm_platform_err_t
+tfm_platform_get_conn_handle_stats(
+                            struct tfm_platform_conn_handle_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
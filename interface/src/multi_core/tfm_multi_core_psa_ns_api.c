@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019-2021, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2022, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -11,6 +11,7 @@
 #include "psa/client.h"
 #include "psa/error.h"
 #include "tfm_api.h"
+#include "tfm_multi_core_api.h"
 #include "tfm_ns_mailbox.h"
 
 /*
@@ -104,6 +105,9 @@ psa_status_t psa_call(psa_handle_t handle, int32_t type,
     params.psa_call_params.in_len = in_len;
     params.psa_call_params.out_vec = out_vec;
     params.psa_call_params.out_len = out_len;
+#if NUM_MAILBOX_SHM_REGION > 0
+    params.psa_call_params.shm_handle = MAILBOX_SHM_NULL_HANDLE;
+#endif
 
     ret = tfm_ns_mailbox_client_call(MAILBOX_PSA_CALL, &params,
                                      NON_SECURE_CLIENT_ID,
@@ -125,3 +129,84 @@ void psa_close(psa_handle_t handle)
     (void)tfm_ns_mailbox_client_call(MAILBOX_PSA_CLOSE, &params,
                                      NON_SECURE_CLIENT_ID, &reply);
 }
+
+#if NUM_MAILBOX_SHM_REGION > 0
+psa_status_t tfm_ns_multi_core_shm_register(const void *base, size_t size,
+                                            uint32_t attr,
+                                            uint32_t *shm_handle)
+{
+    struct psa_client_params_t params;
+    int32_t reply;
+    int32_t ret;
+
+    if (!shm_handle) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    params.shm_register_params.base = base;
+    params.shm_register_params.size = size;
+    params.shm_register_params.attr = attr;
+
+    ret = tfm_ns_mailbox_client_call(MAILBOX_SHM_REGISTER, &params,
+                                     NON_SECURE_CLIENT_ID, &reply);
+    if (ret != MAILBOX_SUCCESS) {
+        return PSA_INTER_CORE_COMM_ERR;
+    }
+
+    /* SPE replies with either the region handle or an error code */
+    if (reply < 0) {
+        return (psa_status_t)reply;
+    }
+
+    *shm_handle = (uint32_t)reply;
+
+    return PSA_SUCCESS;
+}
+
+psa_status_t tfm_ns_multi_core_shm_unregister(uint32_t shm_handle)
+{
+    struct psa_client_params_t params;
+    int32_t ret;
+    psa_status_t status;
+
+    params.shm_unregister_params.shm_handle = shm_handle;
+
+    ret = tfm_ns_mailbox_client_call(MAILBOX_SHM_UNREGISTER, &params,
+                                     NON_SECURE_CLIENT_ID,
+                                     (int32_t *)&status);
+    if (ret != MAILBOX_SUCCESS) {
+        status = PSA_INTER_CORE_COMM_ERR;
+    }
+
+    return status;
+}
+
+psa_status_t tfm_ns_multi_core_psa_call_shm(psa_handle_t handle, int32_t type,
+                                            uint32_t shm_handle,
+                                            const psa_invec *in_vec,
+                                            size_t in_len,
+                                            psa_outvec *out_vec,
+                                            size_t out_len)
+{
+    struct psa_client_params_t params;
+    int32_t ret;
+    psa_status_t status;
+
+    params.psa_call_params.handle = handle;
+    params.psa_call_params.type = type;
+    params.psa_call_params.in_vec = in_vec;
+    params.psa_call_params.in_len = in_len;
+    params.psa_call_params.out_vec = out_vec;
+    params.psa_call_params.out_len = out_len;
+    params.psa_call_params.shm_handle = shm_handle;
+
+    ret = tfm_ns_mailbox_client_call(MAILBOX_PSA_CALL, &params,
+                                     NON_SECURE_CLIENT_ID,
+                                     (int32_t *)&status);
+    if (ret != MAILBOX_SUCCESS) {
+        status = PSA_INTER_CORE_COMM_ERR;
+    }
+
+    return status;
+}
+#endif /* NUM_MAILBOX_SHM_REGION > 0 */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019-2021, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2022, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -15,6 +15,9 @@
 /* The pointer to NSPE mailbox queue */
 static struct ns_mailbox_queue_t *mailbox_queue_ptr = NULL;
 
+/* Statistics of mailbox messages and notifications sent to SPE */
+static struct mailbox_notify_stats_t ns_notify_stats;
+
 static int32_t mailbox_wait_reply(uint8_t idx);
 
 static inline void set_queue_slot_empty(uint8_t idx)
@@ -107,6 +110,7 @@ static int32_t mailbox_tx_client_req(uint32_t call_type,
     uint8_t idx;
     struct mailbox_msg_t *msg_ptr;
     const void *task_handle;
+    bool need_notify;
 
     idx = acquire_empty_slot(mailbox_queue_ptr);
     if (idx >= NUM_MAILBOX_QUEUE_SLOT) {
@@ -133,9 +137,16 @@ static int32_t mailbox_tx_client_req(uint32_t call_type,
 
     tfm_ns_mailbox_hal_enter_critical();
     set_queue_slot_pend(mailbox_queue_ptr, idx);
+    need_notify = is_queue_notify_required(mailbox_queue_ptr);
+    ns_notify_stats.nr_msg++;
+    if (need_notify) {
+        ns_notify_stats.nr_notify++;
+    }
     tfm_ns_mailbox_hal_exit_critical();
 
-    tfm_ns_mailbox_hal_notify_peer();
+    if (need_notify) {
+        tfm_ns_mailbox_hal_notify_peer();
+    }
 
     *slot_idx = idx;
 
@@ -309,6 +320,27 @@ static int32_t mailbox_wait_reply(uint8_t idx)
     return MAILBOX_SUCCESS;
 }
 
+int32_t tfm_ns_mailbox_get_notify_stats(
+                                     struct mailbox_notify_stats_t *ns_stats,
+                                     struct mailbox_notify_stats_t *spe_stats)
+{
+    if (!mailbox_queue_ptr) {
+        return MAILBOX_INIT_ERROR;
+    }
+
+    if (!ns_stats || !spe_stats) {
+        return MAILBOX_INVAL_PARAMS;
+    }
+
+    tfm_ns_mailbox_hal_enter_critical();
+    memcpy(ns_stats, &ns_notify_stats, sizeof(*ns_stats));
+    memcpy(spe_stats, &mailbox_queue_ptr->spe_notify_stats,
+           sizeof(*spe_stats));
+    tfm_ns_mailbox_hal_exit_critical();
+
+    return MAILBOX_SUCCESS;
+}
+
 int32_t tfm_ns_mailbox_init(struct ns_mailbox_queue_t *queue)
 {
     int32_t ret;
@@ -323,6 +355,7 @@ int32_t tfm_ns_mailbox_init(struct ns_mailbox_queue_t *queue)
      */
 
     memset(queue, 0, sizeof(*queue));
+    memset(&ns_notify_stats, 0, sizeof(ns_notify_stats));
 
     /* Initialize empty bitmask */
     queue->empty_slots =
@@ -56,3 +56,25 @@ psa_initial_attest_get_token_size(size_t  challenge_size,
 
     return status;
 }
+
+psa_status_t
+tfm_initial_attest_get_token_batch(const uint8_t *challenges,
+                                   size_t         challenge_size,
+                                   size_t         num_challenges,
+                                   uint8_t       *token_buf,
+                                   size_t         token_buf_size,
+                                   size_t        *token_size)
+{
+    psa_invec in_vec[] = {
+        {challenges, challenge_size * num_challenges},
+        {&challenge_size, sizeof(challenge_size)}
+    };
+    psa_outvec out_vec[] = {
+        {token_buf, token_buf_size},
+        {token_size, sizeof(size_t)}
+    };
+
+    return psa_call(TFM_ATTESTATION_SERVICE_HANDLE, TFM_ATTEST_GET_TOKEN_BATCH,
+                    in_vec, IOVEC_LEN(in_vec),
+                    out_vec, IOVEC_LEN(out_vec));
+}
@@ -1515,6 +1515,86 @@ psa_status_t psa_cipher_decrypt(psa_key_id_t key,
     return status;
 }
 
+psa_status_t tfm_crypto_encrypt_then_mac(psa_key_id_t cipher_key,
+                                         psa_algorithm_t cipher_alg,
+                                         psa_key_id_t mac_key,
+                                         psa_algorithm_t mac_alg,
+                                         const uint8_t *input,
+                                         size_t input_length,
+                                         uint8_t *output,
+                                         size_t output_size,
+                                         size_t *output_length,
+                                         uint8_t *mac,
+                                         size_t mac_size,
+                                         size_t *mac_length)
+{
+    psa_status_t status;
+    struct tfm_crypto_pack_iovec iov = {
+        .function_id = TFM_CRYPTO_CIPHER_ENCRYPT_THEN_MAC_SID,
+        .key_id = cipher_key,
+        .alg = cipher_alg,
+    };
+    struct tfm_crypto_mac_pack_input mac_in = {
+        .key_id = mac_key,
+        .alg = mac_alg,
+    };
+
+    psa_invec in_vec[] = {
+        {.base = &iov, .len = sizeof(struct tfm_crypto_pack_iovec)},
+        {.base = input, .len = input_length},
+        {.base = &mac_in, .len = sizeof(struct tfm_crypto_mac_pack_input)},
+    };
+    psa_outvec out_vec[] = {
+        {.base = output, .len = output_size},
+        {.base = mac, .len = mac_size},
+    };
+
+    status = API_DISPATCH(in_vec, out_vec);
+
+    *output_length = out_vec[0].len;
+    *mac_length = out_vec[1].len;
+    return status;
+}
+
+psa_status_t tfm_crypto_verify_then_decrypt(psa_key_id_t cipher_key,
+                                            psa_algorithm_t cipher_alg,
+                                            psa_key_id_t mac_key,
+                                            psa_algorithm_t mac_alg,
+                                            const uint8_t *input,
+                                            size_t input_length,
+                                            const uint8_t *mac,
+                                            size_t mac_length,
+                                            uint8_t *output,
+                                            size_t output_size,
+                                            size_t *output_length)
+{
+    psa_status_t status;
+    struct tfm_crypto_pack_iovec iov = {
+        .function_id = TFM_CRYPTO_CIPHER_VERIFY_THEN_DECRYPT_SID,
+        .key_id = cipher_key,
+        .alg = cipher_alg,
+    };
+    struct tfm_crypto_mac_pack_input mac_in = {
+        .key_id = mac_key,
+        .alg = mac_alg,
+    };
+
+    psa_invec in_vec[] = {
+        {.base = &iov, .len = sizeof(struct tfm_crypto_pack_iovec)},
+        {.base = input, .len = input_length},
+        {.base = &mac_in, .len = sizeof(struct tfm_crypto_mac_pack_input)},
+        {.base = mac, .len = mac_length},
+    };
+    psa_outvec out_vec[] = {
+        {.base = output, .len = output_size}
+    };
+
+    status = API_DISPATCH(in_vec, out_vec);
+
+    *output_length = out_vec[0].len;
+    return status;
+}
+
 psa_status_t psa_raw_key_agreement(psa_algorithm_t alg,
                                    psa_key_id_t private_key,
                                    const uint8_t *peer_key,
@@ -1623,3 +1703,87 @@ psa_status_t psa_key_derivation_output_key(
 
     return API_DISPATCH(in_vec, out_vec);
 }
+
+psa_status_t tfm_crypto_get_stats(struct tfm_crypto_stats_entry_t *entries,
+                                  size_t max_entries,
+                                  size_t *num_entries)
+{
+    psa_status_t status;
+    struct tfm_crypto_pack_iovec iov = {
+        .function_id = TFM_CRYPTO_GET_STATS_SID,
+    };
+
+    psa_invec in_vec[] = {
+        {.base = &iov, .len = sizeof(struct tfm_crypto_pack_iovec)},
+    };
+    psa_outvec out_vec[] = {
+        {.base = entries,
+         .len = max_entries * sizeof(struct tfm_crypto_stats_entry_t)},
+    };
+
+    status = API_DISPATCH(in_vec, out_vec);
+
+    *num_entries = out_vec[0].len / sizeof(struct tfm_crypto_stats_entry_t);
+    return status;
+}
+
+psa_status_t tfm_crypto_get_heap_stats(struct tfm_crypto_heap_stats_t *stats)
+{
+    struct tfm_crypto_pack_iovec iov = {
+        .function_id = TFM_CRYPTO_GET_HEAP_STATS_SID,
+    };
+
+    psa_invec in_vec[] = {
+        {.base = &iov, .len = sizeof(struct tfm_crypto_pack_iovec)},
+    };
+    psa_outvec out_vec[] = {
+        {.base = stats, .len = sizeof(struct tfm_crypto_heap_stats_t)},
+    };
+
+    return API_DISPATCH(in_vec, out_vec);
+}
+
+psa_status_t tfm_crypto_pin_key(psa_key_id_t key)
+{
+    struct tfm_crypto_pack_iovec iov = {
+        .function_id = TFM_CRYPTO_PIN_KEY_SID,
+        .key_id = key,
+    };
+
+    psa_invec in_vec[] = {
+        {.base = &iov, .len = sizeof(struct tfm_crypto_pack_iovec)},
+    };
+
+    return API_DISPATCH_NO_OUTVEC(in_vec);
+}
+
+psa_status_t tfm_crypto_unpin_key(psa_key_id_t key)
+{
+    struct tfm_crypto_pack_iovec iov = {
+        .function_id = TFM_CRYPTO_UNPIN_KEY_SID,
+        .key_id = key,
+    };
+
+    psa_invec in_vec[] = {
+        {.base = &iov, .len = sizeof(struct tfm_crypto_pack_iovec)},
+    };
+
+    return API_DISPATCH_NO_OUTVEC(in_vec);
+}
+
+psa_status_t tfm_crypto_get_key_cache_stats(
+                                    struct tfm_crypto_key_cache_stats_t *stats)
+{
+    struct tfm_crypto_pack_iovec iov = {
+        .function_id = TFM_CRYPTO_GET_KEY_CACHE_STATS_SID,
+    };
+
+    psa_invec in_vec[] = {
+        {.base = &iov, .len = sizeof(struct tfm_crypto_pack_iovec)},
+    };
+    psa_outvec out_vec[] = {
+        {.base = stats, .len = sizeof(struct tfm_crypto_key_cache_stats_t)},
+    };
+
+    return API_DISPATCH(in_vec, out_vec);
+}
@@ -109,3 +109,15 @@ psa_status_t psa_fwu_reject(psa_status_t error)
     return psa_call(TFM_FIRMWARE_UPDATE_SERVICE_HANDLE, TFM_FWU_REJECT,
                     in_vec, IOVEC_LEN(in_vec), NULL, 0);
 }
+
+psa_status_t tfm_fwu_prepare_staging_area(psa_fwu_component_t component,
+                                          size_t size)
+{
+    psa_invec in_vec[] = {
+        { .base = &component, .len = sizeof(component) },
+        { .base = &size, .len = sizeof(size) }
+    };
+
+    return psa_call(TFM_FIRMWARE_UPDATE_SERVICE_HANDLE, TFM_FWU_PREPARE_STAGING,
+                    in_vec, IOVEC_LEN(in_vec), NULL, 0);
+}
@@ -106,3 +106,26 @@ tfm_platform_nv_counter_read(uint32_t counter_id,
         return (enum tfm_platform_err_t)status;
     }
 }
+
+enum tfm_platform_err_t
+tfm_platform_get_conn_handle_stats(
+                            struct tfm_platform_conn_handle_stats_t *stats)
+{
+    psa_status_t status = PSA_ERROR_CONNECTION_REFUSED;
+    struct psa_outvec out_vec[1];
+
+    out_vec[0].base = stats;
+    out_vec[0].len = sizeof(*stats);
+
+    status = psa_call(TFM_PLATFORM_SERVICE_HANDLE,
+                      TFM_PLATFORM_API_ID_CONN_HANDLE_STATS,
+                      NULL, 0, out_vec, 1);
+
+    if (status == PSA_ERROR_NOT_SUPPORTED) {
+        return TFM_PLATFORM_ERR_NOT_SUPPORTED;
+    } else if (status < PSA_SUCCESS) {
+        return TFM_PLATFORM_ERR_SYSTEM_ERROR;
+    } else {
+        return (enum tfm_platform_err_t)status;
+    }
+}
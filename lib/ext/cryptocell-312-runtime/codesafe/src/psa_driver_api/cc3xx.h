@@ -69,6 +69,28 @@
  *  default as it requires around 0.5 KB of flash.
  */
 #define CC3XX_CONFIG_ENABLE_AEAD_AES_CACHED_MODE
+
+/*!
+ *  Minimum input size, in bytes, for which the single-part entry points of
+ *  the hash, cipher and MAC modules run on the accelerator. For shorter
+ *  inputs the entry points return PSA_ERROR_NOT_SUPPORTED, so that the PSA
+ *  Driver Core falls back to the software implementation, which is faster
+ *  when the accelerator setup cost dominates. The thresholds are platform
+ *  specific and should be set from measurements on the target. A value of 0
+ *  routes every input to the accelerator, which is the default. A threshold
+ *  other than 0 requires \ref CC3XX_CONFIG_ENABLE_SW_FALLBACK.
+ */
+#define CC3XX_CONFIG_HASH_HW_MIN_INPUT_SIZE   (0)
+#define CC3XX_CONFIG_CIPHER_HW_MIN_INPUT_SIZE (0)
+#define CC3XX_CONFIG_MAC_HW_MIN_INPUT_SIZE    (0)
+
+/*!
+ *  Keeps the software implementation of the single-part hash, cipher and MAC
+ *  operations reachable from the PSA Driver Core when this driver returns
+ *  PSA_ERROR_NOT_SUPPORTED. It must be visible to psa_crypto_driver_wrappers.c
+ *  and is set by the CC312_SW_FALLBACK_ENABLED CMake option.
+ */
+#define CC3XX_CONFIG_ENABLE_SW_FALLBACK
 #endif /* __DOXYGEN_ONLY__ */
 
 #include "cc3xx_psa_init.h"
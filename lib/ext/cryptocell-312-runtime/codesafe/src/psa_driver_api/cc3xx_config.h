@@ -19,4 +19,23 @@
 #define CC3XX_CONFIG_ENABLE_AEAD_ONE_SHOT_USE_MULTIPART
 //#define CC3XX_CONFIG_ENABLE_AEAD_AES_CACHED_MODE
 
+#ifndef CC3XX_CONFIG_HASH_HW_MIN_INPUT_SIZE
+#define CC3XX_CONFIG_HASH_HW_MIN_INPUT_SIZE (0)
+#endif
+
+#ifndef CC3XX_CONFIG_CIPHER_HW_MIN_INPUT_SIZE
+#define CC3XX_CONFIG_CIPHER_HW_MIN_INPUT_SIZE (0)
+#endif
+
+#ifndef CC3XX_CONFIG_MAC_HW_MIN_INPUT_SIZE
+#define CC3XX_CONFIG_MAC_HW_MIN_INPUT_SIZE (0)
+#endif
+
+#if ((CC3XX_CONFIG_HASH_HW_MIN_INPUT_SIZE > 0) ||   \
+     (CC3XX_CONFIG_CIPHER_HW_MIN_INPUT_SIZE > 0) || \
+     (CC3XX_CONFIG_MAC_HW_MIN_INPUT_SIZE > 0)) &&   \
+    !defined(CC3XX_CONFIG_ENABLE_SW_FALLBACK)
+#error "CC3XX_CONFIG_*_HW_MIN_INPUT_SIZE requires CC3XX_CONFIG_ENABLE_SW_FALLBACK"
+#endif
+
 #endif /* CC3XX_CONFIG_H */
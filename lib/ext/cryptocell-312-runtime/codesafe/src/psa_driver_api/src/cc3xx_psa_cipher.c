@@ -19,6 +19,7 @@
 #include "cc3xx_internal_chacha20.h"
 #include "cc_pal_mem.h"
 #include "cc_pal_log.h"
+#include "cc3xx_config.h"
 
 /* To be able to include the PSA style configuration */
 #include "mbedtls/build_info.h"
@@ -628,6 +629,11 @@ psa_status_t cc3xx_cipher_encrypt(
     cc3xx_cipher_operation_t operation = {0};
     size_t olength, accumulated_length = 0;
 
+    if (input_length < CC3XX_CONFIG_CIPHER_HW_MIN_INPUT_SIZE) {
+        /* Let the software implementation handle short inputs */
+        return PSA_ERROR_NOT_SUPPORTED;
+    }
+
     if ( (ret = cc3xx_cipher_encrypt_setup(
             &operation,
             attributes,
@@ -702,6 +708,11 @@ psa_status_t cc3xx_cipher_decrypt(
     cc3xx_cipher_operation_t operation = {0};
     size_t olength, accumulated_length;
 
+    if (input_length < CC3XX_CONFIG_CIPHER_HW_MIN_INPUT_SIZE) {
+        /* Let the software implementation handle short inputs */
+        return PSA_ERROR_NOT_SUPPORTED;
+    }
+
     if ( (ret = cc3xx_cipher_decrypt_setup(
             &operation,
             attributes,
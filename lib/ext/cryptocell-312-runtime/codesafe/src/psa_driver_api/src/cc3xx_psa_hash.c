@@ -17,6 +17,7 @@
 #include "cc3xx_crypto_primitives_private.h"
 #include "cc_pal_log.h"
 #include "cc_pal_mem.h"
+#include "cc3xx_config.h"
 
 /* To be able to include the PSA style configuration */
 #include "mbedtls/build_info.h"
@@ -330,6 +331,11 @@ psa_status_t cc3xx_hash_compute(psa_algorithm_t alg, const uint8_t *input,
     psa_status_t abort_status = PSA_ERROR_CORRUPTION_DETECTED;
     cc3xx_hash_operation_t operation = {0};
 
+    if (input_length < CC3XX_CONFIG_HASH_HW_MIN_INPUT_SIZE) {
+        /* Let the software implementation handle short inputs */
+        return PSA_ERROR_NOT_SUPPORTED;
+    }
+
     status = cc3xx_hash_setup(&operation, alg);
     if (status != PSA_SUCCESS) {
         goto exit;
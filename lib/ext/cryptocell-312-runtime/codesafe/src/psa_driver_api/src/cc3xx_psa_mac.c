@@ -20,6 +20,7 @@
 #include "aes_driver.h"
 #include "cc_pal_log.h"
 #include "cc_pal_mem.h"
+#include "cc3xx_config.h"
 
 /* To be able to include the PSA style configuration */
 #include "mbedtls/build_info.h"
@@ -560,6 +561,11 @@ psa_status_t cc3xx_mac_compute(const psa_key_attributes_t *attributes,
     psa_status_t status = PSA_ERROR_CORRUPTION_DETECTED;
     cc3xx_mac_operation_t operation = {0};
 
+    if (input_length < CC3XX_CONFIG_MAC_HW_MIN_INPUT_SIZE) {
+        /* Let the software implementation handle short inputs */
+        return PSA_ERROR_NOT_SUPPORTED;
+    }
+
     status = cc3xx_mac_sign_setup(&operation, attributes, key_buffer,
                                   key_buffer_size, alg);
     if (status != PSA_SUCCESS) {
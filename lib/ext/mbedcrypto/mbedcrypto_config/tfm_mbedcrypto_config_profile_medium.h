@@ -615,7 +615,11 @@
  */
 
 /* ECP options */
+#ifdef CRYPTO_ECP_FIXED_POINT_OPTIM
+#define MBEDTLS_ECP_FIXED_POINT_OPTIM        1 /**< Enable fixed-point speed-up */
+#else
 #define MBEDTLS_ECP_FIXED_POINT_OPTIM        0 /**< Disable fixed-point speed-up */
+#endif
 
 /* \} name SECTION: Customisation configuration options */
 
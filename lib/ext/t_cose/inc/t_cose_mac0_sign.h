@@ -163,6 +163,44 @@ enum t_cose_err_t
 t_cose_mac0_encode_tag(struct t_cose_mac0_sign_ctx *context,
                        QCBOREncodeContext          *cbor_encode_ctx);
 
+/**
+ * The maximum size of the head of the ToBeMaced bytes output by
+ * t_cose_mac0_encode_tbm_head().
+ */
+#define T_COSE_MAC0_MAX_SIZE_TBM_HEAD \
+    (1 + /* For opening the array */ \
+     1 + 4 + /* "MAC0" */ \
+     2 + T_COSE_MAC0_MAX_SIZE_PROTECTED_PARAMETERS + \
+     1 + /* Empty bstr for absent external_aad */ \
+     9) /* The max CBOR length encoding for start of payload */
+
+/**
+ * \brief Output the head of the ToBeMaced bytes of a payload that is
+ *        not in a single buffer.
+ *
+ * \param[in] context       The t_cose signing context.
+ * \param[in] payload_len   Length of the CBOR-formatted payload.
+ * \param[in] buffer        Buffer to output the head to, of
+ *                          \ref T_COSE_MAC0_MAX_SIZE_TBM_HEAD bytes.
+ * \param[out] tbm_head     Pointer and length of the head.
+ *
+ * \return This returns one of the error codes defined by \ref t_cose_err_t.
+ *
+ * This is an alternative to t_cose_mac0_encode_tag() for a payload
+ * that is produced in pieces and never held in the output buffer. It
+ * must be called after t_cose_mac0_encode_parameters().
+ *
+ * The ToBeMaced bytes are \c tbm_head followed by the \c payload_len
+ * bytes of the payload. The caller computes their HMAC with the
+ * algorithm and key of the context, which is the tag
+ * t_cose_mac0_encode_tag() outputs for the same payload.
+ */
+enum t_cose_err_t
+t_cose_mac0_encode_tbm_head(struct t_cose_mac0_sign_ctx *context,
+                            size_t                       payload_len,
+                            struct q_useful_buf          buffer,
+                            struct q_useful_buf_c       *tbm_head);
+
 
 #ifndef T_COSE_DISABLE_CONTENT_TYPE
 /**
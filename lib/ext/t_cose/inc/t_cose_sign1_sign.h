@@ -312,6 +312,70 @@ t_cose_sign1_encode_signature(struct t_cose_sign1_sign_ctx *context,
                               QCBOREncodeContext           *cbor_encode_ctx);
 
 
+/**
+ * The maximum size of the head of the to-be-signed bytes output by
+ * t_cose_sign1_encode_tbs_head().
+ */
+#define T_COSE_SIGN1_MAX_SIZE_TBS_HEAD \
+    (1 + /* For opening the array */ \
+     1 + 10 + /* "Signature1" */ \
+     2 + T_COSE_SIGN1_MAX_SIZE_PROTECTED_PARAMETERS + \
+     1 + /* Empty bstr for absent external_aad */ \
+     9) /* The max CBOR length encoding for start of payload */
+
+
+/**
+ * \brief Output the head of the to-be-signed bytes of a payload that is
+ *        not in a single buffer.
+ *
+ * \param[in] context       The t_cose signing context.
+ * \param[in] payload_len   Length of the CBOR-formatted payload.
+ * \param[in] buffer        Buffer to output the head to, of
+ *                          \ref T_COSE_SIGN1_MAX_SIZE_TBS_HEAD bytes.
+ * \param[out] tbs_head     Pointer and length of the head.
+ *
+ * \return This returns one of the error codes defined by \ref t_cose_err_t.
+ *
+ * This is an alternative to t_cose_sign1_encode_signature() for a
+ * payload that is produced in pieces and never held in the output
+ * buffer, for example because it is sent out as it is produced. It
+ * must be called after t_cose_sign1_encode_parameters().
+ *
+ * The to-be-signed bytes are \c tbs_head followed by the \c payload_len
+ * bytes of the payload. The caller hashes them with the hash
+ * algorithm of the signing algorithm, and then gets the signature
+ * with t_cose_sign1_sign_hash(). The signature is the same as the one
+ * t_cose_sign1_encode_signature() outputs for the same payload.
+ */
+enum t_cose_err_t
+t_cose_sign1_encode_tbs_head(struct t_cose_sign1_sign_ctx *context,
+                             size_t                        payload_len,
+                             struct q_useful_buf           buffer,
+                             struct q_useful_buf_c        *tbs_head);
+
+
+/**
+ * \brief Sign the hash of the to-be-signed bytes.
+ *
+ * \param[in] context           The t_cose signing context.
+ * \param[in] tbs_hash          Hash of the to-be-signed bytes, see
+ *                              t_cose_sign1_encode_tbs_head().
+ * \param[in] signature_buffer  Buffer to output the signature to.
+ * \param[out] signature        Pointer and length of the signature.
+ *
+ * \return This returns one of the error codes defined by \ref t_cose_err_t.
+ *
+ * This runs the signing algorithm with the key and options of the
+ * context, short-circuit signing included. The signature is to be
+ * added as the last item of the \c COSE_Sign1 array.
+ */
+enum t_cose_err_t
+t_cose_sign1_sign_hash(struct t_cose_sign1_sign_ctx *context,
+                       struct q_useful_buf_c         tbs_hash,
+                       struct q_useful_buf           signature_buffer,
+                       struct q_useful_buf_c        *signature);
+
+
 
 
 
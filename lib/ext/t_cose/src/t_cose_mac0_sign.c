@@ -410,3 +410,27 @@ CloseArray:
 Done:
     return return_value;
 }
+
+/*
+ * Public function. See t_cose_mac0.h
+ */
+enum t_cose_err_t
+t_cose_mac0_encode_tbm_head(struct t_cose_mac0_sign_ctx *me,
+                            size_t                       payload_len,
+                            struct q_useful_buf          buffer,
+                            struct q_useful_buf_c       *tbm_head)
+{
+    struct q_useful_buf_c payload = {NULL, payload_len};
+
+    if(q_useful_buf_c_is_null(me->protected_parameters)) {
+        /* t_cose_mac0_encode_parameters() was not called */
+        return T_COSE_ERR_MAKING_PROTECTED;
+    }
+
+    /* The head of the payload bstr is MACed with the first part */
+    return create_tbm(buffer,
+                      me->protected_parameters,
+                      tbm_head,
+                      T_COSE_TBM_BARE_PAYLOAD,
+                      payload);
+}
@@ -421,6 +421,77 @@ Done:
 }
 
 
+/*
+ * Public function. See t_cose_sign1_sign.h
+ */
+enum t_cose_err_t
+t_cose_sign1_encode_tbs_head(struct t_cose_sign1_sign_ctx *me,
+                             size_t                        payload_len,
+                             struct q_useful_buf           buffer,
+                             struct q_useful_buf_c        *tbs_head)
+{
+    QCBOREncodeContext    cbor_encode_ctx;
+    QCBORError            cbor_err;
+    struct q_useful_buf_c payload = {NULL, payload_len};
+
+    if(q_useful_buf_c_is_null(me->protected_parameters)) {
+        /* t_cose_sign1_encode_parameters() was not called */
+        return T_COSE_ERR_MAKING_PROTECTED;
+    }
+
+    /* The Sig_structure up to and including the head of the payload
+     * bstr. This is what create_tbs_hash() hashes before the payload.
+     */
+    QCBOREncode_Init(&cbor_encode_ctx, buffer);
+    QCBOREncode_OpenArray(&cbor_encode_ctx);
+    QCBOREncode_AddSZString(&cbor_encode_ctx,
+                            COSE_SIG_CONTEXT_STRING_SIGNATURE1);
+    QCBOREncode_AddBytes(&cbor_encode_ctx, me->protected_parameters);
+    /* external_aad. There is none so an empty bstr */
+    QCBOREncode_AddBytes(&cbor_encode_ctx, NULL_Q_USEFUL_BUF_C);
+    QCBOREncode_AddBytesLenOnly(&cbor_encode_ctx, payload);
+    QCBOREncode_CloseArray(&cbor_encode_ctx);
+
+    cbor_err = QCBOREncode_Finish(&cbor_encode_ctx, tbs_head);
+    if(cbor_err == QCBOR_ERR_BUFFER_TOO_SMALL) {
+        return T_COSE_ERR_TOO_SMALL;
+    } else if(cbor_err != QCBOR_SUCCESS) {
+        return T_COSE_ERR_CBOR_FORMATTING;
+    }
+
+    return T_COSE_SUCCESS;
+}
+
+
+/*
+ * Public function. See t_cose_sign1_sign.h
+ */
+enum t_cose_err_t
+t_cose_sign1_sign_hash(struct t_cose_sign1_sign_ctx *me,
+                       struct q_useful_buf_c         tbs_hash,
+                       struct q_useful_buf           signature_buffer,
+                       struct q_useful_buf_c        *signature)
+{
+    if(!(me->option_flags & T_COSE_OPT_SHORT_CIRCUIT_SIG)) {
+        /* Normal, non-short-circuit signing */
+        return t_cose_crypto_pub_key_sign(me->cose_algorithm_id,
+                                          me->signing_key,
+                                          tbs_hash,
+                                          signature_buffer,
+                                          signature);
+    }
+
+#ifndef T_COSE_DISABLE_SHORT_CIRCUIT_SIGN
+    return short_circuit_sign(me->cose_algorithm_id,
+                              tbs_hash,
+                              signature_buffer,
+                              signature);
+#else
+    return T_COSE_ERR_SHORT_CIRCUIT_SIG_DISABLED;
+#endif
+}
+
+
 /*
  * Public function. See t_cose_sign1_sign.h
  */
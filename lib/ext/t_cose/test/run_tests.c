@@ -80,6 +80,7 @@ static test_entry s_tests[] = {
     TEST_ENTRY(short_circuit_decode_only_test),
     TEST_ENTRY(short_circuit_make_cwt_test),
     TEST_ENTRY(short_circuit_verify_fail_test),
+    TEST_ENTRY(short_circuit_sign_hash_test),
 #endif /* T_COSE_DISABLE_SHORT_CIRCUIT_SIGN */
 
 #ifdef T_COSE_ENABLE_HASH_FAIL_TEST
@@ -75,6 +75,107 @@ int_fast32_t short_circuit_self_test()
 }
 
 
+/*
+ * Public function, see t_cose_test.h
+ */
+int_fast32_t short_circuit_sign_hash_test()
+{
+    struct t_cose_sign1_sign_ctx    sign_ctx;
+    enum t_cose_err_t               return_value;
+    Q_USEFUL_BUF_MAKE_STACK_UB(     signed_cose_buffer, 200);
+    struct q_useful_buf_c           signed_cose;
+    Q_USEFUL_BUF_MAKE_STACK_UB(     pieces_cose_buffer, 200);
+    struct q_useful_buf_c           pieces_cose;
+    Q_USEFUL_BUF_MAKE_STACK_UB(     tbs_head_buffer,
+                                    T_COSE_SIGN1_MAX_SIZE_TBS_HEAD);
+    struct q_useful_buf_c           tbs_head;
+    Q_USEFUL_BUF_MAKE_STACK_UB(     hash_buffer, T_COSE_CRYPTO_MAX_HASH_SIZE);
+    struct q_useful_buf_c           tbs_hash;
+    Q_USEFUL_BUF_MAKE_STACK_UB(     signature_buffer, T_COSE_MAX_SIG_SIZE);
+    struct q_useful_buf_c           signature;
+    struct t_cose_crypto_hash       hash_ctx;
+    QCBOREncodeContext              cbor_encode;
+    struct q_useful_buf_c           payload;
+    struct q_useful_buf_c           payload_first_part;
+    struct q_useful_buf_c           wrapped_payload;
+
+    payload = Q_USEFUL_BUF_FROM_SZ_LITERAL("payload");
+
+    /* --- Make COSE Sign1 object the usual way --- */
+    t_cose_sign1_sign_init(&sign_ctx,
+                           T_COSE_OPT_SHORT_CIRCUIT_SIG,
+                           T_COSE_ALGORITHM_ES256);
+
+    return_value = t_cose_sign1_sign(&sign_ctx,
+                                     payload,
+                                     signed_cose_buffer,
+                                     &signed_cose);
+    if(return_value) {
+        return 1000 + return_value;
+    }
+
+    /* --- Make it again, hashing the payload in pieces --- */
+    t_cose_sign1_sign_init(&sign_ctx,
+                           T_COSE_OPT_SHORT_CIRCUIT_SIG,
+                           T_COSE_ALGORITHM_ES256);
+
+    QCBOREncode_Init(&cbor_encode, pieces_cose_buffer);
+    return_value = t_cose_sign1_encode_parameters(&sign_ctx, &cbor_encode);
+    if(return_value) {
+        return 2000 + return_value;
+    }
+    QCBOREncode_AddEncoded(&cbor_encode, payload);
+    QCBOREncode_CloseBstrWrap(&cbor_encode, &wrapped_payload);
+
+    return_value = t_cose_sign1_encode_tbs_head(&sign_ctx,
+                                                payload.len,
+                                                tbs_head_buffer,
+                                                &tbs_head);
+    if(return_value) {
+        return 3000 + return_value;
+    }
+
+    return_value = t_cose_crypto_hash_start(&hash_ctx,
+                                            COSE_ALGORITHM_SHA_256);
+    if(return_value) {
+        return 4000 + return_value;
+    }
+    payload_first_part = q_useful_buf_head(payload, 3);
+    t_cose_crypto_hash_update(&hash_ctx, tbs_head);
+    t_cose_crypto_hash_update(&hash_ctx, payload_first_part);
+    t_cose_crypto_hash_update(&hash_ctx,
+                              q_useful_buf_tail(payload,
+                                                payload_first_part.len));
+    return_value = t_cose_crypto_hash_finish(&hash_ctx,
+                                             hash_buffer,
+                                             &tbs_hash);
+    if(return_value) {
+        return 5000 + return_value;
+    }
+
+    return_value = t_cose_sign1_sign_hash(&sign_ctx,
+                                          tbs_hash,
+                                          signature_buffer,
+                                          &signature);
+    if(return_value) {
+        return 6000 + return_value;
+    }
+
+    QCBOREncode_AddBytes(&cbor_encode, signature);
+    QCBOREncode_CloseArray(&cbor_encode);
+    if(QCBOREncode_Finish(&cbor_encode, &pieces_cose)) {
+        return 7000;
+    }
+
+    /* --- Both must be the same, byte for byte --- */
+    if(q_useful_buf_compare(signed_cose, pieces_cose)) {
+        return 8000;
+    }
+
+    return 0;
+}
+
+
 /*
  * Public function, see t_cose_test.h
  */
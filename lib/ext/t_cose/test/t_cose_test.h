@@ -63,6 +63,19 @@ int_fast32_t short_circuit_signing_error_conditions_test(void);
 int_fast32_t short_circuit_make_cwt_test(void);
 
 
+/**
+ * \brief Signing the hash of a payload hashed in pieces.
+ *
+ * \return non-zero on failure.
+ *
+ * This makes the same COSE_Sign1 with t_cose_sign1_sign() and with
+ * t_cose_sign1_encode_tbs_head() and t_cose_sign1_sign_hash(), and
+ * checks they are identical. It uses short-circuit signatures, which
+ * are deterministic.
+ */
+int_fast32_t short_circuit_sign_hash_test(void);
+
+
 /*
  * Test the decode only mode, the mode where the
  * headers are returned, but the signature is no
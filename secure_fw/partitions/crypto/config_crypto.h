@@ -26,12 +26,48 @@
 #define CRYPTO_ENGINE_BUF_SIZE                 0x4000
 #endif
 
+/*
+ * Bytes of the Crypto backend heap divided into size-class slabs for small
+ * allocations, the rest being a fallback heap. 0 uses a single heap.
+ */
+#ifndef CRYPTO_ENGINE_SLAB_SIZE
+#pragma message("CRYPTO_ENGINE_SLAB_SIZE is defaulted to 0. Please check and set it explicitly.")
+#define CRYPTO_ENGINE_SLAB_SIZE                0
+#endif
+
 /* The max number of concurrent operations that can be active (allocated) at any time in Crypto */
 #ifndef CRYPTO_CONC_OPER_NUM
 #pragma message("CRYPTO_CONC_OPER_NUM is defaulted to 8. Please check and set it explicitly.")
 #define CRYPTO_CONC_OPER_NUM                   8
 #endif
 
+/* The max number of operations that can be allocated by a single owner, 0 means no quota */
+#ifndef CRYPTO_CONC_OPER_OWNER_QUOTA
+#pragma message("CRYPTO_CONC_OPER_OWNER_QUOTA is defaulted to 0. Please check and set it explicitly.")
+#define CRYPTO_CONC_OPER_OWNER_QUOTA           0
+#endif
+
+/* The max number of persistent keys kept loaded in the key slots, 0 disables the key cache */
+#ifndef CRYPTO_KEY_CACHE_SLOTS
+#pragma message("CRYPTO_KEY_CACHE_SLOTS is defaulted to 0. Please check and set it explicitly.")
+#define CRYPTO_KEY_CACHE_SLOTS                 0
+#endif
+
+/* The max number of keys of the key cache a single owner can pin */
+#ifndef CRYPTO_KEY_CACHE_PIN_QUOTA
+#pragma message("CRYPTO_KEY_CACHE_PIN_QUOTA is defaulted to 1. Please check and set it explicitly.")
+#define CRYPTO_KEY_CACHE_PIN_QUOTA             1
+#endif
+
+/*
+ * The max number of per-owner subkeys derived from builtin keys kept cached in
+ * the builtin key driver. 0 disables the derived key cache.
+ */
+#ifndef TFM_BUILTIN_DERIVED_KEY_CACHE_SIZE
+#pragma message("TFM_BUILTIN_DERIVED_KEY_CACHE_SIZE is defaulted to 0. Please check and set it explicitly.")
+#define TFM_BUILTIN_DERIVED_KEY_CACHE_SIZE     0
+#endif
+
 /* Enable PSA Crypto random number generator module */
 #ifndef CRYPTO_RNG_MODULE_ENABLED
 #pragma message("CRYPTO_RNG_MODULE_ENABLED is defaulted to 1. Please check and set it explicitly.")
@@ -86,12 +122,44 @@
 #define CRYPTO_KEY_DERIVATION_MODULE_ENABLED   1
 #endif
 
+/* The max number of concurrent operations of each type, in its own pool */
+#ifndef CRYPTO_CIPHER_CONC_OPER_NUM
+#pragma message("CRYPTO_CIPHER_CONC_OPER_NUM is defaulted to 8. Please check and set it explicitly.")
+#define CRYPTO_CIPHER_CONC_OPER_NUM            8
+#endif
+
+#ifndef CRYPTO_MAC_CONC_OPER_NUM
+#pragma message("CRYPTO_MAC_CONC_OPER_NUM is defaulted to 8. Please check and set it explicitly.")
+#define CRYPTO_MAC_CONC_OPER_NUM               8
+#endif
+
+#ifndef CRYPTO_HASH_CONC_OPER_NUM
+#pragma message("CRYPTO_HASH_CONC_OPER_NUM is defaulted to 8. Please check and set it explicitly.")
+#define CRYPTO_HASH_CONC_OPER_NUM              8
+#endif
+
+#ifndef CRYPTO_KEY_DERIVATION_CONC_OPER_NUM
+#pragma message("CRYPTO_KEY_DERIVATION_CONC_OPER_NUM is defaulted to 8. Please check and set it explicitly.")
+#define CRYPTO_KEY_DERIVATION_CONC_OPER_NUM    8
+#endif
+
+#ifndef CRYPTO_AEAD_CONC_OPER_NUM
+#pragma message("CRYPTO_AEAD_CONC_OPER_NUM is defaulted to 8. Please check and set it explicitly.")
+#define CRYPTO_AEAD_CONC_OPER_NUM              8
+#endif
+
 /* Default size of the internal scratch buffer used for PSA FF IOVec allocations */
 #ifndef CRYPTO_IOVEC_BUFFER_SIZE
 #pragma message("CRYPTO_IOVEC_BUFFER_SIZE is defaulted to 5120. Please check and set it explicitly.")
 #define CRYPTO_IOVEC_BUFFER_SIZE               5120
 #endif
 
+/* Stream the input of multi-part update calls through the internal scratch */
+#ifndef CRYPTO_STREAM_UPDATE_ENABLED
+#pragma message("CRYPTO_STREAM_UPDATE_ENABLED is defaulted to 1. Please check and set it explicitly.")
+#define CRYPTO_STREAM_UPDATE_ENABLED           1
+#endif
+
 /* Use stored NV seed to provide entropy */
 #ifndef CRYPTO_NV_SEED
 #pragma message("CRYPTO_NV_SEED is defaulted to 1. Please check and set it explicitly.")
@@ -107,6 +175,12 @@
 #define CRYPTO_SINGLE_PART_FUNCS_DISABLED      0
 #endif
 
+/* Record per-function call statistics in the Crypto dispatcher */
+#ifndef CRYPTO_STATS_ENABLED
+#pragma message("CRYPTO_STATS_ENABLED is defaulted to 0. Please check and set it explicitly.")
+#define CRYPTO_STATS_ENABLED                   0
+#endif
+
 /* The stack size of the Crypto Secure Partition */
 #ifndef CRYPTO_STACK_SIZE
 #pragma message("CRYPTO_STACK_SIZE is defaulted to 0x1B00. Please check and set it explicitly.")
@@ -114,6 +188,10 @@
 #endif
 
 /* Check invalid configs. */
+#if CRYPTO_ENGINE_SLAB_SIZE >= CRYPTO_ENGINE_BUF_SIZE
+#error "Invalid config: CRYPTO_ENGINE_SLAB_SIZE must be smaller than CRYPTO_ENGINE_BUF_SIZE!"
+#endif
+
 #if CRYPTO_NV_SEED && defined(CRYPTO_HW_ACCELERATOR)
 #error "Invalid config: CRYPTO_NV_SEED AND CRYPTO_HW_ACCELERATOR!"
 #endif
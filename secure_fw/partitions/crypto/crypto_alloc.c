@@ -16,36 +16,229 @@
 #include "tfm_crypto_defs.h"
 
 
-struct tfm_crypto_operation_s {
-    uint32_t in_use;                /*!< Indicates if the operation is in use */
+/*
+ * An operation handle encodes the type of the operation, the index of the slot
+ * in the pool of that type and the generation of the slot. The generation is
+ * bumped whenever the slot is released, so that a stale handle does not match
+ * a context that has been allocated again.
+ */
+#define HANDLE_SLOT_MASK            (0xFFu)
+#define HANDLE_TYPE_OFFSET          (8u)
+#define HANDLE_TYPE_MASK            (0xFFu)
+#define HANDLE_GEN_OFFSET           (16u)
+
+#define MAKE_HANDLE(type, idx, gen)                        \
+    (((uint32_t)(gen) << HANDLE_GEN_OFFSET) |              \
+     ((uint32_t)(type) << HANDLE_TYPE_OFFSET) |            \
+     ((uint32_t)(idx) + 1u))
+#define GET_HANDLE_SLOT(handle)     (((handle) & HANDLE_SLOT_MASK) - 1u)
+#define GET_HANDLE_TYPE(handle)     \
+    (((handle) >> HANDLE_TYPE_OFFSET) & HANDLE_TYPE_MASK)
+#define GET_HANDLE_GEN(handle)      ((uint16_t)((handle) >> HANDLE_GEN_OFFSET))
+
+/* Marks the end of a free list */
+#define SLOT_IDX_NONE               (0xFFu)
+
+#if (CRYPTO_CIPHER_CONC_OPER_NUM >= SLOT_IDX_NONE) || \
+    (CRYPTO_MAC_CONC_OPER_NUM >= SLOT_IDX_NONE) || \
+    (CRYPTO_HASH_CONC_OPER_NUM >= SLOT_IDX_NONE) || \
+    (CRYPTO_KEY_DERIVATION_CONC_OPER_NUM >= SLOT_IDX_NONE) || \
+    (CRYPTO_AEAD_CONC_OPER_NUM >= SLOT_IDX_NONE)
+#error "The number of concurrent operations of a type must be less than 255"
+#endif
+
+/* The number of operation types, TFM_CRYPTO_OPERATION_NONE excluded */
+#define TFM_CRYPTO_OPERATION_TYPE_NUM   (TFM_CRYPTO_AEAD_OPERATION)
+
+struct tfm_crypto_slot_hdr_t {
     int32_t owner;                  /*!< Indicates an ID of the owner of
                                      *   the context
                                      */
-    enum tfm_crypto_operation_type type; /*!< Type of the operation */
-    union {
-        psa_cipher_operation_t cipher;    /*!< Cipher operation context */
-        psa_mac_operation_t mac;          /*!< MAC operation context */
-        psa_hash_operation_t hash;        /*!< Hash operation context */
-        psa_key_derivation_operation_t key_deriv; /*!< Key derivation operation context */
-        psa_aead_operation_t aead;        /*!< AEAD operation context */
-    } operation;
+    uint16_t generation;            /*!< Generation of the slot */
+    uint8_t in_use;                 /*!< Indicates if the slot is in use */
+    uint8_t next_free;              /*!< Next slot in the free list */
+};
+
+/*
+ * \brief Pool of the operation contexts of one type. Each slot is a header
+ *        followed by a context sized for that type only.
+ */
+struct tfm_crypto_pool_t {
+    uint8_t *slots;                 /*!< Base of the slot array */
+    size_t slot_size;               /*!< Size of a slot */
+    size_t ctx_offset;              /*!< Offset of the context in a slot */
+    size_t ctx_size;                /*!< Size of the context */
+    uint8_t num;                    /*!< Number of slots */
+    uint8_t free_head;              /*!< First slot in the free list */
 };
 
-static struct tfm_crypto_operation_s operations[CRYPTO_CONC_OPER_NUM] = {{0}};
+#define TFM_CRYPTO_POOL_DECLARE(name, ctx_type, num)                \
+    static struct {                                                 \
+        struct tfm_crypto_slot_hdr_t hdr;                           \
+        ctx_type ctx;                                               \
+    } name##_slots[num]
 
+#define TFM_CRYPTO_POOL_INIT(type, name, num)                       \
+    pool_init(&pools[(type) - 1], (uint8_t *)name##_slots,          \
+              sizeof(name##_slots[0]),                              \
+              (size_t)((uint8_t *)&name##_slots[0].ctx -            \
+                       (uint8_t *)&name##_slots[0]),                \
+              sizeof(name##_slots[0].ctx), (num))
+
+#if CRYPTO_CIPHER_MODULE_ENABLED && (CRYPTO_CIPHER_CONC_OPER_NUM > 0)
+TFM_CRYPTO_POOL_DECLARE(cipher, psa_cipher_operation_t,
+                        CRYPTO_CIPHER_CONC_OPER_NUM);
+#endif
+#if CRYPTO_MAC_MODULE_ENABLED && (CRYPTO_MAC_CONC_OPER_NUM > 0)
+TFM_CRYPTO_POOL_DECLARE(mac, psa_mac_operation_t, CRYPTO_MAC_CONC_OPER_NUM);
+#endif
+#if CRYPTO_HASH_MODULE_ENABLED && (CRYPTO_HASH_CONC_OPER_NUM > 0)
+TFM_CRYPTO_POOL_DECLARE(hash, psa_hash_operation_t,
+                        CRYPTO_HASH_CONC_OPER_NUM);
+#endif
+#if CRYPTO_KEY_DERIVATION_MODULE_ENABLED && \
+    (CRYPTO_KEY_DERIVATION_CONC_OPER_NUM > 0)
+TFM_CRYPTO_POOL_DECLARE(key_deriv, psa_key_derivation_operation_t,
+                        CRYPTO_KEY_DERIVATION_CONC_OPER_NUM);
+#endif
+#if CRYPTO_AEAD_MODULE_ENABLED && (CRYPTO_AEAD_CONC_OPER_NUM > 0)
+TFM_CRYPTO_POOL_DECLARE(aead, psa_aead_operation_t,
+                        CRYPTO_AEAD_CONC_OPER_NUM);
+#endif
+
+static struct tfm_crypto_pool_t pools[TFM_CRYPTO_OPERATION_TYPE_NUM];
+
+/* The number of operations allocated across all the pools, at most
+ * CRYPTO_CONC_OPER_NUM
+ */
+static uint32_t nr_active_ops;
+
+#if CRYPTO_CONC_OPER_OWNER_QUOTA > 0
 /*
- * \brief Function used to clear the memory associated to a backend context
+ * Number of operations held by each owner. An entry is only used while its
+ * owner holds operations, so there cannot be more owners than slots.
+ */
+#define TFM_CRYPTO_OWNER_NUM   (CRYPTO_CIPHER_CONC_OPER_NUM +           \
+                                CRYPTO_MAC_CONC_OPER_NUM +              \
+                                CRYPTO_HASH_CONC_OPER_NUM +             \
+                                CRYPTO_KEY_DERIVATION_CONC_OPER_NUM +   \
+                                CRYPTO_AEAD_CONC_OPER_NUM)
+
+static struct {
+    int32_t owner;
+    uint32_t nr_ops;
+} owner_usage[TFM_CRYPTO_OWNER_NUM];
+
+/*
+ * \brief Charges one operation to the quota of an owner
  *
- * \param[in] index Numerical index in the database of the backend contexts
+ * \param[in] owner ID of the owner
  *
- * \return None
+ * \return PSA_SUCCESS, or PSA_ERROR_INSUFFICIENT_MEMORY if the owner has
+ *         used up its quota
+ */
+static psa_status_t owner_quota_take(int32_t owner)
+{
+    uint32_t i, free_idx = TFM_CRYPTO_OWNER_NUM;
+
+    for (i = 0; i < TFM_CRYPTO_OWNER_NUM; i++) {
+        if (owner_usage[i].nr_ops == 0) {
+            free_idx = i;
+        } else if (owner_usage[i].owner == owner) {
+            if (owner_usage[i].nr_ops >= CRYPTO_CONC_OPER_OWNER_QUOTA) {
+                return PSA_ERROR_INSUFFICIENT_MEMORY;
+            }
+            owner_usage[i].nr_ops++;
+            return PSA_SUCCESS;
+        }
+    }
+
+    if (free_idx == TFM_CRYPTO_OWNER_NUM) {
+        return PSA_ERROR_INSUFFICIENT_MEMORY;
+    }
+
+    owner_usage[free_idx].owner = owner;
+    owner_usage[free_idx].nr_ops = 1;
+
+    return PSA_SUCCESS;
+}
+
+static void owner_quota_give(int32_t owner)
+{
+    uint32_t i;
+
+    for (i = 0; i < TFM_CRYPTO_OWNER_NUM; i++) {
+        if ((owner_usage[i].nr_ops != 0) && (owner_usage[i].owner == owner)) {
+            owner_usage[i].nr_ops--;
+            return;
+        }
+    }
+}
+#endif /* CRYPTO_CONC_OPER_OWNER_QUOTA > 0 */
+
+static struct tfm_crypto_slot_hdr_t *get_slot(
+                                        const struct tfm_crypto_pool_t *pool,
+                                        uint32_t idx)
+{
+    return (struct tfm_crypto_slot_hdr_t *)(pool->slots +
+                                            idx * pool->slot_size);
+}
+
+static void pool_init(struct tfm_crypto_pool_t *pool, uint8_t *slots,
+                      size_t slot_size, size_t ctx_offset, size_t ctx_size,
+                      uint8_t num)
+{
+    uint8_t i;
+
+    pool->slots = slots;
+    pool->slot_size = slot_size;
+    pool->ctx_offset = ctx_offset;
+    pool->ctx_size = ctx_size;
+    pool->num = num;
+
+    (void)memset(slots, 0, slot_size * num);
+
+    /* Chain all the slots into the free list */
+    for (i = 0; i + 1 < num; i++) {
+        get_slot(pool, i)->next_free = i + 1;
+    }
+    if (num > 0) {
+        get_slot(pool, num - 1)->next_free = SLOT_IDX_NONE;
+    }
+    pool->free_head = (num > 0) ? 0 : SLOT_IDX_NONE;
+}
+
+/*
+ * \brief Finds the slot of a handle. The handle must match the generation of
+ *        the slot and the slot must be in use.
  *
+ * \return The pool holding the slot, or NULL if the handle is invalid
  */
-static void memset_operation_context(uint32_t index)
+static struct tfm_crypto_pool_t *handle_to_slot(
+                                        uint32_t handle,
+                                        struct tfm_crypto_slot_hdr_t **slot)
 {
-    /* Clear the contents of the backend context */
-    (void)memset((uint8_t *)&(operations[index].operation), 0,
-                 sizeof(operations[index].operation));
+    uint32_t type = GET_HANDLE_TYPE(handle);
+    uint32_t idx = GET_HANDLE_SLOT(handle);
+    struct tfm_crypto_pool_t *pool;
+
+    if ((type == TFM_CRYPTO_OPERATION_NONE) ||
+        (type > TFM_CRYPTO_OPERATION_TYPE_NUM)) {
+        return NULL;
+    }
+
+    pool = &pools[type - 1];
+    if (idx >= pool->num) {
+        return NULL;
+    }
+
+    *slot = get_slot(pool, idx);
+    if (((*slot)->in_use != TFM_CRYPTO_IN_USE) ||
+        ((*slot)->generation != GET_HANDLE_GEN(handle))) {
+        return NULL;
+    }
+
+    return pool;
 }
 
 /*!
@@ -57,8 +250,42 @@ static void memset_operation_context(uint32_t index)
 /*!@{*/
 psa_status_t tfm_crypto_init_alloc(void)
 {
-    /* Clear the contents of the local contexts */
-    (void)memset(operations, 0, sizeof(operations));
+    uint32_t i;
+
+    /* Clear the contents of the local contexts and build the free lists */
+    (void)memset(pools, 0, sizeof(pools));
+    for (i = 0; i < TFM_CRYPTO_OPERATION_TYPE_NUM; i++) {
+        /* Pools of the types without contexts stay empty */
+        pools[i].free_head = SLOT_IDX_NONE;
+    }
+    nr_active_ops = 0;
+
+#if CRYPTO_CIPHER_MODULE_ENABLED && (CRYPTO_CIPHER_CONC_OPER_NUM > 0)
+    TFM_CRYPTO_POOL_INIT(TFM_CRYPTO_CIPHER_OPERATION, cipher,
+                         CRYPTO_CIPHER_CONC_OPER_NUM);
+#endif
+#if CRYPTO_MAC_MODULE_ENABLED && (CRYPTO_MAC_CONC_OPER_NUM > 0)
+    TFM_CRYPTO_POOL_INIT(TFM_CRYPTO_MAC_OPERATION, mac,
+                         CRYPTO_MAC_CONC_OPER_NUM);
+#endif
+#if CRYPTO_HASH_MODULE_ENABLED && (CRYPTO_HASH_CONC_OPER_NUM > 0)
+    TFM_CRYPTO_POOL_INIT(TFM_CRYPTO_HASH_OPERATION, hash,
+                         CRYPTO_HASH_CONC_OPER_NUM);
+#endif
+#if CRYPTO_KEY_DERIVATION_MODULE_ENABLED && \
+    (CRYPTO_KEY_DERIVATION_CONC_OPER_NUM > 0)
+    TFM_CRYPTO_POOL_INIT(TFM_CRYPTO_KEY_DERIVATION_OPERATION, key_deriv,
+                         CRYPTO_KEY_DERIVATION_CONC_OPER_NUM);
+#endif
+#if CRYPTO_AEAD_MODULE_ENABLED && (CRYPTO_AEAD_CONC_OPER_NUM > 0)
+    TFM_CRYPTO_POOL_INIT(TFM_CRYPTO_AEAD_OPERATION, aead,
+                         CRYPTO_AEAD_CONC_OPER_NUM);
+#endif
+
+#if CRYPTO_CONC_OPER_OWNER_QUOTA > 0
+    (void)memset(owner_usage, 0, sizeof(owner_usage));
+#endif
+
     return PSA_SUCCESS;
 }
 
@@ -66,9 +293,11 @@ psa_status_t tfm_crypto_operation_alloc(enum tfm_crypto_operation_type type,
                                         uint32_t *handle,
                                         void **ctx)
 {
-    uint32_t i = 0;
     int32_t partition_id = 0;
     psa_status_t status;
+    struct tfm_crypto_pool_t *pool;
+    struct tfm_crypto_slot_hdr_t *slot;
+    uint8_t idx;
 
     /* Handle must be initialised before calling a setup function */
     if (*handle != TFM_CRYPTO_INVALID_HANDLE) {
@@ -81,23 +310,39 @@ psa_status_t tfm_crypto_operation_alloc(enum tfm_crypto_operation_type type,
     }
     *ctx = NULL;
 
+    if ((type == TFM_CRYPTO_OPERATION_NONE) ||
+        (type > TFM_CRYPTO_OPERATION_TYPE_NUM)) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
     status = tfm_crypto_get_caller_id(&partition_id);
     if (status != PSA_SUCCESS) {
         return status;
     }
 
-    for (i = 0; i < CRYPTO_CONC_OPER_NUM; i++) {
-        if (operations[i].in_use == TFM_CRYPTO_NOT_IN_USE) {
-            operations[i].in_use = TFM_CRYPTO_IN_USE;
-            operations[i].owner = partition_id;
-            operations[i].type = type;
-            *handle = i + 1;
-            *ctx = (void *) &(operations[i].operation);
-            return PSA_SUCCESS;
-        }
+    pool = &pools[type - 1];
+    idx = pool->free_head;
+    if ((idx == SLOT_IDX_NONE) || (nr_active_ops >= CRYPTO_CONC_OPER_NUM)) {
+        return PSA_ERROR_NOT_PERMITTED;
     }
 
-    return PSA_ERROR_NOT_PERMITTED;
+#if CRYPTO_CONC_OPER_OWNER_QUOTA > 0
+    status = owner_quota_take(partition_id);
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+#endif
+
+    slot = get_slot(pool, idx);
+    pool->free_head = slot->next_free;
+
+    slot->in_use = TFM_CRYPTO_IN_USE;
+    slot->owner = partition_id;
+    nr_active_ops++;
+    *handle = MAKE_HANDLE(type, idx, slot->generation);
+    *ctx = (void *)((uint8_t *)slot + pool->ctx_offset);
+
+    return PSA_SUCCESS;
 }
 
 psa_status_t tfm_crypto_operation_release(uint32_t *handle)
@@ -105,12 +350,14 @@ psa_status_t tfm_crypto_operation_release(uint32_t *handle)
     uint32_t h_val = *handle;
     int32_t partition_id = 0;
     psa_status_t status;
+    struct tfm_crypto_pool_t *pool;
+    struct tfm_crypto_slot_hdr_t *slot = NULL;
 
     /* Handle shall be cleaned up always at first */
     *handle = TFM_CRYPTO_INVALID_HANDLE;
 
-    if ((h_val == TFM_CRYPTO_INVALID_HANDLE) ||
-        (h_val > CRYPTO_CONC_OPER_NUM)) {
+    pool = handle_to_slot(h_val, &slot);
+    if (pool == NULL) {
         return PSA_ERROR_INVALID_ARGUMENT;
     }
 
@@ -119,18 +366,25 @@ psa_status_t tfm_crypto_operation_release(uint32_t *handle)
         return status;
     }
 
-    if ((operations[h_val - 1].in_use == TFM_CRYPTO_IN_USE) &&
-        (operations[h_val - 1].owner == partition_id)) {
+    if (slot->owner != partition_id) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
 
-        memset_operation_context(h_val - 1);
-        operations[h_val - 1].in_use = TFM_CRYPTO_NOT_IN_USE;
-        operations[h_val - 1].type = TFM_CRYPTO_OPERATION_NONE;
-        operations[h_val - 1].owner = 0;
+    /* Clear the contents of the backend context */
+    (void)memset((uint8_t *)slot + pool->ctx_offset, 0, pool->ctx_size);
 
-        return PSA_SUCCESS;
-    }
+#if CRYPTO_CONC_OPER_OWNER_QUOTA > 0
+    owner_quota_give(slot->owner);
+#endif
 
-    return PSA_ERROR_INVALID_ARGUMENT;
+    slot->in_use = TFM_CRYPTO_NOT_IN_USE;
+    slot->owner = 0;
+    nr_active_ops--;
+    slot->generation++;
+    slot->next_free = pool->free_head;
+    pool->free_head = (uint8_t)GET_HANDLE_SLOT(h_val);
+
+    return PSA_SUCCESS;
 }
 
 psa_status_t tfm_crypto_operation_lookup(enum tfm_crypto_operation_type type,
@@ -139,9 +393,15 @@ psa_status_t tfm_crypto_operation_lookup(enum tfm_crypto_operation_type type,
 {
     int32_t partition_id = 0;
     psa_status_t status;
+    struct tfm_crypto_pool_t *pool;
+    struct tfm_crypto_slot_hdr_t *slot = NULL;
+
+    if (GET_HANDLE_TYPE(handle) != (uint32_t)type) {
+        return PSA_ERROR_BAD_STATE;
+    }
 
-    if ((handle == TFM_CRYPTO_INVALID_HANDLE) ||
-        (handle > CRYPTO_CONC_OPER_NUM)) {
+    pool = handle_to_slot(handle, &slot);
+    if (pool == NULL) {
         return PSA_ERROR_BAD_STATE;
     }
 
@@ -154,10 +414,8 @@ psa_status_t tfm_crypto_operation_lookup(enum tfm_crypto_operation_type type,
         return status;
     }
 
-    if ((operations[handle - 1].in_use == TFM_CRYPTO_IN_USE) &&
-        (operations[handle - 1].type == type) &&
-        (operations[handle - 1].owner == partition_id)) {
-        *ctx = (void *) &(operations[handle - 1].operation);
+    if (slot->owner == partition_id) {
+        *ctx = (void *)((uint8_t *)slot + pool->ctx_offset);
         return PSA_SUCCESS;
     }
 
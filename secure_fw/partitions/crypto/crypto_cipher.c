@@ -67,6 +67,76 @@ psa_status_t tfm_crypto_cipher_interface(psa_invec in_vec[],
 #endif
     }
 
+    if (sid == TFM_CRYPTO_CIPHER_ENCRYPT_THEN_MAC_SID) {
+#if CRYPTO_SINGLE_PART_FUNCS_DISABLED || !CRYPTO_MAC_MODULE_ENABLED
+        return PSA_ERROR_NOT_SUPPORTED;
+#else
+        const struct tfm_crypto_mac_pack_input *mac_in = in_vec[2].base;
+        mbedtls_svc_key_id_t mac_key;
+        const uint8_t *input = in_vec[1].base;
+        size_t input_length = in_vec[1].len;
+        uint8_t *output = out_vec[0].base;
+        size_t output_size = out_vec[0].len;
+
+        if (in_vec[2].len != sizeof(struct tfm_crypto_mac_pack_input)) {
+            return PSA_ERROR_PROGRAMMER_ERROR;
+        }
+
+        /* The MAC key belongs to the same owner as the cipher key */
+        mac_key = mbedtls_svc_key_id_make(
+                            MBEDTLS_SVC_KEY_ID_GET_OWNER_ID(*encoded_key),
+                            mac_in->key_id);
+
+        status = psa_cipher_encrypt(*encoded_key, iov->alg, input, input_length,
+                                    output, output_size, &out_vec[0].len);
+        if (status == PSA_SUCCESS) {
+            status = psa_mac_compute(mac_key, mac_in->alg,
+                                     output, out_vec[0].len,
+                                     out_vec[1].base, out_vec[1].len,
+                                     &out_vec[1].len);
+        }
+        if (status != PSA_SUCCESS) {
+            out_vec[0].len = 0;
+            out_vec[1].len = 0;
+        }
+        return status;
+#endif
+    }
+
+    if (sid == TFM_CRYPTO_CIPHER_VERIFY_THEN_DECRYPT_SID) {
+#if CRYPTO_SINGLE_PART_FUNCS_DISABLED || !CRYPTO_MAC_MODULE_ENABLED
+        return PSA_ERROR_NOT_SUPPORTED;
+#else
+        const struct tfm_crypto_mac_pack_input *mac_in = in_vec[2].base;
+        mbedtls_svc_key_id_t mac_key;
+        const uint8_t *input = in_vec[1].base;
+        size_t input_length = in_vec[1].len;
+        uint8_t *output = out_vec[0].base;
+        size_t output_size = out_vec[0].len;
+
+        if (in_vec[2].len != sizeof(struct tfm_crypto_mac_pack_input)) {
+            return PSA_ERROR_PROGRAMMER_ERROR;
+        }
+
+        mac_key = mbedtls_svc_key_id_make(
+                            MBEDTLS_SVC_KEY_ID_GET_OWNER_ID(*encoded_key),
+                            mac_in->key_id);
+
+        /* Never decrypt a ciphertext whose MAC does not verify */
+        status = psa_mac_verify(mac_key, mac_in->alg, input, input_length,
+                                in_vec[3].base, in_vec[3].len);
+        if (status == PSA_SUCCESS) {
+            status = psa_cipher_decrypt(*encoded_key, iov->alg,
+                                        input, input_length,
+                                        output, output_size, &out_vec[0].len);
+        }
+        if (status != PSA_SUCCESS) {
+            out_vec[0].len = 0;
+        }
+        return status;
+#endif
+    }
+
     if ((sid == TFM_CRYPTO_CIPHER_ENCRYPT_SETUP_SID) ||
         (sid == TFM_CRYPTO_CIPHER_DECRYPT_SETUP_SID)) {
         p_handle = out_vec[0].base;
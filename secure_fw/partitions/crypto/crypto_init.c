@@ -154,6 +154,150 @@ psa_status_t tfm_crypto_get_caller_id(int32_t *id)
     return tfm_crypto_get_scratch_owner(id);
 }
 
+#if CRYPTO_STREAM_UPDATE_ENABLED
+static psa_status_t tfm_crypto_dispatch(psa_invec in_vec[],
+                                        size_t in_len,
+                                        psa_outvec out_vec[],
+                                        size_t out_len);
+
+/**
+ * \brief Gets the function which aborts the operation of a multi-part update
+ *        that can be streamed through the scratch.
+ *
+ * \param[in]  function_id  Function ID of the update
+ * \param[out] abort_sid    Function ID which aborts the operation
+ * \param[out] has_output   Whether the update writes to the first outvec
+ *
+ * \return true if the update can be streamed
+ */
+static bool tfm_crypto_get_stream_abort_sid(uint16_t function_id,
+                                            uint16_t *abort_sid,
+                                            bool *has_output)
+{
+    *has_output = false;
+
+    switch (function_id) {
+    case TFM_CRYPTO_HASH_UPDATE_SID:
+        *abort_sid = TFM_CRYPTO_HASH_ABORT_SID;
+        return true;
+    case TFM_CRYPTO_MAC_UPDATE_SID:
+        *abort_sid = TFM_CRYPTO_MAC_ABORT_SID;
+        return true;
+    case TFM_CRYPTO_AEAD_UPDATE_AD_SID:
+        *abort_sid = TFM_CRYPTO_AEAD_ABORT_SID;
+        return true;
+    case TFM_CRYPTO_CIPHER_UPDATE_SID:
+        *abort_sid = TFM_CRYPTO_CIPHER_ABORT_SID;
+        *has_output = true;
+        return true;
+    case TFM_CRYPTO_AEAD_UPDATE_SID:
+        *abort_sid = TFM_CRYPTO_AEAD_ABORT_SID;
+        *has_output = true;
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* Scratch windows used to stream an update which produces output. An update
+ * of N bytes can output up to N plus one block held back by the previous
+ * update, so the output window is a block larger than the input window.
+ */
+#define TFM_CRYPTO_STREAM_IN_WINDOW_SIZE                                     \
+    (((sizeof(scratch.buf) - PSA_BLOCK_CIPHER_BLOCK_MAX_SIZE) / 2) &          \
+     ~(TFM_CRYPTO_IOVEC_ALIGNMENT - 1))
+#define TFM_CRYPTO_STREAM_OUT_WINDOW_SIZE                                    \
+    (TFM_CRYPTO_STREAM_IN_WINDOW_SIZE + PSA_BLOCK_CIPHER_BLOCK_MAX_SIZE)
+
+/**
+ * \brief Feeds the input of a multi-part update request which doesn't fit in
+ *        the scratch to the dispatcher in windows read into the scratch. The
+ *        first input vector holds the data. When the update has an output,
+ *        the output of each window is written to the client before the next
+ *        window is read. The operation is aborted if any window fails, as
+ *        part of the input has already been processed.
+ */
+static psa_status_t tfm_crypto_stream_update(const psa_msg_t *msg,
+                                             psa_invec in_vec[],
+                                             psa_outvec out_vec[],
+                                             uint16_t abort_sid,
+                                             bool has_output)
+{
+    struct tfm_crypto_pack_iovec abort_iov;
+    uint32_t op_handle;
+    psa_outvec abort_out_vec[] = {
+        { .base = &op_handle, .len = sizeof(op_handle) }
+    };
+    size_t in_remaining = msg->in_size[1];
+    size_t out_remaining = has_output ? msg->out_size[0] : 0;
+    size_t in_window_size = has_output ? TFM_CRYPTO_STREAM_IN_WINDOW_SIZE :
+                                         sizeof(scratch.buf);
+    void *in_window = NULL;
+    void *out_window = NULL;
+    psa_status_t status;
+#if CRYPTO_STATS_ENABLED
+    const struct tfm_crypto_pack_iovec *iov = in_vec[0].base;
+    uint32_t start = tfm_crypto_stats_get_cycles();
+#endif
+
+    status = tfm_crypto_alloc_scratch(in_window_size, &in_window);
+    if ((status == PSA_SUCCESS) && has_output) {
+        status = tfm_crypto_alloc_scratch(TFM_CRYPTO_STREAM_OUT_WINDOW_SIZE,
+                                          &out_window);
+    }
+    if (status != PSA_SUCCESS) {
+        tfm_crypto_clear_scratch();
+        return status;
+    }
+
+    tfm_crypto_set_caller_id(msg->client_id);
+
+    while (in_remaining > 0) {
+        in_vec[1].base = in_window;
+        in_vec[1].len = psa_read(msg->handle, 1, in_window,
+                                 (in_remaining < in_window_size) ?
+                                 in_remaining : in_window_size);
+        in_remaining -= in_vec[1].len;
+
+        if (!has_output) {
+            status = tfm_crypto_dispatch(in_vec, 2, NULL, 0);
+            if (status != PSA_SUCCESS) {
+                break;
+            }
+            continue;
+        }
+
+        out_vec[0].base = out_window;
+        out_vec[0].len = (out_remaining < TFM_CRYPTO_STREAM_OUT_WINDOW_SIZE) ?
+                         out_remaining : TFM_CRYPTO_STREAM_OUT_WINDOW_SIZE;
+        status = tfm_crypto_dispatch(in_vec, 2, out_vec, 1);
+        if (status != PSA_SUCCESS) {
+            break;
+        }
+
+        psa_write(msg->handle, 0, out_window, out_vec[0].len);
+        out_remaining -= out_vec[0].len;
+    }
+
+    if (status != PSA_SUCCESS) {
+        abort_iov = *(const struct tfm_crypto_pack_iovec *)in_vec[0].base;
+        abort_iov.function_id = abort_sid;
+        in_vec[0].base = &abort_iov;
+        (void)tfm_crypto_dispatch(in_vec, 1, abort_out_vec, 1);
+    }
+
+#if CRYPTO_STATS_ENABLED
+    /* Recorded once for the whole request */
+    tfm_crypto_stats_record(iov->function_id, msg->in_size[1],
+                            tfm_crypto_stats_get_cycles() - start);
+#endif
+
+    tfm_crypto_clear_scratch();
+
+    return status;
+}
+#endif /* CRYPTO_STREAM_UPDATE_ENABLED */
+
 static psa_status_t tfm_crypto_init_iovecs(const psa_msg_t *msg,
                                            psa_invec in_vec[],
                                            size_t in_len,
@@ -202,6 +346,10 @@ static psa_status_t tfm_crypto_call_srv(const psa_msg_t *msg)
     psa_invec in_vec[PSA_MAX_IOVEC] = { {NULL, 0} };
     psa_outvec out_vec[PSA_MAX_IOVEC] = { {NULL, 0} };
     struct tfm_crypto_pack_iovec iov = {0};
+#if (PSA_FRAMEWORK_HAS_MM_IOVEC != 1) && CRYPTO_STREAM_UPDATE_ENABLED
+    uint16_t abort_sid;
+    bool has_output;
+#endif
 
     /* Check the number of in_vec filled */
     while ((in_len > 0) && (msg->in_size[in_len - 1] == 0)) {
@@ -226,6 +374,20 @@ static psa_status_t tfm_crypto_call_srv(const psa_msg_t *msg)
     in_vec[0].base = &iov;
     in_vec[0].len = sizeof(struct tfm_crypto_pack_iovec);
 
+#if (PSA_FRAMEWORK_HAS_MM_IOVEC != 1) && CRYPTO_STREAM_UPDATE_ENABLED
+    /* Multi-part updates do not need the whole input in the scratch */
+    if ((in_len == 2) &&
+        tfm_crypto_get_stream_abort_sid(iov.function_id, &abort_sid,
+                                        &has_output) &&
+        (out_len == (has_output ? 1 : 0)) &&
+        ((ALIGN(msg->in_size[1], TFM_CRYPTO_IOVEC_ALIGNMENT) +
+          ALIGN(msg->out_size[0], TFM_CRYPTO_IOVEC_ALIGNMENT)) >
+         sizeof(scratch.buf))) {
+        return tfm_crypto_stream_update(msg, in_vec, out_vec, abort_sid,
+                                        has_output);
+    }
+#endif
+
     status = tfm_crypto_init_iovecs(msg, in_vec, in_len, out_vec, out_len);
     if (status != PSA_SUCCESS) {
         return status;
@@ -275,8 +437,12 @@ static psa_status_t tfm_crypto_engine_init(void)
     /* Initialise the Mbed Crypto memory allocator to use static memory
      * allocation from the provided buffer instead of using the heap
      */
+#if CRYPTO_ENGINE_SLAB_SIZE > 0
+    tfm_crypto_mem_init(mbedtls_mem_buf, CRYPTO_ENGINE_BUF_SIZE);
+#else
     mbedtls_memory_buffer_alloc_init(mbedtls_mem_buf,
                                      CRYPTO_ENGINE_BUF_SIZE);
+#endif
 
     /* mbedtls_printf is used to print messages including error information. */
 #if (TFM_PARTITION_LOG_LEVEL >= TFM_PARTITION_LOG_LEVEL_ERROR)
@@ -305,6 +471,11 @@ static psa_status_t tfm_crypto_engine_init(void)
 
 static psa_status_t tfm_crypto_module_init(void)
 {
+#if CRYPTO_STATS_ENABLED
+    /* Init the Statistics module */
+    tfm_crypto_stats_init();
+#endif
+
     /* Init the Alloc module */
     return tfm_crypto_init_alloc();
 }
@@ -347,10 +518,10 @@ psa_status_t tfm_crypto_sfn(const psa_msg_t *msg)
     return PSA_ERROR_GENERIC_ERROR;
 }
 
-psa_status_t tfm_crypto_api_dispatcher(psa_invec in_vec[],
-                                       size_t in_len,
-                                       psa_outvec out_vec[],
-                                       size_t out_len)
+static psa_status_t tfm_crypto_dispatch(psa_invec in_vec[],
+                                        size_t in_len,
+                                        psa_outvec out_vec[],
+                                        size_t out_len)
 {
     psa_status_t status = PSA_ERROR_CORRUPTION_DETECTED;
     const struct tfm_crypto_pack_iovec *iov = in_vec[0].base;
@@ -366,7 +537,8 @@ psa_status_t tfm_crypto_api_dispatcher(psa_invec in_vec[],
     group_id = TFM_CRYPTO_GET_GROUP_ID(iov->function_id);
 
     is_key_required = !((group_id == TFM_CRYPTO_GROUP_ID_HASH) ||
-                        (group_id == TFM_CRYPTO_GROUP_ID_RANDOM));
+                        (group_id == TFM_CRYPTO_GROUP_ID_RANDOM) ||
+                        (group_id == TFM_CRYPTO_GROUP_ID_STATS));
 
     if (is_key_required) {
         status = tfm_crypto_get_caller_id(&caller_id);
@@ -377,6 +549,13 @@ psa_status_t tfm_crypto_api_dispatcher(psa_invec in_vec[],
          * of the calling partition
          */
         encoded_key = mbedtls_svc_key_id_make(caller_id, iov->key_id);
+
+#if CRYPTO_KEY_CACHE_SLOTS > 0
+        /* Key management requests update the key cache themselves */
+        if (group_id != TFM_CRYPTO_GROUP_ID_KEY_MANAGEMENT) {
+            tfm_crypto_key_cache_access(encoded_key);
+        }
+#endif
     }
 
     /* Dispatch to each sub-module based on the Group ID */
@@ -403,6 +582,10 @@ psa_status_t tfm_crypto_api_dispatcher(psa_invec in_vec[],
                                                    &encoded_key);
     case TFM_CRYPTO_GROUP_ID_RANDOM:
         return tfm_crypto_random_interface(in_vec, out_vec);
+#if TFM_CRYPTO_STATS_GROUP_ENABLED
+    case TFM_CRYPTO_GROUP_ID_STATS:
+        return tfm_crypto_stats_interface(in_vec, out_vec);
+#endif
     default:
         LOG_ERRFMT("[ERR][Crypto] Unsupported request!\r\n");
         return PSA_ERROR_NOT_SUPPORTED;
@@ -410,3 +593,36 @@ psa_status_t tfm_crypto_api_dispatcher(psa_invec in_vec[],
 
     return PSA_ERROR_NOT_SUPPORTED;
 }
+
+psa_status_t tfm_crypto_api_dispatcher(psa_invec in_vec[],
+                                       size_t in_len,
+                                       psa_outvec out_vec[],
+                                       size_t out_len)
+{
+#if CRYPTO_STATS_ENABLED
+    psa_status_t status;
+    uint16_t function_id;
+    uint32_t start;
+    size_t bytes = 0;
+    size_t i;
+
+    if (in_vec[0].len != sizeof(struct tfm_crypto_pack_iovec)) {
+        return PSA_ERROR_PROGRAMMER_ERROR;
+    }
+
+    function_id =
+        ((const struct tfm_crypto_pack_iovec *)in_vec[0].base)->function_id;
+    for (i = 1; i < in_len; i++) {
+        bytes += in_vec[i].len;
+    }
+
+    start = tfm_crypto_stats_get_cycles();
+    status = tfm_crypto_dispatch(in_vec, in_len, out_vec, out_len);
+    tfm_crypto_stats_record(function_id, bytes,
+                            tfm_crypto_stats_get_cycles() - start);
+
+    return status;
+#else
+    return tfm_crypto_dispatch(in_vec, in_len, out_vec, out_len);
+#endif /* CRYPTO_STATS_ENABLED */
+}
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "config_crypto.h"
+#include "tfm_mbedcrypto_include.h"
+
+#include "tfm_crypto_api.h"
+#include "tfm_crypto_defs.h"
+
+#if CRYPTO_KEY_CACHE_SLOTS > 0
+#if defined(MBEDTLS_PSA_KEY_SLOT_COUNT) && \
+    (CRYPTO_KEY_CACHE_SLOTS >= MBEDTLS_PSA_KEY_SLOT_COUNT)
+#error "Invalid config: CRYPTO_KEY_CACHE_SLOTS must be smaller than MBEDTLS_PSA_KEY_SLOT_COUNT!"
+#endif
+
+/*
+ * Persistent keys accessed by the Crypto operations are recorded in the cache,
+ * up to CRYPTO_KEY_CACHE_SLOTS of them. Mbed Crypto keeps a persistent key
+ * loaded in its key slot until the slot is needed for another key, and then
+ * recycles one of the loaded persistent keys regardless of how recently it
+ * was used. To make that less likely, when the cache is full the least
+ * recently used key which is not pinned is purged with psa_purge_key() once
+ * another key has been loaded, so that the cache never holds more than
+ * CRYPTO_KEY_CACHE_SLOTS loaded keys and a slot is left free for the next
+ * one. Keys are recorded with their owner, and each owner can pin at most
+ * CRYPTO_KEY_CACHE_PIN_QUOTA of them.
+ *
+ * The slots are not locked, so a pin is advisory: it keeps the key out of the
+ * eviction of the cache, but Mbed Crypto still recycles the slot of a cached
+ * or pinned key when volatile keys and the keys of other requests take all the
+ * other slots. The key is then read again from storage on its next use.
+ */
+struct tfm_crypto_key_cache_entry_t {
+    mbedtls_svc_key_id_t key;   /* Owner and ID of the cached key */
+    uint32_t last_access;       /* Value of access_clock at the last access */
+    bool in_use;                /* The entry holds a key */
+    bool pinned;                /* Not evicted by the cache when set */
+};
+
+static struct tfm_crypto_key_cache_entry_t cache[CRYPTO_KEY_CACHE_SLOTS];
+static uint32_t access_clock;
+static struct tfm_crypto_key_cache_stats_t cache_stats;
+
+static bool key_is_cacheable(mbedtls_svc_key_id_t key)
+{
+    psa_key_id_t key_id = MBEDTLS_SVC_KEY_ID_GET_KEY_ID(key);
+
+    /* Only the persistent keys of the clients are read from storage. Volatile
+     * and built-in keys are identified in the vendor range.
+     */
+    return (key_id >= PSA_KEY_ID_USER_MIN) && (key_id <= PSA_KEY_ID_USER_MAX);
+}
+
+static struct tfm_crypto_key_cache_entry_t *cache_find(mbedtls_svc_key_id_t key)
+{
+    size_t i;
+
+    for (i = 0; i < CRYPTO_KEY_CACHE_SLOTS; i++) {
+        if (cache[i].in_use && mbedtls_svc_key_id_equal(cache[i].key, key)) {
+            return &cache[i];
+        }
+    }
+
+    return NULL;
+}
+
+static size_t cache_owner_pinned(mbedtls_svc_key_id_t key)
+{
+    size_t i, num = 0;
+
+    for (i = 0; i < CRYPTO_KEY_CACHE_SLOTS; i++) {
+        if (cache[i].in_use && cache[i].pinned &&
+            (MBEDTLS_SVC_KEY_ID_GET_OWNER_ID(cache[i].key) ==
+             MBEDTLS_SVC_KEY_ID_GET_OWNER_ID(key))) {
+            num++;
+        }
+    }
+
+    return num;
+}
+
+static psa_status_t cache_insert(mbedtls_svc_key_id_t key,
+                                 struct tfm_crypto_key_cache_entry_t **entry)
+{
+    struct tfm_crypto_key_cache_entry_t *victim = NULL;
+    psa_key_attributes_t attributes = PSA_KEY_ATTRIBUTES_INIT;
+    psa_status_t status;
+    size_t i;
+
+    for (i = 0; i < CRYPTO_KEY_CACHE_SLOTS; i++) {
+        if (!cache[i].in_use) {
+            victim = &cache[i];
+            break;
+        }
+        if (!cache[i].pinned &&
+            ((victim == NULL) ||
+             ((int32_t)(cache[i].last_access - victim->last_access) < 0))) {
+            victim = &cache[i];
+        }
+    }
+
+    if (victim == NULL) {
+        /* All the entries are pinned */
+        return PSA_ERROR_INSUFFICIENT_MEMORY;
+    }
+
+    /* Load the key, which checks that it exists and is accessible, so that
+     * a key which can't be used does not evict a cached one.
+     */
+    status = psa_get_key_attributes(key, &attributes);
+    psa_reset_key_attributes(&attributes);
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+
+    if (victim->in_use) {
+        /* Free the key slot of the victim for the next key. The victim can
+         * have been recycled by Mbed Crypto already, or be in use by another
+         * request, it is then left as it is.
+         */
+        (void)psa_purge_key(victim->key);
+        cache_stats.evictions++;
+    }
+
+    victim->key = key;
+    victim->in_use = true;
+    victim->pinned = false;
+    *entry = victim;
+
+    return PSA_SUCCESS;
+}
+
+void tfm_crypto_key_cache_access(mbedtls_svc_key_id_t key)
+{
+    struct tfm_crypto_key_cache_entry_t *entry;
+
+    if (!key_is_cacheable(key)) {
+        return;
+    }
+
+    entry = cache_find(key);
+    if (entry != NULL) {
+        cache_stats.hits++;
+    } else {
+        cache_stats.misses++;
+        if (cache_insert(key, &entry) != PSA_SUCCESS) {
+            /* The operation itself reports a key which can't be loaded */
+            return;
+        }
+    }
+
+    entry->last_access = ++access_clock;
+}
+
+void tfm_crypto_key_cache_release(mbedtls_svc_key_id_t key)
+{
+    struct tfm_crypto_key_cache_entry_t *entry = cache_find(key);
+
+    if (entry != NULL) {
+        entry->in_use = false;
+        entry->pinned = false;
+    }
+}
+
+psa_status_t tfm_crypto_key_cache_pin(mbedtls_svc_key_id_t key, bool pin)
+{
+    struct tfm_crypto_key_cache_entry_t *entry;
+    psa_status_t status;
+
+    if (!key_is_cacheable(key)) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    entry = cache_find(key);
+    if (!pin) {
+        if (entry != NULL) {
+            entry->pinned = false;
+        }
+        return PSA_SUCCESS;
+    }
+
+    if ((entry != NULL) && entry->pinned) {
+        return PSA_SUCCESS;
+    }
+
+    if (cache_owner_pinned(key) >= CRYPTO_KEY_CACHE_PIN_QUOTA) {
+        return PSA_ERROR_INSUFFICIENT_MEMORY;
+    }
+
+    if (entry == NULL) {
+        status = cache_insert(key, &entry);
+        if (status != PSA_SUCCESS) {
+            return status;
+        }
+    }
+
+    entry->pinned = true;
+    entry->last_access = ++access_clock;
+
+    return PSA_SUCCESS;
+}
+
+void tfm_crypto_key_cache_get_stats(struct tfm_crypto_key_cache_stats_t *stats)
+{
+    size_t i;
+
+    cache_stats.cached = 0;
+    cache_stats.pinned = 0;
+    for (i = 0; i < CRYPTO_KEY_CACHE_SLOTS; i++) {
+        if (cache[i].in_use) {
+            cache_stats.cached++;
+            if (cache[i].pinned) {
+                cache_stats.pinned++;
+            }
+        }
+    }
+
+    (void)memcpy(stats, &cache_stats, sizeof(*stats));
+}
+#endif /* CRYPTO_KEY_CACHE_SLOTS > 0 */
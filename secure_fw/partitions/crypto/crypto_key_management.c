@@ -65,11 +65,17 @@ psa_status_t tfm_crypto_key_management_interface(psa_invec in_vec[],
     break;
     case TFM_CRYPTO_CLOSE_KEY_SID:
     {
+#if CRYPTO_KEY_CACHE_SLOTS > 0
+        tfm_crypto_key_cache_release(*encoded_key);
+#endif
         status = psa_close_key(*encoded_key);
     }
     break;
     case TFM_CRYPTO_DESTROY_KEY_SID:
     {
+#if CRYPTO_KEY_CACHE_SLOTS > 0
+        tfm_crypto_key_cache_release(*encoded_key);
+#endif
         status = psa_destroy_key(*encoded_key);
     }
     break;
@@ -129,6 +135,9 @@ psa_status_t tfm_crypto_key_management_interface(psa_invec in_vec[],
     break;
     case TFM_CRYPTO_PURGE_KEY_SID:
     {
+#if CRYPTO_KEY_CACHE_SLOTS > 0
+        tfm_crypto_key_cache_release(*encoded_key);
+#endif
         status = psa_purge_key(*encoded_key);
     }
     break;
@@ -177,6 +186,17 @@ psa_status_t tfm_crypto_key_management_interface(psa_invec in_vec[],
         *key_handle = MBEDTLS_SVC_KEY_ID_GET_KEY_ID(*encoded_key);
     }
     break;
+    case TFM_CRYPTO_PIN_KEY_SID:
+    case TFM_CRYPTO_UNPIN_KEY_SID:
+    {
+#if CRYPTO_KEY_CACHE_SLOTS > 0
+        status = tfm_crypto_key_cache_pin(*encoded_key,
+                                  iov->function_id == TFM_CRYPTO_PIN_KEY_SID);
+#else
+        status = PSA_ERROR_NOT_SUPPORTED;
+#endif
+    }
+    break;
     default:
         return PSA_ERROR_NOT_SUPPORTED;
     }
@@ -0,0 +1,326 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "config_crypto.h"
+#include "tfm_mbedcrypto_include.h"
+
+#include "tfm_crypto_api.h"
+#include "tfm_crypto_defs.h"
+
+#if CRYPTO_ENGINE_SLAB_SIZE > 0
+#include "mbedtls/platform.h"
+
+/*
+ * The engine buffer is split in two regions, both made of fixed-size blocks
+ * whose state is kept outside of the buffer, so that a stray write by the
+ * backend cannot corrupt the allocator.
+ *
+ * The first CRYPTO_ENGINE_SLAB_SIZE bytes are divided in equal shares between
+ * the size classes below, each share being a pool of blocks of the class size.
+ * Small allocations, such as bignum limbs and cipher contexts, are served from
+ * the smallest class that fits, then from the larger classes when it is
+ * exhausted.
+ *
+ * The rest of the buffer is a pool of TFM_CRYPTO_HEAP_BLOCK_SIZE blocks, an
+ * allocation larger than the largest class taking a run of consecutive blocks.
+ * The smallest free run that fits is used, and freed blocks are free again
+ * at once, without headers to merge.
+ */
+#define TFM_CRYPTO_MEM_ALIGN        (8u)
+#define TFM_CRYPTO_MEM_ALIGN_UP(x)  (((x) + TFM_CRYPTO_MEM_ALIGN - 1) & \
+                                     ~(size_t)(TFM_CRYPTO_MEM_ALIGN - 1))
+
+static const size_t slab_block_size[] = {16, 32, 64, 128, 256};
+
+#define TFM_CRYPTO_SLAB_CLASS_NUM \
+    (sizeof(slab_block_size) / sizeof(slab_block_size[0]))
+
+/* Upper bound of the number of blocks of all the classes */
+#define TFM_CRYPTO_SLAB_BLOCK_MAX   (CRYPTO_ENGINE_SLAB_SIZE / 16)
+
+#define TFM_CRYPTO_HEAP_BLOCK_SIZE  (64u)
+#define TFM_CRYPTO_HEAP_BLOCK_MAX   (CRYPTO_ENGINE_BUF_SIZE / \
+                                     TFM_CRYPTO_HEAP_BLOCK_SIZE)
+
+/* State of a heap block which is not the first one of its run */
+#define TFM_CRYPTO_HEAP_RUN_CONT    (0xFFFFu)
+
+#if TFM_CRYPTO_HEAP_BLOCK_MAX >= TFM_CRYPTO_HEAP_RUN_CONT
+#error "CRYPTO_ENGINE_BUF_SIZE is too large for the Crypto engine heap!"
+#endif
+
+struct tfm_crypto_slab_t {
+    uint8_t *base;              /* First block of the class */
+    uint8_t *end;               /* End of the last block of the class */
+    size_t block_size;
+    size_t first_bit;           /* Bit of the first block in slab_in_use */
+    void *free_list;            /* Next free block, linked through the block */
+};
+
+static struct tfm_crypto_slab_t slabs[TFM_CRYPTO_SLAB_CLASS_NUM];
+/* One bit per slab block, set while the block is allocated */
+static uint8_t slab_in_use[(TFM_CRYPTO_SLAB_BLOCK_MAX + 7) / 8];
+
+static uint8_t *heap_base;
+static size_t heap_block_num;
+/*
+ * State of each heap block: 0 when free, the length of the run for the first
+ * block of an allocated run, TFM_CRYPTO_HEAP_RUN_CONT for its other blocks.
+ */
+static uint16_t heap_runs[TFM_CRYPTO_HEAP_BLOCK_MAX];
+
+static struct tfm_crypto_heap_stats_t heap_stats;
+
+static bool slab_bit_test(size_t bit)
+{
+    return (slab_in_use[bit / 8] & (1u << (bit % 8))) != 0;
+}
+
+static void slab_bit_set(size_t bit, bool val)
+{
+    if (val) {
+        slab_in_use[bit / 8] |= (uint8_t)(1u << (bit % 8));
+    } else {
+        slab_in_use[bit / 8] &= (uint8_t)~(1u << (bit % 8));
+    }
+}
+
+static void *slab_alloc(size_t size)
+{
+    struct tfm_crypto_slab_t *slab;
+    uint8_t *block;
+    size_t i;
+
+    for (i = 0; i < TFM_CRYPTO_SLAB_CLASS_NUM; i++) {
+        slab = &slabs[i];
+        if ((size <= slab->block_size) && (slab->free_list != NULL)) {
+            block = slab->free_list;
+            slab->free_list = *(void **)block;
+            slab_bit_set(slab->first_bit +
+                         (size_t)(block - slab->base) / slab->block_size,
+                         true);
+
+            heap_stats.slab_allocs++;
+            heap_stats.slab_used++;
+            if (heap_stats.slab_used > heap_stats.slab_peak) {
+                heap_stats.slab_peak = heap_stats.slab_used;
+            }
+            return block;
+        }
+    }
+
+    return NULL;
+}
+
+static void slab_free(struct tfm_crypto_slab_t *slab, uint8_t *ptr)
+{
+    size_t offset = (size_t)(ptr - slab->base);
+    size_t bit = slab->first_bit + offset / slab->block_size;
+
+    /* Not the start of a block, or a block which is not allocated */
+    if ((offset % slab->block_size != 0) || !slab_bit_test(bit)) {
+        heap_stats.invalid_frees++;
+        return;
+    }
+
+    slab_bit_set(bit, false);
+    *(void **)ptr = slab->free_list;
+    slab->free_list = ptr;
+    heap_stats.slab_used--;
+}
+
+static void *heap_alloc(size_t size)
+{
+    size_t num = (size + TFM_CRYPTO_HEAP_BLOCK_SIZE - 1) /
+                 TFM_CRYPTO_HEAP_BLOCK_SIZE;
+    size_t best = heap_block_num;
+    size_t best_len = SIZE_MAX;
+    size_t i, start, len;
+
+    /* Smallest free run of at least num blocks */
+    i = 0;
+    while (i < heap_block_num) {
+        if (heap_runs[i] != 0) {
+            i += (heap_runs[i] == TFM_CRYPTO_HEAP_RUN_CONT) ? 1 : heap_runs[i];
+            continue;
+        }
+
+        start = i;
+        while ((i < heap_block_num) && (heap_runs[i] == 0)) {
+            i++;
+        }
+        len = i - start;
+        if ((len >= num) && (len < best_len)) {
+            best = start;
+            best_len = len;
+        }
+    }
+
+    if (best == heap_block_num) {
+        return NULL;
+    }
+
+    heap_runs[best] = (uint16_t)num;
+    for (i = 1; i < num; i++) {
+        heap_runs[best + i] = TFM_CRYPTO_HEAP_RUN_CONT;
+    }
+
+    heap_stats.heap_allocs++;
+    heap_stats.heap_used += num * TFM_CRYPTO_HEAP_BLOCK_SIZE;
+    if (heap_stats.heap_used > heap_stats.heap_peak) {
+        heap_stats.heap_peak = heap_stats.heap_used;
+    }
+    return heap_base + best * TFM_CRYPTO_HEAP_BLOCK_SIZE;
+}
+
+static void heap_free(uint8_t *ptr)
+{
+    size_t offset = (size_t)(ptr - heap_base);
+    size_t idx = offset / TFM_CRYPTO_HEAP_BLOCK_SIZE;
+    size_t num, i;
+
+    /* Not the start of an allocated run */
+    if ((offset % TFM_CRYPTO_HEAP_BLOCK_SIZE != 0) ||
+        (heap_runs[idx] == 0) ||
+        (heap_runs[idx] == TFM_CRYPTO_HEAP_RUN_CONT)) {
+        heap_stats.invalid_frees++;
+        return;
+    }
+
+    num = heap_runs[idx];
+    for (i = 0; i < num; i++) {
+        heap_runs[idx + i] = 0;
+    }
+    heap_stats.heap_used -= num * TFM_CRYPTO_HEAP_BLOCK_SIZE;
+}
+
+static void *tfm_crypto_mem_calloc(size_t n, size_t size)
+{
+    void *ptr;
+
+    if ((n == 0) || (size == 0)) {
+        return NULL;
+    }
+
+    if (n > SIZE_MAX / size) {
+        heap_stats.failed_allocs++;
+        return NULL;
+    }
+    size *= n;
+
+    ptr = slab_alloc(size);
+    if (ptr == NULL) {
+        ptr = heap_alloc(size);
+    }
+
+    if (ptr == NULL) {
+        heap_stats.failed_allocs++;
+        return NULL;
+    }
+
+    (void)memset(ptr, 0, size);
+    return ptr;
+}
+
+static void tfm_crypto_mem_free(void *ptr)
+{
+    uint8_t *p = ptr;
+    size_t i;
+
+    if (p == NULL) {
+        return;
+    }
+
+    for (i = 0; i < TFM_CRYPTO_SLAB_CLASS_NUM; i++) {
+        if ((p >= slabs[i].base) && (p < slabs[i].end)) {
+            slab_free(&slabs[i], p);
+            return;
+        }
+    }
+
+    if ((p >= heap_base) &&
+        (p < heap_base + heap_block_num * TFM_CRYPTO_HEAP_BLOCK_SIZE)) {
+        heap_free(p);
+        return;
+    }
+
+    /* Not allocated from the engine buffer */
+    heap_stats.invalid_frees++;
+}
+
+void tfm_crypto_mem_init(uint8_t *buf, size_t size)
+{
+    size_t pad = TFM_CRYPTO_MEM_ALIGN_UP((uintptr_t)buf) - (uintptr_t)buf;
+    size_t share = (CRYPTO_ENGINE_SLAB_SIZE / TFM_CRYPTO_SLAB_CLASS_NUM) &
+                   ~(size_t)(TFM_CRYPTO_MEM_ALIGN - 1);
+    size_t bit = 0;
+    uint8_t *p;
+    size_t i, j, num, used;
+
+    (void)memset(&heap_stats, 0, sizeof(heap_stats));
+    (void)memset(slab_in_use, 0, sizeof(slab_in_use));
+    (void)memset(heap_runs, 0, sizeof(heap_runs));
+
+    /* The slabs only take the part of the buffer which exists */
+    size = (size > pad) ? size - pad : 0;
+    p = buf + pad;
+
+    for (i = 0; i < TFM_CRYPTO_SLAB_CLASS_NUM; i++) {
+        num = ((share < size) ? share : size) / slab_block_size[i];
+        used = num * slab_block_size[i];
+
+        slabs[i].block_size = slab_block_size[i];
+        slabs[i].base = p;
+        slabs[i].first_bit = bit;
+        slabs[i].free_list = NULL;
+        for (j = num; j > 0; j--) {
+            *(void **)(p + (j - 1) * slab_block_size[i]) = slabs[i].free_list;
+            slabs[i].free_list = p + (j - 1) * slab_block_size[i];
+        }
+        p += used;
+        size -= used;
+        bit += num;
+        slabs[i].end = p;
+    }
+
+    /* The rest of the buffer is divided in heap blocks */
+    heap_base = p;
+    heap_block_num = size / TFM_CRYPTO_HEAP_BLOCK_SIZE;
+
+    mbedtls_platform_set_calloc_free(tfm_crypto_mem_calloc,
+                                     tfm_crypto_mem_free);
+}
+
+void tfm_crypto_mem_get_stats(struct tfm_crypto_heap_stats_t *stats)
+{
+    uint32_t run = 0;
+    size_t i;
+
+    heap_stats.heap_free = 0;
+    heap_stats.heap_largest_free = 0;
+
+    for (i = 0; i < heap_block_num; i++) {
+        if (heap_runs[i] != 0) {
+            run = 0;
+            continue;
+        }
+
+        run += TFM_CRYPTO_HEAP_BLOCK_SIZE;
+        heap_stats.heap_free += TFM_CRYPTO_HEAP_BLOCK_SIZE;
+        if (run > heap_stats.heap_largest_free) {
+            heap_stats.heap_largest_free = run;
+        }
+    }
+
+    (void)memcpy(stats, &heap_stats, sizeof(*stats));
+}
+#endif /* CRYPTO_ENGINE_SLAB_SIZE > 0 */
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "config_crypto.h"
+#include "tfm_mbedcrypto_include.h"
+
+#include "tfm_crypto_api.h"
+#include "tfm_crypto_defs.h"
+
+#if TFM_CRYPTO_STATS_GROUP_ENABLED
+
+#if CRYPTO_STATS_ENABLED
+#include "cmsis_compiler.h"
+#include "tfm_hal_device_header.h"
+
+/* Number of distinct functions for which statistics are recorded */
+#ifndef TFM_CRYPTO_STATS_MAX_ENTRIES
+#define TFM_CRYPTO_STATS_MAX_ENTRIES 32
+#endif
+
+static struct tfm_crypto_stats_entry_t stats[TFM_CRYPTO_STATS_MAX_ENTRIES];
+static size_t stats_num;
+
+/*
+ * The default implementation reads the DWT cycle counter, only accessible to
+ * privileged code, so it is used with isolation level 1 only. Platforms
+ * override these functions to use a timer of their own, without which the
+ * cycle counts are 0.
+ */
+#if defined(DWT_CTRL_CYCCNTENA_Msk) && (TFM_LVL == 1)
+#define TFM_CRYPTO_STATS_USE_DWT
+#endif
+
+__WEAK void tfm_crypto_stats_timer_init(void)
+{
+#ifdef TFM_CRYPTO_STATS_USE_DWT
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+__WEAK uint32_t tfm_crypto_stats_get_cycles(void)
+{
+#ifdef TFM_CRYPTO_STATS_USE_DWT
+    return DWT->CYCCNT;
+#else
+    return 0;
+#endif
+}
+
+void tfm_crypto_stats_init(void)
+{
+    (void)memset(stats, 0, sizeof(stats));
+    stats_num = 0;
+
+    tfm_crypto_stats_timer_init();
+}
+
+void tfm_crypto_stats_record(uint16_t function_id, size_t bytes,
+                             uint32_t cycles)
+{
+    struct tfm_crypto_stats_entry_t *entry = NULL;
+    size_t i;
+
+    for (i = 0; i < stats_num; i++) {
+        if (stats[i].function_id == function_id) {
+            entry = &stats[i];
+            break;
+        }
+    }
+
+    if (entry == NULL) {
+        if (stats_num == TFM_CRYPTO_STATS_MAX_ENTRIES) {
+            /* Table full, the function is not recorded */
+            return;
+        }
+        entry = &stats[stats_num++];
+        entry->function_id = function_id;
+        entry->cycles_min = UINT32_MAX;
+    }
+
+    entry->count++;
+    entry->bytes += bytes;
+    entry->cycles_total += cycles;
+    if (cycles < entry->cycles_min) {
+        entry->cycles_min = cycles;
+    }
+    if (cycles > entry->cycles_max) {
+        entry->cycles_max = cycles;
+    }
+}
+#endif /* CRYPTO_STATS_ENABLED */
+
+/*!
+ * \addtogroup tfm_crypto_api_shim_layer
+ *
+ */
+
+/*!@{*/
+psa_status_t tfm_crypto_stats_interface(psa_invec in_vec[],
+                                        psa_outvec out_vec[])
+{
+    const struct tfm_crypto_pack_iovec *iov = in_vec[0].base;
+    psa_status_t status;
+    int32_t caller_id = 0;
+
+    /* Timing and memory usage are not disclosed to the Non-secure side */
+    status = tfm_crypto_get_caller_id(&caller_id);
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+    if (caller_id < 0) {
+        out_vec[0].len = 0;
+        return PSA_ERROR_NOT_PERMITTED;
+    }
+
+#if CRYPTO_STATS_ENABLED
+    if (iov->function_id == TFM_CRYPTO_GET_STATS_SID) {
+        size_t num = out_vec[0].len / sizeof(struct tfm_crypto_stats_entry_t);
+
+        if (num > stats_num) {
+            num = stats_num;
+        }
+
+        if (num > 0) {
+            (void)memcpy(out_vec[0].base, stats,
+                         num * sizeof(struct tfm_crypto_stats_entry_t));
+        }
+        out_vec[0].len = num * sizeof(struct tfm_crypto_stats_entry_t);
+
+        return PSA_SUCCESS;
+    }
+#endif /* CRYPTO_STATS_ENABLED */
+
+#if CRYPTO_ENGINE_SLAB_SIZE > 0
+    if (iov->function_id == TFM_CRYPTO_GET_HEAP_STATS_SID) {
+        struct tfm_crypto_heap_stats_t heap_stats;
+
+        if (out_vec[0].len != sizeof(struct tfm_crypto_heap_stats_t)) {
+            return PSA_ERROR_PROGRAMMER_ERROR;
+        }
+
+        tfm_crypto_mem_get_stats(&heap_stats);
+        (void)memcpy(out_vec[0].base, &heap_stats, sizeof(heap_stats));
+
+        return PSA_SUCCESS;
+    }
+#endif /* CRYPTO_ENGINE_SLAB_SIZE > 0 */
+
+#if CRYPTO_KEY_CACHE_SLOTS > 0
+    if (iov->function_id == TFM_CRYPTO_GET_KEY_CACHE_STATS_SID) {
+        struct tfm_crypto_key_cache_stats_t key_cache_stats;
+
+        if (out_vec[0].len != sizeof(struct tfm_crypto_key_cache_stats_t)) {
+            return PSA_ERROR_PROGRAMMER_ERROR;
+        }
+
+        tfm_crypto_key_cache_get_stats(&key_cache_stats);
+        (void)memcpy(out_vec[0].base, &key_cache_stats,
+                     sizeof(key_cache_stats));
+
+        return PSA_SUCCESS;
+    }
+#endif /* CRYPTO_KEY_CACHE_SLOTS > 0 */
+
+    out_vec[0].len = 0;
+    return PSA_ERROR_NOT_SUPPORTED;
+}
+/*!@}*/
+#endif /* TFM_CRYPTO_STATS_GROUP_ENABLED */
@@ -7,10 +7,13 @@
 
 #include "tfm_builtin_key_loader.h"
 
+#include "config_crypto.h"
 #include "psa/error.h"
+#include "psa/lifecycle.h"
 #include "tfm_mbedcrypto_include.h"
 #include "tfm_crypto_defs.h"
 #include "mbedtls/hkdf.h"
+#include "mbedtls/platform_util.h"
 #include "psa_manifest/pid.h"
 #include "tfm_plat_crypto_keys.h"
 
@@ -34,6 +37,111 @@ struct tfm_builtin_key_t {
 
 static struct tfm_builtin_key_t builtin_key_slots[TFM_BUILTIN_MAX_KEYS] = {0};
 
+#if TFM_BUILTIN_DERIVED_KEY_CACHE_SIZE > 0
+struct tfm_builtin_derived_key_t {
+    uint8_t key[TFM_BUILTIN_MAX_KEY_LEN];
+    size_t key_len;
+    psa_drv_slot_number_t slot_number;
+    mbedtls_key_owner_id_t owner;
+    uint32_t is_valid;
+};
+
+static struct tfm_builtin_derived_key_t
+                derived_key_cache[TFM_BUILTIN_DERIVED_KEY_CACHE_SIZE] = {0};
+/* Next cache entry to be evicted, entries are replaced in round-robin */
+static uint32_t derived_key_cache_victim;
+/* Lifecycle state the cached subkeys were derived in */
+static uint32_t derived_key_cache_lifecycle = PSA_LIFECYCLE_UNKNOWN;
+
+static void derived_key_cache_evict(struct tfm_builtin_derived_key_t *entry)
+{
+    mbedtls_platform_zeroize(entry, sizeof(*entry));
+}
+
+static struct tfm_builtin_derived_key_t *derived_key_cache_find(
+        psa_drv_slot_number_t slot_number, mbedtls_key_owner_id_t owner,
+        size_t key_len)
+{
+    uint32_t i;
+
+    for (i = 0; i < TFM_BUILTIN_DERIVED_KEY_CACHE_SIZE; i++) {
+        if (derived_key_cache[i].is_valid &&
+            derived_key_cache[i].slot_number == slot_number &&
+            derived_key_cache[i].owner == owner &&
+            derived_key_cache[i].key_len == key_len) {
+            return &derived_key_cache[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void derived_key_cache_insert(psa_drv_slot_number_t slot_number,
+                                     mbedtls_key_owner_id_t owner,
+                                     const uint8_t *key, size_t key_len)
+{
+    struct tfm_builtin_derived_key_t *entry;
+    uint32_t i;
+
+    if (key_len > TFM_BUILTIN_MAX_KEY_LEN) {
+        return;
+    }
+
+    /* Prefer a free entry over evicting a valid one */
+    for (i = 0; i < TFM_BUILTIN_DERIVED_KEY_CACHE_SIZE; i++) {
+        if (!derived_key_cache[i].is_valid) {
+            break;
+        }
+    }
+
+    if (i == TFM_BUILTIN_DERIVED_KEY_CACHE_SIZE) {
+        i = derived_key_cache_victim;
+        derived_key_cache_victim = (derived_key_cache_victim + 1) %
+                                   TFM_BUILTIN_DERIVED_KEY_CACHE_SIZE;
+    }
+
+    entry = &derived_key_cache[i];
+    derived_key_cache_evict(entry);
+
+    memcpy(entry->key, key, key_len);
+    entry->key_len = key_len;
+    entry->slot_number = slot_number;
+    entry->owner = owner;
+    entry->is_valid = 1;
+}
+#endif /* TFM_BUILTIN_DERIVED_KEY_CACHE_SIZE > 0 */
+
+void tfm_builtin_key_loader_invalidate_derived_keys(
+        psa_drv_slot_number_t slot_number)
+{
+#if TFM_BUILTIN_DERIVED_KEY_CACHE_SIZE > 0
+    uint32_t i;
+
+    for (i = 0; i < TFM_BUILTIN_DERIVED_KEY_CACHE_SIZE; i++) {
+        if (derived_key_cache[i].is_valid &&
+            (slot_number == TFM_BUILTIN_KEY_SLOT_ALL ||
+             derived_key_cache[i].slot_number == slot_number)) {
+            derived_key_cache_evict(&derived_key_cache[i]);
+        }
+    }
+#else
+    (void)slot_number;
+#endif /* TFM_BUILTIN_DERIVED_KEY_CACHE_SIZE > 0 */
+}
+
+#if TFM_BUILTIN_DERIVED_KEY_CACHE_SIZE > 0
+/* Drops every cached subkey when the device lifecycle has changed */
+static void derived_key_cache_check_lifecycle(void)
+{
+    uint32_t lifecycle = psa_rot_lifecycle_state();
+
+    if (lifecycle != derived_key_cache_lifecycle) {
+        tfm_builtin_key_loader_invalidate_derived_keys(TFM_BUILTIN_KEY_SLOT_ALL);
+        derived_key_cache_lifecycle = lifecycle;
+    }
+}
+#endif /* TFM_BUILTIN_DERIVED_KEY_CACHE_SIZE > 0 */
+
 psa_status_t tfm_builtin_key_loader_load_key(uint8_t *buf, size_t key_len,
                                              psa_key_attributes_t *attr)
 {
@@ -60,10 +168,14 @@ psa_status_t tfm_builtin_key_loader_load_key(uint8_t *buf, size_t key_len,
         return err;
     }
 
+    /* Subkeys derived from the previous content of the slot are stale */
+    tfm_builtin_key_loader_invalidate_derived_keys(slot_number);
+
     memcpy(&(builtin_key_slots[slot_number].attr), attr,
            sizeof(psa_key_attributes_t));
     memcpy(&(builtin_key_slots[slot_number].key), buf, key_len);
     builtin_key_slots[slot_number].key_len = key_len;
+    builtin_key_slots[slot_number].slot_number = slot_number;
     builtin_key_slots[slot_number].is_loaded = 1;
 
     return PSA_SUCCESS;
@@ -115,6 +227,9 @@ static psa_status_t derive_subkey_into_buffer(
         uint8_t *key_buffer, size_t key_buffer_size, size_t *key_buffer_length)
 {
     int mbedtls_err;
+#if TFM_BUILTIN_DERIVED_KEY_CACHE_SIZE > 0
+    struct tfm_builtin_derived_key_t *cached;
+#endif
 
 #ifdef TFM_PARTITION_TEST_PS
     /* Hack to allow the PS tests to work, since they directly call
@@ -126,6 +241,18 @@ static psa_status_t derive_subkey_into_buffer(
     }
 #endif /* TFM_PARTITION_TEST_PS */
 
+#if TFM_BUILTIN_DERIVED_KEY_CACHE_SIZE > 0
+    derived_key_cache_check_lifecycle();
+
+    cached = derived_key_cache_find(key_slot->slot_number, owner,
+                                    key_buffer_size);
+    if (cached != NULL) {
+        memcpy(key_buffer, cached->key, cached->key_len);
+        *key_buffer_length = cached->key_len;
+        return PSA_SUCCESS;
+    }
+#endif /* TFM_BUILTIN_DERIVED_KEY_CACHE_SIZE > 0 */
+
     /* FIXME this should be moved to using the PSA APIs once key derivation is
      * implemented in the PSA driver wrapper. Using the external PSA apis
      * directly creates a keyslot and we'd need to read the data from it and
@@ -143,6 +270,11 @@ static psa_status_t derive_subkey_into_buffer(
 
     *key_buffer_length = key_buffer_size;
 
+#if TFM_BUILTIN_DERIVED_KEY_CACHE_SIZE > 0
+    derived_key_cache_insert(key_slot->slot_number, owner, key_buffer,
+                             key_buffer_size);
+#endif /* TFM_BUILTIN_DERIVED_KEY_CACHE_SIZE > 0 */
+
     return PSA_SUCCESS;
 }
 
@@ -27,6 +27,9 @@ enum psa_drv_slot_number_t {
 #include "platform_builtin_key_loader_ids.h"
 #endif
 
+/* Selects every slot in \ref tfm_builtin_key_loader_invalidate_derived_keys */
+#define TFM_BUILTIN_KEY_SLOT_ALL ((psa_drv_slot_number_t)-1)
+
 /**
  * \brief Load a key into the builtin key driver
  *
@@ -73,6 +76,21 @@ psa_status_t tfm_builtin_key_loader_get_key_buffer(
         psa_drv_slot_number_t slot_number, psa_key_attributes_t *attributes,
         uint8_t *key_buffer, size_t key_buffer_size, size_t *key_buffer_length);
 
+/**
+ * \brief Drops the cached per-owner subkeys derived from a builtin key and
+ *        zeroizes their key material.
+ *
+ * \note The cache is invalidated automatically when a slot is reloaded and,
+ *       for every slot, when the PSA RoT lifecycle state changes. The platform
+ *       must call this function when builtin key material is otherwise
+ *       revoked.
+ *
+ * \param[in]  slot_number  The slot of the builtin key, or
+ *                          \ref TFM_BUILTIN_KEY_SLOT_ALL for every slot.
+ */
+void tfm_builtin_key_loader_invalidate_derived_keys(
+        psa_drv_slot_number_t slot_number);
+
 #ifdef __cplusplus
 }
 #endif
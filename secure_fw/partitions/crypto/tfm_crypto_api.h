@@ -12,6 +12,7 @@
 extern "C" {
 #endif
 
+#include <stdbool.h>
 #include <stdint.h>
 #include "tfm_crypto_defs.h"
 #include "psa/crypto_client_struct.h"
@@ -237,6 +238,108 @@ psa_status_t tfm_crypto_key_derivation_interface(psa_invec in_vec[],
  */
 psa_status_t tfm_crypto_random_interface(psa_invec in_vec[],
                                          psa_outvec out_vec[]);
+/**
+ * \brief The Statistics group is served when one of its sources is enabled
+ */
+#define TFM_CRYPTO_STATS_GROUP_ENABLED  (CRYPTO_STATS_ENABLED ||            \
+                                         (CRYPTO_ENGINE_SLAB_SIZE > 0) ||   \
+                                         (CRYPTO_KEY_CACHE_SLOTS > 0))
+
+/**
+ * \brief This function acts as interface for the Statistics module
+ *
+ * \param[in]  in_vec   Array of invec parameters
+ * \param[out] out_vec  Array of outvec parameters
+ *
+ * \return Return values as described in \ref psa_status_t
+ */
+psa_status_t tfm_crypto_stats_interface(psa_invec in_vec[],
+                                        psa_outvec out_vec[]);
+
+/**
+ * \brief Initialises the statistics table and the cycle counter
+ */
+void tfm_crypto_stats_init(void);
+
+/**
+ * \brief Starts the cycle counter used to time the calls. The default
+ *        implementation uses the DWT cycle counter with isolation level 1,
+ *        platforms can override it.
+ */
+void tfm_crypto_stats_timer_init(void);
+
+/**
+ * \brief Returns the current value of the cycle counter used to time the
+ *        calls. The default implementation reads the DWT cycle counter with
+ *        isolation level 1 and returns 0 otherwise, platforms can override it.
+ *
+ * \return Current value of the cycle counter
+ */
+uint32_t tfm_crypto_stats_get_cycles(void);
+
+/**
+ * \brief Records a call in the statistics of a function
+ *
+ * \param[in] function_id  Function SID, see \ref tfm_crypto_func_sid
+ * \param[in] bytes        Bytes passed as input data by the call
+ * \param[in] cycles       Cycles spent serving the call
+ */
+void tfm_crypto_stats_record(uint16_t function_id, size_t bytes,
+                             uint32_t cycles);
+
+/**
+ * \brief Splits the memory of the Crypto engine into size-class slabs and a
+ *        fallback heap, and sets them as the Mbed Crypto allocator
+ *
+ * \param[in] buf   Memory to be used by the Crypto engine
+ * \param[in] size  Size of \p buf in bytes
+ */
+void tfm_crypto_mem_init(uint8_t *buf, size_t size);
+
+/**
+ * \brief Reads the usage statistics of the memory of the Crypto engine
+ *
+ * \param[out] stats  Statistics of the memory of the Crypto engine
+ */
+void tfm_crypto_mem_get_stats(struct tfm_crypto_heap_stats_t *stats);
+
+/**
+ * \brief Records an access to a key by a Crypto operation. A persistent key is
+ *        kept loaded in its key slot until it is the least recently used key
+ *        of the cache, which is then purged. Volatile and built-in keys are
+ *        ignored.
+ *
+ * \param[in] key  Key identifier, including the owner of the key
+ */
+void tfm_crypto_key_cache_access(mbedtls_svc_key_id_t key);
+
+/**
+ * \brief Removes a key from the key cache. It needs to be called before the
+ *        key is closed, purged or destroyed.
+ *
+ * \param[in] key  Key identifier, including the owner of the key
+ */
+void tfm_crypto_key_cache_release(mbedtls_svc_key_id_t key);
+
+/**
+ * \brief Pins or unpins a persistent key in the key cache. A pinned key is
+ *        never evicted to make room for another key. An owner can pin at most
+ *        CRYPTO_KEY_CACHE_PIN_QUOTA keys.
+ *
+ * \param[in] key  Key identifier, including the owner of the key
+ * \param[in] pin  true to pin the key, false to unpin it
+ *
+ * \return Return values as described in \ref psa_status_t
+ */
+psa_status_t tfm_crypto_key_cache_pin(mbedtls_svc_key_id_t key, bool pin);
+
+/**
+ * \brief Reads the statistics of the key cache
+ *
+ * \param[out] stats  Statistics of the key cache
+ */
+void tfm_crypto_key_cache_get_stats(struct tfm_crypto_key_cache_stats_t *stats);
+
 /**
  * \brief This function acts as interface for the Hash module
  *
@@ -5,6 +5,7 @@
  *
  */
 #include <string.h>
+#include "config_fwu.h"
 #include "psa/crypto.h"
 #include "tfm_sp_log.h"
 #include "bootutil_priv.h"
@@ -42,17 +43,224 @@ typedef struct fwu_image_info_data_s {
     uint8_t data[MAX_IMAGE_INFO_LENGTH];
 } fwu_image_info_data_t;
 
+#if (MCUBOOT_IMAGE_NUMBER > 1)
+/*
+ * The part of the manifest of a staged image which is checked at
+ * installation, read once from flash and kept until the image is written
+ * again.
+ */
+typedef struct fwu_manifest_cache_s {
+    /* The other fields are filled. */
+    bool valid;
+
+    /* The version of the staged image. */
+    struct image_version version;
+
+    /* The images the staged image depends on, and the highest minimum
+     * version it requires for each of them.
+     */
+    bool depends[MCUBOOT_IMAGE_NUMBER];
+    struct image_version min_version[MCUBOOT_IMAGE_NUMBER];
+} fwu_manifest_cache_t;
+#endif
+
 typedef struct tfm_fwu_mcuboot_ctx_s {
     /* The flash area corresponding to component. */
     const struct flash_area *fap;
 
     /* The size of the downloaded data in the FWU process. */
     size_t loaded_size;
+
+#if TFM_FWU_WRITE_PIPELINE
+    /* The block being programmed in background, 0 sized if none. */
+    size_t pending_offset;
+    size_t pending_size;
+#endif
+
+#if TFM_FWU_ERASE_AHEAD
+    /* The size of the start of the staging area which has been erased. */
+    size_t erased_size;
+
+    /* The staging area was written since erased_size was last updated. */
+    bool dirty;
+#endif
+
+#if TFM_FWU_INCREMENTAL_DIGEST
+    /* The hash of the data loaded so far, while it is loaded in order. */
+    psa_hash_operation_t hash_op;
+
+    /* The hash_op is active. */
+    bool hashing;
+
+    /* The size of the data added to hash_op. */
+    size_t hashed_size;
+
+    /* The digest of the downloaded data once finished, 0 sized if not. */
+    uint8_t digest[TFM_FWU_MAX_DIGEST_SIZE];
+    size_t digest_size;
+#endif
+
+#if (MCUBOOT_IMAGE_NUMBER > 1)
+    /* The manifest of the downloaded image. */
+    fwu_manifest_cache_t manifest;
+#endif
 } tfm_fwu_mcuboot_ctx_t;
 
 static tfm_fwu_mcuboot_ctx_t mcuboot_ctx[FWU_COMPONENT_NUMBER];
 static fwu_image_info_data_t __attribute__((aligned(4))) boot_shared_data;
 
+#if TFM_FWU_INCREMENTAL_DIGEST
+/*
+ * The digest of the downloaded data is computed as the blocks are loaded,
+ * so that querying a CANDIDATE component doesn't read the whole image back
+ * from flash. Each block is read back and hashed once it is programmed, so
+ * the digest is the one of the flash contents. The hash only follows blocks
+ * loaded in order. Any other block drops it, and the digest is then
+ * computed from flash as without this option.
+ */
+static void digest_reset(psa_fwu_component_t component)
+{
+    if (mcuboot_ctx[component].hashing) {
+        (void)psa_hash_abort(&mcuboot_ctx[component].hash_op);
+    }
+    mcuboot_ctx[component].hashing = false;
+    mcuboot_ctx[component].hashed_size = 0;
+    mcuboot_ctx[component].digest_size = 0;
+}
+
+static void digest_start(psa_fwu_component_t component)
+{
+    digest_reset(component);
+
+    mcuboot_ctx[component].hash_op = psa_hash_operation_init();
+    if (psa_hash_setup(&mcuboot_ctx[component].hash_op,
+                       PSA_ALG_SHA_256) == PSA_SUCCESS) {
+        mcuboot_ctx[component].hashing = true;
+    }
+}
+
+static void digest_update(psa_fwu_component_t component,
+                          size_t block_offset,
+                          size_t block_size)
+{
+    const struct flash_area *fap = mcuboot_ctx[component].fap;
+    uint8_t tmpbuf[BOOT_TMPBUF_SZ];
+    size_t blk_sz;
+    size_t off;
+
+    if (!mcuboot_ctx[component].hashing) {
+        return;
+    }
+
+    if (block_offset != mcuboot_ctx[component].hashed_size) {
+        digest_reset(component);
+        return;
+    }
+
+    for (off = block_offset; off < block_offset + block_size; off += blk_sz) {
+        blk_sz = block_offset + block_size - off;
+        if (blk_sz > sizeof(tmpbuf)) {
+            blk_sz = sizeof(tmpbuf);
+        }
+
+        if ((flash_area_read(fap, off, tmpbuf, blk_sz) != 0) ||
+            (psa_hash_update(&mcuboot_ctx[component].hash_op,
+                             tmpbuf, blk_sz) != PSA_SUCCESS)) {
+            digest_reset(component);
+            return;
+        }
+    }
+
+    mcuboot_ctx[component].hashed_size += block_size;
+}
+
+static void digest_finish(psa_fwu_component_t component)
+{
+    if (!mcuboot_ctx[component].hashing ||
+        (mcuboot_ctx[component].hashed_size !=
+         mcuboot_ctx[component].loaded_size)) {
+        return;
+    }
+
+    if (psa_hash_finish(&mcuboot_ctx[component].hash_op,
+                        mcuboot_ctx[component].digest,
+                        sizeof(mcuboot_ctx[component].digest),
+                        &mcuboot_ctx[component].digest_size) != PSA_SUCCESS) {
+        (void)psa_hash_abort(&mcuboot_ctx[component].hash_op);
+        mcuboot_ctx[component].digest_size = 0;
+    }
+    mcuboot_ctx[component].hashing = false;
+}
+#endif /* TFM_FWU_INCREMENTAL_DIGEST */
+
+#if TFM_FWU_ERASE_AHEAD
+/*
+ * The staging area is not erased as a whole when an update starts. Its
+ * sectors are erased in order, just before the blocks written into them, or
+ * in advance when the client prepares the staging area. The erased part is
+ * always the start of the staging area, up to erased_size.
+ */
+static psa_status_t erase_ahead(psa_fwu_component_t component,
+                                const struct flash_area *fap,
+                                size_t size)
+{
+    size_t sector_size = DRV_FLASH_AREA(fap)->GetInfo()->sector_size;
+    size_t erased_size = mcuboot_ctx[component].erased_size;
+    size_t len;
+
+    if ((size == 0) || (size > fap->fa_size - erased_size)) {
+        size = fap->fa_size - erased_size;
+    }
+    if (size == 0) {
+        return PSA_SUCCESS;
+    }
+
+    /* Whole sectors are erased, only the last one may be cut by the end of
+     * the staging area.
+     */
+    len = ((size + sector_size - 1) / sector_size) * sector_size;
+    if (len > fap->fa_size - erased_size) {
+        len = fap->fa_size - erased_size;
+    }
+
+    if (flash_area_erase(fap, erased_size, len) != 0) {
+        LOG_ERRFMT("TFM FWU: erasing flash failed.\r\n");
+        return PSA_ERROR_STORAGE_FAILURE;
+    }
+
+    mcuboot_ctx[component].erased_size = erased_size + len;
+    return PSA_SUCCESS;
+}
+
+/* Erases the staging area up to the end of a block about to be written. */
+static psa_status_t erase_for_block(psa_fwu_component_t component,
+                                    const struct flash_area *fap,
+                                    size_t block_offset,
+                                    size_t block_size)
+{
+    /* Out of range blocks are rejected when they are written. */
+    if ((block_size == 0) ||
+        (block_offset > fap->fa_size) ||
+        (block_size > fap->fa_size - block_offset) ||
+        (block_offset + block_size <= mcuboot_ctx[component].erased_size)) {
+        return PSA_SUCCESS;
+    }
+
+    return erase_ahead(component, fap, block_offset + block_size -
+                                       mcuboot_ctx[component].erased_size);
+}
+#endif /* TFM_FWU_ERASE_AHEAD */
+
+/* The staged image changes, its manifest must be read again. */
+static void manifest_reset(psa_fwu_component_t component)
+{
+#if (MCUBOOT_IMAGE_NUMBER > 1)
+    mcuboot_ctx[component].manifest.valid = false;
+#else
+    (void)component;
+#endif
+}
+
 static int fwu_bootloader_get_shared_data(void)
 {
     return tfm_core_get_boot_data(TLV_MAJOR_FWU,
@@ -123,19 +331,52 @@ psa_status_t fwu_bootloader_staging_area_init(psa_fwu_component_t component,
         return PSA_ERROR_STORAGE_FAILURE;
     }
 
+#if TFM_FWU_ERASE_AHEAD
+    /* Erased lazily as the image is written. What was erased in advance is
+     * kept, unless a previous update has written into it since.
+     */
+    if (mcuboot_ctx[component].dirty) {
+        mcuboot_ctx[component].erased_size = 0;
+    }
+    mcuboot_ctx[component].dirty = true;
+#else
     if (flash_area_erase(fap, 0, fap->fa_size) != 0) {
         LOG_ERRFMT("TFM FWU: erasing flash failed.\r\n");
         return PSA_ERROR_GENERIC_ERROR;
     }
+#endif
 
     mcuboot_ctx[component].fap = fap;
 
     /* Reset the loaded_size. */
     mcuboot_ctx[component].loaded_size = 0;
+#if TFM_FWU_WRITE_PIPELINE
+    mcuboot_ctx[component].pending_size = 0;
+#endif
+    manifest_reset(component);
+#if TFM_FWU_INCREMENTAL_DIGEST
+    digest_start(component);
+#endif
 
     return PSA_SUCCESS;
 }
 
+#if TFM_FWU_WRITE_PIPELINE
+/* Waits for the flash driver to complete the programming in background, if
+ * any. Returns false if the programming failed.
+ */
+static bool flash_wait_ready(const struct flash_area *fap)
+{
+    ARM_FLASH_STATUS status;
+
+    do {
+        status = DRV_FLASH_AREA(fap)->GetStatus();
+    } while (status.busy);
+
+    return !status.error;
+}
+#endif
+
 psa_status_t fwu_bootloader_load_image(psa_fwu_component_t component,
                                        size_t block_offset,
                                        const void *block,
@@ -154,16 +395,230 @@ psa_status_t fwu_bootloader_load_image(psa_fwu_component_t component,
         return PSA_ERROR_BAD_STATE;
     }
 
+    manifest_reset(component);
+
+#if TFM_FWU_ERASE_AHEAD
+    if (erase_for_block(component, fap, block_offset,
+                        block_size) != PSA_SUCCESS) {
+#if TFM_FWU_INCREMENTAL_DIGEST
+        digest_reset(component);
+#endif
+        return PSA_ERROR_STORAGE_FAILURE;
+    }
+#endif
+
     if (flash_area_write(fap, block_offset, block, block_size) != 0) {
         LOG_ERRFMT("TFM FWU: write flash failed.\r\n");
+#if TFM_FWU_INCREMENTAL_DIGEST
+        digest_reset(component);
+#endif
+        return PSA_ERROR_STORAGE_FAILURE;
+    }
+
+#if TFM_FWU_WRITE_PIPELINE
+    /* A driver which programs in background may still be reading the last
+     * program unit from the stack of flash_area_write(), or the block which
+     * the caller reuses once this returns.
+     */
+    if (!flash_wait_ready(fap)) {
+        LOG_ERRFMT("TFM FWU: write flash failed.\r\n");
+#if TFM_FWU_INCREMENTAL_DIGEST
+        digest_reset(component);
+#endif
         return PSA_ERROR_STORAGE_FAILURE;
     }
+#endif
+
+#if TFM_FWU_INCREMENTAL_DIGEST
+    digest_update(component, block_offset, block_size);
+#endif
 
     /* The overflow check has been done in flash_area_write. */
     mcuboot_ctx[component].loaded_size += block_size;
     return PSA_SUCCESS;
 }
 
+#if TFM_FWU_WRITE_PIPELINE
+psa_status_t fwu_bootloader_load_image_start(psa_fwu_component_t component,
+                                             size_t block_offset,
+                                             const void *block,
+                                             size_t block_size)
+{
+    const struct flash_area *fap;
+    ARM_FLASH_CAPABILITIES capabilities;
+    uint32_t data_width;
+    int32_t ret;
+
+    if (block == NULL || component >= FWU_COMPONENT_NUMBER) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    /* The component should already be added into the mcuboot_ctx. */
+    if (mcuboot_ctx[component].fap != NULL) {
+        fap = mcuboot_ctx[component].fap;
+    } else {
+        return PSA_ERROR_BAD_STATE;
+    }
+
+    /* The previous block must have been waited for. */
+    if (mcuboot_ctx[component].pending_size != 0) {
+        return PSA_ERROR_BAD_STATE;
+    }
+
+    manifest_reset(component);
+
+    capabilities = DRV_FLASH_AREA(fap)->GetCapabilities();
+    data_width = 1u << capabilities.data_width;
+
+    /* Only the blocks which can be handed to the driver as they are, without
+     * reading back the partial program units around them, are programmed in
+     * background. The others are written synchronously.
+     */
+    if ((block_size == 0) ||
+        (block_offset % TFM_HAL_FLASH_PROGRAM_UNIT != 0) ||
+        (block_size % TFM_HAL_FLASH_PROGRAM_UNIT != 0) ||
+        (block_size % data_width != 0) ||
+        (block_offset > fap->fa_size) ||
+        (block_size > fap->fa_size - block_offset)) {
+        return fwu_bootloader_load_image(component, block_offset,
+                                         block, block_size);
+    }
+
+#if TFM_FWU_ERASE_AHEAD
+    if (erase_for_block(component, fap, block_offset,
+                        block_size) != PSA_SUCCESS) {
+#if TFM_FWU_INCREMENTAL_DIGEST
+        digest_reset(component);
+#endif
+        return PSA_ERROR_STORAGE_FAILURE;
+    }
+#endif
+
+    /* A CMSIS flash driver returns the number of data items programmed when
+     * the programming is complete on return, or 0 when it has only been
+     * started. In the latter case the driver reports busy until it is done.
+     */
+    ret = DRV_FLASH_AREA(fap)->ProgramData(fap->fa_off + block_offset,
+                                           block,
+                                           block_size / data_width);
+    if ((ret < 0) ||
+        ((ret > 0) && ((size_t)ret != block_size / data_width))) {
+        /* Failed, or only programmed a part of the block */
+        LOG_ERRFMT("TFM FWU: write flash failed.\r\n");
+#if TFM_FWU_INCREMENTAL_DIGEST
+        digest_reset(component);
+#endif
+        return PSA_ERROR_STORAGE_FAILURE;
+    }
+
+    if (ret == 0) {
+        mcuboot_ctx[component].pending_offset = block_offset;
+        mcuboot_ctx[component].pending_size = block_size;
+    } else {
+#if TFM_FWU_INCREMENTAL_DIGEST
+        digest_update(component, block_offset, block_size);
+#endif
+        mcuboot_ctx[component].loaded_size += block_size;
+    }
+    return PSA_SUCCESS;
+}
+
+psa_status_t fwu_bootloader_load_image_wait(psa_fwu_component_t component)
+{
+    size_t pending_size;
+
+    if (component >= FWU_COMPONENT_NUMBER) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    pending_size = mcuboot_ctx[component].pending_size;
+    if (pending_size == 0) {
+        return PSA_SUCCESS;
+    }
+    mcuboot_ctx[component].pending_size = 0;
+
+    if (!flash_wait_ready(mcuboot_ctx[component].fap)) {
+        LOG_ERRFMT("TFM FWU: write flash failed.\r\n");
+#if TFM_FWU_INCREMENTAL_DIGEST
+        digest_reset(component);
+#endif
+        return PSA_ERROR_STORAGE_FAILURE;
+    }
+
+#if TFM_FWU_INCREMENTAL_DIGEST
+    digest_update(component, mcuboot_ctx[component].pending_offset,
+                  pending_size);
+#endif
+
+    mcuboot_ctx[component].loaded_size += pending_size;
+    return PSA_SUCCESS;
+}
+#endif /* TFM_FWU_WRITE_PIPELINE */
+
+psa_status_t fwu_bootloader_read_image(psa_fwu_component_t component,
+                                       bool staged,
+                                       size_t image_offset,
+                                       void *buf,
+                                       size_t size)
+{
+    const struct flash_area *fap;
+    int rc;
+
+    if (buf == NULL || component >= FWU_COMPONENT_NUMBER) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    /* The running image is in the primary slot. */
+    if (flash_area_open(staged ? FLASH_AREA_IMAGE_SECONDARY(component) :
+                                 FLASH_AREA_IMAGE_PRIMARY(component),
+                        &fap) != 0) {
+        LOG_ERRFMT("TFM FWU: opening flash failed.\r\n");
+        return PSA_ERROR_STORAGE_FAILURE;
+    }
+
+    rc = flash_area_read(fap, image_offset, buf, size);
+    flash_area_close(fap);
+    if (rc != 0) {
+        return PSA_ERROR_STORAGE_FAILURE;
+    }
+
+    return PSA_SUCCESS;
+}
+
+#if TFM_FWU_ERASE_AHEAD
+psa_status_t fwu_bootloader_prepare_staging_area(psa_fwu_component_t component,
+                                                 size_t size)
+{
+    const struct flash_area *fap;
+    psa_status_t status;
+
+    if (component >= FWU_COMPONENT_NUMBER) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    /* During an update, the erasing continues after the erased part. */
+    if (mcuboot_ctx[component].fap != NULL) {
+        return erase_ahead(component, mcuboot_ctx[component].fap, size);
+    }
+
+    if (flash_area_open(FLASH_AREA_IMAGE_SECONDARY(component),
+                        &fap) != 0) {
+        LOG_ERRFMT("TFM FWU: opening flash failed.\r\n");
+        return PSA_ERROR_STORAGE_FAILURE;
+    }
+
+    /* The content left by a previous update is erased from the start. */
+    if (mcuboot_ctx[component].dirty) {
+        mcuboot_ctx[component].erased_size = 0;
+        mcuboot_ctx[component].dirty = false;
+    }
+
+    status = erase_ahead(component, fap, size);
+    flash_area_close(fap);
+    return status;
+}
+#endif /* TFM_FWU_ERASE_AHEAD */
+
 #if (MCUBOOT_IMAGE_NUMBER > 1)
 /**
  * \brief Compare image version numbers not including the build number.
@@ -197,6 +652,82 @@ static bool is_version_greater_or_equal(const struct image_version *image_ver_1,
     }
     return false;
 }
+
+/**
+ * \brief Read the version and the dependencies of the staged image into the
+ *        manifest cache of the component, unless it is already there.
+ *
+ * \param[in] component The component of the staged image.
+ *
+ * \return PSA_SUCCESS                On success
+ *         PSA_ERROR_DATA_CORRUPT     The manifest is invalid
+ *         PSA_ERROR_STORAGE_FAILURE  The manifest can't be read
+ */
+static psa_status_t load_manifest(psa_fwu_component_t component)
+{
+    fwu_manifest_cache_t *manifest = &mcuboot_ctx[component].manifest;
+    const struct flash_area *fap = mcuboot_ctx[component].fap;
+    struct image_tlv_iter it;
+    struct image_header hdr;
+    struct image_dependency dep;
+    uint32_t off;
+    uint16_t len;
+    int rc;
+
+    if (manifest->valid) {
+        return PSA_SUCCESS;
+    }
+
+    /* Read the image header. */
+    if (flash_area_read(fap, 0, &hdr, sizeof(hdr)) != 0) {
+        return PSA_ERROR_STORAGE_FAILURE;
+    }
+
+    /* Return PSA_ERROR_DATA_CORRUPT if the image header is invalid. */
+    if (hdr.ih_magic != IMAGE_MAGIC) {
+        return PSA_ERROR_DATA_CORRUPT;
+    }
+
+    memset(manifest, 0, sizeof(*manifest));
+    manifest->version = hdr.ih_ver;
+
+    /* Initialize the iterator. */
+    if (bootutil_tlv_iter_begin(&it, &hdr, fap, IMAGE_TLV_DEPENDENCY, true)) {
+        return PSA_ERROR_STORAGE_FAILURE;
+    }
+    while (true) {
+        rc = bootutil_tlv_iter_next(&it, &off, &len, NULL);
+        if (rc < 0) {
+            return PSA_ERROR_STORAGE_FAILURE;
+        } else if (rc > 0) {
+            /* No more dependency found. */
+            break;
+        }
+
+        if (len != sizeof(dep)) {
+            return PSA_ERROR_DATA_CORRUPT;
+        }
+        if (flash_area_read(fap, off, &dep, len) != 0) {
+            return PSA_ERROR_STORAGE_FAILURE;
+        }
+        if (dep.image_id >= MCUBOOT_IMAGE_NUMBER) {
+            return PSA_ERROR_DATA_CORRUPT;
+        }
+
+        /* The dependencies on the same image are all met by the highest of
+         * their minimum versions.
+         */
+        if (!manifest->depends[dep.image_id] ||
+            !is_version_greater_or_equal(&manifest->min_version[dep.image_id],
+                                         &dep.image_min_version)) {
+            manifest->depends[dep.image_id] = true;
+            manifest->min_version[dep.image_id] = dep.image_min_version;
+        }
+    }
+
+    manifest->valid = true;
+    return PSA_SUCCESS;
+}
 #endif
 
 psa_status_t fwu_bootloader_install_image(const psa_fwu_component_t *candidates, uint8_t number)
@@ -204,17 +735,10 @@ psa_status_t fwu_bootloader_install_image(const psa_fwu_component_t *candidates,
     uint8_t index_i, cand_index;
 #if (MCUBOOT_IMAGE_NUMBER > 1)
     psa_fwu_component_t component;
-    const struct flash_area *fap;
-    struct image_tlv_iter it;
-    struct image_header hdr;
-    int rc;
-    uint32_t off;
-    uint16_t len;
-    struct image_dependency dep;
+    const fwu_manifest_cache_t *manifest;
     struct image_version image_ver = { 0 };
-    const struct flash_area *fap_secondary;
-    struct image_header hdr_secondary;
-    bool check_pass = true;
+    uint8_t image_id;
+    psa_status_t status;
 #endif
 
     if (candidates == NULL) {
@@ -222,6 +746,9 @@ psa_status_t fwu_bootloader_install_image(const psa_fwu_component_t *candidates,
     }
 
 #if (MCUBOOT_IMAGE_NUMBER > 1)
+    /* Read the manifests of all the candidates first, the dependencies are
+     * then checked against the cached versions without accessing the flash.
+     */
     for (cand_index = 0; cand_index < number; cand_index++) {
         component = candidates[cand_index];
         /* The image should already be added into the mcuboot_ctx. */
@@ -229,40 +756,19 @@ psa_status_t fwu_bootloader_install_image(const psa_fwu_component_t *candidates,
            (mcuboot_ctx[component].fap == NULL)) {
             return PSA_ERROR_INVALID_ARGUMENT;
         }
-        fap = mcuboot_ctx[component].fap;
-        /* Read the image header. */
-        if (flash_area_read(fap, 0, &hdr, sizeof(hdr)) != 0) {
-            return PSA_ERROR_STORAGE_FAILURE;
-        }
-
-        /* Return PSA_ERROR_DATA_CORRUPT if the image header is invalid. */
-        if (hdr.ih_magic != IMAGE_MAGIC) {
-            return PSA_ERROR_DATA_CORRUPT;
-        }
-
-        /* Initialize the iterator. */
-        if (bootutil_tlv_iter_begin(&it, &hdr, fap, IMAGE_TLV_DEPENDENCY, true)) {
-            return PSA_ERROR_STORAGE_FAILURE;
+        status = load_manifest(component);
+        if (status != PSA_SUCCESS) {
+            return status;
         }
-        /* Check dependencies. */
-        while (true) {
-            rc = bootutil_tlv_iter_next(&it, &off, &len, NULL);
-            if (rc < 0) {
-                return PSA_ERROR_STORAGE_FAILURE;
-            } else if (rc > 0) {
-                /* No more dependency found. */
-                rc = 0;
-                break;
-            }
+    }
 
-            /* A dependency requirement is found. Set check_pass to false. */
-            check_pass = false;
-            if (flash_area_read(fap, off, &dep, len) != 0) {
-                return PSA_ERROR_STORAGE_FAILURE;
-            }
+    /* Check dependencies. */
+    for (cand_index = 0; cand_index < number; cand_index++) {
+        manifest = &mcuboot_ctx[candidates[cand_index]].manifest;
 
-            if (dep.image_id > MCUBOOT_IMAGE_NUMBER) {
-                return PSA_ERROR_DATA_CORRUPT;
+        for (image_id = 0; image_id < MCUBOOT_IMAGE_NUMBER; image_id++) {
+            if (!manifest->depends[image_id]) {
+                continue;
             }
 
             /* As this partition does not validate the image in the secondary slot,
@@ -272,59 +778,52 @@ psa_status_t fwu_bootloader_install_image(const psa_fwu_component_t *candidates,
              * dependency check pass.
              */
             /* Check the dependency image in the primary slot. */
-            if (get_active_image_version(dep.image_id,
-                                        &image_ver) != PSA_SUCCESS) {
+            if (get_active_image_version(image_id,
+                                         &image_ver) != PSA_SUCCESS) {
                 return PSA_ERROR_STORAGE_FAILURE;
             }
+            if (is_version_greater_or_equal(&image_ver,
+                                            &manifest->min_version[image_id])) {
+                continue;
+            }
 
-            /* Check whether the version of the running image can meet the
-             * dependency requirement.
+            /* The running image cannot meet the dependency requirement. Check
+             * whether the CANDIDATE image can meet it.
              */
-            if (is_version_greater_or_equal(&image_ver,
-                                            &dep.image_min_version)) {
-                check_pass = true;
-            } else {
-                /* Check whether the CANDIDATE image can meet this image's dependency
-                 * requirement.
-                 */
-                for (index_i = 0; index_i < number; index_i++) {
-                    if (candidates[index_i] == dep.image_id)
-                        break;
-                }
-                if ((index_i < number) && (mcuboot_ctx[dep.image_id].fap != NULL)) {
-                    /* The running image cannot meet the dependency requirement. Check
-                     * the dependency image in the secondary slot.
-                     */
-                    fap_secondary = mcuboot_ctx[dep.image_id].fap;
-                    if (flash_area_read(fap_secondary,
-                                        0,
-                                        &hdr_secondary,
-                                        sizeof(hdr_secondary)) != 0) {
-                        return PSA_ERROR_STORAGE_FAILURE;
-                    }
-
-                    /* Check the version of the dependency image in the secondary slot
-                     * only if the image header is good.
-                     */
-                    if (hdr_secondary.ih_magic == IMAGE_MAGIC &&
-                        (is_version_greater_or_equal(&hdr_secondary.ih_ver,
-                                                     &dep.image_min_version))) {
-                        /* The dependency image in the secondary slot meet the
-                         * dependency requirement.
-                         */
-                        check_pass = true;
-                    }
+            for (index_i = 0; index_i < number; index_i++) {
+                if (candidates[index_i] == image_id) {
+                    break;
                 }
             }
 
             /* Return directly if dependency check fails. */
-            if (!check_pass) {
+            if ((index_i == number) ||
+                !is_version_greater_or_equal(
+                                    &mcuboot_ctx[image_id].manifest.version,
+                                    &manifest->min_version[image_id])) {
                 return PSA_ERROR_DEPENDENCY_NEEDED;
             }
         }
     }
 #endif
 
+#if TFM_FWU_ERASE_AHEAD
+    /* The image trailer at the end of the staging area must be erased before
+     * the boot magic is written into it.
+     */
+    for (cand_index = 0; cand_index < number; cand_index++) {
+        if ((candidates[cand_index] >= FWU_COMPONENT_NUMBER) ||
+            (mcuboot_ctx[candidates[cand_index]].fap == NULL)) {
+            return PSA_ERROR_INVALID_ARGUMENT;
+        }
+        if (erase_ahead(candidates[cand_index],
+                        mcuboot_ctx[candidates[cand_index]].fap,
+                        0) != PSA_SUCCESS) {
+            return PSA_ERROR_STORAGE_FAILURE;
+        }
+    }
+#endif
+
     /* Write the boot magic in image trailer so that these images will be
      * taken as candidates.
      */
@@ -462,6 +961,9 @@ psa_status_t fwu_bootloader_reject_staged_image(psa_fwu_component_t component)
 
     /* The image should already be added into the mcuboot_ctx. */
     if (mcuboot_ctx[component].fap != NULL) {
+#if TFM_FWU_INCREMENTAL_DIGEST
+        digest_reset(component);
+#endif
         return erase_boot_magic(mcuboot_ctx[component].fap);
     }
 
@@ -495,10 +997,21 @@ psa_status_t fwu_bootloader_abort(psa_fwu_component_t component)
         return PSA_ERROR_INVALID_ARGUMENT;
     }
 
+#if TFM_FWU_ERASE_AHEAD
+    if (flash_area_erase(fap, 0, fap->fa_size) == 0) {
+        mcuboot_ctx[component].erased_size = fap->fa_size;
+        mcuboot_ctx[component].dirty = false;
+    }
+#else
     flash_area_erase(fap, 0, fap->fa_size);
+#endif
     flash_area_close(fap);
     mcuboot_ctx[component].fap = NULL;
     mcuboot_ctx[component].loaded_size = 0;
+    manifest_reset(component);
+#if TFM_FWU_INCREMENTAL_DIGEST
+    digest_reset(component);
+#endif
     return PSA_SUCCESS;
 }
 
@@ -562,6 +1075,17 @@ static psa_status_t get_second_image_digest(psa_fwu_component_t component,
     } else {
         return PSA_ERROR_INVALID_ARGUMENT;
     }
+
+#if TFM_FWU_INCREMENTAL_DIGEST
+    /* Use the digest computed while the data was loaded, if any. */
+    digest_finish(component);
+    if (mcuboot_ctx[component].digest_size != 0) {
+        memcpy(info->impl.candidate_digest, mcuboot_ctx[component].digest,
+               mcuboot_ctx[component].digest_size);
+        return PSA_SUCCESS;
+    }
+#endif
+
     if ((flash_area_open(FLASH_AREA_IMAGE_SECONDARY(component),
                             &fap)) != 0) {
         LOG_ERRFMT("TFM FWU: opening flash failed.\r\n");
@@ -608,6 +1132,17 @@ psa_status_t fwu_bootloader_get_image_info(psa_fwu_component_t component,
     info->max_size = fap->fa_size;
     info->location = fap->fa_id;
     info->flags = PSA_FWU_FLAG_VOLATILE_STAGING;
+#if TFM_FWU_ERASE_AHEAD
+    /* The part erased before a previous update is no longer erased. */
+    if ((mcuboot_ctx[component].fap == NULL) && mcuboot_ctx[component].dirty) {
+        info->impl.staging_erased_size = 0;
+    } else {
+        info->impl.staging_erased_size =
+                                (uint32_t)mcuboot_ctx[component].erased_size;
+    }
+#else
+    info->impl.staging_erased_size = 0;
+#endif
 
     if (query_state) {
         /* As DIRECT_XIP, RAM_LOAD and OVERWRITE_ONLY do not support image revert.
@@ -652,6 +1187,19 @@ close_return:
     return ret;
 }
 
+psa_status_t fwu_bootloader_cancel_image(psa_fwu_component_t component)
+{
+    if (component >= FWU_COMPONENT_NUMBER) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    /* The staging area is left as it is until the component is cleaned. */
+#if TFM_FWU_INCREMENTAL_DIGEST
+    digest_reset(component);
+#endif
+    return PSA_SUCCESS;
+}
+
 psa_status_t fwu_bootloader_clean_component(psa_fwu_component_t component)
 {
     const struct flash_area *fap = NULL;
@@ -666,7 +1214,15 @@ psa_status_t fwu_bootloader_clean_component(psa_fwu_component_t component)
         if (flash_area_erase(fap, 0, fap->fa_size) != 0) {
             return PSA_ERROR_STORAGE_FAILURE;
         }
+#if TFM_FWU_ERASE_AHEAD
+        mcuboot_ctx[component].erased_size = fap->fa_size;
+        mcuboot_ctx[component].dirty = false;
+#endif
         mcuboot_ctx[component].fap = NULL;
+        manifest_reset(component);
+#if TFM_FWU_INCREMENTAL_DIGEST
+        digest_reset(component);
+#endif
     } else {
         return PSA_ERROR_DOES_NOT_EXIST;
     }
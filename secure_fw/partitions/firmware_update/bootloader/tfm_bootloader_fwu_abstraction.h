@@ -9,6 +9,7 @@
 #define __TFM_BOOTLOADER_FWU_ABSTRACTION_H__
 
 #include "stdbool.h"
+#include "config_fwu.h"
 #include "psa/update.h"
 
 #ifdef __cplusplus
@@ -79,6 +80,94 @@ psa_status_t fwu_bootloader_load_image(psa_fwu_component_t component,
                                        const void *block,
                                        size_t block_size);
 
+#if TFM_FWU_WRITE_PIPELINE
+/**
+ * \brief Start loading the image into the target component.
+ *
+ * Same as \ref fwu_bootloader_load_image, except that the bootloader may only
+ * start the programming of the block and complete it in background when the
+ * flash driver supports it. Otherwise the block is written before returning.
+ * The block must be left untouched until \ref fwu_bootloader_load_image_wait
+ * has been called for the component, which must be done before starting to
+ * load the next block.
+ *
+ * \param[in] component The identifier of the target component in bootloader.
+ * \param[in] image_offset  The offset of the image being passed into block, in
+ *                          bytes
+ * \param[in] block         A buffer containing a block of image data. This
+ *                          might be a complete image or a subset.
+ * \param[in] block_size    Size of block.
+ *
+ * \return PSA_SUCCESS                     On success
+ *         PSA_ERROR_INVALID_ARGUMENT      Invalid input parameter
+ *         PSA_ERROR_BAD_STATE             The previous block was not waited
+ *                                         for
+ *         PSA_ERROR_STORAGE_FAILURE       The programming failed to start
+ *
+ */
+psa_status_t fwu_bootloader_load_image_start(psa_fwu_component_t component,
+                                             size_t image_offset,
+                                             const void *block,
+                                             size_t block_size);
+
+/**
+ * \brief Wait for the block started by \ref fwu_bootloader_load_image_start to
+ *        be programmed.
+ *
+ * Returns immediately when no block is being programmed in background.
+ *
+ * \param[in] component The identifier of the target component in bootloader.
+ *
+ * \return PSA_SUCCESS                     On success
+ *         PSA_ERROR_INVALID_ARGUMENT      Invalid input parameter
+ *         PSA_ERROR_STORAGE_FAILURE       The programming of the block failed
+ *
+ */
+psa_status_t fwu_bootloader_load_image_wait(psa_fwu_component_t component);
+#endif /* TFM_FWU_WRITE_PIPELINE */
+
+/**
+ * \brief Read a part of an image of the component.
+ *
+ * \param[in]  component     The identifier of the target component in
+ *                           bootloader.
+ * \param[in]  staged        Read the image being loaded into the staging area
+ *                           if true, the active image otherwise.
+ * \param[in]  image_offset  The offset of the part to read in the image, in
+ *                           bytes
+ * \param[out] buf           The buffer where the part is read
+ * \param[in]  size          Size of the part to read
+ *
+ * \return PSA_SUCCESS                     On success
+ *         PSA_ERROR_INVALID_ARGUMENT      Invalid input parameter
+ *         PSA_ERROR_STORAGE_FAILURE       The part can't be read
+ *
+ */
+psa_status_t fwu_bootloader_read_image(psa_fwu_component_t component,
+                                       bool staged,
+                                       size_t image_offset,
+                                       void *buf,
+                                       size_t size);
+
+/**
+ * \brief Erase a part of the staging area of the component in advance.
+ *
+ * The component is in READY or WRITING state. The staging area is erased in
+ * whole sectors, continuing after the part already erased, so that loading
+ * the image later doesn't wait for the flash to be erased.
+ *
+ * \param[in] component The identifier of the target component in bootloader.
+ * \param[in] size      The size to erase in bytes, rounded up to whole
+ *                      sectors. 0 erases the rest of the staging area.
+ *
+ * \return PSA_SUCCESS                     On success
+ *         PSA_ERROR_INVALID_ARGUMENT      Invalid input parameter
+ *         PSA_ERROR_STORAGE_FAILURE       The flash failed to be erased
+ *
+ */
+psa_status_t fwu_bootloader_prepare_staging_area(psa_fwu_component_t component,
+                                                 size_t size);
+
 /**
  * \brief Starts the installation of an image.
  *
@@ -155,6 +244,20 @@ psa_status_t fwu_bootloader_reject_staged_image(psa_fwu_component_t component);
  */
 psa_status_t fwu_bootloader_reject_trial_image(psa_fwu_component_t component);
 
+/**
+ * \brief The FWU process of the component, in WRITING or CANDIDATE state, is
+ *        cancelled. Release what is held for loading its image.
+ *
+ * The staging area is left as it is, it is cleaned by
+ * \ref fwu_bootloader_clean_component.
+ *
+ * \param[in] component The identifier of the target component in bootloader.
+ *
+ * \return PSA_SUCCESS                     On success
+ *         PSA_ERROR_INVALID_ARGUMENT      Invalid input parameter
+ */
+psa_status_t fwu_bootloader_cancel_image(psa_fwu_component_t component);
+
 /**
  * \brief The component is in FAILED or UPDATED state. Clean the staging area of the component.
  *
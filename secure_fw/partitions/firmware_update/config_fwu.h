@@ -16,6 +16,42 @@
 #define TFM_FWU_BUF_SIZE               PSA_FWU_MAX_WRITE_SIZE
 #endif
 
+/*
+ * Program the FWU data in background while the next part is read from the
+ * client, using the two halves of the transfer buffer in turn
+ */
+#ifndef TFM_FWU_WRITE_PIPELINE
+#pragma message("TFM_FWU_WRITE_PIPELINE is defaulted to 0. Please check and set it explicitly.")
+#define TFM_FWU_WRITE_PIPELINE         0
+#endif
+
+/*
+ * Hash the FWU data as it is written, so that the candidate digest is known
+ * without reading the image back from flash
+ */
+#ifndef TFM_FWU_INCREMENTAL_DIGEST
+#pragma message("TFM_FWU_INCREMENTAL_DIGEST is defaulted to 0. Please check and set it explicitly.")
+#define TFM_FWU_INCREMENTAL_DIGEST     0
+#endif
+
+/*
+ * Size of the output buffer of the decoder of compressed and delta FWU image
+ * streams, 0 to accept plain images only
+ */
+#ifndef TFM_FWU_DELTA_BUF_SIZE
+#pragma message("TFM_FWU_DELTA_BUF_SIZE is defaulted to 0. Please check and set it explicitly.")
+#define TFM_FWU_DELTA_BUF_SIZE         0
+#endif
+
+/*
+ * Erase the FWU staging area sector by sector as it is written, instead of as
+ * a whole when the update starts
+ */
+#ifndef TFM_FWU_ERASE_AHEAD
+#pragma message("TFM_FWU_ERASE_AHEAD is defaulted to 0. Please check and set it explicitly.")
+#define TFM_FWU_ERASE_AHEAD            0
+#endif
+
 /* The stack size of the Firmware Update Secure Partition */
 #ifndef FWU_STACK_SIZE
 #pragma message("FWU_STACK_SIZE is defaulted to 0x600. Please check and set it explicitly.")
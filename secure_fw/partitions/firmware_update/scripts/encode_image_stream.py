@@ -0,0 +1,185 @@
+#-------------------------------------------------------------------------------
+# Copyright (c) 2022, Arm Limited. All rights reserved.
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+#-------------------------------------------------------------------------------
+
+# Encodes an image into the image stream accepted by psa_fwu_write() when
+# TFM_FWU_DELTA_BUF_SIZE is not 0. The format is described in
+# docs/technical_references/design_docs/tfm_fwu_service.rst. The encoded
+# stream is decoded back and compared with the image before it is written.
+
+import argparse
+import sys
+
+MAGIC = b"TFMD"
+
+OP_LITERAL = 0x00
+OP_COPY_BASE = 0x01
+OP_COPY_OUTPUT = 0x02
+
+# Shortest match worth a copy command, which takes up to 11 bytes
+MIN_MATCH = 12
+KEY_SIZE = 4
+MAX_CANDIDATES = 32
+ARG_MAX = 0xFFFFFFFF
+
+def encode_arg(value):
+    if value > ARG_MAX:
+        raise ValueError("argument {} does not fit in 32 bits".format(value))
+
+    out = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+def decode_arg(stream, pos):
+    value = 0
+    shift = 0
+    while True:
+        if pos >= len(stream) or shift > 28:
+            raise ValueError("malformed argument at offset {}".format(pos))
+        byte = stream[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            if value > ARG_MAX:
+                raise ValueError("argument at offset {} exceeds 32 bits"
+                                 .format(pos))
+            return value, pos
+
+def match_length(a, a_pos, b, b_pos, limit):
+    length = 0
+    while length < limit and a[a_pos + length] == b[b_pos + length]:
+        length += 1
+    return length
+
+def best_match(index, data, image, pos, key, max_candidates):
+    best_pos = 0
+    best_len = 0
+    for candidate in reversed(index.get(key, [])[-max_candidates:]):
+        limit = len(image) - pos
+        if data is not image:
+            limit = min(limit, len(data) - candidate)
+        length = match_length(data, candidate, image, pos, limit)
+        if length > best_len:
+            best_pos = candidate
+            best_len = length
+    return best_pos, best_len
+
+def encode(image, base):
+    base_index = {}
+    if base:
+        for pos in range(len(base) - KEY_SIZE + 1):
+            base_index.setdefault(base[pos:pos + KEY_SIZE], []).append(pos)
+
+    out_index = {}
+    stream = bytearray(MAGIC)
+    literal_start = 0
+    pos = 0
+
+    def flush_literal(end):
+        if end > literal_start:
+            stream.append(OP_LITERAL)
+            stream.extend(encode_arg(end - literal_start))
+            stream.extend(image[literal_start:end])
+
+    while pos < len(image):
+        key = image[pos:pos + KEY_SIZE]
+        length = 0
+        if len(key) == KEY_SIZE:
+            base_pos, base_len = best_match(base_index, base, image, pos, key,
+                                            MAX_CANDIDATES)
+            out_pos, out_len = best_match(out_index, image, image, pos, key,
+                                          MAX_CANDIDATES)
+            length = max(base_len, out_len)
+
+        if length < MIN_MATCH:
+            if len(key) == KEY_SIZE:
+                out_index.setdefault(key, []).append(pos)
+            pos += 1
+            continue
+
+        flush_literal(pos)
+        if base_len >= out_len:
+            stream.append(OP_COPY_BASE)
+            stream.extend(encode_arg(base_pos))
+        else:
+            stream.append(OP_COPY_OUTPUT)
+            stream.extend(encode_arg(pos - out_pos))
+        stream.extend(encode_arg(length))
+
+        for skipped in range(pos, pos + length):
+            skipped_key = image[skipped:skipped + KEY_SIZE]
+            if len(skipped_key) == KEY_SIZE:
+                out_index.setdefault(skipped_key, []).append(skipped)
+        pos += length
+        literal_start = pos
+
+    flush_literal(len(image))
+    return bytes(stream)
+
+# Follows the semantics of the decoder in tfm_fwu_delta.c
+def decode(stream, base):
+    if stream[:len(MAGIC)] != MAGIC:
+        raise ValueError("missing magic number")
+
+    out = bytearray()
+    pos = len(MAGIC)
+    while pos < len(stream):
+        opcode = stream[pos]
+        pos += 1
+        if opcode == OP_LITERAL:
+            length, pos = decode_arg(stream, pos)
+            if pos + length > len(stream):
+                raise ValueError("truncated literal")
+            out.extend(stream[pos:pos + length])
+            pos += length
+        elif opcode == OP_COPY_BASE:
+            offset, pos = decode_arg(stream, pos)
+            length, pos = decode_arg(stream, pos)
+            if offset + length > len(base):
+                raise ValueError("copy beyond the base image")
+            out.extend(base[offset:offset + length])
+        elif opcode == OP_COPY_OUTPUT:
+            distance, pos = decode_arg(stream, pos)
+            length, pos = decode_arg(stream, pos)
+            if distance == 0 or distance > len(out):
+                raise ValueError("copy before the start of the output")
+            for _ in range(length):
+                out.append(out[-distance])
+        else:
+            raise ValueError("unknown opcode {:#x}".format(opcode))
+    return bytes(out)
+
+parser = argparse.ArgumentParser()
+parser.add_argument("--input_file", help="the image to encode", required=True)
+parser.add_argument("--base_file", help="the active image, to encode a diff "
+                    "against it", required=False)
+parser.add_argument("--output_file", help="encoded stream output file",
+                    required=True)
+args = parser.parse_args()
+
+with open(args.input_file, "rb") as in_file:
+    image = in_file.read()
+
+base = b""
+if args.base_file:
+    with open(args.base_file, "rb") as base_file:
+        base = base_file.read()
+
+stream = encode(image, base)
+if decode(stream, base) != image:
+    sys.exit("error: the encoded stream does not decode to the input image")
+
+with open(args.output_file, "wb") as out_file:
+    out_file.write(stream)
+
+print("Encoded {} bytes into {} bytes".format(len(image), len(stream)))
@@ -0,0 +1,287 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "config_fwu.h"
+#include "tfm_bootloader_fwu_abstraction.h"
+#include "tfm_fwu_delta.h"
+
+#if TFM_FWU_DELTA_BUF_SIZE > 0
+#define DELTA_OP_LITERAL        0x00
+#define DELTA_OP_COPY_BASE      0x01
+#define DELTA_OP_COPY_OUTPUT    0x02
+
+enum delta_state {
+    DELTA_STATE_MAGIC = 0,      /* Receiving the magic number */
+    DELTA_STATE_OPCODE,         /* Expecting the opcode of a command */
+    DELTA_STATE_ARG,            /* Receiving the arguments of a command */
+    DELTA_STATE_LITERAL,        /* Receiving the bytes of a LITERAL command */
+    DELTA_STATE_ERROR,          /* Decoding failed */
+};
+
+static const uint8_t delta_magic[TFM_FWU_DELTA_MAGIC_SIZE] = {
+    'T', 'F', 'M', 'D'
+};
+
+static size_t delta_min(size_t a, size_t b)
+{
+    return (a < b) ? a : b;
+}
+
+static psa_status_t delta_flush(struct tfm_fwu_delta_ctx_t *ctx)
+{
+    psa_status_t status;
+
+    if (ctx->out_fill == 0) {
+        return PSA_SUCCESS;
+    }
+
+    status = fwu_bootloader_load_image(ctx->component, ctx->out_flushed,
+                                       ctx->out_buf, ctx->out_fill);
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+
+    ctx->out_flushed += ctx->out_fill;
+    ctx->out_fill = 0;
+
+    return PSA_SUCCESS;
+}
+
+/* Returns the free room of the output buffer, flushing it when it is full */
+static psa_status_t delta_get_room(struct tfm_fwu_delta_ctx_t *ctx,
+                                   size_t *room)
+{
+    psa_status_t status;
+
+    if (ctx->out_fill == sizeof(ctx->out_buf)) {
+        status = delta_flush(ctx);
+        if (status != PSA_SUCCESS) {
+            return status;
+        }
+    }
+
+    *room = sizeof(ctx->out_buf) - ctx->out_fill;
+
+    return PSA_SUCCESS;
+}
+
+static psa_status_t delta_copy(struct tfm_fwu_delta_ctx_t *ctx)
+{
+    size_t len = ctx->arg[1];
+    size_t room, num, src, i;
+    uint8_t *dst;
+    psa_status_t status;
+
+    if (ctx->opcode == DELTA_OP_COPY_BASE) {
+        if (ctx->arg[1] > UINT32_MAX - ctx->arg[0]) {
+            return PSA_ERROR_INVALID_ARGUMENT;
+        }
+        ctx->base_copied = true;
+    }
+
+    if ((ctx->opcode == DELTA_OP_COPY_OUTPUT) &&
+        ((ctx->arg[0] == 0) ||
+         (ctx->arg[0] > ctx->out_flushed + ctx->out_fill))) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    while (len > 0) {
+        status = delta_get_room(ctx, &room);
+        if (status != PSA_SUCCESS) {
+            return status;
+        }
+        num = delta_min(len, room);
+        dst = &ctx->out_buf[ctx->out_fill];
+
+        if (ctx->opcode == DELTA_OP_COPY_BASE) {
+            status = fwu_bootloader_read_image(ctx->component, false,
+                                               ctx->arg[0], dst, num);
+            ctx->arg[0] += num;
+        } else {
+            src = ctx->out_flushed + ctx->out_fill - ctx->arg[0];
+            if (src >= ctx->out_flushed) {
+                /* Copied forward one byte at a time, so that an overlapping
+                 * source repeats the bytes being output.
+                 */
+                for (i = 0; i < num; i++) {
+                    dst[i] = ctx->out_buf[src - ctx->out_flushed + i];
+                }
+            } else {
+                /* The source has already been written to the staging area */
+                num = delta_min(num, ctx->out_flushed - src);
+                status = fwu_bootloader_read_image(ctx->component, true,
+                                                   src, dst, num);
+            }
+        }
+        if (status != PSA_SUCCESS) {
+            return status;
+        }
+
+        ctx->out_fill += num;
+        len -= num;
+    }
+
+    return PSA_SUCCESS;
+}
+
+bool tfm_fwu_delta_is_encoded(const uint8_t *block, size_t block_size)
+{
+    return (block_size >= TFM_FWU_DELTA_MAGIC_SIZE) &&
+           (memcmp(block, delta_magic, TFM_FWU_DELTA_MAGIC_SIZE) == 0);
+}
+
+void tfm_fwu_delta_init(struct tfm_fwu_delta_ctx_t *ctx,
+                        psa_fwu_component_t component)
+{
+    ctx->component = component;
+    ctx->state = DELTA_STATE_MAGIC;
+    ctx->arg_idx = 0;
+    ctx->base_copied = false;
+    ctx->stream_size = 0;
+    ctx->out_flushed = 0;
+    ctx->out_fill = 0;
+}
+
+static psa_status_t delta_decode(struct tfm_fwu_delta_ctx_t *ctx,
+                                 const uint8_t *block,
+                                 size_t block_size)
+{
+    size_t room, num;
+    uint8_t byte;
+    psa_status_t status;
+
+    while (block_size > 0) {
+        switch (ctx->state) {
+        case DELTA_STATE_MAGIC:
+            if (*block != delta_magic[ctx->arg_idx]) {
+                return PSA_ERROR_INVALID_ARGUMENT;
+            }
+            block++;
+            block_size--;
+            if (++ctx->arg_idx == TFM_FWU_DELTA_MAGIC_SIZE) {
+                ctx->state = DELTA_STATE_OPCODE;
+            }
+            break;
+
+        case DELTA_STATE_OPCODE:
+            ctx->opcode = *block++;
+            block_size--;
+            if (ctx->opcode > DELTA_OP_COPY_OUTPUT) {
+                return PSA_ERROR_INVALID_ARGUMENT;
+            }
+            ctx->arg[0] = 0;
+            ctx->arg[1] = 0;
+            ctx->arg_idx = 0;
+            ctx->shift = 0;
+            ctx->state = DELTA_STATE_ARG;
+            break;
+
+        case DELTA_STATE_ARG:
+            byte = *block++;
+            block_size--;
+
+            /* The fifth byte only holds the 4 top bits of a 32-bit number */
+            if ((ctx->shift == 28) && ((byte & 0xF0) != 0)) {
+                return PSA_ERROR_INVALID_ARGUMENT;
+            }
+            ctx->arg[ctx->arg_idx] |= (uint32_t)(byte & 0x7F) << ctx->shift;
+            if (byte & 0x80) {
+                ctx->shift += 7;
+                break;
+            }
+            ctx->shift = 0;
+
+            if (ctx->opcode == DELTA_OP_LITERAL) {
+                ctx->state = (ctx->arg[0] > 0) ? DELTA_STATE_LITERAL :
+                                                 DELTA_STATE_OPCODE;
+            } else if (++ctx->arg_idx == 2) {
+                status = delta_copy(ctx);
+                if (status != PSA_SUCCESS) {
+                    return status;
+                }
+                ctx->state = DELTA_STATE_OPCODE;
+            }
+            break;
+
+        case DELTA_STATE_LITERAL:
+            status = delta_get_room(ctx, &room);
+            if (status != PSA_SUCCESS) {
+                return status;
+            }
+            num = delta_min(delta_min(block_size, ctx->arg[0]), room);
+
+            (void)memcpy(&ctx->out_buf[ctx->out_fill], block, num);
+            ctx->out_fill += num;
+            block += num;
+            block_size -= num;
+
+            ctx->arg[0] -= num;
+            if (ctx->arg[0] == 0) {
+                ctx->state = DELTA_STATE_OPCODE;
+            }
+            break;
+
+        default:
+            return PSA_ERROR_BAD_STATE;
+        }
+    }
+
+    return PSA_SUCCESS;
+}
+
+psa_status_t tfm_fwu_delta_write(struct tfm_fwu_delta_ctx_t *ctx,
+                                 size_t stream_offset,
+                                 const uint8_t *block,
+                                 size_t block_size)
+{
+    psa_status_t status;
+
+    if (ctx->state == DELTA_STATE_ERROR) {
+        return PSA_ERROR_BAD_STATE;
+    }
+
+    /* The stream is decoded as it is received */
+    if (stream_offset != ctx->stream_size) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    status = delta_decode(ctx, block, block_size);
+    if (status != PSA_SUCCESS) {
+        ctx->state = DELTA_STATE_ERROR;
+        return status;
+    }
+
+    ctx->stream_size += block_size;
+
+    return PSA_SUCCESS;
+}
+
+psa_status_t tfm_fwu_delta_finish(struct tfm_fwu_delta_ctx_t *ctx)
+{
+    psa_status_t status;
+
+    if (ctx->state == DELTA_STATE_ERROR) {
+        return PSA_ERROR_BAD_STATE;
+    }
+
+    /* The stream must end between two commands */
+    if (ctx->state != DELTA_STATE_OPCODE) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    status = delta_flush(ctx);
+    if (status != PSA_SUCCESS) {
+        ctx->state = DELTA_STATE_ERROR;
+    }
+
+    return status;
+}
+#endif /* TFM_FWU_DELTA_BUF_SIZE > 0 */
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __TFM_FWU_DELTA_H__
+#define __TFM_FWU_DELTA_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "compiler_ext_defs.h"
+#include "config_fwu.h"
+#include "psa/update.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if TFM_FWU_DELTA_BUF_SIZE > 0
+/**
+ * \brief Size of the magic number which starts an encoded image stream
+ */
+#define TFM_FWU_DELTA_MAGIC_SIZE 4
+
+/**
+ * \brief The context of the decoder of an encoded image stream.
+ *
+ * An encoded image stream starts with the magic number "TFMD" and is followed
+ * by commands. Each command is an opcode byte followed by its arguments, which
+ * are unsigned LEB128 numbers of up to 32 bits:
+ *
+ * - 0x00 LITERAL len: the next len bytes of the stream are output.
+ * - 0x01 COPY_BASE offset len: len bytes of the active image are output,
+ *   starting at offset.
+ * - 0x02 COPY_OUTPUT distance len: len bytes are output, starting distance
+ *   bytes before the current end of the output. The source may overlap the
+ *   bytes being output, in which case they are repeated.
+ *
+ * LITERAL and COPY_OUTPUT make up an LZ77 compression, COPY_BASE a binary
+ * diff against the active image.
+ */
+struct tfm_fwu_delta_ctx_t {
+    psa_fwu_component_t component;
+    uint8_t state;
+    uint8_t opcode;
+    uint8_t arg_idx;        /* Next argument, or next magic number byte */
+    uint8_t shift;          /* Bit position of the next argument bits */
+    bool base_copied;       /* The output holds parts of the active image */
+    uint32_t arg[2];
+    size_t stream_size;     /* Size of the encoded stream received so far */
+    size_t out_flushed;     /* Size of the output written to the component */
+    size_t out_fill;        /* Size of the output held in out_buf */
+    uint8_t out_buf[TFM_FWU_DELTA_BUF_SIZE] __aligned(4);
+};
+
+/**
+ * \brief Checks whether the first block of an image stream starts an encoded
+ *        image stream.
+ *
+ * \param[in] block       The block written at offset 0 of the image
+ * \param[in] block_size  Size of block
+ *
+ * \return true if the image stream is encoded
+ */
+bool tfm_fwu_delta_is_encoded(const uint8_t *block, size_t block_size);
+
+/**
+ * \brief Initializes the decoder of the encoded image stream of a component.
+ *
+ * \param[out] ctx        The decoder context
+ * \param[in]  component  The component the image is decoded into
+ */
+void tfm_fwu_delta_init(struct tfm_fwu_delta_ctx_t *ctx,
+                        psa_fwu_component_t component);
+
+/**
+ * \brief Decodes a block of the encoded image stream into the staging area of
+ *        the component. The decoded image is written in order, through a
+ *        buffer of TFM_FWU_DELTA_BUF_SIZE bytes.
+ *
+ * \param[in,out] ctx            The decoder context
+ * \param[in]     stream_offset  Offset of the block in the encoded stream,
+ *                               which must follow the previous block
+ * \param[in]     block          The block of the encoded stream
+ * \param[in]     block_size     Size of block
+ *
+ * \return PSA_SUCCESS                  On success
+ *         PSA_ERROR_INVALID_ARGUMENT   The block doesn't follow the previous
+ *                                      one, or the encoded stream is malformed
+ *         PSA_ERROR_BAD_STATE          A previous block failed to be decoded
+ *         Errors of the bootloader when reading or loading the image
+ */
+psa_status_t tfm_fwu_delta_write(struct tfm_fwu_delta_ctx_t *ctx,
+                                 size_t stream_offset,
+                                 const uint8_t *block,
+                                 size_t block_size);
+
+/**
+ * \brief Writes the end of the decoded image once the whole encoded image
+ *        stream has been received.
+ *
+ * \param[in,out] ctx  The decoder context
+ *
+ * \return PSA_SUCCESS                  On success
+ *         PSA_ERROR_INVALID_ARGUMENT   The encoded stream is truncated
+ *         PSA_ERROR_BAD_STATE          A previous block failed to be decoded
+ *         Errors of the bootloader when loading the image
+ */
+psa_status_t tfm_fwu_delta_finish(struct tfm_fwu_delta_ctx_t *ctx);
+#endif /* TFM_FWU_DELTA_BUF_SIZE > 0 */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TFM_FWU_DELTA_H__ */
@@ -11,12 +11,16 @@
 #include "config_fwu.h"
 #include "tfm_platform_api.h"
 #include "tfm_bootloader_fwu_abstraction.h"
+#include "tfm_fwu_delta.h"
 #include "psa/update.h"
 #include "service_api.h"
 #include "tfm_api.h"
 #include "psa/service.h"
 #include "psa_manifest/tfm_firmware_update.h"
 #include "compiler_ext_defs.h"
+#if TFM_FWU_WRITE_PIPELINE
+#include "flash_layout.h"
+#endif
 
 #define COMPONENTS_ITER(x)  \
     for ((x) = 0; (x) < (FWU_COMPONENT_NUMBER); (x)++)
@@ -25,6 +29,9 @@ typedef struct tfm_fwu_ctx_s {
     psa_status_t error;
     uint8_t component_state;
     bool in_use;
+#if TFM_FWU_DELTA_BUF_SIZE > 0
+    bool encoded;
+#endif
 } tfm_fwu_ctx_t;
 
 /**
@@ -32,9 +39,61 @@ typedef struct tfm_fwu_ctx_s {
  */
 static tfm_fwu_ctx_t fwu_ctx[FWU_COMPONENT_NUMBER];
 
+#if TFM_FWU_DELTA_BUF_SIZE > 0
+/**
+ * \brief The decoders of the components written with an encoded image stream.
+ */
+static struct tfm_fwu_delta_ctx_t delta_ctx[FWU_COMPONENT_NUMBER];
+
+/**
+ * \brief Passes the block to the decoder of the component if its image stream
+ *        is encoded, which is told by the block written at offset 0.
+ *
+ * \return true if the block was decoded, with the result in \p status
+ */
+static bool tfm_fwu_delta_load(psa_fwu_component_t component,
+                               size_t image_offset,
+                               const uint8_t *block,
+                               size_t block_size,
+                               psa_status_t *status)
+{
+    if ((image_offset == 0) && !fwu_ctx[component].encoded &&
+        tfm_fwu_delta_is_encoded(block, block_size)) {
+        fwu_ctx[component].encoded = true;
+        tfm_fwu_delta_init(&delta_ctx[component], component);
+    }
+
+    if (!fwu_ctx[component].encoded) {
+        return false;
+    }
+
+    *status = tfm_fwu_delta_write(&delta_ctx[component], image_offset,
+                                  block, block_size);
+    return true;
+}
+#endif /* TFM_FWU_DELTA_BUF_SIZE > 0 */
+
 #if PSA_FRAMEWORK_HAS_MM_IOVEC != 1
 static uint8_t block[TFM_FWU_BUF_SIZE] __aligned(4);
+
+#if TFM_FWU_WRITE_PIPELINE
+/* The transfer buffer is used as two halves, one being read from the client
+ * while the other one is programmed. Each half is a whole number of flash
+ * program units, and of words, so that it can be programmed in background.
+ */
+#if TFM_HAL_FLASH_PROGRAM_UNIT > 4
+#define FWU_PIPELINE_ALIGN      TFM_HAL_FLASH_PROGRAM_UNIT
+#else
+#define FWU_PIPELINE_ALIGN      4
 #endif
+#define FWU_PIPELINE_CHUNK_SIZE ((TFM_FWU_BUF_SIZE / 2) - \
+                                 ((TFM_FWU_BUF_SIZE / 2) % FWU_PIPELINE_ALIGN))
+
+#if FWU_PIPELINE_CHUNK_SIZE == 0
+#error "Invalid config: TFM_FWU_BUF_SIZE is too small for TFM_FWU_WRITE_PIPELINE!"
+#endif
+#endif /* TFM_FWU_WRITE_PIPELINE */
+#endif /* PSA_FRAMEWORK_HAS_MM_IOVEC != 1 */
 
 static psa_status_t tfm_fwu_start(const psa_msg_t *msg)
 {
@@ -94,6 +153,9 @@ static psa_status_t tfm_fwu_start(const psa_msg_t *msg)
         }
         fwu_ctx[component].in_use = true;
         fwu_ctx[component].component_state = PSA_FWU_WRITING;
+#if TFM_FWU_DELTA_BUF_SIZE > 0
+        fwu_ctx[component].encoded = false;
+#endif
     }
     return PSA_SUCCESS;
 }
@@ -108,6 +170,11 @@ static psa_status_t tfm_fwu_write(const psa_msg_t *msg)
     uint8_t *block;
 #else
     size_t write_size, num;
+#if TFM_FWU_WRITE_PIPELINE
+    uint8_t *chunk = block;
+    bool pending = false;
+    psa_status_t wait_status;
+#endif
 #endif
 
     /* Check input parameters. */
@@ -136,10 +203,64 @@ static psa_status_t tfm_fwu_write(const psa_msg_t *msg)
 #if PSA_FRAMEWORK_HAS_MM_IOVEC == 1
     if (block_size > 0) {
         block = (uint8_t *)psa_map_invec(msg->handle, 2);
-        status = fwu_bootloader_load_image(component,
-                                           image_offset,
-                                           block,
-                                           block_size);
+#if TFM_FWU_DELTA_BUF_SIZE > 0
+        if (!tfm_fwu_delta_load(component, image_offset,
+                                block, block_size, &status))
+#endif
+        {
+            status = fwu_bootloader_load_image(component,
+                                               image_offset,
+                                               block,
+                                               block_size);
+        }
+    }
+#elif TFM_FWU_WRITE_PIPELINE
+    while (block_size > 0) {
+        write_size = FWU_PIPELINE_CHUNK_SIZE <= block_size ?
+                     FWU_PIPELINE_CHUNK_SIZE : block_size;
+
+        /* Read the chunk while the previous one is being programmed */
+        num = psa_read(msg->handle, 2, chunk, write_size);
+        if (num != write_size) {
+            status = PSA_ERROR_PROGRAMMER_ERROR;
+            break;
+        }
+
+        if (pending) {
+            pending = false;
+            status = fwu_bootloader_load_image_wait(component);
+            if (status != PSA_SUCCESS) {
+                break;
+            }
+        }
+
+#if TFM_FWU_DELTA_BUF_SIZE > 0
+        /* An encoded image is decoded and written synchronously */
+        if (!tfm_fwu_delta_load(component, image_offset,
+                                chunk, write_size, &status))
+#endif
+        {
+            status = fwu_bootloader_load_image_start(component,
+                                                     image_offset,
+                                                     chunk,
+                                                     write_size);
+            pending = (status == PSA_SUCCESS);
+        }
+        if (status != PSA_SUCCESS) {
+            break;
+        }
+
+        chunk = (chunk == block) ? block + FWU_PIPELINE_CHUNK_SIZE : block;
+        block_size -= write_size;
+        image_offset += write_size;
+    }
+
+    /* The last chunk is programmed before the write completes */
+    if (pending) {
+        wait_status = fwu_bootloader_load_image_wait(component);
+        if (status == PSA_SUCCESS) {
+            status = wait_status;
+        }
     }
 #else
     while (block_size > 0) {
@@ -150,10 +271,16 @@ static psa_status_t tfm_fwu_write(const psa_msg_t *msg)
             return PSA_ERROR_PROGRAMMER_ERROR;
         }
 
-        status = fwu_bootloader_load_image(component,
-                                           image_offset,
-                                           block,
-                                           write_size);
+#if TFM_FWU_DELTA_BUF_SIZE > 0
+        if (!tfm_fwu_delta_load(component, image_offset,
+                                block, write_size, &status))
+#endif
+        {
+            status = fwu_bootloader_load_image(component,
+                                               image_offset,
+                                               block,
+                                               write_size);
+        }
         if (status != PSA_SUCCESS) {
             return status;
         }
@@ -167,6 +294,9 @@ static psa_status_t tfm_fwu_write(const psa_msg_t *msg)
 static psa_status_t tfm_fwu_finish(const psa_msg_t *msg)
 {
     psa_fwu_component_t component;
+#if TFM_FWU_DELTA_BUF_SIZE > 0
+    psa_status_t status;
+#endif
 
     /* Check input parameters. */
     if (msg->in_size[0] != sizeof(component)) {
@@ -183,6 +313,16 @@ static psa_status_t tfm_fwu_finish(const psa_msg_t *msg)
         return PSA_ERROR_BAD_STATE;
     }
 
+#if TFM_FWU_DELTA_BUF_SIZE > 0
+    /* Write the end of a decoded image. */
+    if (fwu_ctx[component].encoded) {
+        status = tfm_fwu_delta_finish(&delta_ctx[component]);
+        if (status != PSA_SUCCESS) {
+            return status;
+        }
+    }
+#endif
+
     /* Validity, authenticity and integrity of the image is deferred to system
      * reboot.
      */
@@ -291,6 +431,20 @@ static psa_status_t tfm_fwu_query(const psa_msg_t *msg)
      */
     result = fwu_bootloader_get_image_info(component, query_state,
                                            query_impl_info, &info);
+
+#if TFM_FWU_DELTA_BUF_SIZE > 0
+    /* The digest of an image which copies parts of the active image would
+     * let the client learn them, by choosing the parts which are copied.
+     * It is only reported to Secure clients.
+     */
+    if (query_impl_info && fwu_ctx[component].encoded &&
+        delta_ctx[component].base_copied &&
+        TFM_CLIENT_ID_IS_NS(msg->client_id)) {
+        memset(info.impl.candidate_digest, 0,
+               sizeof(info.impl.candidate_digest));
+    }
+#endif
+
     if (result == PSA_SUCCESS) {
         psa_write(msg->handle, 0, &info, sizeof(info));
     }
@@ -438,6 +592,7 @@ psa_status_t tfm_fwu_reject(const psa_msg_t *msg)
 static psa_status_t tfm_fwu_cancel(const psa_msg_t *msg)
 {
     psa_fwu_component_t component;
+    psa_status_t status;
 
     if (msg->in_size[0] != sizeof(component)) {
         return PSA_ERROR_PROGRAMMER_ERROR;
@@ -452,6 +607,10 @@ static psa_status_t tfm_fwu_cancel(const psa_msg_t *msg)
         /* The component is in FWU process. */
         if ((fwu_ctx[component].component_state == PSA_FWU_WRITING) ||
            (fwu_ctx[component].component_state == PSA_FWU_CANDIDATE)) {
+            status = fwu_bootloader_cancel_image(component);
+            if (status != PSA_SUCCESS) {
+                return status;
+            }
             fwu_ctx[component].component_state = PSA_FWU_FAILED;
             fwu_ctx[component].error = PSA_SUCCESS;
             return PSA_SUCCESS;
@@ -504,6 +663,45 @@ static psa_status_t tfm_fwu_clean(const psa_msg_t *msg)
     }
 }
 
+#if TFM_FWU_ERASE_AHEAD
+static psa_status_t tfm_fwu_prepare_staging(const psa_msg_t *msg)
+{
+    psa_fwu_component_t component;
+    psa_fwu_component_info_t info;
+    size_t size;
+    psa_status_t status;
+
+    if ((msg->in_size[0] != sizeof(component)) ||
+        (msg->in_size[1] != sizeof(size))) {
+        return PSA_ERROR_PROGRAMMER_ERROR;
+    }
+
+    psa_read(msg->handle, 0, &component, sizeof(component));
+    psa_read(msg->handle, 1, &size, sizeof(size));
+    if (component >= FWU_COMPONENT_NUMBER) {
+        return PSA_ERROR_DOES_NOT_EXIST;
+    }
+
+    if (fwu_ctx[component].in_use) {
+        /* The image being written is followed by the erased part. */
+        if (fwu_ctx[component].component_state != PSA_FWU_WRITING) {
+            return PSA_ERROR_BAD_STATE;
+        }
+    } else {
+        /* The staging area may hold the previous image of a TRIAL component. */
+        status = fwu_bootloader_get_image_info(component, true, false, &info);
+        if (status != PSA_SUCCESS) {
+            return status;
+        }
+        if (info.state != PSA_FWU_READY) {
+            return PSA_ERROR_BAD_STATE;
+        }
+    }
+
+    return fwu_bootloader_prepare_staging_area(component, size);
+}
+#endif /* TFM_FWU_ERASE_AHEAD */
+
 psa_status_t tfm_firmware_update_service_sfn(const psa_msg_t *msg)
 {
     switch (msg->type) {
@@ -527,6 +725,10 @@ psa_status_t tfm_firmware_update_service_sfn(const psa_msg_t *msg)
         return tfm_fwu_accept();
     case TFM_FWU_REJECT:
         return tfm_fwu_reject(msg);
+#if TFM_FWU_ERASE_AHEAD
+    case TFM_FWU_PREPARE_STAGING:
+        return tfm_fwu_prepare_staging(msg);
+#endif
     default:
         return PSA_ERROR_NOT_SUPPORTED;
     }
@@ -109,6 +109,61 @@ initial_attest_get_token(const void *challenge_buf, size_t challenge_size,
 psa_status_t
 initial_attest_get_token_size(size_t challenge_size, size_t *token_size);
 
+/**
+ * \brief Stream the initial attestation token out, in order, without a buffer
+ *        holding the whole token
+ *
+ * \param[in]  challenge_buf   Pointer to the challenge
+ * \param[in]  challenge_size  Size of the challenge
+ * \param[in]  token_buf_size  Number of bytes the destination accepts. Nothing
+ *                             is written if the token is larger.
+ * \param[in]  write           Function called with the next bytes of the token
+ * \param[in]  write_ctx       Context passed to \p write
+ * \param[out] token_size      Size of the streamed token
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+psa_status_t
+initial_attest_stream_token(const void *challenge_buf, size_t challenge_size,
+                            size_t token_buf_size,
+                            void (*write)(void *write_ctx,
+                                          const uint8_t *buf,
+                                          size_t len),
+                            void *write_ctx,
+                            size_t *token_size);
+
+/**
+ * \brief Create a batch of initial attestation tokens, one per challenge, in
+ *        a single request
+ *
+ * \param[in]  challenges_buf  Pointer to the challenges, one after the other
+ * \param[in]  challenge_size  Size of each challenge
+ * \param[in]  num_tokens      Number of challenges, and of tokens to create
+ * \param[in]  token_buf       Buffer where each token is created in turn.
+ *                             Not used when ATTEST_TOKEN_STREAM_BUF_SIZE is
+ *                             not 0, the tokens are then streamed through
+ *                             the streaming window.
+ * \param[in]  token_buf_size  Size of \p token_buf
+ * \param[in]  tokens_size     Number of bytes the destination accepts. Nothing
+ *                             is written if the tokens are larger.
+ * \param[in]  write           Function called with each token, in order
+ * \param[in]  write_ctx       Context passed to \p write
+ * \param[out] token_size      Size of each token, they all have the same size
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+psa_status_t
+initial_attest_get_token_batch(const void *challenges_buf,
+                               size_t challenge_size,
+                               size_t num_tokens,
+                               void *token_buf, size_t token_buf_size,
+                               size_t tokens_size,
+                               void (*write)(void *write_ctx,
+                                             const uint8_t *buf,
+                                             size_t len),
+                               void *write_ctx,
+                               size_t *token_size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -47,66 +47,95 @@ __attribute__ ((aligned(4)))
 static struct attest_boot_data boot_data;
 
 /*!
- * \brief Static function to look up all entries in the shared data area
- *       (boot status) which belong to a specific module.
+ * \struct attest_boot_data_index
  *
- * \param[in]     module  The identifier of SW module to look up based on this
- * \param[out]    claim   The type of SW module's attribute
- * \param[out]    tlv_len Length of the shared data entry
- * \param[in/out] tlv_ptr Pointer to the shared data entry. If its value NULL as
- *                        input then it will starts the look up from the
- *                        beginning of the shared data section. If not NULL then
- *                        it continue look up from the next entry. It returns
- *                        the address of next found entry which belongs to
- *                        module.
+ * \brief Offsets of the boot status entries used by the claims, relative to
+ *        \ref boot_data. An offset of 0 means that there is no such entry.
  *
- * \retval    -1          Error, boot status is malformed
- * \retval     0          Entry not found
- * \retval     1          Entry found
+ * \details Built once by \ref attest_boot_data_init when the boot status is
+ *          received, so that claims are looked up without walking the TLV
+ *          section.
  */
-static int32_t attest_get_tlv_by_module(uint8_t    module,
-                                        uint8_t   *claim,
-                                        uint16_t  *tlv_len,
-                                        uint8_t  **tlv_ptr)
+struct attest_boot_data_index {
+    bool valid;                       /* The boot status is well formed */
+    uint16_t module[SW_MAX];          /* First entry of each SW module */
+    uint16_t general[CLAIM_MASK + 1]; /* First entry of each SW_GENERAL claim */
+};
+
+static struct attest_boot_data_index boot_data_index;
+
+/*!
+ * \brief Static function to validate the boot status and to index its
+ *        entries by module and by SW_GENERAL claim.
+ */
+static void attest_boot_data_index_init(void)
 {
     struct shared_data_tlv_entry tlv_entry;
-    uint8_t *tlv_end;
-    uint8_t *tlv_curr;
+    size_t tlv_end;
+    size_t offset;
+    size_t entry_size;
+    uint8_t module;
+    uint8_t claim;
 
-    if (boot_data.header.tlv_magic != SHARED_DATA_TLV_INFO_MAGIC) {
-        return -1;
-    }
+    (void)memset(&boot_data_index, 0, sizeof(boot_data_index));
 
-    /* Get the boundaries of TLV section where to lookup*/
-    tlv_end = (uint8_t *)&boot_data + boot_data.header.tlv_tot_len;
-    if (*tlv_ptr == NULL) {
-        /* At first call set to the beginning of the TLV section */
-        tlv_curr = boot_data.data;
-    } else {
-        /* Any subsequent call set to the next TLV entry */
-        (void)memcpy(&tlv_entry, *tlv_ptr, SHARED_DATA_ENTRY_HEADER_SIZE);
-
-        tlv_curr  = (*tlv_ptr) + SHARED_DATA_ENTRY_HEADER_SIZE
-                    + tlv_entry.tlv_len;
+    if ((boot_data.header.tlv_magic != SHARED_DATA_TLV_INFO_MAGIC) ||
+        (boot_data.header.tlv_tot_len > sizeof(boot_data))) {
+        return;
     }
 
-    /* Iterates over the TLV section and returns the address and size of TLVs
-     * with requested module identifier
-     */
-    while (tlv_curr < tlv_end) {
+    tlv_end = boot_data.header.tlv_tot_len;
+    for (offset = SHARED_DATA_HEADER_SIZE; offset < tlv_end;
+         offset += entry_size) {
+        /* An entry running past the end of the TLV section is malformed */
+        if ((tlv_end - offset) < SHARED_DATA_ENTRY_HEADER_SIZE) {
+            return;
+        }
+
         /* Create local copy to avoid unaligned access */
-        (void)memcpy(&tlv_entry, tlv_curr, SHARED_DATA_ENTRY_HEADER_SIZE);
-        if (GET_IAS_MODULE(tlv_entry.tlv_type) == module) {
-            *claim   = GET_IAS_CLAIM(tlv_entry.tlv_type);
-            *tlv_ptr = tlv_curr;
-            *tlv_len = tlv_entry.tlv_len;
-            return 1;
+        (void)memcpy(&tlv_entry, (uint8_t *)&boot_data + offset,
+                     SHARED_DATA_ENTRY_HEADER_SIZE);
+
+        entry_size = SHARED_DATA_ENTRY_SIZE(tlv_entry.tlv_len);
+        if (entry_size > (tlv_end - offset)) {
+            return;
         }
 
-        tlv_curr += (SHARED_DATA_ENTRY_HEADER_SIZE + tlv_entry.tlv_len);
+        module = GET_IAS_MODULE(tlv_entry.tlv_type);
+        claim  = GET_IAS_CLAIM(tlv_entry.tlv_type);
+
+        if ((module < SW_MAX) && (boot_data_index.module[module] == 0)) {
+            boot_data_index.module[module] = (uint16_t)offset;
+        }
+        if ((module == SW_GENERAL) && (boot_data_index.general[claim] == 0)) {
+            boot_data_index.general[claim] = (uint16_t)offset;
+        }
     }
 
-    return 0;
+    boot_data_index.valid = true;
+}
+
+/*!
+ * \brief Static function to get an indexed entry of the boot status.
+ *
+ * \param[in]  offset   Offset of the entry in \ref boot_data
+ * \param[out] claim    The type of SW module's attribute
+ * \param[out] tlv_len  Length of the shared data entry
+ * \param[out] tlv_ptr  Pointer to the shared data entry
+ */
+static void attest_get_indexed_tlv(uint16_t   offset,
+                                   uint8_t   *claim,
+                                   uint16_t  *tlv_len,
+                                   uint8_t  **tlv_ptr)
+{
+    struct shared_data_tlv_entry tlv_entry;
+
+    *tlv_ptr = (uint8_t *)&boot_data + offset;
+
+    /* Create local copy to avoid unaligned access */
+    (void)memcpy(&tlv_entry, *tlv_ptr, SHARED_DATA_ENTRY_HEADER_SIZE);
+    *claim   = GET_IAS_CLAIM(tlv_entry.tlv_type);
+    *tlv_len = tlv_entry.tlv_len;
 }
 
 int32_t attest_get_tlv_by_id(uint8_t    claim,
@@ -114,29 +143,21 @@ int32_t attest_get_tlv_by_id(uint8_t    claim,
                              uint8_t  **tlv_ptr)
 {
     uint8_t tlv_id;
-    uint8_t module = SW_GENERAL;
-    int32_t found;
 
-    /* Ensure that look up starting from the beginning of the boot status */
     *tlv_ptr = NULL;
 
-    /* Look up specific TLV entry which belongs to SW_GENERAL module */
-    do {
-        /* Look up next entry */
-        found = attest_get_tlv_by_module(module, &tlv_id,
-                                         tlv_len, tlv_ptr);
-        if (found != 1) {
-            break;
-        }
-        /* At least one entry was found which belongs to SW_GENERAL,
-         * check whether this one is looked for
-         */
-        if (claim == tlv_id) {
-            break;
-        }
-    } while (found == 1);
+    if (!boot_data_index.valid) {
+        return -1;
+    }
+
+    if ((claim > CLAIM_MASK) || (boot_data_index.general[claim] == 0)) {
+        return 0;
+    }
+
+    attest_get_indexed_tlv(boot_data_index.general[claim],
+                           &tlv_id, tlv_len, tlv_ptr);
 
-    return found;
+    return 1;
 }
 
 #ifdef TFM_PARTITION_MEASURED_BOOT
@@ -319,7 +340,6 @@ attest_encode_sw_components_array(QCBOREncodeContext *encode_ctx,
     uint8_t *tlv_ptr;
     uint8_t  tlv_id;
     uint8_t module = 0;
-    int32_t found;
 
     if ((encode_ctx == NULL) || (cnt == NULL)) {
         return PSA_ATTEST_ERR_INVALID_INPUT;
@@ -327,22 +347,23 @@ attest_encode_sw_components_array(QCBOREncodeContext *encode_ctx,
 
     *cnt = 0;
 
+    if (!boot_data_index.valid) {
+        /* Boot status area is malformed. */
+        return PSA_ATTEST_ERR_CLAIM_UNAVAILABLE;
+    }
+
     /* Extract all boot records (measurements) from the boot status information
      * that was received from the secure bootloader.
      */
     for (module = 0; module < SW_MAX; ++module) {
-        /* Indicates to restart the look up from the beginning of the shared
-         * data section.
-         */
-        tlv_ptr = NULL;
-
-        /* Look up the first TLV entry which belongs to the SW module */
-        found = attest_get_tlv_by_module(module, &tlv_id,
-                                         &tlv_len, &tlv_ptr);
-        if (found == -1) {
-            /* Boot status area is malformed. */
-            return PSA_ATTEST_ERR_CLAIM_UNAVAILABLE;
-        } else if ((found == 1) && (tlv_id == SW_BOOT_RECORD)) {
+        if (boot_data_index.module[module] == 0) {
+            continue;
+        }
+
+        /* Get the first TLV entry which belongs to the SW module */
+        attest_get_indexed_tlv(boot_data_index.module[module], &tlv_id,
+                               &tlv_len, &tlv_ptr);
+        if (tlv_id == SW_BOOT_RECORD) {
             (*cnt)++;
             if (*cnt == 1) {
                 /* Open array which stores SW components claims. */
@@ -370,7 +391,16 @@ attest_encode_sw_components_array(QCBOREncodeContext *encode_ctx,
 
 enum psa_attest_err_t attest_boot_data_init(void)
 {
-    return attest_get_boot_data(TLV_MAJOR_IAS,
-                                (struct tfm_boot_data *)&boot_data,
-                                MAX_BOOT_STATUS);
+    enum psa_attest_err_t attest_err;
+
+    attest_err = attest_get_boot_data(TLV_MAJOR_IAS,
+                                      (struct tfm_boot_data *)&boot_data,
+                                      MAX_BOOT_STATUS);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    attest_boot_data_index_init();
+
+    return PSA_ATTEST_ERR_SUCCESS;
 }
@@ -57,7 +57,8 @@ attest_encode_sw_components_array(QCBOREncodeContext *encode_ctx,
 
 /*!
  * \brief Gets the IAS TLV entries (boot data coming from boot loader) from
- *        shared memory area to service memory area
+ *        shared memory area to service memory area, and indexes them for the
+ *        claim look ups
  *
  * \return Returns error code as specified in \ref psa_attest_err_t
  */
@@ -5,6 +5,7 @@
  *
  */
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
 #include <stddef.h>
@@ -59,15 +60,6 @@ error_mapping_to_psa_status_t(enum psa_attest_err_t attest_err)
     }
 }
 
-psa_status_t attest_init(void)
-{
-    enum psa_attest_err_t res;
-
-    res = attest_boot_data_init();
-
-    return error_mapping_to_psa_status_t(res);
-}
-
 /*!
  * \brief Static function to map return values between \ref attest_token_err_t
  *        and \ref psa_attest_err_t
@@ -679,38 +671,271 @@ static enum psa_attest_err_t attest_get_t_cose_algorithm(
     return PSA_ATTEST_ERR_SUCCESS;
 }
 
+/*!
+ * \struct attest_claim_t
+ *
+ * \brief A claim of the token and the function adding it. The claims which
+ *        are constant for the boot session are encoded only once when the
+ *        claim cache is enabled.
+ */
+struct attest_claim_t {
+    enum psa_attest_err_t (*add_claim)(struct attest_token_encode_ctx *);
+    bool is_static;
+};
+
 #if ATTEST_TOKEN_PROFILE_PSA_IOT_1 || ATTEST_TOKEN_PROFILE_PSA_2_0_0
-    static enum psa_attest_err_t
-    (*claim_query_funcs[])(struct attest_token_encode_ctx *) = {
-        &attest_add_boot_seed_claim,
-        &attest_add_instance_id_claim,
-        &attest_add_implementation_id_claim,
-        &attest_add_caller_id_claim,
-        &attest_add_security_lifecycle_claim,
-        &attest_add_all_sw_components,
-        &attest_add_profile_definition,
+static const struct attest_claim_t token_claims[] = {
+    {&attest_add_boot_seed_claim,          true},
+    {&attest_add_instance_id_claim,        true},
+    {&attest_add_implementation_id_claim,  true},
+    {&attest_add_caller_id_claim,          false},
+    {&attest_add_security_lifecycle_claim, false},
+    {&attest_add_all_sw_components,        true},
+    {&attest_add_profile_definition,       true},
 #if ATTEST_INCLUDE_OPTIONAL_CLAIMS
-        &attest_add_verification_service,
-        &attest_add_cert_ref_claim
+    {&attest_add_verification_service,     true},
+    {&attest_add_cert_ref_claim,           true},
 #endif
-    };
+};
 #elif ATTEST_TOKEN_PROFILE_ARM_CCA
-
-    static enum psa_attest_err_t
-    (*claim_query_funcs[])(struct attest_token_encode_ctx *) = {
-        &attest_add_instance_id_claim,
-        &attest_add_implementation_id_claim,
-        &attest_add_security_lifecycle_claim,
-        &attest_add_all_sw_components,
-        &attest_add_profile_definition,
-        &attest_add_hash_algo_claim,
-        &attest_add_platform_config_claim,
+static const struct attest_claim_t token_claims[] = {
+    {&attest_add_instance_id_claim,        true},
+    {&attest_add_implementation_id_claim,  true},
+    {&attest_add_security_lifecycle_claim, false},
+    {&attest_add_all_sw_components,        true},
+    {&attest_add_profile_definition,       true},
+    {&attest_add_hash_algo_claim,          true},
+    {&attest_add_platform_config_claim,    true},
 #if ATTEST_INCLUDE_OPTIONAL_CLAIMS
-        &attest_add_verification_service,
+    {&attest_add_verification_service,     true},
+#endif
+};
+#endif
+
+#if ATTEST_CLAIM_CACHE_SIZE > 0
+#if ATTEST_CLAIM_CACHE_SIZE > UINT16_MAX
+#error "Invalid config: ATTEST_CLAIM_CACHE_SIZE must fit in 16 bits!"
+#endif
+
+/*!
+ * \struct attest_cached_claim_t
+ *
+ * \brief Label and encoded value of a static claim, as added to the token
+ */
+struct attest_cached_claim_t {
+    int32_t label;
+    uint16_t offset;    /* Offset of the encoded value in claim_cache_buf */
+    uint16_t len;       /* Length of the encoded value, 0 if not cached */
+};
+
+static uint8_t claim_cache_buf[ATTEST_CLAIM_CACHE_SIZE];
+static struct attest_cached_claim_t cached_claims[ARRAY_LENGTH(token_claims)];
+
+/*!
+ * \brief Static function to decode the integer label at the start of an
+ *        encoded map entry.
+ *
+ * \param[in]  buf    Encoded map entry
+ * \param[in]  len    Length of the encoded map entry
+ * \param[out] label  Decoded label
+ *
+ * \return Returns the size of the encoded label, 0 if it is not an integer
+ *         which fits in 32 bits
+ */
+static size_t attest_decode_int_label(const uint8_t *buf, size_t len,
+                                      int32_t *label)
+{
+    uint8_t major_type;
+    uint8_t additional_info;
+    uint32_t argument = 0;
+    size_t size;
+    size_t i;
+
+    if (len == 0) {
+        return 0;
+    }
+
+    major_type = buf[0] >> 5;
+    additional_info = buf[0] & 0x1F;
+
+    /* Major types 0 and 1 are positive and negative integers */
+    if (major_type > 1) {
+        return 0;
+    }
+
+    if (additional_info < 24) {
+        argument = additional_info;
+        size = 1;
+    } else if (additional_info <= 26) {
+        size = 1 + (1u << (additional_info - 24));
+        if (size > len) {
+            return 0;
+        }
+        for (i = 1; i < size; i++) {
+            argument = (argument << 8) | buf[i];
+        }
+    } else {
+        return 0;
+    }
+
+    if (argument > INT32_MAX) {
+        return 0;
+    }
+
+    *label = (major_type == 0) ? (int32_t)argument : -1 - (int32_t)argument;
+
+    return size;
+}
+
+/*!
+ * \brief Static function to encode the static claims into the claim cache.
+ *        A claim which can't be encoded, or doesn't fit, is left out of the
+ *        cache and is encoded on each request instead.
+ */
+static void attest_cache_static_claims(void)
+{
+    struct attest_token_encode_ctx claim_ctx;
+    struct q_useful_buf free_buf;
+    struct q_useful_buf_c encoded;
+    size_t used = 0;
+    size_t label_size;
+    int32_t label;
+    size_t i;
+
+    for (i = 0; i < ARRAY_LENGTH(token_claims); i++) {
+        cached_claims[i].len = 0;
+        if (!token_claims[i].is_static) {
+            continue;
+        }
+
+        /* Encode the claim alone, as the only entry of a map */
+        free_buf.ptr = &claim_cache_buf[used];
+        free_buf.len = sizeof(claim_cache_buf) - used;
+        QCBOREncode_Init(&claim_ctx.cbor_enc_ctx, free_buf);
+        QCBOREncode_OpenMap(&claim_ctx.cbor_enc_ctx);
+        if (token_claims[i].add_claim(&claim_ctx) != PSA_ATTEST_ERR_SUCCESS) {
+            continue;
+        }
+        QCBOREncode_CloseMap(&claim_ctx.cbor_enc_ctx);
+        if (QCBOREncode_Finish(&claim_ctx.cbor_enc_ctx, &encoded) !=
+            QCBOR_SUCCESS) {
+            continue;
+        }
+
+        /* A map of a single entry has a one byte head */
+        if ((encoded.len < 2) ||
+            (((const uint8_t *)encoded.ptr)[0] != 0xA1)) {
+            continue;
+        }
+
+        label_size = attest_decode_int_label((const uint8_t *)encoded.ptr + 1,
+                                             encoded.len - 1, &label);
+        if ((label_size == 0) || (1 + label_size >= encoded.len)) {
+            continue;
+        }
+
+        cached_claims[i].label = label;
+        cached_claims[i].offset = (uint16_t)(used + 1 + label_size);
+        cached_claims[i].len = (uint16_t)(encoded.len - 1 - label_size);
+        used += encoded.len;
+    }
+}
+#endif /* ATTEST_CLAIM_CACHE_SIZE > 0 */
+
+/*!
+ * \brief Static function to add a claim to the attestation token, from the
+ *        claim cache when it holds the claim.
+ *
+ * \param[in]  token_ctx  Token encoding context
+ * \param[in]  idx        Index of the claim in \ref token_claims
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t
+attest_add_claim(struct attest_token_encode_ctx *token_ctx, size_t idx)
+{
+#if ATTEST_CLAIM_CACHE_SIZE > 0
+    struct q_useful_buf_c encoded;
+
+    if (cached_claims[idx].len != 0) {
+        encoded.ptr = &claim_cache_buf[cached_claims[idx].offset];
+        encoded.len = cached_claims[idx].len;
+        attest_token_encode_add_cbor(token_ctx,
+                                     cached_claims[idx].label,
+                                     &encoded);
+
+        return PSA_ATTEST_ERR_SUCCESS;
+    }
+#endif
+
+    return token_claims[idx].add_claim(token_ctx);
+}
+
+psa_status_t attest_init(void)
+{
+    enum psa_attest_err_t res;
+
+    res = attest_boot_data_init();
+
+#if ATTEST_CLAIM_CACHE_SIZE > 0
+    if (res == PSA_ATTEST_ERR_SUCCESS) {
+        attest_cache_static_claims();
+    }
 #endif
-    };
+
+    return error_mapping_to_psa_status_t(res);
+}
+
+/*!
+ * \brief Static function to select the signing algorithm and the test options
+ *        of the initial attestation token
+ *
+ * \param[in]  challenge          Structure to carry the challenge value:
+ *                                pointer + challeng's length
+ * \param[out] cose_algorithm_id  COSE algorithm to sign the token with
+ * \param[out] option_flags       Token options, see \ref attest_get_option_flags
+ * \param[out] key_select         Selects which attestation key to sign with
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t
+attest_get_token_options(struct q_useful_buf_c *challenge,
+                         int32_t *cose_algorithm_id,
+                         uint32_t *option_flags,
+                         int32_t *key_select)
+{
+    enum psa_attest_err_t attest_err;
+
+    *option_flags = 0;
+    *key_select = 0;
+
+    attest_err = attest_get_t_cose_algorithm(cose_algorithm_id);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+#ifdef INCLUDE_TEST_CODE
+    attest_get_option_flags(challenge, option_flags, key_select);
+    if (*option_flags) {
+        /* If any option flags are provided (TOKEN_OPT_OMIT_CLAIMS or
+         * TOKEN_OPT_SHORT_CIRCUIT_SIGN) then force the cose_algorithm_id
+         * to be either:
+         *  - T_COSE_ALGORITHM_ES256 or  (SYMMETRIC_INITIAL_ATTESTATION=OFF)
+         *  - T_COSE_ALGORITHM_HMAC256   (SYMMETRIC_INITIAL_ATTESTATION=ON)
+         * for testing purposes to match with expected minimal token.
+         */
+        /* ESxxx range is smaller than 0; HMACxxx range is greater than 0 */
+        *cose_algorithm_id = *cose_algorithm_id < 0 ?
+                             T_COSE_ALGORITHM_ES256 :
+                             T_COSE_ALGORITHM_HMAC256;
+    }
+#else
+    (void)challenge;
 #endif
 
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
 /*!
  * \brief Static function to create the initial attestation token
  *
@@ -731,32 +956,17 @@ attest_create_token(struct q_useful_buf_c *challenge,
     enum psa_attest_err_t attest_err = PSA_ATTEST_ERR_SUCCESS;
     enum attest_token_err_t token_err;
     struct attest_token_encode_ctx attest_token_ctx;
-    int32_t key_select = 0;
-    uint32_t option_flags = 0;
-    int i;
+    int32_t key_select;
+    uint32_t option_flags;
+    size_t i;
     int32_t cose_algorithm_id;
 
-    attest_err = attest_get_t_cose_algorithm(&cose_algorithm_id);
+    attest_err = attest_get_token_options(challenge, &cose_algorithm_id,
+                                          &option_flags, &key_select);
     if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
         return attest_err;
     }
 
-#ifdef INCLUDE_TEST_CODE
-    attest_get_option_flags(challenge, &option_flags, &key_select);
-    if (option_flags) {
-        /* If any option flags are provided (TOKEN_OPT_OMIT_CLAIMS or
-         * TOKEN_OPT_SHORT_CIRCUIT_SIGN) then force the cose_algorithm_id
-         * to be either:
-         *  - T_COSE_ALGORITHM_ES256 or  (SYMMETRIC_INITIAL_ATTESTATION=OFF)
-         *  - T_COSE_ALGORITHM_HMAC256   (SYMMETRIC_INITIAL_ATTESTATION=ON)
-         * for testing purposes to match with expected minimal token.
-         */
-        /* ESxxx range is smaller than 0; HMACxxx range is greater than 0 */
-        cose_algorithm_id = cose_algorithm_id < 0 ? T_COSE_ALGORITHM_ES256 :
-                                                    T_COSE_ALGORITHM_HMAC256;
-    }
-#endif
-
     /* Get started creating the token. This sets up the CBOR and COSE contexts
      * which causes the COSE headers to be constructed.
      */
@@ -778,9 +988,9 @@ attest_create_token(struct q_useful_buf_c *challenge,
     }
 
     if (!(option_flags & TOKEN_OPT_OMIT_CLAIMS)) {
-        for (i = 0; i < ARRAY_LENGTH(claim_query_funcs); ++i) {
+        for (i = 0; i < ARRAY_LENGTH(token_claims); ++i) {
             /* Calling the attest_add_XXX_claim functions */
-            attest_err = claim_query_funcs[i](&attest_token_ctx);
+            attest_err = attest_add_claim(&attest_token_ctx, i);
             if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
                 goto error;
             }
@@ -797,71 +1007,1063 @@ error:
     return attest_err;
 }
 
-psa_status_t
-initial_attest_get_token(const void *challenge_buf, size_t challenge_size,
-                         void *token_buf, size_t token_buf_size,
-                         size_t *token_size)
-{
-    enum psa_attest_err_t attest_err = PSA_ATTEST_ERR_SUCCESS;
-    struct q_useful_buf_c challenge;
-    struct q_useful_buf token;
-    struct q_useful_buf_c completed_token;
+/*!
+ * \brief Size of the COSE envelope of the token, which is everything but the
+ *        payload and its byte string head. 0 until it is measured.
+ */
+static size_t token_cose_overhead;
 
-    challenge.ptr = challenge_buf;
-    challenge.len = challenge_size;
-    token.ptr = token_buf;
-    token.len = token_buf_size;
+/*!
+ * \brief Static function to get the size of the head of a CBOR byte string
+ *
+ * \param[in]  len  Length of the byte string content
+ *
+ * \return Returns the size of the head in bytes
+ */
+static size_t attest_cbor_bstr_head_size(size_t len)
+{
+    if (len < 24) {
+        return 1;
+    } else if (len <= UINT8_MAX) {
+        return 2;
+    } else if (len <= UINT16_MAX) {
+        return 3;
+    } else {
+        return 5;
+    }
+}
 
-    attest_err = attest_verify_challenge_size(challenge.len);
+/*!
+ * \brief Static function to compute the size of the initial attestation token
+ *        without going through the signing pipeline. The COSE envelope is
+ *        measured once with an empty payload. The payload is then encoded in
+ *        size calculation mode for each request, the static claims coming
+ *        from the claim cache. The test options of the challenge apply as
+ *        they do to the token.
+ *
+ * \param[in]  challenge   Structure to carry the challenge value:
+ *                         pointer + challeng's length
+ * \param[out] token_size  Size of the token
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t
+attest_compute_token_size(struct q_useful_buf_c *challenge,
+                          size_t *token_size)
+{
+    enum psa_attest_err_t attest_err;
+    enum attest_token_err_t token_err;
+    struct attest_token_encode_ctx token_ctx;
+    struct q_useful_buf size_only = {NULL, INT32_MAX};
+    struct q_useful_buf_c encoded;
+    int32_t cose_algorithm_id;
+    int32_t key_select;
+    uint32_t option_flags;
+    size_t cose_overhead;
+    size_t i;
+
+    /* Same algorithm, key and options as attest_create_token() */
+    attest_err = attest_get_token_options(challenge, &cose_algorithm_id,
+                                          &option_flags, &key_select);
     if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
-        goto error;
+        return attest_err;
     }
 
-    if (token.len == 0) {
-        attest_err = PSA_ATTEST_ERR_INVALID_INPUT;
-        goto error;
+    /* Only the envelope of the default options is kept, the test options
+     * change the headers and the signature
+     */
+    if ((token_cose_overhead == 0) || (option_flags != 0) ||
+        (key_select != 0)) {
+        token_err = attest_token_encode_start(&token_ctx, option_flags,
+                                              key_select, cose_algorithm_id,
+                                              &size_only);
+        if (token_err != ATTEST_TOKEN_ERR_SUCCESS) {
+            return error_mapping_to_psa_attest_err_t(token_err);
+        }
+
+        token_err = attest_token_encode_finish(&token_ctx, &encoded);
+        if (token_err != ATTEST_TOKEN_ERR_SUCCESS) {
+            return error_mapping_to_psa_attest_err_t(token_err);
+        }
+
+        /* The empty payload is a one byte map in a one byte head bstr */
+        cose_overhead = encoded.len - 2;
+        if ((option_flags == 0) && (key_select == 0)) {
+            token_cose_overhead = cose_overhead;
+        }
+    } else {
+        cose_overhead = token_cose_overhead;
     }
 
-    attest_err = attest_create_token(&challenge, &token, &completed_token);
+    /* Encode the payload as attest_create_token() does */
+    QCBOREncode_Init(&token_ctx.cbor_enc_ctx, size_only);
+    QCBOREncode_OpenMap(&token_ctx.cbor_enc_ctx);
+
+    attest_err = attest_add_nonce_claim(&token_ctx, challenge);
     if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
-        goto error;
+        return attest_err;
     }
 
-    *token_size  = completed_token.len;
+    if (!(option_flags & TOKEN_OPT_OMIT_CLAIMS)) {
+        for (i = 0; i < ARRAY_LENGTH(token_claims); ++i) {
+            attest_err = attest_add_claim(&token_ctx, i);
+            if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+                return attest_err;
+            }
+        }
+    }
 
-error:
-    return error_mapping_to_psa_status_t(attest_err);
+    QCBOREncode_CloseMap(&token_ctx.cbor_enc_ctx);
+    if (QCBOREncode_Finish(&token_ctx.cbor_enc_ctx, &encoded) !=
+        QCBOR_SUCCESS) {
+        return PSA_ATTEST_ERR_GENERAL;
+    }
+
+    *token_size = cose_overhead +
+                  attest_cbor_bstr_head_size(encoded.len) + encoded.len;
+
+    return PSA_ATTEST_ERR_SUCCESS;
 }
 
-psa_status_t
-initial_attest_get_token_size(const size_t challenge_size,
-                              size_t *token_size)
+#if ATTEST_TOKEN_STREAM_BUF_SIZE > 0
+#if ATTEST_TOKEN_STREAM_BUF_SIZE > UINT16_MAX
+#error "Invalid config: ATTEST_TOKEN_STREAM_BUF_SIZE must fit in 16 bits!"
+#endif
+
+/* Entries of the claim map of a streamed token: the nonce, then the claims */
+#define ATTEST_STREAM_ENTRIES   (ARRAY_LENGTH(token_claims) + 1)
+
+/* Longest encoding of the integer label of a claim */
+#define ATTEST_LABEL_MAX_SIZE   9
+
+/*!
+ * \brief Window through which a streamed token is encoded: the nonce and the
+ *        claims that the claim cache does not hold, each encoded once, then
+ *        the COSE headers and the signature. The nonce and the claims which
+ *        can change during a request always are in it.
+ */
+static uint8_t token_window[ATTEST_TOKEN_STREAM_BUF_SIZE];
+
+/*!
+ * \struct attest_window_entry_t
+ *
+ * \brief Position of an encoded entry of the claim map in \ref token_window
+ */
+struct attest_window_entry_t {
+    uint16_t offset;
+    uint16_t len;       /* 0 if the entry is not in the window */
+};
+
+static struct attest_window_entry_t window_entries[ATTEST_STREAM_ENTRIES];
+
+/* Context of the streamed token, kept off the partition stack */
+static struct attest_token_stream_ctx token_stream_ctx;
+
+/*!
+ * \brief Function passing the next bytes of the payload of a streamed token
+ *        to its signature, or to its destination.
+ */
+typedef enum attest_token_err_t
+(*attest_stream_pass_t)(struct attest_token_stream_ctx *stream_ctx,
+                        const struct q_useful_buf_c *bytes);
+
+/*!
+ * \brief Static function to tell whether the claim cache holds an entry of
+ *        the claim map
+ *
+ * \param[in]  entry  Index of the entry, 0 for the nonce and then the index
+ *                    of the claim in \ref token_claims plus one
+ *
+ * \return Returns true if the entry is cached
+ */
+static bool attest_entry_is_cached(size_t entry)
 {
-    enum psa_attest_err_t attest_err = PSA_ATTEST_ERR_SUCCESS;
-    struct q_useful_buf_c challenge;
-    struct q_useful_buf token;
-    struct q_useful_buf_c completed_token;
+#if ATTEST_CLAIM_CACHE_SIZE > 0
+    return (entry != 0) && (cached_claims[entry - 1].len != 0);
+#else
+    (void)entry;
 
-    /* Only the size of the challenge is needed */
-    challenge.ptr = NULL;
-    challenge.len = challenge_size;
+    return false;
+#endif
+}
 
-    /* Special value to get the size of the token, but token is not created */
-    token.ptr = NULL;
-    token.len = INT32_MAX;
+/*!
+ * \brief Static function to tell whether an entry of the claim map can
+ *        change during a request, as the security lifecycle can
+ *
+ * \param[in]  entry  Index of the entry, see \ref attest_entry_is_cached
+ *
+ * \return Returns true if the entry is not constant for the boot session
+ */
+static bool attest_entry_is_dynamic(size_t entry)
+{
+    return (entry == 0) || !token_claims[entry - 1].is_static;
+}
 
-    attest_err = attest_verify_challenge_size(challenge_size);
+/*!
+ * \brief Static function to encode an entry of the claim map alone, as the
+ *        only entry of a map of which the head is then left out.
+ *
+ * \param[in]  buf        Buffer to encode into, NULL pointer to only get the
+ *                        size
+ * \param[in]  challenge  Challenge to encode as the nonce claim
+ * \param[in]  entry      Index of the entry, see \ref attest_entry_is_cached
+ * \param[out] encoded    The encoded entry
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t
+attest_encode_entry(const struct q_useful_buf *buf,
+                    struct q_useful_buf_c *challenge,
+                    size_t entry,
+                    struct q_useful_buf_c *encoded)
+{
+    enum psa_attest_err_t attest_err;
+    struct attest_token_encode_ctx token_ctx;
+    QCBORError qcbor_result;
+
+    QCBOREncode_Init(&token_ctx.cbor_enc_ctx, *buf);
+    QCBOREncode_OpenMap(&token_ctx.cbor_enc_ctx);
+
+    if (entry == 0) {
+        attest_err = attest_add_nonce_claim(&token_ctx, challenge);
+    } else {
+        attest_err = attest_add_claim(&token_ctx, entry - 1);
+    }
     if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
-        goto error;
+        return attest_err;
     }
 
-    attest_err = attest_create_token(&challenge, &token, &completed_token);
-    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
-        goto error;
+    QCBOREncode_CloseMap(&token_ctx.cbor_enc_ctx);
+    qcbor_result = QCBOREncode_Finish(&token_ctx.cbor_enc_ctx, encoded);
+    if (qcbor_result == QCBOR_ERR_BUFFER_TOO_SMALL) {
+        return PSA_ATTEST_ERR_BUFFER_OVERFLOW;
+    } else if ((qcbor_result != QCBOR_SUCCESS) || (encoded->len < 2)) {
+        return PSA_ATTEST_ERR_GENERAL;
     }
 
-    *token_size = completed_token.len;
+    /* A map of a single entry has a one byte head */
+    if (encoded->ptr != NULL) {
+        encoded->ptr = (const uint8_t *)encoded->ptr + 1;
+    }
+    encoded->len -= 1;
+
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
+/*!
+ * \brief Static function to encode the entries of the claim map which the
+ *        claim cache does not hold into the window, one after the other.
+ *        Each of them is then encoded once, whereas the token is passed
+ *        twice.
+ *
+ * The nonce and the claims which can change during a request are packed
+ * first, and must fit: the signature and the written token then read the
+ * same values. The static claims are packed after them as long as there is
+ * room, the others are encoded each time they are passed.
+ *
+ * \param[in]  challenge     Challenge to encode as the nonce claim
+ * \param[in]  num_entries   Number of entries of the claim map
+ * \param[in]  dynamic_only  Whether to leave all the static claims out
+ * \param[out] used          Number of bytes of the window they take
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t
+attest_pack_entries(struct q_useful_buf_c *challenge,
+                    size_t num_entries,
+                    bool dynamic_only,
+                    size_t *used)
+{
+    enum psa_attest_err_t attest_err;
+    struct q_useful_buf free_buf;
+    struct q_useful_buf_c encoded;
+    size_t entry;
+    int pass;
+
+    *used = 0;
+    for (entry = 0; entry < num_entries; entry++) {
+        window_entries[entry].len = 0;
+    }
+
+    /* The dynamic entries in the first pass, the static ones in the second */
+    for (pass = 0; pass < (dynamic_only ? 1 : 2); pass++) {
+        for (entry = 0; entry < num_entries; entry++) {
+            if (attest_entry_is_cached(entry) ||
+                (attest_entry_is_dynamic(entry) != (pass == 0))) {
+                continue;
+            }
+
+            free_buf.ptr = &token_window[*used];
+            free_buf.len = sizeof(token_window) - *used;
+            attest_err = attest_encode_entry(&free_buf, challenge, entry,
+                                             &encoded);
+            if (attest_err == PSA_ATTEST_ERR_BUFFER_OVERFLOW) {
+                if (pass == 0) {
+                    /* The window cannot hold the dynamic entries */
+                    return PSA_ATTEST_ERR_GENERAL;
+                }
+                /* It is encoded each time it is passed instead */
+                continue;
+            } else if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+                return attest_err;
+            }
+
+            window_entries[entry].offset = (uint16_t)
+                    ((const uint8_t *)encoded.ptr - token_window);
+            window_entries[entry].len = (uint16_t)encoded.len;
+            *used = window_entries[entry].offset + encoded.len;
+        }
+    }
+
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
+/*!
+ * \brief Static function to get the size of an entry of the claim map
+ *
+ * \param[in]  challenge  Challenge to encode as the nonce claim
+ * \param[in]  entry      Index of the entry, see \ref attest_entry_is_cached
+ * \param[out] size       Size of the encoded entry
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t
+attest_entry_size(struct q_useful_buf_c *challenge,
+                  size_t entry,
+                  size_t *size)
+{
+    enum psa_attest_err_t attest_err;
+    struct q_useful_buf size_only = {NULL, INT32_MAX};
+    struct q_useful_buf_c encoded;
+#if ATTEST_CLAIM_CACHE_SIZE > 0
+    QCBOREncodeContext cbor_ctx;
+
+    if (attest_entry_is_cached(entry)) {
+        QCBOREncode_Init(&cbor_ctx, size_only);
+        QCBOREncode_AddInt64(&cbor_ctx, cached_claims[entry - 1].label);
+        if (QCBOREncode_Finish(&cbor_ctx, &encoded) != QCBOR_SUCCESS) {
+            return PSA_ATTEST_ERR_GENERAL;
+        }
+        *size = encoded.len + cached_claims[entry - 1].len;
+
+        return PSA_ATTEST_ERR_SUCCESS;
+    }
+#endif
+
+    if (window_entries[entry].len != 0) {
+        *size = window_entries[entry].len;
+
+        return PSA_ATTEST_ERR_SUCCESS;
+    }
+
+    attest_err = attest_encode_entry(&size_only, challenge, entry, &encoded);
+    if (attest_err == PSA_ATTEST_ERR_SUCCESS) {
+        *size = encoded.len;
+    }
+
+    return attest_err;
+}
+
+/*!
+ * \brief Static function to pass an entry of the claim map of a streamed
+ *        token on
+ *
+ * \param[in]  stream_ctx  Token streaming context
+ * \param[in]  pass        Function the bytes of the entry are passed to
+ * \param[in]  challenge   Challenge to encode as the nonce claim
+ * \param[in]  entry       Index of the entry, see \ref attest_entry_is_cached
+ * \param[in]  scratch     Part of the window to encode the entry in, when it
+ *                         is neither cached nor in the window already
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t
+attest_pass_entry(struct attest_token_stream_ctx *stream_ctx,
+                  attest_stream_pass_t pass,
+                  struct q_useful_buf_c *challenge,
+                  size_t entry,
+                  const struct q_useful_buf *scratch)
+{
+    enum psa_attest_err_t attest_err;
+    enum attest_token_err_t token_err;
+    struct q_useful_buf_c encoded;
+#if ATTEST_CLAIM_CACHE_SIZE > 0
+    uint8_t label_buf[ATTEST_LABEL_MAX_SIZE];
+    struct q_useful_buf label = {label_buf, sizeof(label_buf)};
+    QCBOREncodeContext cbor_ctx;
+
+    if (attest_entry_is_cached(entry)) {
+        /* Only the label is encoded, the value is passed straight from the
+         * claim cache.
+         */
+        QCBOREncode_Init(&cbor_ctx, label);
+        QCBOREncode_AddInt64(&cbor_ctx, cached_claims[entry - 1].label);
+        if (QCBOREncode_Finish(&cbor_ctx, &encoded) != QCBOR_SUCCESS) {
+            return PSA_ATTEST_ERR_GENERAL;
+        }
+
+        token_err = pass(stream_ctx, &encoded);
+        if (token_err != ATTEST_TOKEN_ERR_SUCCESS) {
+            return error_mapping_to_psa_attest_err_t(token_err);
+        }
+
+        encoded.ptr = &claim_cache_buf[cached_claims[entry - 1].offset];
+        encoded.len = cached_claims[entry - 1].len;
+        token_err = pass(stream_ctx, &encoded);
+
+        return error_mapping_to_psa_attest_err_t(token_err);
+    }
+#endif
+
+    if (window_entries[entry].len != 0) {
+        encoded.ptr = &token_window[window_entries[entry].offset];
+        encoded.len = window_entries[entry].len;
+    } else {
+        attest_err = attest_encode_entry(scratch, challenge, entry, &encoded);
+        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+            return attest_err;
+        }
+    }
+
+    token_err = pass(stream_ctx, &encoded);
+
+    return error_mapping_to_psa_attest_err_t(token_err);
+}
+
+/*!
+ * \brief Static function to pass the payload of a streamed token on
+ *
+ * \param[in]  stream_ctx   Token streaming context
+ * \param[in]  pass         Function the bytes of the payload are passed to
+ * \param[in]  challenge    Challenge to encode as the nonce claim
+ * \param[in]  num_entries  Number of entries of the claim map
+ * \param[in]  scratch      Part of the window to encode entries in
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t
+attest_pass_payload(struct attest_token_stream_ctx *stream_ctx,
+                    attest_stream_pass_t pass,
+                    struct q_useful_buf_c *challenge,
+                    size_t num_entries,
+                    const struct q_useful_buf *scratch)
+{
+    enum psa_attest_err_t attest_err;
+    enum attest_token_err_t token_err;
+    /* The head of a map (major type 5) of less than 24 entries is one byte */
+    uint8_t map_head = 0xA0 | (uint8_t)num_entries;
+    struct q_useful_buf_c encoded = {&map_head, sizeof(map_head)};
+    size_t entry;
+
+    token_err = pass(stream_ctx, &encoded);
+    if (token_err != ATTEST_TOKEN_ERR_SUCCESS) {
+        return error_mapping_to_psa_attest_err_t(token_err);
+    }
+
+    for (entry = 0; entry < num_entries; entry++) {
+        attest_err = attest_pass_entry(stream_ctx, pass, challenge, entry,
+                                       scratch);
+        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+            return attest_err;
+        }
+    }
+
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
+/*!
+ * \brief Static function to replace the nonce claim in the window with the
+ *        one of the next token of a batch
+ *
+ * \param[in]  challenge  Challenge to encode as the nonce claim
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t
+attest_repack_nonce(struct q_useful_buf_c *challenge)
+{
+    enum psa_attest_err_t attest_err;
+    struct q_useful_buf nonce_buf;
+    struct q_useful_buf_c encoded;
+
+    if (window_entries[0].len == 0) {
+        /* It is encoded each time it is passed */
+        return PSA_ATTEST_ERR_SUCCESS;
+    }
+
+    /* The nonce is packed first, after the head of the map it is encoded in,
+     * and all the challenges of a batch have the same size.
+     */
+    nonce_buf.ptr = token_window;
+    nonce_buf.len = window_entries[0].offset + window_entries[0].len;
+    attest_err = attest_encode_entry(&nonce_buf, challenge, 0, &encoded);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+    if (encoded.len != window_entries[0].len) {
+        return PSA_ATTEST_ERR_GENERAL;
+    }
+
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
+/*!
+ * \brief Static function to stream initial attestation tokens out, one per
+ *        challenge, without a buffer holding a whole token.
+ *
+ * The entries of the claim map that the claim cache does not hold are
+ * encoded into the window, which gives the length of the payload. The
+ * payload is then passed twice: once to compute the signature, and once to
+ * write it out, after the COSE headers and before the signature. So nothing
+ * is written unless the token is complete.
+ *
+ * The nonce and the claims which can change during a request, such as the
+ * security lifecycle, are read once and kept in the window, so that the
+ * signature covers the claims written out. The static claims which do not fit
+ * in the window are encoded again every time they are passed instead.
+ *
+ * The tokens of a batch only differ by their nonce, which is encoded again
+ * for each of them, and by their signature. They all have the same size, and
+ * the claims read for the first of them.
+ *
+ * \param[in]  challenges      The challenges, one after the other
+ * \param[in]  challenge_size  Size of each challenge
+ * \param[in]  num_tokens      Number of challenges, and of tokens to stream
+ * \param[in]  token_buf_size  Number of bytes the destination accepts for
+ *                             each token
+ * \param[in]  write           Function writing the tokens to the destination
+ * \param[in]  write_ctx       Context passed to \p write
+ * \param[out] token_size      Size of each streamed token
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t
+attest_stream_token(const uint8_t *challenges,
+                    size_t challenge_size,
+                    size_t num_tokens,
+                    size_t token_buf_size,
+                    attest_token_write_t write,
+                    void *write_ctx,
+                    size_t *token_size)
+{
+    enum psa_attest_err_t attest_err;
+    enum attest_token_err_t token_err;
+    struct q_useful_buf_c challenge;
+    struct q_useful_buf window;
+    size_t num_entries;
+    size_t payload_len;
+    size_t entry;
+    size_t used;
+    size_t size;
+    size_t i;
+    int32_t cose_algorithm_id;
+    int32_t key_select;
+    uint32_t option_flags;
+
+    challenge.ptr = challenges;
+    challenge.len = challenge_size;
+
+    attest_err = attest_get_token_options(&challenge, &cose_algorithm_id,
+                                          &option_flags, &key_select);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    num_entries = (option_flags & TOKEN_OPT_OMIT_CLAIMS) ?
+                  1 : ATTEST_STREAM_ENTRIES;
+    if (num_entries > 23) {
+        return PSA_ATTEST_ERR_GENERAL;
+    }
+
+    attest_err = attest_pack_entries(&challenge, num_entries, false, &used);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    /* The COSE headers and the signature go after the entries */
+    window.ptr = &token_window[used];
+    window.len = sizeof(token_window) - used;
+    token_err = attest_token_stream_start(&token_stream_ctx,
+                                          option_flags,
+                                          key_select,
+                                          cose_algorithm_id,
+                                          &window);
+    if (token_err == ATTEST_TOKEN_ERR_TOO_SMALL) {
+        /* No room is left for them, the static claims are encoded again
+         * each time they are passed instead.
+         */
+        attest_err = attest_pack_entries(&challenge, num_entries, true,
+                                         &used);
+        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+            return attest_err;
+        }
+        window.ptr = &token_window[used];
+        window.len = sizeof(token_window) - used;
+        token_err = attest_token_stream_start(&token_stream_ctx,
+                                              option_flags,
+                                              key_select,
+                                              cose_algorithm_id,
+                                              &window);
+    }
+    if (token_err != ATTEST_TOKEN_ERR_SUCCESS) {
+        attest_err = error_mapping_to_psa_attest_err_t(token_err);
+        goto error;
+    }
+
+    payload_len = 1;
+    for (entry = 0; entry < num_entries; entry++) {
+        attest_err = attest_entry_size(&challenge, entry, &size);
+        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+            goto error;
+        }
+        if (!attest_entry_is_cached(entry) &&
+            (window_entries[entry].len == 0) && (size > window.len)) {
+            /* Larger than the window on its own */
+            attest_err = PSA_ATTEST_ERR_GENERAL;
+            goto error;
+        }
+        payload_len += size;
+    }
+
+    for (i = 0; i < num_tokens; ++i) {
+        if (i != 0) {
+            challenge.ptr = challenges + i * challenge_size;
+            attest_err = attest_repack_nonce(&challenge);
+            if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+                goto error;
+            }
+        }
+
+        /* Nothing is written if the token does not fit in the destination */
+        token_err = attest_token_stream_digest_start(&token_stream_ctx,
+                                                     payload_len,
+                                                     token_buf_size);
+        if (token_err != ATTEST_TOKEN_ERR_SUCCESS) {
+            attest_err = error_mapping_to_psa_attest_err_t(token_err);
+            goto error;
+        }
+
+        attest_err = attest_pass_payload(&token_stream_ctx,
+                                         attest_token_stream_digest,
+                                         &challenge, num_entries, &window);
+        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+            goto error;
+        }
+
+        token_err = attest_token_stream_sign(&token_stream_ctx,
+                                             write, write_ctx);
+        if (token_err != ATTEST_TOKEN_ERR_SUCCESS) {
+            attest_err = error_mapping_to_psa_attest_err_t(token_err);
+            goto error;
+        }
+
+        /* From here on, only an entry encoded again could fail */
+        attest_err = attest_pass_payload(&token_stream_ctx,
+                                         attest_token_stream_payload,
+                                         &challenge, num_entries, &window);
+        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+            goto error;
+        }
+
+        token_err = attest_token_stream_finish(&token_stream_ctx, token_size);
+        if (token_err != ATTEST_TOKEN_ERR_SUCCESS) {
+            attest_err = error_mapping_to_psa_attest_err_t(token_err);
+            goto error;
+        }
+    }
+
+error:
+    /* Releases the signature operation if the token was not signed */
+    attest_token_stream_abort(&token_stream_ctx);
+
+    return attest_err;
+}
+#endif /* ATTEST_TOKEN_STREAM_BUF_SIZE > 0 */
+
+#if ATTEST_TOKEN_BATCH_MAX > 0
+/*!
+ * \brief Static function to get the options of a batch of tokens
+ *
+ * The tokens of a batch are all created with the options of the first
+ * challenge, which the other challenges must select as well.
+ *
+ * \param[in]  challenges      Challenges of the tokens, one after the other
+ * \param[in]  challenge_size  Size of each challenge
+ * \param[in]  num_tokens      Number of challenges
+ * \param[out] cose_algorithm_id  The COSE algorithm ID
+ * \param[out] option_flags       The option flags
+ * \param[out] key_select         The key selection
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t
+attest_get_batch_options(const uint8_t *challenges,
+                         size_t challenge_size,
+                         size_t num_tokens,
+                         int32_t *cose_algorithm_id,
+                         uint32_t *option_flags,
+                         int32_t *key_select)
+{
+    enum psa_attest_err_t attest_err;
+    struct q_useful_buf_c challenge;
+#ifdef INCLUDE_TEST_CODE
+    int32_t next_cose_algorithm_id;
+    int32_t next_key_select;
+    uint32_t next_option_flags;
+    size_t i;
+#endif
+
+    challenge.ptr = challenges;
+    challenge.len = challenge_size;
+
+    attest_err = attest_get_token_options(&challenge, cose_algorithm_id,
+                                          option_flags, key_select);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+#ifdef INCLUDE_TEST_CODE
+    for (i = 1; i < num_tokens; ++i) {
+        challenge.ptr = challenges + i * challenge_size;
+        attest_err = attest_get_token_options(&challenge,
+                                              &next_cose_algorithm_id,
+                                              &next_option_flags,
+                                              &next_key_select);
+        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+            return attest_err;
+        }
+        if ((next_cose_algorithm_id != *cose_algorithm_id) ||
+            (next_option_flags != *option_flags) ||
+            (next_key_select != *key_select)) {
+            return PSA_ATTEST_ERR_INVALID_INPUT;
+        }
+    }
+#else
+    (void)num_tokens;
+#endif
+
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
+#if ATTEST_TOKEN_STREAM_BUF_SIZE > 0
+/*!
+ * \brief Static function to stream a batch of tokens, one per challenge
+ *
+ * The tokens are streamed in turn through the window, which holds the
+ * claims encoded once for the whole batch. Each token only differs from the
+ * previous one by its nonce and its signature.
+ *
+ * \param[in]  challenges      Challenges of the tokens, one after the other
+ * \param[in]  challenge_size  Size of each challenge
+ * \param[in]  num_tokens      Number of tokens to create
+ * \param[in]  tokens_size     Number of bytes the destination accepts.
+ *                             Nothing is written if the tokens are larger.
+ * \param[in]  write           Function called with the bytes of the tokens
+ * \param[in]  write_ctx       Context passed to \p write
+ * \param[out] token_size      Size of each token
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t
+attest_create_token_batch(const uint8_t *challenges,
+                          size_t challenge_size,
+                          size_t num_tokens,
+                          size_t tokens_size,
+                          attest_token_write_t write,
+                          void *write_ctx,
+                          size_t *token_size)
+{
+    enum psa_attest_err_t attest_err;
+    int32_t cose_algorithm_id;
+    int32_t key_select;
+    uint32_t option_flags;
+
+    attest_err = attest_get_batch_options(challenges, challenge_size,
+                                          num_tokens, &cose_algorithm_id,
+                                          &option_flags, &key_select);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    /* All the tokens have the same size, so the first one is the only one
+     * that may not fit.
+     */
+    return attest_stream_token(challenges, challenge_size, num_tokens,
+                               tokens_size / num_tokens,
+                               write, write_ctx, token_size);
+}
+#else /* ATTEST_TOKEN_STREAM_BUF_SIZE > 0 */
+/* Context of the batch, kept off the partition stack */
+static struct attest_token_batch_ctx token_batch_ctx;
+
+/*!
+ * \brief Static function to create a batch of tokens, one per challenge
+ *
+ * The claims are encoded once, in the first token, with the nonce claim last.
+ * Each next token is the previous one with its own nonce and signature.
+ *
+ * \param[in]  challenges      Challenges of the tokens, one after the other
+ * \param[in]  challenge_size  Size of each challenge
+ * \param[in]  num_tokens      Number of tokens to create
+ * \param[in]  token           Buffer where each token is created in turn
+ * \param[in]  tokens_size     Number of bytes the destination accepts.
+ *                             Nothing is written if the tokens are larger.
+ * \param[in]  write           Function called with each token
+ * \param[in]  write_ctx       Context passed to \p write
+ * \param[out] token_size      Size of each token
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t
+attest_create_token_batch(const uint8_t *challenges,
+                          size_t challenge_size,
+                          size_t num_tokens,
+                          struct q_useful_buf *token,
+                          size_t tokens_size,
+                          attest_token_write_t write,
+                          void *write_ctx,
+                          size_t *token_size)
+{
+    enum psa_attest_err_t attest_err;
+    enum attest_token_err_t token_err;
+    struct attest_token_encode_ctx *token_ctx =
+                                        &token_batch_ctx.common_ctx.encode_ctx;
+    struct q_useful_buf_c challenge;
+    struct q_useful_buf_c completed_token;
+    int32_t cose_algorithm_id;
+    int32_t key_select;
+    uint32_t option_flags;
+    size_t i;
+
+    attest_err = attest_get_batch_options(challenges, challenge_size,
+                                          num_tokens, &cose_algorithm_id,
+                                          &option_flags, &key_select);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    challenge.ptr = challenges;
+    challenge.len = challenge_size;
+
+    token_err = attest_token_batch_start(&token_batch_ctx,
+                                         option_flags,
+                                         key_select,
+                                         cose_algorithm_id,
+                                         token);
+    if (token_err != ATTEST_TOKEN_ERR_SUCCESS) {
+        attest_err = error_mapping_to_psa_attest_err_t(token_err);
+        goto error;
+    }
+
+    if (!(option_flags & TOKEN_OPT_OMIT_CLAIMS)) {
+        for (i = 0; i < ARRAY_LENGTH(token_claims); ++i) {
+            attest_err = attest_add_claim(token_ctx, i);
+            if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+                goto error;
+            }
+        }
+    }
+
+    /* The challenge is the last bytes of the payload, the only ones that
+     * differ between the tokens of the batch.
+     */
+    attest_err = attest_add_nonce_claim(token_ctx, &challenge);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        goto error;
+    }
+
+    token_err = attest_token_batch_finish(&token_batch_ctx, challenge_size,
+                                          &completed_token);
+    if (token_err != ATTEST_TOKEN_ERR_SUCCESS) {
+        attest_err = error_mapping_to_psa_attest_err_t(token_err);
+        goto error;
+    }
+
+    /* All the tokens have the same size */
+    if (completed_token.len > tokens_size / num_tokens) {
+        attest_err = PSA_ATTEST_ERR_BUFFER_OVERFLOW;
+        goto error;
+    }
+
+    write(write_ctx, completed_token.ptr, completed_token.len);
+
+    for (i = 1; i < num_tokens; ++i) {
+        challenge.ptr = challenges + i * challenge_size;
+        token_err = attest_token_batch_next(&token_batch_ctx, &challenge,
+                                            &completed_token);
+        if (token_err != ATTEST_TOKEN_ERR_SUCCESS) {
+            attest_err = error_mapping_to_psa_attest_err_t(token_err);
+            goto error;
+        }
+
+        write(write_ctx, completed_token.ptr, completed_token.len);
+    }
+
+    *token_size = completed_token.len;
+
+error:
+    attest_token_batch_end(&token_batch_ctx);
+
+    return attest_err;
+}
+#endif /* ATTEST_TOKEN_STREAM_BUF_SIZE > 0 */
+#endif /* ATTEST_TOKEN_BATCH_MAX > 0 */
+
+psa_status_t
+initial_attest_get_token(const void *challenge_buf, size_t challenge_size,
+                         void *token_buf, size_t token_buf_size,
+                         size_t *token_size)
+{
+    enum psa_attest_err_t attest_err = PSA_ATTEST_ERR_SUCCESS;
+    struct q_useful_buf_c challenge;
+    struct q_useful_buf token;
+    struct q_useful_buf_c completed_token;
+
+    challenge.ptr = challenge_buf;
+    challenge.len = challenge_size;
+    token.ptr = token_buf;
+    token.len = token_buf_size;
+
+    attest_err = attest_verify_challenge_size(challenge.len);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        goto error;
+    }
+
+    if (token.len == 0) {
+        attest_err = PSA_ATTEST_ERR_INVALID_INPUT;
+        goto error;
+    }
+
+    attest_err = attest_create_token(&challenge, &token, &completed_token);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        goto error;
+    }
+
+    *token_size  = completed_token.len;
+
+error:
+    return error_mapping_to_psa_status_t(attest_err);
+}
+
+psa_status_t
+initial_attest_get_token_size(const size_t challenge_size,
+                              size_t *token_size)
+{
+    enum psa_attest_err_t attest_err = PSA_ATTEST_ERR_SUCCESS;
+    struct q_useful_buf_c challenge;
+    struct q_useful_buf token;
+    struct q_useful_buf_c completed_token;
+
+    /* Only the size of the challenge is needed */
+    challenge.ptr = NULL;
+    challenge.len = challenge_size;
+
+    /* Special value to get the size of the token, but token is not created */
+    token.ptr = NULL;
+    token.len = INT32_MAX;
+
+    attest_err = attest_verify_challenge_size(challenge_size);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        goto error;
+    }
+
+    attest_err = attest_compute_token_size(&challenge, token_size);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        /* Fall back to creating the token in size calculation mode */
+        attest_err = attest_create_token(&challenge, &token, &completed_token);
+        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+            goto error;
+        }
+
+        *token_size = completed_token.len;
+    }
+
+error:
+    return error_mapping_to_psa_status_t(attest_err);
+}
+
+#if ATTEST_TOKEN_STREAM_BUF_SIZE > 0
+psa_status_t
+initial_attest_stream_token(const void *challenge_buf, size_t challenge_size,
+                            size_t token_buf_size,
+                            attest_token_write_t write, void *write_ctx,
+                            size_t *token_size)
+{
+    enum psa_attest_err_t attest_err = PSA_ATTEST_ERR_SUCCESS;
+    struct q_useful_buf_c challenge;
+
+    challenge.ptr = challenge_buf;
+    challenge.len = challenge_size;
+
+    attest_err = attest_verify_challenge_size(challenge.len);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        goto error;
+    }
+
+    if (token_buf_size == 0) {
+        attest_err = PSA_ATTEST_ERR_INVALID_INPUT;
+        goto error;
+    }
+
+    attest_err = attest_stream_token(challenge.ptr, challenge.len, 1,
+                                     token_buf_size, write, write_ctx,
+                                     token_size);
+
+error:
+    return error_mapping_to_psa_status_t(attest_err);
+}
+#endif /* ATTEST_TOKEN_STREAM_BUF_SIZE > 0 */
+
+#if ATTEST_TOKEN_BATCH_MAX > 0
+psa_status_t
+initial_attest_get_token_batch(const void *challenges_buf,
+                               size_t challenge_size,
+                               size_t num_tokens,
+                               void *token_buf, size_t token_buf_size,
+                               size_t tokens_size,
+                               attest_token_write_t write, void *write_ctx,
+                               size_t *token_size)
+{
+    enum psa_attest_err_t attest_err = PSA_ATTEST_ERR_SUCCESS;
+#if ATTEST_TOKEN_STREAM_BUF_SIZE == 0
+    struct q_useful_buf token;
+
+    token.ptr = token_buf;
+    token.len = token_buf_size;
+#else
+    /* The tokens are streamed through the window instead */
+    (void)token_buf;
+    (void)token_buf_size;
+#endif
+
+    attest_err = attest_verify_challenge_size(challenge_size);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        goto error;
+    }
+
+    if ((num_tokens == 0) || (num_tokens > ATTEST_TOKEN_BATCH_MAX) ||
+        (tokens_size == 0)) {
+        attest_err = PSA_ATTEST_ERR_INVALID_INPUT;
+        goto error;
+    }
+
+#if ATTEST_TOKEN_STREAM_BUF_SIZE > 0
+    attest_err = attest_create_token_batch(challenges_buf, challenge_size,
+                                           num_tokens, tokens_size,
+                                           write, write_ctx, token_size);
+#else
+    if (token.len == 0) {
+        attest_err = PSA_ATTEST_ERR_INVALID_INPUT;
+        goto error;
+    }
+
+    attest_err = attest_create_token_batch(challenges_buf, challenge_size,
+                                           num_tokens, &token, tokens_size,
+                                           write, write_ctx, token_size);
+#endif
 
 error:
     return error_mapping_to_psa_status_t(attest_err);
 }
+#endif /* ATTEST_TOKEN_BATCH_MAX > 0 */
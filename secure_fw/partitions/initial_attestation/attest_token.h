@@ -12,6 +12,7 @@
 #ifndef __ATTEST_TOKEN_H__
 #define __ATTEST_TOKEN_H__
 
+#include <stddef.h>
 #include <stdint.h>
 #include "qcbor.h"
 #ifdef SYMMETRIC_INITIAL_ATTESTATION
@@ -19,6 +20,7 @@
 #else
 #include "t_cose_sign1_sign.h"
 #endif
+#include "psa/crypto.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -251,6 +253,246 @@ enum attest_token_err_t
 attest_token_encode_finish(struct attest_token_encode_ctx *me,
                            struct q_useful_buf_c *completed_token);
 
+/**
+ * \brief Function called to write the next bytes of a streamed token
+ *        to its destination.
+ *
+ * \param[in] write_ctx  Context given to attest_token_stream_sign().
+ * \param[in] buf        Next bytes of the token.
+ * \param[in] len        Number of bytes in \p buf.
+ */
+typedef void (*attest_token_write_t)(void *write_ctx,
+                                     const uint8_t *buf,
+                                     size_t len);
+
+/**
+ * The context for streaming an attestation token out instead of
+ * creating it in a buffer. The payload is passed twice: first to
+ * compute the signature with an incremental hash (or MAC), then to
+ * write it out between the COSE headers and the signature. Nothing is
+ * written until the signature is computed, and nothing can fail once
+ * it is, so a token is either written whole or not at all. The payload
+ * length must be known before starting.
+ *
+ * The structure is opaque for the caller.
+ */
+struct attest_token_stream_ctx {
+    /* Private data structure */
+    struct attest_token_encode_ctx encode_ctx;
+    int32_t                        cose_alg_id;
+    struct q_useful_buf_c          headers;
+    struct q_useful_buf            sig_buf;
+    size_t                         sig_len;
+    size_t                         payload_len;
+    size_t                         payload_left;
+    size_t                         token_len;
+    attest_token_write_t           write;
+    void                          *write_ctx;
+    psa_hash_operation_t           hash_op;
+#ifdef SYMMETRIC_INITIAL_ATTESTATION
+    psa_mac_operation_t            mac_op;
+#endif
+};
+
+/**
+ * \brief Start streaming a token out.
+ *
+ * \param[in] me           The token streaming context to be initialized.
+ * \param[in] opt_flags    Flags to select different custom options,
+ *                         for example \ref TOKEN_OPT_SHORT_CIRCUIT_SIGN.
+ * \param[in] key_select   Selects which attestation key to sign with.
+ * \param[in] cose_alg_id  The algorithm to sign with.
+ * \param[in,out] window   Buffer holding the COSE headers and the
+ *                         signature until they are written. On return
+ *                         it is the part of it which is left.
+ *
+ * \return one of the \ref attest_token_err_t errors.
+ *
+ * \ref ATTEST_TOKEN_ERR_TOO_SMALL is returned if \p window is too small.
+ */
+enum attest_token_err_t
+attest_token_stream_start(struct attest_token_stream_ctx *me,
+                          uint32_t opt_flags,
+                          int32_t key_select,
+                          int32_t cose_alg_id,
+                          struct q_useful_buf *window);
+
+/**
+ * \brief Start the signature of a streamed token.
+ *
+ * \param[in] me           Token streaming context.
+ * \param[in] payload_len  Exact length of the encoded payload.
+ * \param[in] max_len      Number of bytes the destination accepts.
+ *
+ * \return one of the \ref attest_token_err_t errors.
+ *
+ * \ref ATTEST_TOKEN_ERR_TOO_SMALL is returned if the token is longer
+ * than \p max_len.
+ *
+ * Once attest_token_stream_finish() has returned, this can be called
+ * again to stream another token with the same COSE headers.
+ */
+enum attest_token_err_t
+attest_token_stream_digest_start(struct attest_token_stream_ctx *me,
+                                 size_t payload_len,
+                                 size_t max_len);
+
+/**
+ * \brief Add the next bytes of the payload to the signature
+ *
+ * \param[in] me     Token streaming context.
+ * \param[in] bytes  The next encoded bytes of the payload.
+ *
+ * \return one of the \ref attest_token_err_t errors.
+ */
+enum attest_token_err_t
+attest_token_stream_digest(struct attest_token_stream_ctx *me,
+                           const struct q_useful_buf_c *bytes);
+
+/**
+ * \brief Compute the signature and start writing the token out
+ *
+ * \param[in] me         Token streaming context.
+ * \param[in] write      Function writing the token to its destination.
+ * \param[in] write_ctx  Context passed to \p write.
+ *
+ * \return one of the \ref attest_token_err_t errors.
+ *
+ * Once the whole payload was added to the signature, this computes it.
+ * On success, the COSE headers and the head of the payload byte string
+ * are written, and the same payload must then be passed again to
+ * attest_token_stream_payload().
+ */
+enum attest_token_err_t
+attest_token_stream_sign(struct attest_token_stream_ctx *me,
+                         attest_token_write_t write,
+                         void *write_ctx);
+
+/**
+ * \brief Write the next bytes of the payload out
+ *
+ * \param[in] me     Token streaming context.
+ * \param[in] bytes  The next encoded bytes of the payload.
+ *
+ * \return one of the \ref attest_token_err_t errors.
+ */
+enum attest_token_err_t
+attest_token_stream_payload(struct attest_token_stream_ctx *me,
+                            const struct q_useful_buf_c *bytes);
+
+/**
+ * \brief Finish streaming the token out
+ *
+ * \param[in] me          Token streaming context.
+ * \param[out] token_len  Length of the streamed token.
+ *
+ * \return one of the \ref attest_token_err_t errors.
+ *
+ * This writes the signature once the whole payload has been written.
+ */
+enum attest_token_err_t
+attest_token_stream_finish(struct attest_token_stream_ctx *me,
+                           size_t *token_len);
+
+/**
+ * \brief Abort streaming the token out
+ *
+ * \param[in] me  Token streaming context.
+ *
+ * This releases the crypto operation of the signature when streaming
+ * fails after attest_token_stream_start() was called. It does nothing
+ * once attest_token_stream_sign() has succeeded.
+ */
+void attest_token_stream_abort(struct attest_token_stream_ctx *me);
+
+/**
+ * The context for creating a batch of tokens that only differ in the
+ * last bytes of their payload, the tail. The first token is created
+ * with the encode functions, and each next token reuses its headers
+ * and payload with its own tail and signature.
+ */
+struct attest_token_batch_ctx {
+    /* Private data structure */
+    struct attest_token_stream_ctx common_ctx;
+    struct attest_token_stream_ctx next_ctx;
+    uint8_t *token;
+    size_t headers_len;
+    size_t payload_offset;
+    size_t payload_len;
+    size_t tail_len;
+};
+
+/**
+ * \brief Start creating the first token of a batch.
+ *
+ * \param[in] me           The token batch context to be initialized.
+ * \param[in] opt_flags    Flags to select different custom options,
+ *                         for example \ref TOKEN_OPT_OMIT_CLAIMS.
+ * \param[in] key_select   Selects which attestation key to sign with.
+ * \param[in] cose_alg_id  The algorithm to sign with. The IDs are
+ *                         defined in [COSE (RFC 8152)]
+ *                         (https://tools.ietf.org/html/rfc8152) or
+ *                         in the [IANA COSE Registry]
+ *                         (https://www.iana.org/assignments/cose/cose.xhtml).
+ * \param[in] out_buf      The output buffer where each token of the
+ *                         batch is created in turn.
+ *
+ * \return one of the \ref attest_token_err_t errors.
+ *
+ * The claims of the first token are then added to the encode context
+ * of \c common_ctx, the ones that differ between the tokens last.
+ */
+enum attest_token_err_t
+attest_token_batch_start(struct attest_token_batch_ctx *me,
+                         uint32_t opt_flags,
+                         int32_t key_select,
+                         int32_t cose_alg_id,
+                         const struct q_useful_buf *out_buf);
+
+/**
+ * \brief Finish the first token of a batch.
+ *
+ * \param[in] me                Token batch context.
+ * \param[in] tail_len          Number of bytes at the end of the payload
+ *                              that differ between the tokens.
+ * \param[out] completed_token  Pointer and length of the first token.
+ *
+ * \return one of the \ref attest_token_err_t errors.
+ *
+ * The digest of the part common to all the tokens is computed here,
+ * when the signing algorithm allows it to be reused.
+ */
+enum attest_token_err_t
+attest_token_batch_finish(struct attest_token_batch_ctx *me,
+                          size_t tail_len,
+                          struct q_useful_buf_c *completed_token);
+
+/**
+ * \brief Create the next token of a batch.
+ *
+ * \param[in] me                Token batch context.
+ * \param[in] tail              The last bytes of the payload of the token.
+ * \param[out] completed_token  Pointer and length of the token.
+ *
+ * \return one of the \ref attest_token_err_t errors.
+ *
+ * The token replaces the previous one in the output buffer.
+ */
+enum attest_token_err_t
+attest_token_batch_next(struct attest_token_batch_ctx *me,
+                        const struct q_useful_buf_c *tail,
+                        struct q_useful_buf_c *completed_token);
+
+/**
+ * \brief End a batch of tokens
+ *
+ * \param[in] me  Token batch context.
+ *
+ * This releases the crypto operation holding the digest of the common
+ * part. It must be called once attest_token_batch_start() was called.
+ */
+void attest_token_batch_end(struct attest_token_batch_ctx *me);
+
 #ifdef __cplusplus
 }
 #endif
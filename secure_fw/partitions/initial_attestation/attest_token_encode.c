@@ -9,6 +9,7 @@
  * See BSD-3-Clause license in README.md
  */
 
+#include <string.h>
 #include "attest_token.h"
 #include "config_attest.h"
 #include "qcbor.h"
@@ -16,6 +17,7 @@
 #include "t_cose_mac0_sign.h"
 #else
 #include "t_cose_sign1_sign.h"
+#include "t_cose_crypto.h"
 #endif
 #include "t_cose_common.h"
 #include "q_useful_buf.h"
@@ -59,6 +61,30 @@ static enum attest_token_err_t t_cose_err_to_attest_err(enum t_cose_err_t err)
     }
 }
 
+#if (ATTEST_TOKEN_STREAM_BUF_SIZE > 0) || (ATTEST_TOKEN_BATCH_MAX > 0)
+/**
+ * \brief Map PSA Crypto error to attestation token error.
+ *
+ * \param[in] status   The PSA Crypto error to map.
+ *
+ * \return the attestation token error.
+ */
+static enum attest_token_err_t psa_err_to_attest_err(psa_status_t status)
+{
+    switch (status) {
+
+    case PSA_SUCCESS:
+        return ATTEST_TOKEN_ERR_SUCCESS;
+
+    case PSA_ERROR_NOT_SUPPORTED:
+        return ATTEST_TOKEN_ERR_HASH_UNAVAILABLE;
+
+    default:
+        return ATTEST_TOKEN_ERR_GENERAL;
+    }
+}
+#endif /* (ATTEST_TOKEN_STREAM_BUF_SIZE > 0) || (ATTEST_TOKEN_BATCH_MAX > 0) */
+
 #ifdef SYMMETRIC_INITIAL_ATTESTATION
 /*
  * Outline of token creation. Much of this occurs inside
@@ -190,6 +216,146 @@ attest_token_encode_finish(struct attest_token_encode_ctx *me,
 Done:
     return return_value;
 }
+#if (ATTEST_TOKEN_STREAM_BUF_SIZE > 0) || (ATTEST_TOKEN_BATCH_MAX > 0)
+/*
+ * Static function to get the hash algorithm of a HMAC algorithm, which is
+ * also the one of the short-circuit tag.
+ */
+static psa_algorithm_t stream_hash_alg(int32_t cose_alg_id)
+{
+    switch (cose_alg_id) {
+    case T_COSE_ALGORITHM_HMAC256:
+        return PSA_ALG_SHA_256;
+    case T_COSE_ALGORITHM_HMAC384:
+        return PSA_ALG_SHA_384;
+    case T_COSE_ALGORITHM_HMAC512:
+        return PSA_ALG_SHA_512;
+    default:
+        return PSA_ALG_NONE;
+    }
+}
+
+/*
+ * Static function to get the size of the authentication tag of a streamed
+ * token.
+ */
+static enum attest_token_err_t
+stream_sig_size(struct attest_token_stream_ctx *me, size_t *sig_len)
+{
+    psa_algorithm_t hash_alg = stream_hash_alg(me->cose_alg_id);
+
+    if (hash_alg == PSA_ALG_NONE) {
+        return ATTEST_TOKEN_ERR_UNSUPPORTED_SIG_ALG;
+    }
+
+    /* The tag is as long as the hash, whether it is short-circuit or not */
+    *sig_len = PSA_HASH_LENGTH(hash_alg);
+
+    return ATTEST_TOKEN_ERR_SUCCESS;
+}
+
+/*
+ * Static function to start the MAC of a streamed token. The head of the
+ * ToBeMaced structure, up to the head of the payload, is MACed here and
+ * the payload is MACed as it is streamed.
+ */
+static enum attest_token_err_t
+stream_digest_start(struct attest_token_stream_ctx *me, size_t payload_len)
+{
+    Q_USEFUL_BUF_MAKE_STACK_UB(tbm_head_buf, T_COSE_MAC0_MAX_SIZE_TBM_HEAD);
+    psa_algorithm_t hash_alg = stream_hash_alg(me->cose_alg_id);
+    struct q_useful_buf_c tbm_head;
+    enum t_cose_err_t cose_ret;
+    psa_status_t status;
+
+    cose_ret = t_cose_mac0_encode_tbm_head(&(me->encode_ctx.mac_ctx),
+                                           payload_len,
+                                           tbm_head_buf,
+                                           &tbm_head);
+    if (cose_ret != T_COSE_SUCCESS) {
+        return t_cose_err_to_attest_err(cose_ret);
+    }
+
+    if (me->encode_ctx.opt_flags & TOKEN_OPT_SHORT_CIRCUIT_SIGN) {
+        /* The short-circuit tag is a hash instead of a HMAC */
+        status = psa_hash_setup(&(me->hash_op), hash_alg);
+        if (status == PSA_SUCCESS) {
+            status = psa_hash_update(&(me->hash_op),
+                                     tbm_head.ptr, tbm_head.len);
+        }
+
+        return psa_err_to_attest_err(status);
+    }
+
+    status = psa_mac_sign_setup(&(me->mac_op),
+                                TFM_BUILTIN_KEY_ID_IAK,
+                                PSA_ALG_HMAC(hash_alg));
+    if (status == PSA_SUCCESS) {
+        status = psa_mac_update(&(me->mac_op), tbm_head.ptr, tbm_head.len);
+    }
+
+    return psa_err_to_attest_err(status);
+}
+
+/*
+ * Static function to MAC the next bytes of the payload of a streamed token.
+ */
+static enum attest_token_err_t
+stream_digest_update(struct attest_token_stream_ctx *me,
+                     const struct q_useful_buf_c *bytes)
+{
+    psa_status_t status;
+
+    if (me->encode_ctx.opt_flags & TOKEN_OPT_SHORT_CIRCUIT_SIGN) {
+        status = psa_hash_update(&(me->hash_op), bytes->ptr, bytes->len);
+    } else {
+        status = psa_mac_update(&(me->mac_op), bytes->ptr, bytes->len);
+    }
+
+    return psa_err_to_attest_err(status);
+}
+
+/*
+ * Static function to finish the authentication tag of a streamed token.
+ */
+static enum attest_token_err_t
+stream_digest_sign(struct attest_token_stream_ctx *me,
+                   struct q_useful_buf sig_buf,
+                   struct q_useful_buf_c *sig)
+{
+    psa_status_t status;
+
+    if (me->encode_ctx.opt_flags & TOKEN_OPT_SHORT_CIRCUIT_SIGN) {
+        status = psa_hash_finish(&(me->hash_op),
+                                 sig_buf.ptr, sig_buf.len, &(sig->len));
+    } else {
+        status = psa_mac_sign_finish(&(me->mac_op),
+                                     sig_buf.ptr, sig_buf.len, &(sig->len));
+    }
+    sig->ptr = sig_buf.ptr;
+
+    return psa_err_to_attest_err(status);
+}
+
+/*
+ * Static function to initialize the MAC operations of a streamed token, so
+ * that they can be aborted whether they were started or not.
+ */
+static void stream_digest_init(struct attest_token_stream_ctx *me)
+{
+    me->hash_op = psa_hash_operation_init();
+    me->mac_op = psa_mac_operation_init();
+}
+
+/*
+ * Static function to release the MAC operations of a streamed token.
+ */
+static void stream_digest_abort(struct attest_token_stream_ctx *me)
+{
+    (void)psa_hash_abort(&(me->hash_op));
+    (void)psa_mac_abort(&(me->mac_op));
+}
+#endif /* (ATTEST_TOKEN_STREAM_BUF_SIZE > 0) || (ATTEST_TOKEN_BATCH_MAX > 0) */
 #else /* SYMMETRIC_INITIAL_ATTESTATION */
 /*
  * Outline of token creation. Much of this occurs inside
@@ -319,6 +485,148 @@ attest_token_encode_finish(struct attest_token_encode_ctx *me,
 Done:
         return return_value;
 }
+#if (ATTEST_TOKEN_STREAM_BUF_SIZE > 0) || (ATTEST_TOKEN_BATCH_MAX > 0)
+/* Largest hash of the to-be-signed bytes of a streamed token */
+#define STREAM_HASH_MAX_SIZE PSA_HASH_LENGTH(PSA_ALG_SHA_512)
+
+/*
+ * Static function to get the hash algorithm of a signing algorithm
+ */
+static psa_algorithm_t stream_hash_alg(int32_t cose_alg_id)
+{
+    switch (cose_alg_id) {
+    case T_COSE_ALGORITHM_ES256:
+        return PSA_ALG_SHA_256;
+    case T_COSE_ALGORITHM_ES384:
+        return PSA_ALG_SHA_384;
+    case T_COSE_ALGORITHM_ES512:
+        return PSA_ALG_SHA_512;
+    default:
+        return PSA_ALG_NONE;
+    }
+}
+
+/*
+ * Static function to get the size of the signature of a streamed token.
+ */
+static enum attest_token_err_t
+stream_sig_size(struct attest_token_stream_ctx *me, size_t *sig_len)
+{
+    enum t_cose_err_t cose_ret;
+
+    /* A real signature is sized from the attestation key, as t_cose does,
+     * since the test options select ES256 whatever the curve of the key.
+     */
+    if (!(me->encode_ctx.opt_flags & TOKEN_OPT_SHORT_CIRCUIT_SIGN)) {
+        cose_ret = t_cose_crypto_sig_size(me->cose_alg_id,
+                                          me->encode_ctx.signer_ctx.signing_key,
+                                          sig_len);
+        return t_cose_err_to_attest_err(cose_ret);
+    }
+
+    /* The size of a short-circuit signature only depends on the COSE
+     * algorithm.
+     */
+    switch (me->cose_alg_id) {
+    case T_COSE_ALGORITHM_ES256:
+        *sig_len = PSA_ECDSA_SIGNATURE_SIZE(256);
+        break;
+    case T_COSE_ALGORITHM_ES384:
+        *sig_len = PSA_ECDSA_SIGNATURE_SIZE(384);
+        break;
+    case T_COSE_ALGORITHM_ES512:
+        *sig_len = PSA_ECDSA_SIGNATURE_SIZE(521);
+        break;
+    default:
+        return ATTEST_TOKEN_ERR_UNSUPPORTED_SIG_ALG;
+    }
+
+    return ATTEST_TOKEN_ERR_SUCCESS;
+}
+
+/*
+ * Static function to start the hash of a streamed token. The head of the
+ * Sig_structure, up to the head of the payload, is hashed here and the
+ * payload is hashed as it is streamed.
+ */
+static enum attest_token_err_t
+stream_digest_start(struct attest_token_stream_ctx *me, size_t payload_len)
+{
+    Q_USEFUL_BUF_MAKE_STACK_UB(tbs_head_buf, T_COSE_SIGN1_MAX_SIZE_TBS_HEAD);
+    struct q_useful_buf_c tbs_head;
+    enum t_cose_err_t cose_ret;
+    psa_status_t status;
+
+    cose_ret = t_cose_sign1_encode_tbs_head(&(me->encode_ctx.signer_ctx),
+                                            payload_len,
+                                            tbs_head_buf,
+                                            &tbs_head);
+    if (cose_ret != T_COSE_SUCCESS) {
+        return t_cose_err_to_attest_err(cose_ret);
+    }
+
+    status = psa_hash_setup(&(me->hash_op), stream_hash_alg(me->cose_alg_id));
+    if (status == PSA_SUCCESS) {
+        status = psa_hash_update(&(me->hash_op), tbs_head.ptr, tbs_head.len);
+    }
+
+    return psa_err_to_attest_err(status);
+}
+
+/*
+ * Static function to hash the next bytes of the payload of a streamed token.
+ */
+static enum attest_token_err_t
+stream_digest_update(struct attest_token_stream_ctx *me,
+                     const struct q_useful_buf_c *bytes)
+{
+    return psa_err_to_attest_err(psa_hash_update(&(me->hash_op),
+                                                 bytes->ptr, bytes->len));
+}
+
+/*
+ * Static function to sign the hash of a streamed token.
+ */
+static enum attest_token_err_t
+stream_digest_sign(struct attest_token_stream_ctx *me,
+                   struct q_useful_buf sig_buf,
+                   struct q_useful_buf_c *sig)
+{
+    uint8_t hash_buf[STREAM_HASH_MAX_SIZE];
+    struct q_useful_buf_c hash = {hash_buf, 0};
+    psa_status_t status;
+
+    status = psa_hash_finish(&(me->hash_op),
+                             hash_buf, sizeof(hash_buf), &(hash.len));
+    if (status != PSA_SUCCESS) {
+        return psa_err_to_attest_err(status);
+    }
+
+    /* t_cose signs it, with the short-circuit signature if selected */
+    return t_cose_err_to_attest_err(
+                t_cose_sign1_sign_hash(&(me->encode_ctx.signer_ctx),
+                                       hash,
+                                       sig_buf,
+                                       sig));
+}
+
+/*
+ * Static function to initialize the hash operation of a streamed token, so
+ * that it can be aborted whether it was started or not.
+ */
+static void stream_digest_init(struct attest_token_stream_ctx *me)
+{
+    me->hash_op = psa_hash_operation_init();
+}
+
+/*
+ * Static function to release the hash operation of a streamed token.
+ */
+static void stream_digest_abort(struct attest_token_stream_ctx *me)
+{
+    (void)psa_hash_abort(&(me->hash_op));
+}
+#endif /* (ATTEST_TOKEN_STREAM_BUF_SIZE > 0) || (ATTEST_TOKEN_BATCH_MAX > 0) */
 #endif /* SYMMETRIC_INITIAL_ATTESTATION */
 
 /*
@@ -375,3 +683,498 @@ void attest_token_encode_add_cbor(struct attest_token_encode_ctx *me,
 {
     QCBOREncode_AddEncodedToMapN(&(me->cbor_enc_ctx), label, *encoded);
 }
+
+
+#if (ATTEST_TOKEN_STREAM_BUF_SIZE > 0) || (ATTEST_TOKEN_BATCH_MAX > 0)
+/* Longest head of a CBOR data item */
+#define CBOR_HEAD_MAX_SIZE 9
+
+/*
+ * Static function to encode the head of a byte string of len bytes
+ */
+static enum attest_token_err_t
+encode_bstr_head(struct q_useful_buf head_buf,
+                 size_t len,
+                 struct q_useful_buf_c *head)
+{
+    QCBOREncodeContext    cbor_encode_ctx;
+    struct q_useful_buf_c content = {NULL, len};
+
+    QCBOREncode_Init(&cbor_encode_ctx, head_buf);
+    QCBOREncode_AddBytesLenOnly(&cbor_encode_ctx, content);
+    if (QCBOREncode_Finish(&cbor_encode_ctx, head) != QCBOR_SUCCESS) {
+        return ATTEST_TOKEN_ERR_CBOR_FORMATTING;
+    }
+
+    return ATTEST_TOKEN_ERR_SUCCESS;
+}
+
+/*
+ * Static function to get the length of a CBOR head from its first byte, 0 if
+ * it is not a definite length head.
+ */
+static size_t cbor_head_len(uint8_t initial_byte)
+{
+    uint8_t additional_info = initial_byte & 0x1F;
+
+    if (additional_info < 24) {
+        return 1;
+    } else if (additional_info <= 27) {
+        /* Followed by a 1, 2, 4 or 8 bytes argument */
+        return 1 + ((size_t)1 << (additional_info - 24));
+    }
+
+    return 0;
+}
+
+/*
+ * Static function to get the length of the COSE headers of a token. A token
+ * with an empty payload is started in the window. The COSE headers are the
+ * bytes before the head of the payload byte string, whatever the payload is.
+ *
+ * QCBOR only inserts the head of an array when the array is closed, and the
+ * COSE array of a streamed token is never closed. So the token is started
+ * one byte into the window, and the tag is moved down to make room for the
+ * head of the array, which always has 4 items. The protected headers, which
+ * t_cose keeps a pointer to, stay where they were encoded.
+ */
+static enum attest_token_err_t
+encode_headers(struct attest_token_encode_ctx *me,
+               uint32_t opt_flags,
+               int32_t key_select,
+               int32_t cose_alg_id,
+               const struct q_useful_buf *window,
+               size_t *headers_len)
+{
+    enum attest_token_err_t return_value;
+    struct q_useful_buf_c wrapped_payload;
+    struct q_useful_buf after_head;
+    QCBORError qcbor_result;
+    uint8_t *headers = window->ptr;
+    size_t tag_len = 0;
+
+    if (window->len == 0) {
+        return ATTEST_TOKEN_ERR_TOO_SMALL;
+    }
+    after_head.ptr = headers + 1;
+    after_head.len = window->len - 1;
+
+    return_value = attest_token_encode_start(me,
+                                             opt_flags,
+                                             key_select,
+                                             cose_alg_id,
+                                             &after_head);
+    if (return_value != ATTEST_TOKEN_ERR_SUCCESS) {
+        return return_value;
+    }
+
+    QCBOREncode_CloseMap(&(me->cbor_enc_ctx));
+    QCBOREncode_CloseBstrWrap(&(me->cbor_enc_ctx), &wrapped_payload);
+    qcbor_result = QCBOREncode_GetErrorState(&(me->cbor_enc_ctx));
+    if (qcbor_result == QCBOR_ERR_BUFFER_TOO_SMALL) {
+        /* The window is too small for the headers */
+        return ATTEST_TOKEN_ERR_TOO_SMALL;
+    } else if (qcbor_result != QCBOR_SUCCESS) {
+        return ATTEST_TOKEN_ERR_CBOR_FORMATTING;
+    }
+    *headers_len = (size_t)((const uint8_t *)wrapped_payload.ptr - headers);
+
+    /* The tag (major type 6), if any, goes before the array (major type 4) */
+    if ((*headers_len > 1) && ((headers[1] >> 5) == 6)) {
+        tag_len = cbor_head_len(headers[1]);
+        if ((tag_len == 0) || (tag_len >= *headers_len)) {
+            return ATTEST_TOKEN_ERR_CBOR_FORMATTING;
+        }
+        memmove(headers, headers + 1, tag_len);
+    }
+    headers[tag_len] = 0x84;
+
+    return ATTEST_TOKEN_ERR_SUCCESS;
+}
+#endif /* (ATTEST_TOKEN_STREAM_BUF_SIZE > 0) || (ATTEST_TOKEN_BATCH_MAX > 0) */
+
+#if ATTEST_TOKEN_STREAM_BUF_SIZE > 0
+/*
+ * Public function. See attest_token.h
+ */
+enum attest_token_err_t
+attest_token_stream_start(struct attest_token_stream_ctx *me,
+                          uint32_t opt_flags,
+                          int32_t key_select,
+                          int32_t cose_alg_id,
+                          struct q_useful_buf *window)
+{
+    enum attest_token_err_t return_value;
+    size_t headers_len;
+
+    stream_digest_init(me);
+    me->cose_alg_id = cose_alg_id;
+
+    return_value = encode_headers(&(me->encode_ctx),
+                                  opt_flags,
+                                  key_select,
+                                  cose_alg_id,
+                                  window,
+                                  &headers_len);
+    if (return_value != ATTEST_TOKEN_ERR_SUCCESS) {
+        return return_value;
+    }
+
+    return_value = stream_sig_size(me, &(me->sig_len));
+    if (return_value != ATTEST_TOKEN_ERR_SUCCESS) {
+        return return_value;
+    }
+
+    /* The signature is kept after the headers until it is written */
+    if (me->sig_len > window->len - headers_len) {
+        return ATTEST_TOKEN_ERR_TOO_SMALL;
+    }
+    me->headers.ptr = window->ptr;
+    me->headers.len = headers_len;
+    me->sig_buf.ptr = (uint8_t *)window->ptr + headers_len;
+    me->sig_buf.len = me->sig_len;
+
+    window->ptr = (uint8_t *)me->sig_buf.ptr + me->sig_len;
+    window->len -= headers_len + me->sig_len;
+
+    return ATTEST_TOKEN_ERR_SUCCESS;
+}
+
+/*
+ * Public function. See attest_token.h
+ */
+enum attest_token_err_t
+attest_token_stream_digest_start(struct attest_token_stream_ctx *me,
+                                 size_t payload_len,
+                                 size_t max_len)
+{
+    enum attest_token_err_t return_value;
+    Q_USEFUL_BUF_MAKE_STACK_UB(head_buf, CBOR_HEAD_MAX_SIZE);
+    struct q_useful_buf_c head;
+
+    return_value = encode_bstr_head(head_buf, me->sig_len, &head);
+    if (return_value != ATTEST_TOKEN_ERR_SUCCESS) {
+        return return_value;
+    }
+    me->token_len = head.len + me->sig_len;
+
+    return_value = encode_bstr_head(head_buf, payload_len, &head);
+    if (return_value != ATTEST_TOKEN_ERR_SUCCESS) {
+        return return_value;
+    }
+    me->token_len += me->headers.len + head.len + payload_len;
+
+    if (me->token_len > max_len) {
+        return ATTEST_TOKEN_ERR_TOO_SMALL;
+    }
+
+    me->payload_len  = payload_len;
+    me->payload_left = payload_len;
+
+    return stream_digest_start(me, payload_len);
+}
+
+/*
+ * Public function. See attest_token.h
+ */
+enum attest_token_err_t
+attest_token_stream_digest(struct attest_token_stream_ctx *me,
+                           const struct q_useful_buf_c *bytes)
+{
+    if (bytes->len > me->payload_left) {
+        return ATTEST_TOKEN_ERR_CBOR_FORMATTING;
+    }
+    me->payload_left -= bytes->len;
+
+    return stream_digest_update(me, bytes);
+}
+
+/*
+ * Public function. See attest_token.h
+ */
+enum attest_token_err_t
+attest_token_stream_sign(struct attest_token_stream_ctx *me,
+                         attest_token_write_t write,
+                         void *write_ctx)
+{
+    enum attest_token_err_t return_value;
+    Q_USEFUL_BUF_MAKE_STACK_UB(head_buf, CBOR_HEAD_MAX_SIZE);
+    struct q_useful_buf_c sig;
+    struct q_useful_buf_c head;
+
+    if (me->payload_left != 0) {
+        /* The payload is shorter than announced */
+        return ATTEST_TOKEN_ERR_CBOR_FORMATTING;
+    }
+
+    return_value = stream_digest_sign(me, me->sig_buf, &sig);
+    if (return_value != ATTEST_TOKEN_ERR_SUCCESS) {
+        return return_value;
+    }
+
+    if (sig.len != me->sig_len) {
+        return ATTEST_TOKEN_ERR_GENERAL;
+    }
+
+    return_value = encode_bstr_head(head_buf, me->payload_len, &head);
+    if (return_value != ATTEST_TOKEN_ERR_SUCCESS) {
+        return return_value;
+    }
+
+    me->write        = write;
+    me->write_ctx    = write_ctx;
+    me->payload_left = me->payload_len;
+
+    me->write(me->write_ctx, me->headers.ptr, me->headers.len);
+    me->write(me->write_ctx, head.ptr, head.len);
+
+    return ATTEST_TOKEN_ERR_SUCCESS;
+}
+
+/*
+ * Public function. See attest_token.h
+ */
+enum attest_token_err_t
+attest_token_stream_payload(struct attest_token_stream_ctx *me,
+                            const struct q_useful_buf_c *bytes)
+{
+    if (bytes->len > me->payload_left) {
+        return ATTEST_TOKEN_ERR_CBOR_FORMATTING;
+    }
+    me->payload_left -= bytes->len;
+
+    me->write(me->write_ctx, bytes->ptr, bytes->len);
+
+    return ATTEST_TOKEN_ERR_SUCCESS;
+}
+
+/*
+ * Public function. See attest_token.h
+ */
+enum attest_token_err_t
+attest_token_stream_finish(struct attest_token_stream_ctx *me,
+                           size_t *token_len)
+{
+    enum attest_token_err_t return_value;
+    Q_USEFUL_BUF_MAKE_STACK_UB(head_buf, CBOR_HEAD_MAX_SIZE);
+    struct q_useful_buf_c head;
+
+    if (me->payload_left != 0) {
+        /* The payload is shorter than the signed one */
+        return ATTEST_TOKEN_ERR_CBOR_FORMATTING;
+    }
+
+    return_value = encode_bstr_head(head_buf, me->sig_len, &head);
+    if (return_value != ATTEST_TOKEN_ERR_SUCCESS) {
+        return return_value;
+    }
+
+    me->write(me->write_ctx, head.ptr, head.len);
+    me->write(me->write_ctx, me->sig_buf.ptr, me->sig_len);
+
+    *token_len = me->token_len;
+
+    return ATTEST_TOKEN_ERR_SUCCESS;
+}
+
+/*
+ * Public function. See attest_token.h
+ */
+void attest_token_stream_abort(struct attest_token_stream_ctx *me)
+{
+    stream_digest_abort(me);
+}
+#endif /* ATTEST_TOKEN_STREAM_BUF_SIZE > 0 */
+
+#if ATTEST_TOKEN_BATCH_MAX > 0
+/*
+ * Static function to digest the part of the to-be-signed bytes that is
+ * common to all the tokens of a batch. That is everything up to the tail of
+ * the payload.
+ */
+static enum attest_token_err_t
+batch_digest_common(struct attest_token_batch_ctx *me,
+                    struct attest_token_stream_ctx *digest_ctx)
+{
+    enum attest_token_err_t return_value;
+    struct q_useful_buf_c common_part;
+
+    return_value = stream_digest_start(digest_ctx, me->payload_len);
+    if (return_value != ATTEST_TOKEN_ERR_SUCCESS) {
+        return return_value;
+    }
+
+    common_part.ptr = me->token + me->payload_offset;
+    common_part.len = me->payload_len - me->tail_len;
+
+    return stream_digest_update(digest_ctx, &common_part);
+}
+
+/*
+ * Static function to start the digest of the next token of a batch, up to
+ * the tail of its payload.
+ */
+static enum attest_token_err_t
+batch_digest_start(struct attest_token_batch_ctx *me,
+                   struct attest_token_stream_ctx *token_ctx)
+{
+#ifdef SYMMETRIC_INITIAL_ATTESTATION
+    /* MAC operations can't be cloned, the common part is MACed again */
+    return batch_digest_common(me, token_ctx);
+#else
+    /* The hash of the common part is computed once, and cloned */
+    return psa_err_to_attest_err(psa_hash_clone(&(me->common_ctx.hash_op),
+                                                &(token_ctx->hash_op)));
+#endif
+}
+
+/*
+ * Public function. See attest_token.h
+ */
+enum attest_token_err_t
+attest_token_batch_start(struct attest_token_batch_ctx *me,
+                         uint32_t opt_flags,
+                         int32_t key_select,
+                         int32_t cose_alg_id,
+                         const struct q_useful_buf *out_buf)
+{
+    enum attest_token_err_t return_value;
+
+    stream_digest_init(&(me->common_ctx));
+    me->common_ctx.cose_alg_id = cose_alg_id;
+    me->token = out_buf->ptr;
+
+    /* The headers are the same for all the tokens of the batch. The first
+     * token then overwrites the empty one in the buffer.
+     */
+    return_value = encode_headers(&(me->common_ctx.encode_ctx),
+                                  opt_flags,
+                                  key_select,
+                                  cose_alg_id,
+                                  out_buf,
+                                  &(me->headers_len));
+    if (return_value != ATTEST_TOKEN_ERR_SUCCESS) {
+        return return_value;
+    }
+
+    return attest_token_encode_start(&(me->common_ctx.encode_ctx),
+                                     opt_flags,
+                                     key_select,
+                                     cose_alg_id,
+                                     out_buf);
+}
+
+/*
+ * Public function. See attest_token.h
+ */
+enum attest_token_err_t
+attest_token_batch_finish(struct attest_token_batch_ctx *me,
+                          size_t tail_len,
+                          struct q_useful_buf_c *completed_token)
+{
+    enum attest_token_err_t return_value;
+    Q_USEFUL_BUF_MAKE_STACK_UB(head_buf, CBOR_HEAD_MAX_SIZE);
+    struct q_useful_buf_c head;
+    size_t payload_head_len;
+    size_t payload_end;
+
+    return_value = attest_token_encode_finish(&(me->common_ctx.encode_ctx),
+                                              completed_token);
+    if (return_value != ATTEST_TOKEN_ERR_SUCCESS) {
+        return return_value;
+    }
+
+    return_value = stream_sig_size(&(me->common_ctx),
+                                   &(me->common_ctx.sig_len));
+    if (return_value != ATTEST_TOKEN_ERR_SUCCESS) {
+        return return_value;
+    }
+
+    return_value = encode_bstr_head(head_buf, me->common_ctx.sig_len, &head);
+    if (return_value != ATTEST_TOKEN_ERR_SUCCESS) {
+        return return_value;
+    }
+
+    /* The payload byte string is between the headers and the signature */
+    if (completed_token->len <= me->headers_len + head.len +
+                                me->common_ctx.sig_len) {
+        return ATTEST_TOKEN_ERR_GENERAL;
+    }
+    payload_end = completed_token->len - head.len - me->common_ctx.sig_len;
+    payload_head_len = cbor_head_len(me->token[me->headers_len]);
+    if ((payload_head_len == 0) ||
+        (me->headers_len + payload_head_len + tail_len > payload_end)) {
+        return ATTEST_TOKEN_ERR_GENERAL;
+    }
+
+    me->common_ctx.token_len = completed_token->len;
+    me->payload_offset = me->headers_len + payload_head_len;
+    me->payload_len = payload_end - me->payload_offset;
+    me->tail_len = tail_len;
+
+#ifdef SYMMETRIC_INITIAL_ATTESTATION
+    return ATTEST_TOKEN_ERR_SUCCESS;
+#else
+    return batch_digest_common(me, &(me->common_ctx));
+#endif
+}
+
+/*
+ * Public function. See attest_token.h
+ */
+enum attest_token_err_t
+attest_token_batch_next(struct attest_token_batch_ctx *me,
+                        const struct q_useful_buf_c *tail,
+                        struct q_useful_buf_c *completed_token)
+{
+    enum attest_token_err_t return_value;
+    struct attest_token_stream_ctx *token_ctx = &(me->next_ctx);
+    struct q_useful_buf sig_buf;
+    struct q_useful_buf_c sig;
+
+    if (tail->len != me->tail_len) {
+        return ATTEST_TOKEN_ERR_GENERAL;
+    }
+
+    /* Only the tail and the signature differ from the previous token */
+    memcpy(me->token + me->payload_offset + me->payload_len - me->tail_len,
+           tail->ptr, tail->len);
+
+    *token_ctx = me->common_ctx;
+    stream_digest_init(token_ctx);
+
+    /* The signature overwrites the one of the previous token */
+    sig_buf.ptr = me->token + me->common_ctx.token_len -
+                  me->common_ctx.sig_len;
+    sig_buf.len = me->common_ctx.sig_len;
+
+    return_value = batch_digest_start(me, token_ctx);
+    if (return_value == ATTEST_TOKEN_ERR_SUCCESS) {
+        return_value = stream_digest_update(token_ctx, tail);
+    }
+    if (return_value == ATTEST_TOKEN_ERR_SUCCESS) {
+        return_value = stream_digest_sign(token_ctx, sig_buf, &sig);
+    }
+    if (return_value != ATTEST_TOKEN_ERR_SUCCESS) {
+        stream_digest_abort(token_ctx);
+        return return_value;
+    }
+
+    if (sig.len != me->common_ctx.sig_len) {
+        return ATTEST_TOKEN_ERR_GENERAL;
+    }
+
+    completed_token->ptr = me->token;
+    completed_token->len = me->common_ctx.token_len;
+
+    return ATTEST_TOKEN_ERR_SUCCESS;
+}
+
+/*
+ * Public function. See attest_token.h
+ */
+void attest_token_batch_end(struct attest_token_batch_ctx *me)
+{
+    stream_digest_abort(&(me->common_ctx));
+}
+#endif /* ATTEST_TOKEN_BATCH_MAX > 0 */
@@ -28,6 +28,24 @@
 #define ATTEST_STACK_SIZE              0x700
 #endif
 
+/* Size of the buffer where the static claims are encoded once, 0 disables it */
+#ifndef ATTEST_CLAIM_CACHE_SIZE
+#pragma message("ATTEST_CLAIM_CACHE_SIZE is defaulted to 0. Please check and set it explicitly.")
+#define ATTEST_CLAIM_CACHE_SIZE        0
+#endif
+
+/* Size of the window the token is streamed through, 0 disables streaming */
+#ifndef ATTEST_TOKEN_STREAM_BUF_SIZE
+#pragma message("ATTEST_TOKEN_STREAM_BUF_SIZE is defaulted to 0. Please check and set it explicitly.")
+#define ATTEST_TOKEN_STREAM_BUF_SIZE   0
+#endif
+
+/* Maximum number of tokens of a batch request, 0 disables batch requests */
+#ifndef ATTEST_TOKEN_BATCH_MAX
+#pragma message("ATTEST_TOKEN_BATCH_MAX is defaulted to 0. Please check and set it explicitly.")
+#define ATTEST_TOKEN_BATCH_MAX         0
+#endif
+
 /* Set the initial attestation token profile */
 #if (!ATTEST_TOKEN_PROFILE_PSA_IOT_1) && \
     (!ATTEST_TOKEN_PROFILE_PSA_2_0_0) && \
@@ -12,6 +12,7 @@
 #include "psa/initial_attestation.h"
 #include "psa/crypto.h"
 #include "attest.h"
+#include "config_attest.h"
 
 #include "array.h"
 #include "psa/framework_feature.h"
@@ -26,6 +27,23 @@ typedef psa_status_t (*attest_func_t)(const psa_msg_t *msg);
 
 int32_t g_attest_caller_id;
 
+#if !(ATTEST_TOKEN_STREAM_BUF_SIZE > 0) && \
+    ((PSA_FRAMEWORK_HAS_MM_IOVEC != 1) || (ATTEST_TOKEN_BATCH_MAX > 0))
+/* Buffer to store the created attestation token. */
+static uint8_t token_buff[PSA_INITIAL_ATTEST_TOKEN_MAX_SIZE];
+#endif
+
+#if ((PSA_FRAMEWORK_HAS_MM_IOVEC != 1) && \
+     (ATTEST_TOKEN_STREAM_BUF_SIZE > 0)) || (ATTEST_TOKEN_BATCH_MAX > 0)
+static void attest_write_outvec(void *write_ctx, const uint8_t *buf,
+                                size_t len)
+{
+    const psa_msg_t *msg = write_ctx;
+
+    psa_write(msg->handle, 0, buf, len);
+}
+#endif
+
 #if PSA_FRAMEWORK_HAS_MM_IOVEC == 1
 static psa_status_t psa_attest_get_token(const psa_msg_t *msg)
 {
@@ -58,10 +76,38 @@ static psa_status_t psa_attest_get_token(const psa_msg_t *msg)
 
     return status;
 }
-#else /* PSA_FRAMEWORK_HAS_MM_IOVEC == 1 */
-/* Buffer to store the created attestation token. */
-static uint8_t token_buff[PSA_INITIAL_ATTEST_TOKEN_MAX_SIZE];
+#elif ATTEST_TOKEN_STREAM_BUF_SIZE > 0
+static psa_status_t psa_attest_get_token(const psa_msg_t *msg)
+{
+    uint8_t challenge_buff[PSA_INITIAL_ATTEST_CHALLENGE_SIZE_64];
+    uint32_t bytes_read = 0;
+    size_t challenge_size;
+    size_t token_buff_size;
+    size_t token_size;
+
+    challenge_size = msg->in_size[0];
+    token_buff_size = msg->out_size[0];
+
+    if (challenge_size > PSA_INITIAL_ATTEST_CHALLENGE_SIZE_64
+        || challenge_size == 0 || token_buff_size == 0) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    /* store the client ID here for later use in service */
+    g_attest_caller_id = msg->client_id;
+
+    bytes_read = psa_read(msg->handle, 0, challenge_buff, challenge_size);
+    if (bytes_read != challenge_size) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
 
+    /* The token is written to the outvec as it is created */
+    return initial_attest_stream_token(challenge_buff, challenge_size,
+                                       token_buff_size,
+                                       attest_write_outvec, (void *)msg,
+                                       &token_size);
+}
+#else /* PSA_FRAMEWORK_HAS_MM_IOVEC == 1 */
 static psa_status_t psa_attest_get_token(const psa_msg_t *msg)
 {
     psa_status_t status = PSA_SUCCESS;
@@ -127,6 +173,71 @@ static psa_status_t psa_attest_get_token_size(const psa_msg_t *msg)
     return status;
 }
 
+#if ATTEST_TOKEN_BATCH_MAX > 0
+/* Buffer to store the challenges of a batch of tokens. */
+static uint8_t challenges_buff[ATTEST_TOKEN_BATCH_MAX *
+                               PSA_INITIAL_ATTEST_CHALLENGE_SIZE_64];
+
+static psa_status_t psa_attest_get_token_batch(const psa_msg_t *msg)
+{
+    psa_status_t status = PSA_SUCCESS;
+    size_t challenge_size;
+    size_t challenges_size;
+    size_t token_size;
+    size_t bytes_read = 0;
+
+    if (msg->in_size[1] != sizeof(challenge_size)
+        || msg->out_size[1] != sizeof(token_size)) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    /* store the client ID here for later use in service */
+    g_attest_caller_id = msg->client_id;
+
+    bytes_read = psa_read(msg->handle, 1,
+                          &challenge_size, msg->in_size[1]);
+    if (bytes_read != sizeof(challenge_size)) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    challenges_size = msg->in_size[0];
+    if (challenge_size > PSA_INITIAL_ATTEST_CHALLENGE_SIZE_64
+        || challenge_size == 0 || challenges_size == 0
+        || challenges_size > sizeof(challenges_buff)
+        || challenges_size % challenge_size != 0
+        || msg->out_size[0] == 0) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    bytes_read = psa_read(msg->handle, 0, challenges_buff, challenges_size);
+    if (bytes_read != challenges_size) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    /* The tokens are written to the outvec one after the other */
+#if ATTEST_TOKEN_STREAM_BUF_SIZE > 0
+    status = initial_attest_get_token_batch(challenges_buff, challenge_size,
+                                            challenges_size / challenge_size,
+                                            NULL, 0,
+                                            msg->out_size[0],
+                                            attest_write_outvec, (void *)msg,
+                                            &token_size);
+#else
+    status = initial_attest_get_token_batch(challenges_buff, challenge_size,
+                                            challenges_size / challenge_size,
+                                            token_buff, sizeof(token_buff),
+                                            msg->out_size[0],
+                                            attest_write_outvec, (void *)msg,
+                                            &token_size);
+#endif
+    if (status == PSA_SUCCESS) {
+        psa_write(msg->handle, 1, &token_size, sizeof(token_size));
+    }
+
+    return status;
+}
+#endif /* ATTEST_TOKEN_BATCH_MAX > 0 */
+
 psa_status_t tfm_attestation_service_sfn(const psa_msg_t *msg)
 {
     switch (msg->type) {
@@ -134,6 +245,10 @@ psa_status_t tfm_attestation_service_sfn(const psa_msg_t *msg)
         return psa_attest_get_token(msg);
     case TFM_ATTEST_GET_TOKEN_SIZE:
         return psa_attest_get_token_size(msg);
+#if ATTEST_TOKEN_BATCH_MAX > 0
+    case TFM_ATTEST_GET_TOKEN_BATCH:
+        return psa_attest_get_token_batch(msg);
+#endif
     default:
         return PSA_ERROR_NOT_SUPPORTED;
     }
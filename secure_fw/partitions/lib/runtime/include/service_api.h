@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2020, Arm Limited. All rights reserved.
+ * Copyright (c) 2020-2022, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -8,6 +8,7 @@
 #define __SERVICE_API_H__
 
 #include <stdint.h>
+#include "runtime_defs.h"
 #include "tfm_boot_status.h"
 
 /**
@@ -22,4 +23,15 @@ int32_t tfm_core_get_boot_data(uint8_t major_type,
                                struct tfm_boot_data *boot_data,
                                uint32_t len);
 
+/**
+ * \brief Retrieve the usage statistics of the SPM connection handle pool, for
+ *        debugging purposes.
+ *
+ * \param[out] stats       Pointer to the statistics buffer.
+ *
+ * \return PSA_SUCCESS, or PSA_ERROR_INVALID_ARGUMENT if the buffer is not
+ *         writable by the caller.
+ */
+int32_t tfm_core_get_conn_handle_stats(struct tfm_conn_handle_stats_t *stats);
+
 #endif /* __SERVICE_API_H__ */
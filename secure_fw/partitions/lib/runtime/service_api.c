@@ -22,6 +22,15 @@ int32_t tfm_core_get_boot_data(uint8_t major_type,
         );
 }
 
+__attribute__((naked))
+int32_t tfm_core_get_conn_handle_stats(struct tfm_conn_handle_stats_t *stats)
+{
+    __ASM volatile(
+        "SVC    "M2S(TFM_SVC_GET_CONN_HANDLE_STATS)"       \n"
+        "BX     lr                                         \n"
+        );
+}
+
 #if TFM_LVL != 1
 /* Entry point when Partition FLIH functions return */
 __attribute__((naked))
@@ -31,6 +31,28 @@
 #define MEM_CHECK_NONSECURE             (MEM_CHECK_AU_NONSECURE | \
                                          MEM_CHECK_MPU_NONSECURE)
 
+#if NUM_MAILBOX_SHM_REGION > 0
+/* Shared memory region handle: generation in bits [23:8], index + 1 in [7:0] */
+#define SHM_HANDLE_IDX_MASK             (0xFFUL)
+#define SHM_HANDLE_GEN_SHIFT            (8)
+#define SHM_HANDLE_GEN_MASK             (0xFFFFUL)
+
+/* A non-secure shared memory region validated at registration */
+struct shm_region_t {
+    uintptr_t base;
+    uintptr_t limit;               /* Address of the last byte */
+    uint32_t  flags;               /* Access types validated at registration */
+    int32_t   client_id;           /* Client ID of the non-secure owner */
+    uint16_t  generation;          /* Detect stale handles */
+    bool      is_used;
+};
+
+static struct shm_region_t shm_regions[NUM_MAILBOX_SHM_REGION];
+
+/* The region containing the payloads of the PSA client call under delivery */
+static const struct shm_region_t *active_shm_region = NULL;
+#endif /* NUM_MAILBOX_SHM_REGION > 0 */
+
 void tfm_get_mem_region_security_attr(const void *p, size_t s,
                                       struct security_attr_info_t *p_attr)
 {
@@ -390,6 +412,129 @@ static enum tfm_status_e mem_attr_check(struct mem_attr_info_t attr,
     return secure_mem_attr_check(attr, flags);
 }
 
+#if NUM_MAILBOX_SHM_REGION > 0
+static struct shm_region_t *get_shm_region(uint32_t handle, int32_t client_id)
+{
+    uint32_t idx = handle & SHM_HANDLE_IDX_MASK;
+    struct shm_region_t *region;
+
+    if ((idx == 0) || (idx > NUM_MAILBOX_SHM_REGION)) {
+        return NULL;
+    }
+
+    region = &shm_regions[idx - 1];
+    if (!region->is_used ||
+        (region->generation !=
+         ((handle >> SHM_HANDLE_GEN_SHIFT) & SHM_HANDLE_GEN_MASK)) ||
+        (region->client_id != client_id)) {
+        return NULL;
+    }
+
+    return region;
+}
+
+/*
+ * Check whether the range lies inside the active shared memory region, which
+ * was validated with the requested access types at registration.
+ */
+static bool is_in_active_shm_region(const void *p, size_t s, uint32_t flags)
+{
+    const struct shm_region_t *region = active_shm_region;
+
+    if (!region || !(flags & MEM_CHECK_NONSECURE)) {
+        return false;
+    }
+
+    if ((flags & MEM_CHECK_MPU_READWRITE) &&
+        !(region->flags & MEM_CHECK_MPU_READWRITE)) {
+        return false;
+    }
+
+    /* Overflow of the range is checked by the caller */
+    return ((uintptr_t)p >= region->base) &&
+           ((uintptr_t)p + s - 1 <= region->limit);
+}
+
+enum tfm_status_e tfm_multi_core_register_shm(const void *p, size_t s,
+                                              uint32_t flags,
+                                              int32_t client_id,
+                                              uint32_t *handle)
+{
+    uint32_t idx;
+    struct shm_region_t *region;
+
+    if (!handle || (s == 0) || !(flags & MEM_CHECK_NONSECURE) ||
+        !(flags & (MEM_CHECK_MPU_READWRITE | MEM_CHECK_MPU_READ))) {
+        return TFM_ERROR_GENERIC;
+    }
+
+    /* Walk the platform memory region tables once for the whole region */
+    if (tfm_has_access_to_region(p, s, flags) != TFM_SUCCESS) {
+        return TFM_ERROR_GENERIC;
+    }
+
+    for (idx = 0; idx < NUM_MAILBOX_SHM_REGION; idx++) {
+        if (!shm_regions[idx].is_used) {
+            break;
+        }
+    }
+
+    if (idx == NUM_MAILBOX_SHM_REGION) {
+        return TFM_ERROR_GENERIC;
+    }
+
+    region = &shm_regions[idx];
+    region->base = (uintptr_t)p;
+    region->limit = (uintptr_t)p + s - 1;
+    region->flags = flags;
+    region->client_id = client_id;
+    region->generation = (uint16_t)((region->generation + 1) &
+                                    SHM_HANDLE_GEN_MASK);
+    if (region->generation == 0) {
+        region->generation = 1;
+    }
+    region->is_used = true;
+
+    *handle = ((uint32_t)region->generation << SHM_HANDLE_GEN_SHIFT) |
+              (idx + 1);
+
+    return TFM_SUCCESS;
+}
+
+enum tfm_status_e tfm_multi_core_unregister_shm(uint32_t handle,
+                                                int32_t client_id)
+{
+    struct shm_region_t *region = get_shm_region(handle, client_id);
+
+    if (!region || (region == active_shm_region)) {
+        return TFM_ERROR_GENERIC;
+    }
+
+    region->is_used = false;
+
+    return TFM_SUCCESS;
+}
+
+enum tfm_status_e tfm_multi_core_activate_shm(uint32_t handle,
+                                              int32_t client_id)
+{
+    const struct shm_region_t *region = get_shm_region(handle, client_id);
+
+    if (!region) {
+        return TFM_ERROR_GENERIC;
+    }
+
+    active_shm_region = region;
+
+    return TFM_SUCCESS;
+}
+
+void tfm_multi_core_deactivate_shm(void)
+{
+    active_shm_region = NULL;
+}
+#endif /* NUM_MAILBOX_SHM_REGION > 0 */
+
 enum tfm_status_e tfm_has_access_to_region(const void *p, size_t s,
                                            uint32_t flags)
 {
@@ -414,6 +559,13 @@ enum tfm_status_e tfm_has_access_to_region(const void *p, size_t s,
         tfm_core_panic();
     }
 
+#if NUM_MAILBOX_SHM_REGION > 0
+    /* The payloads inside the active region were validated at registration */
+    if (is_in_active_shm_region(p, s, flags)) {
+        return TFM_SUCCESS;
+    }
+#endif
+
     security_attr_init(&security_attr);
 
     /* Retrieve security attributes of target memory region */
@@ -34,4 +34,10 @@
 #define PLATFORM_NV_COUNTER_MODULE_DISABLED    0
 #endif
 
+/* Disable the debug request for the SPM connection handle statistics */
+#ifndef PLATFORM_SERVICE_CONN_HANDLE_STATS
+#pragma message("PLATFORM_SERVICE_CONN_HANDLE_STATS is defaulted to 0. Please check and set it explicitly.")
+#define PLATFORM_SERVICE_CONN_HANDLE_STATS     0
+#endif
+
 #endif /* __CONFIG_PARTITION_PLATFORM_H__ */
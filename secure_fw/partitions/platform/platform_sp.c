@@ -21,6 +21,10 @@
 #include "region_defs.h"
 #include "psa_manifest/tfm_platform.h"
 
+#if PLATFORM_SERVICE_CONN_HANDLE_STATS
+#include "service_api.h"
+#endif /* PLATFORM_SERVICE_CONN_HANDLE_STATS */
+
 #if !PLATFORM_NV_COUNTER_MODULE_DISABLED
 #define NV_COUNTER_ID_SIZE  sizeof(enum tfm_nv_counter_t)
 #endif /* !PLATFORM_NV_COUNTER_MODULE_DISABLED */
@@ -239,6 +243,32 @@ static psa_status_t platform_sp_ioctl_psa_api(const psa_msg_t *msg)
     return ret;
 }
 
+#if PLATFORM_SERVICE_CONN_HANDLE_STATS
+static psa_status_t platform_sp_conn_handle_stats_psa_api(const psa_msg_t *msg)
+{
+    struct tfm_conn_handle_stats_t spm_stats;
+    struct tfm_platform_conn_handle_stats_t stats;
+
+    if ((msg->in_size[0] != 0) ||
+        (msg->out_size[0] != sizeof(stats))) {
+        return TFM_PLATFORM_ERR_INVALID_PARAM;
+    }
+
+    if (tfm_core_get_conn_handle_stats(&spm_stats) != PSA_SUCCESS) {
+        return TFM_PLATFORM_ERR_SYSTEM_ERROR;
+    }
+
+    stats.total = spm_stats.total;
+    stats.free = spm_stats.free;
+    stats.high_watermark = spm_stats.high_watermark;
+    stats.alloc_fails = spm_stats.alloc_fails;
+
+    psa_write(msg->handle, 0, &stats, sizeof(stats));
+
+    return TFM_PLATFORM_ERR_SUCCESS;
+}
+#endif /* PLATFORM_SERVICE_CONN_HANDLE_STATS */
+
 psa_status_t tfm_platform_service_sfn(const psa_msg_t *msg)
 {
     switch (msg->type) {
@@ -252,6 +282,10 @@ psa_status_t tfm_platform_service_sfn(const psa_msg_t *msg)
         return platform_sp_system_reset_psa_api(msg);
     case TFM_PLATFORM_API_ID_IOCTL:
         return platform_sp_ioctl_psa_api(msg);
+#if PLATFORM_SERVICE_CONN_HANDLE_STATS
+    case TFM_PLATFORM_API_ID_CONN_HANDLE_STATS:
+        return platform_sp_conn_handle_stats_psa_api(msg);
+#endif /* PLATFORM_SERVICE_CONN_HANDLE_STATS */
     default:
         return PSA_ERROR_NOT_SUPPORTED;
     }
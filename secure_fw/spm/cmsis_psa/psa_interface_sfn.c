@@ -36,6 +36,8 @@ psa_status_t psa_call_pack_sfn(psa_handle_t handle, uint32_t ctrl_param,
                                const psa_invec *in_vec, psa_outvec *out_vec)
 {
     struct partition_t *p_client, *p_target;
+    /* Used by stateless services, replied before this function returns */
+    struct conn_handle_t stateless_handle;
     psa_status_t stat;
 
     if (__get_active_exc_num() != EXC_NUM_THREAD_MODE) {
@@ -45,7 +47,8 @@ psa_status_t psa_call_pack_sfn(psa_handle_t handle, uint32_t ctrl_param,
 
     p_client = GET_CURRENT_COMPONENT();
 
-    stat = tfm_spm_client_psa_call(handle, ctrl_param, in_vec, out_vec);
+    stat = tfm_spm_client_psa_call_sfn(handle, ctrl_param, in_vec, out_vec,
+                                       &stateless_handle);
 
     p_target = GET_CURRENT_COMPONENT();
     if (p_client != p_target) {
@@ -34,6 +34,7 @@
 #include "lists.h"
 #include "tfm_pools.h"
 #include "region.h"
+#include "runtime_defs.h"
 #include "psa_manifest/pid.h"
 #include "ffm/backend.h"
 #include "load/partition_defs.h"
@@ -54,6 +55,21 @@ struct service_t *stateless_services_ref_tbl[STATIC_HANDLE_NUM_LIMIT];
 TFM_POOL_DECLARE(conn_handle_pool, sizeof(struct conn_handle_t),
                  CONFIG_TFM_CONN_HANDLE_MAX_NUM);
 
+#if CONFIG_TFM_CONN_HANDLE_RESERVED_NUM > 0
+/*
+ * Only the partitions which can act as clients hold reservations: the NS
+ * agents and the partitions with dependencies. config_spm.h checks that the
+ * reservations fit in the pool.
+ */
+#define HAS_CONN_HANDLE_RESERVATION(p_ptn)                              \
+            (IS_PARTITION_NS_AGENT((p_ptn)->p_ldinf) ||                 \
+             ((p_ptn)->p_ldinf->ndeps > 0))
+
+/* The number of reserved connection handles not taken by their owners yet */
+static uint32_t nr_unused_reserved_handles =
+        CONFIG_TFM_CONN_HANDLE_RESERVED_NUM * CONFIG_TFM_CLIENT_PARTITION_NUM;
+#endif
+
 /*********************** Connection handle conversion APIs *******************/
 
 #define CONVERSION_FACTOR_BITOFFSET    3
@@ -136,19 +152,44 @@ struct conn_handle_t *tfm_spm_to_handle_instance(psa_handle_t user_handle)
 }
 
 /* Service handle management functions */
-struct conn_handle_t *tfm_spm_create_conn_handle(void)
+struct conn_handle_t *tfm_spm_create_conn_handle(struct partition_t *p_client)
 {
     struct conn_handle_t *p_handle;
 
+    SPM_ASSERT(p_client != NULL);
+
+#if CONFIG_TFM_CONN_HANDLE_RESERVED_NUM > 0
+    if (HAS_CONN_HANDLE_RESERVATION(p_client) &&
+        (p_client->nr_conn_handles < CONFIG_TFM_CONN_HANDLE_RESERVED_NUM)) {
+        /* Take a handle reserved for this client */
+        p_handle = (struct conn_handle_t *)tfm_pool_alloc(conn_handle_pool);
+        if (p_handle) {
+            nr_unused_reserved_handles--;
+        }
+    } else {
+        /* Leave the handles reserved for other clients */
+        p_handle = (struct conn_handle_t *)tfm_pool_alloc_unreserved(
+                                                conn_handle_pool,
+                                                nr_unused_reserved_handles);
+    }
+#else
     /* Get buffer for handle list structure from handle pool */
     p_handle = (struct conn_handle_t *)tfm_pool_alloc(conn_handle_pool);
+#endif
     if (!p_handle) {
+        SPMLOG_DBGMSGVAL("Connection handle pool exhausted, failures: ",
+                         conn_handle_pool->alloc_fail_count);
         return NULL;
     }
 
+#if CONFIG_TFM_CONN_HANDLE_RESERVED_NUM > 0
+    p_client->nr_conn_handles++;
+#endif
+
     spm_memset(p_handle, 0, sizeof(*p_handle));
 
     p_handle->status = TFM_HANDLE_STATUS_IDLE;
+    p_handle->p_client = p_client;
 
     return p_handle;
 }
@@ -171,11 +212,49 @@ void tfm_spm_free_conn_handle(struct conn_handle_t *conn_handle)
     SPM_ASSERT(conn_handle != NULL);
 
     CRITICAL_SECTION_ENTER(cs_assert);
+#if CONFIG_TFM_CONN_HANDLE_RESERVED_NUM > 0
+    /* Give the handle back to the reservation of the client */
+    if (HAS_CONN_HANDLE_RESERVATION(conn_handle->p_client) &&
+        (conn_handle->p_client->nr_conn_handles <=
+         CONFIG_TFM_CONN_HANDLE_RESERVED_NUM)) {
+        nr_unused_reserved_handles++;
+    }
+    conn_handle->p_client->nr_conn_handles--;
+#endif
     /* Back handle buffer to pool */
     tfm_pool_free(conn_handle_pool, conn_handle);
     CRITICAL_SECTION_LEAVE(cs_assert);
 }
 
+void tfm_spm_get_conn_handle_stats_handler(uint32_t args[])
+{
+    struct tfm_conn_handle_stats_t *p_stats =
+                                (struct tfm_conn_handle_stats_t *)args[0];
+    struct partition_t *curr_partition = GET_CURRENT_COMPONENT();
+    struct critical_section_t cs_assert = CRITICAL_SECTION_STATIC_INIT;
+    struct tfm_pool_stats_t pool_stats;
+    fih_int fih_rc = FIH_FAILURE;
+
+    FIH_CALL(tfm_hal_memory_check, fih_rc,
+             curr_partition->boundary, (uintptr_t)p_stats,
+             sizeof(*p_stats), TFM_HAL_ACCESS_READWRITE);
+    if (fih_not_eq(fih_rc, fih_int_encode(PSA_SUCCESS))) {
+        args[0] = (uint32_t)PSA_ERROR_INVALID_ARGUMENT;
+        return;
+    }
+
+    CRITICAL_SECTION_ENTER(cs_assert);
+    tfm_pool_get_stats(conn_handle_pool, &pool_stats);
+    CRITICAL_SECTION_LEAVE(cs_assert);
+
+    p_stats->total = (uint32_t)pool_stats.chunk_count;
+    p_stats->free = (uint32_t)pool_stats.free_count;
+    p_stats->high_watermark = (uint32_t)pool_stats.high_watermark;
+    p_stats->alloc_fails = pool_stats.alloc_fail_count;
+
+    args[0] = (uint32_t)PSA_SUCCESS;
+}
+
 /* Partition management functions */
 
 /* This API is only used in IPC backend. */
@@ -340,8 +419,24 @@ struct conn_handle_t *spm_get_handle_by_msg_handle(psa_handle_t msg_handle)
      * Check the conditions above
      */
     int32_t partition_id;
-    struct conn_handle_t *p_conn_handle =
-                                    tfm_spm_to_handle_instance(msg_handle);
+    struct partition_t *p_curr_partition;
+    struct conn_handle_t *p_conn_handle;
+
+    if (IS_STACK_MSG_HANDLE(msg_handle)) {
+        /*
+         * An SFN partition serves one message at a time, which is the only
+         * message the running partition can access.
+         */
+        p_curr_partition = GET_CURRENT_COMPONENT();
+        p_conn_handle = p_curr_partition->p_handles;
+        if (!p_conn_handle || p_conn_handle->msg.handle != msg_handle) {
+            return NULL;
+        }
+
+        return p_conn_handle;
+    }
+
+    p_conn_handle = tfm_spm_to_handle_instance(msg_handle);
 
     if (tfm_spm_validate_conn_handle(p_conn_handle) != PSA_SUCCESS) {
         return NULL;
@@ -21,6 +21,7 @@
 #include "psa/service.h"
 #include "load/partition_defs.h"
 #include "load/interrupt_defs.h"
+#include "tfm_pools.h"
 
 #define TFM_HANDLE_STATUS_IDLE          0 /* Handle created             */
 #define TFM_HANDLE_STATUS_ACTIVE        1 /* Handle in use              */
@@ -63,6 +64,18 @@
 #define IS_STATIC_HANDLE(handle) \
     ((handle) & (1UL << STATIC_HANDLE_INDICATOR_OFFSET))
 
+/*
+ * In SFN backend, a stateless call completes before returning to the client,
+ * so its message lives in the stack frame of the client instead of the handle
+ * pool. The message handle is the static handle, which never collides with a
+ * user handle converted from the pool.
+ */
+#if CONFIG_TFM_SPM_BACKEND_SFN == 1
+#define IS_STACK_MSG_HANDLE(handle)     IS_STATIC_HANDLE(handle)
+#else
+#define IS_STACK_MSG_HANDLE(handle)     0
+#endif
+
 /* Valid index should be [0, STATIC_HANDLE_NUM_LIMIT-1] */
 #define IS_VALID_STATIC_HANDLE_IDX(index) \
     ((uint32_t)(index) < STATIC_HANDLE_NUM_LIMIT)
@@ -128,6 +141,9 @@ struct partition_t {
     uint32_t                           state;           /* SFN model */
 #endif
     struct conn_handle_t               *p_handles;
+#if CONFIG_TFM_CONN_HANDLE_RESERVED_NUM > 0
+    uint32_t                           nr_conn_handles; /* Handles as client */
+#endif
     struct partition_t                 *next;
 };
 
@@ -150,10 +166,12 @@ int32_t tfm_spm_partition_get_running_partition_id(void);
 /**
  * \brief                   Create connection handle for client connect
  *
+ * \param[in] p_client      The client partition of the connection
+ *
  * \retval NULL             Create failed
  * \retval "Not NULL"       Service handle created
  */
-struct conn_handle_t *tfm_spm_create_conn_handle(void);
+struct conn_handle_t *tfm_spm_create_conn_handle(struct partition_t *p_client);
 
 /**
  * \brief                   Validate connection handle for client connect
@@ -175,6 +193,17 @@ psa_status_t tfm_spm_validate_conn_handle(const struct conn_handle_t *conn_handl
  */
 void tfm_spm_free_conn_handle(struct conn_handle_t *conn_handle);
 
+/**
+ * \brief                   SVC handler to get the usage statistics of the
+ *                          connection handle pool, for debugging purposes.
+ *
+ * \param[in,out] args      args[0] is the \ref tfm_conn_handle_stats_t
+ *                          buffer of the caller, which must be writable by
+ *                          the current partition. args[0] is set to the
+ *                          status on return.
+ */
+void tfm_spm_get_conn_handle_stats_handler(uint32_t args[]);
+
 /******************** Partition management functions *************************/
 
 #if CONFIG_TFM_SPM_BACKEND_IPC == 1
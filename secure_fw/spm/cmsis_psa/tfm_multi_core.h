@@ -11,6 +11,7 @@
 #include <stdbool.h>
 
 #include "tfm_api.h"
+#include "tfm_mailbox_config.h"
 
 /* Follow CMSE flag definitions */
 #define MEM_CHECK_MPU_READWRITE         (1 << 0x0)
@@ -102,6 +103,59 @@ void tfm_get_ns_mem_region_attr(const void *p, size_t s,
 enum tfm_status_e tfm_has_access_to_region(const void *p, size_t s,
                                            uint32_t flags);
 
+#if NUM_MAILBOX_SHM_REGION > 0
+/**
+ * \brief Register a non-secure shared memory region. The region is checked
+ *        against the platform memory region tables once here.
+ *
+ * \param[in]  p              The start address of the region
+ * \param[in]  s              The size of the region
+ * \param[in]  flags          The memory access types to be checked. It must
+ *                            contain \ref MEM_CHECK_NONSECURE.
+ * \param[in]  client_id      The client ID of the non-secure owner
+ * \param[out] handle         The handle of the registered region
+ *
+ * \return TFM_SUCCESS if the region is registered,
+ *         TFM_ERROR_GENERIC otherwise.
+ */
+enum tfm_status_e tfm_multi_core_register_shm(const void *p, size_t s,
+                                              uint32_t flags,
+                                              int32_t client_id,
+                                              uint32_t *handle);
+
+/**
+ * \brief Unregister a non-secure shared memory region.
+ *
+ * \param[in] handle          The handle of the registered region
+ * \param[in] client_id       The client ID of the non-secure owner
+ *
+ * \return TFM_SUCCESS if the region is unregistered,
+ *         TFM_ERROR_GENERIC otherwise.
+ */
+enum tfm_status_e tfm_multi_core_unregister_shm(uint32_t handle,
+                                                int32_t client_id);
+
+/**
+ * \brief Select the registered region which contains the payloads of the
+ *        PSA client call under delivery. Non-secure memory access checks
+ *        against the selected region complete in constant time, without
+ *        walking the platform memory region tables.
+ *
+ * \param[in] handle          The handle of the registered region
+ * \param[in] client_id       The client ID of the non-secure owner
+ *
+ * \return TFM_SUCCESS if the region is selected,
+ *         TFM_ERROR_GENERIC otherwise.
+ */
+enum tfm_status_e tfm_multi_core_activate_shm(uint32_t handle,
+                                              int32_t client_id);
+
+/**
+ * \brief Deselect the region selected by \ref tfm_multi_core_activate_shm.
+ */
+void tfm_multi_core_deactivate_shm(void);
+#endif /* NUM_MAILBOX_SHM_REGION > 0 */
+
 /**
  * \brief Initialization of the multi core communication.
  *
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2021, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2022, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -48,11 +48,18 @@ psa_status_t tfm_pool_init(struct tfm_pool_instance_t *pool, size_t poolsz,
     /* Prepare instance and insert to pool list */
     pool->chunksz = chunksz;
     pool->chunk_count = num;
+    pool->free_count = num;
 
     return PSA_SUCCESS;
 }
 
 void *tfm_pool_alloc(struct tfm_pool_instance_t *pool)
+{
+    return tfm_pool_alloc_unreserved(pool, 0);
+}
+
+void *tfm_pool_alloc_unreserved(struct tfm_pool_instance_t *pool,
+                                size_t nr_reserved)
 {
     struct tfm_pool_chunk_t *node;
 
@@ -60,13 +67,19 @@ void *tfm_pool_alloc(struct tfm_pool_instance_t *pool)
         return NULL;
     }
 
-    if (UNI_LIST_IS_EMPTY(pool, next)) {
+    if (UNI_LIST_IS_EMPTY(pool, next) || (pool->free_count <= nr_reserved)) {
+        pool->alloc_fail_count++;
         return NULL;
     }
 
     node = UNI_LIST_NEXT_NODE(pool, next);
     UNI_LIST_REMOVE_NODE(pool, node, next);
 
+    pool->free_count--;
+    if (pool->chunk_count - pool->free_count > pool->high_watermark) {
+        pool->high_watermark = pool->chunk_count - pool->free_count;
+    }
+
     return &(((struct tfm_pool_chunk_t *)node)->data);
 }
 
@@ -77,6 +90,21 @@ void tfm_pool_free(struct tfm_pool_instance_t *pool, void *ptr)
     pchunk = TO_CONTAINER(ptr, struct tfm_pool_chunk_t, data);
 
     UNI_LIST_INSERT_AFTER(pool, pchunk, next);
+
+    pool->free_count++;
+}
+
+void tfm_pool_get_stats(const struct tfm_pool_instance_t *pool,
+                        struct tfm_pool_stats_t *stats)
+{
+    if (!pool || !stats) {
+        return;
+    }
+
+    stats->chunk_count = pool->chunk_count;
+    stats->free_count = pool->free_count;
+    stats->high_watermark = pool->high_watermark;
+    stats->alloc_fail_count = pool->alloc_fail_count;
 }
 
 bool is_valid_chunk_data_in_pool(struct tfm_pool_instance_t *pool,
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2021, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2022, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -25,9 +25,20 @@ struct tfm_pool_instance_t {
     struct tfm_pool_chunk_t *next;        /* Point to the first free node   */
     size_t chunksz;                       /* Chunks size of pool member     */
     size_t chunk_count;                   /* A number of chunks in the pool */
+    size_t free_count;                    /* A number of free chunks        */
+    size_t high_watermark;                /* Max number of chunks in use    */
+    uint32_t alloc_fail_count;            /* A number of failed allocations */
     uint8_t chunks[];                     /* Data indicator                 */
 };
 
+/* Usage statistics of a memory pool */
+struct tfm_pool_stats_t {
+    size_t chunk_count;                   /* A number of chunks in the pool */
+    size_t free_count;                    /* A number of free chunks        */
+    size_t high_watermark;                /* Max number of chunks in use    */
+    uint32_t alloc_fail_count;            /* A number of failed allocations */
+};
+
 /*
  * This will declares a static memory pool variable with chunk memory.
  * Parameters:
@@ -75,6 +86,19 @@ psa_status_t tfm_pool_init(struct tfm_pool_instance_t *pool, size_t poolsz,
  */
 void *tfm_pool_alloc(struct tfm_pool_instance_t *pool);
 
+/**
+ * \brief Allocate a memory from pool, leaving at least the given number of
+ *        chunks free for other owners.
+ *
+ * \param[in] pool              pool pointer decleared by \ref TFM_POOL_DECLARE
+ * \param[in] nr_reserved       Number of chunks which must remain free.
+ *
+ * \retval buffer pointer       Success.
+ * \retval NULL                 Failed.
+ */
+void *tfm_pool_alloc_unreserved(struct tfm_pool_instance_t *pool,
+                                size_t nr_reserved);
+
 /**
  * \brief Free the allocated memory.
  *
@@ -84,6 +108,16 @@ void *tfm_pool_alloc(struct tfm_pool_instance_t *pool);
  */
 void tfm_pool_free(struct tfm_pool_instance_t *pool, void *ptr);
 
+/**
+ * \brief Get the usage statistics of the pool.
+ *
+ * \param[in]  pool             pool pointer decleared by \ref TFM_POOL_DECLARE
+ * \param[out] stats            The buffer to be written with
+ *                              \ref tfm_pool_stats_t.
+ */
+void tfm_pool_get_stats(const struct tfm_pool_instance_t *pool,
+                        struct tfm_pool_stats_t *stats);
+
 /**
  * \brief Checks whether a pointer points to a chunk data in the pool.
  *
@@ -18,6 +18,37 @@
 
 static struct secure_mailbox_queue_t spe_mailbox_queue;
 
+#if NUM_MAILBOX_SHM_REGION > 0
+/*
+ * Register a shared memory region of the NSPE client. Return the handle of the
+ * region, or a negative PSA error code.
+ */
+static psa_status_t mailbox_shm_register(
+                                        const struct psa_client_params_t *p,
+                                        int32_t client_id)
+{
+    uint32_t flags = MEM_CHECK_NONSECURE;
+    uint32_t shm_handle;
+
+    if (p->shm_register_params.attr & MAILBOX_SHM_ATTR_WRITE) {
+        flags |= MEM_CHECK_MPU_READWRITE;
+    } else if (p->shm_register_params.attr & MAILBOX_SHM_ATTR_READ) {
+        flags |= MEM_CHECK_MPU_READ;
+    } else {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    if (tfm_multi_core_register_shm(p->shm_register_params.base,
+                                    p->shm_register_params.size,
+                                    flags, client_id,
+                                    &shm_handle) != TFM_SUCCESS) {
+        return PSA_ERROR_INSUFFICIENT_MEMORY;
+    }
+
+    return (psa_status_t)shm_handle;
+}
+#endif /* NUM_MAILBOX_SHM_REGION > 0 */
+
 static int32_t tfm_mailbox_dispatch(uint32_t call_type,
                                     const struct psa_client_params_t *params,
                                     int32_t client_id,
@@ -28,7 +59,9 @@ static int32_t tfm_mailbox_dispatch(uint32_t call_type,
     SPM_ASSERT(params != NULL);
     SPM_ASSERT(psa_ret != NULL);
 
+#if NUM_MAILBOX_SHM_REGION == 0
     (void)client_id;
+#endif
 
     switch (call_type) {
     case MAILBOX_PSA_FRAMEWORK_VERSION:
@@ -45,6 +78,23 @@ static int32_t tfm_mailbox_dispatch(uint32_t call_type,
         spm_params.in_len = params->psa_call_params.in_len;
         spm_params.out_vec = params->psa_call_params.out_vec;
         spm_params.out_len = params->psa_call_params.out_len;
+#if NUM_MAILBOX_SHM_REGION > 0
+        if (params->psa_call_params.shm_handle != MAILBOX_SHM_NULL_HANDLE) {
+            /*
+             * The payloads are checked against the registered region while
+             * the call is delivered to SPM.
+             */
+            if (tfm_multi_core_activate_shm(params->psa_call_params.shm_handle,
+                                            client_id) != TFM_SUCCESS) {
+                *psa_ret = PSA_ERROR_PROGRAMMER_ERROR;
+                return MAILBOX_SUCCESS;
+            }
+
+            *psa_ret = tfm_rpc_psa_call(&spm_params);
+            tfm_multi_core_deactivate_shm();
+            return MAILBOX_SUCCESS;
+        }
+#endif
         *psa_ret = tfm_rpc_psa_call(&spm_params);
         return MAILBOX_SUCCESS;
 /* Following cases are only needed by connection-based services */
@@ -59,6 +109,20 @@ static int32_t tfm_mailbox_dispatch(uint32_t call_type,
         tfm_rpc_psa_close(&spm_params);
         return MAILBOX_SUCCESS;
 #endif /* CONFIG_TFM_CONNECTION_BASED_SERVICE_API */
+#if NUM_MAILBOX_SHM_REGION > 0
+    case MAILBOX_SHM_REGISTER:
+        *psa_ret = mailbox_shm_register(params, client_id);
+        return MAILBOX_SUCCESS;
+    case MAILBOX_SHM_UNREGISTER:
+        if (tfm_multi_core_unregister_shm(
+                                    params->shm_unregister_params.shm_handle,
+                                    client_id) != TFM_SUCCESS) {
+            *psa_ret = PSA_ERROR_INVALID_HANDLE;
+        } else {
+            *psa_ret = PSA_SUCCESS;
+        }
+        return MAILBOX_SUCCESS;
+#endif /* NUM_MAILBOX_SHM_REGION > 0 */
     default:
         return MAILBOX_INVAL_PARAMS;
     }
@@ -184,27 +248,38 @@ __STATIC_INLINE int32_t check_mailbox_msg(const struct mailbox_msg_t *msg)
     return MAILBOX_SUCCESS;
 }
 
-int32_t tfm_mailbox_handle_msg(void)
+static void mailbox_notify_peer(void)
 {
-    uint8_t idx;
-    int32_t result;
-    psa_status_t psa_ret = PSA_ERROR_GENERIC_ERROR;
-    mailbox_queue_status_t mask_bits, pend_slots, reply_slots = 0;
     struct ns_mailbox_queue_t *ns_queue = spe_mailbox_queue.ns_queue;
-    struct mailbox_msg_t *msg_ptr;
 
-    SPM_ASSERT(ns_queue != NULL);
+#ifdef MAILBOX_COALESCING
+    /*
+     * Defer the notification while SPE mailbox is handling NSPE mailbox queue.
+     * A single notification is sent out for all the replies at the end of the
+     * current handling round.
+     */
+    if (spe_mailbox_queue.is_handling) {
+        spe_mailbox_queue.is_notify_pending = true;
+        return;
+    }
+#endif
 
     tfm_mailbox_hal_enter_critical();
-
-    pend_slots = get_nspe_queue_pend_status(ns_queue);
-
+    ns_queue->spe_notify_stats.nr_notify++;
     tfm_mailbox_hal_exit_critical();
 
-    /* Check if NSPE mailbox did assert a PSA client call request */
-    if (!pend_slots) {
-        return MAILBOX_NO_PEND_EVENT;
-    }
+    tfm_mailbox_hal_notify_peer();
+}
+
+static void mailbox_handle_pend_slots(struct ns_mailbox_queue_t *ns_queue,
+                                      mailbox_queue_status_t pend_slots)
+{
+    uint8_t idx;
+    int32_t result;
+    psa_status_t psa_ret = PSA_ERROR_GENERIC_ERROR;
+    mailbox_queue_status_t mask_bits, reply_slots = 0;
+    struct mailbox_msg_t *msg_ptr;
+    uint32_t nr_msg = 0;
 
     for (idx = 0; idx < NUM_MAILBOX_QUEUE_SLOT; idx++) {
         mask_bits = (1 << idx);
@@ -213,6 +288,8 @@ int32_t tfm_mailbox_handle_msg(void)
             continue;
         }
 
+        nr_msg++;
+
         /*
          * TODO
          * The operations are simplified here. Use the SPE mailbox queue
@@ -252,10 +329,12 @@ int32_t tfm_mailbox_handle_msg(void)
         spe_mailbox_queue.cur_proc_slot_idx = NUM_MAILBOX_QUEUE_SLOT;
 
         if ((msg_ptr->call_type == MAILBOX_PSA_FRAMEWORK_VERSION) ||
-            (msg_ptr->call_type == MAILBOX_PSA_VERSION)) {
+            (msg_ptr->call_type == MAILBOX_PSA_VERSION) ||
+            (msg_ptr->call_type == MAILBOX_SHM_REGISTER) ||
+            (msg_ptr->call_type == MAILBOX_SHM_UNREGISTER)) {
             /*
-             * Directly write the result to NSPE for psa_framework_version() and
-             * psa_version().
+             * Directly write the result to NSPE for psa_framework_version(),
+             * psa_version() and shared memory region (un)registration.
              */
             reply_slots |= (1 << idx);
 
@@ -285,11 +364,76 @@ int32_t tfm_mailbox_handle_msg(void)
     /* Set the NSPE mailbox replied status */
     set_nspe_queue_replied_status(ns_queue, reply_slots);
 
+    ns_queue->spe_notify_stats.nr_msg += nr_msg;
+
     tfm_mailbox_hal_exit_critical();
 
     if (reply_slots) {
-        tfm_mailbox_hal_notify_peer();
+        mailbox_notify_peer();
+    }
+}
+
+#ifdef MAILBOX_COALESCING
+/*
+ * Handle the pending slots while NSPE mailbox skips notifying SPE of the
+ * messages submitted meanwhile. Those messages are picked up in a single extra
+ * pass, after NSPE mailbox is told that SPE mailbox stopped handling its queue.
+ * SPE mailbox never waits for new messages, so that the target partitions can
+ * reply to the calls delivered. NSPE mailbox notifies SPE of later messages.
+ * The replies completed in the meantime share a single notification.
+ */
+static void mailbox_coalesce_pend_slots(struct ns_mailbox_queue_t *ns_queue,
+                                        mailbox_queue_status_t pend_slots)
+{
+    spe_mailbox_queue.is_handling = true;
+
+    tfm_mailbox_hal_enter_critical();
+    ns_queue->is_spe_handling = true;
+    tfm_mailbox_hal_exit_critical();
+
+    mailbox_handle_pend_slots(ns_queue, pend_slots);
+
+    tfm_mailbox_hal_enter_critical();
+    ns_queue->is_spe_handling = false;
+    pend_slots = get_nspe_queue_pend_status(ns_queue);
+    tfm_mailbox_hal_exit_critical();
+
+    if (pend_slots) {
+        mailbox_handle_pend_slots(ns_queue, pend_slots);
+    }
+
+    spe_mailbox_queue.is_handling = false;
+
+    if (spe_mailbox_queue.is_notify_pending) {
+        spe_mailbox_queue.is_notify_pending = false;
+        mailbox_notify_peer();
     }
+}
+#endif /* MAILBOX_COALESCING */
+
+int32_t tfm_mailbox_handle_msg(void)
+{
+    mailbox_queue_status_t pend_slots;
+    struct ns_mailbox_queue_t *ns_queue = spe_mailbox_queue.ns_queue;
+
+    SPM_ASSERT(ns_queue != NULL);
+
+    tfm_mailbox_hal_enter_critical();
+
+    pend_slots = get_nspe_queue_pend_status(ns_queue);
+
+    tfm_mailbox_hal_exit_critical();
+
+    /* Check if NSPE mailbox did assert a PSA client call request */
+    if (!pend_slots) {
+        return MAILBOX_NO_PEND_EVENT;
+    }
+
+#ifdef MAILBOX_COALESCING
+    mailbox_coalesce_pend_slots(ns_queue, pend_slots);
+#else
+    mailbox_handle_pend_slots(ns_queue, pend_slots);
+#endif
 
     return MAILBOX_SUCCESS;
 }
@@ -330,7 +474,7 @@ int32_t tfm_mailbox_reply_msg(mailbox_msg_handle_t handle, int32_t reply)
 
     tfm_mailbox_hal_exit_critical();
 
-    tfm_mailbox_hal_notify_peer();
+    mailbox_notify_peer();
 
     return MAILBOX_SUCCESS;
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019-2021, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2022, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -33,6 +33,16 @@ struct secure_mailbox_queue_t {
                                                      * queue slot currently
                                                      * under processing.
                                                      */
+#ifdef MAILBOX_COALESCING
+    bool                         is_handling;       /*
+                                                     * SPE mailbox is handling
+                                                     * NSPE mailbox queue.
+                                                     */
+    bool                         is_notify_pending; /*
+                                                     * A notification to NSPE
+                                                     * is deferred.
+                                                     */
+#endif
 };
 
 /**
@@ -142,19 +142,23 @@ uint32_t tfm_spm_client_psa_version(uint32_t sid)
     return service->p_ldinf->version;
 }
 
-psa_status_t tfm_spm_client_psa_call(psa_handle_t handle,
-                                     uint32_t ctrl_param,
-                                     const psa_invec *inptr,
-                                     psa_outvec *outptr)
+static psa_status_t spm_client_psa_call(
+                                    psa_handle_t handle,
+                                    uint32_t ctrl_param,
+                                    const psa_invec *inptr,
+                                    psa_outvec *outptr,
+                                    struct conn_handle_t *p_stateless_handle)
 {
     psa_invec invecs[PSA_MAX_IOVEC];
     psa_outvec outvecs[PSA_MAX_IOVEC];
     struct conn_handle_t *conn_handle;
+#if CONFIG_TFM_SPM_BACKEND_IPC == 1
+    struct critical_section_t cs_assert = CRITICAL_SECTION_STATIC_INIT;
+#endif
     struct service_t *service;
     int i, j;
     int32_t client_id;
     uint32_t sid, version, index;
-    struct critical_section_t cs_assert = CRITICAL_SECTION_STATIC_INIT;
     bool ns_caller = tfm_spm_is_ns_caller();
     struct partition_t *curr_partition = GET_CURRENT_COMPONENT();
     int32_t type = (int32_t)(int16_t)((ctrl_param & TYPE_MASK) >> TYPE_OFFSET);
@@ -210,8 +214,21 @@ psa_status_t tfm_spm_client_psa_call(psa_handle_t handle,
             return PSA_ERROR_PROGRAMMER_ERROR;
         }
 
+#if CONFIG_TFM_SPM_BACKEND_SFN == 1
+        /*
+         * Take the handle from the stack frame of psa_call_pack_sfn() instead
+         * of the pool. That frame lives until the message is replied. The
+         * static handle is used as the message handle.
+         */
+        conn_handle = p_stateless_handle;
+        conn_handle->rhandle = NULL;
+        conn_handle->status = TFM_HANDLE_STATUS_IDLE;
+#if PSA_FRAMEWORK_HAS_MM_IOVEC
+        conn_handle->iovec_status = 0;
+#endif
+#else
         CRITICAL_SECTION_ENTER(cs_assert);
-        conn_handle = tfm_spm_create_conn_handle();
+        conn_handle = tfm_spm_create_conn_handle(curr_partition);
         CRITICAL_SECTION_LEAVE(cs_assert);
 
         if (!conn_handle) {
@@ -220,6 +237,7 @@ psa_status_t tfm_spm_client_psa_call(psa_handle_t handle,
 
         conn_handle->rhandle = NULL;
         handle = tfm_spm_to_user_handle(conn_handle);
+#endif
     } else {
 #if CONFIG_TFM_CONNECTION_BASED_SERVICE_API == 1
         /* It is a PROGRAMMER ERROR if an invalid handle was passed. */
@@ -326,6 +344,27 @@ psa_status_t tfm_spm_client_psa_call(psa_handle_t handle,
     return backend_messaging(service, conn_handle);
 }
 
+#if CONFIG_TFM_SPM_BACKEND_SFN == 1
+psa_status_t tfm_spm_client_psa_call_sfn(
+                                    psa_handle_t handle,
+                                    uint32_t ctrl_param,
+                                    const psa_invec *inptr,
+                                    psa_outvec *outptr,
+                                    struct conn_handle_t *p_stateless_handle)
+{
+    return spm_client_psa_call(handle, ctrl_param, inptr, outptr,
+                               p_stateless_handle);
+}
+#else
+psa_status_t tfm_spm_client_psa_call(psa_handle_t handle,
+                                     uint32_t ctrl_param,
+                                     const psa_invec *inptr,
+                                     psa_outvec *outptr)
+{
+    return spm_client_psa_call(handle, ctrl_param, inptr, outptr, NULL);
+}
+#endif
+
 /* Following PSA APIs are only needed by connection-based services */
 #if CONFIG_TFM_CONNECTION_BASED_SERVICE_API == 1
 
@@ -375,7 +414,7 @@ psa_status_t tfm_spm_client_psa_connect(uint32_t sid, uint32_t version)
      * code to client when creation fails.
      */
     CRITICAL_SECTION_ENTER(cs_assert);
-    conn_handle = tfm_spm_create_conn_handle();
+    conn_handle = tfm_spm_create_conn_handle(GET_CURRENT_COMPONENT());
     CRITICAL_SECTION_LEAVE(cs_assert);
     if (!conn_handle) {
         return PSA_ERROR_CONNECTION_BUSY;
@@ -857,7 +896,14 @@ psa_status_t tfm_spm_partition_psa_reply(psa_handle_t msg_handle,
     ret = backend_replying(handle, ret);
     CRITICAL_SECTION_LEAVE(cs_assert);
 
-    if (handle->status == TFM_HANDLE_STATUS_TO_FREE) {
+    if (IS_STACK_MSG_HANDLE(msg_handle)) {
+        /*
+         * The handle is released with the stack frame of psa_call_pack_sfn()
+         * right after this reply, so do not leave a reference to it.
+         */
+        handle->status = TFM_HANDLE_STATUS_IDLE;
+        service->partition->p_handles = NULL;
+    } else if (handle->status == TFM_HANDLE_STATUS_TO_FREE) {
         tfm_spm_free_conn_handle(handle);
     } else {
         handle->status = TFM_HANDLE_STATUS_IDLE;
@@ -44,6 +44,30 @@
  */
 static uint32_t is_boot_data_valid = BOOT_DATA_INVALID;
 
+#ifdef BOOT_DATA_AVAILABLE
+/*!
+ * \struct boot_data_major_index
+ *
+ * \brief Describes where the entries of a major type are in the shared data
+ *        area. Offsets are relative to BOOT_TFM_SHARED_DATA_BASE.
+ */
+struct boot_data_major_index {
+    uint16_t first; /* Offset of the first entry, 0 if there is none */
+    uint16_t end;   /* Offset following the last entry */
+    uint16_t size;  /* Size of all the entries, including their headers */
+};
+
+/*!
+ * \var major_index
+ *
+ * \brief Index of the shared data area by major type. It is built when the
+ *        area is validated, so that a request knows up front whether the
+ *        entries fit the caller's buffer and only visits the entries lying
+ *        between the first and the last one of the requested type.
+ */
+static struct boot_data_major_index major_index[MAJOR_MASK + 1];
+#endif /* BOOT_DATA_AVAILABLE */
+
 /*!
  * \struct boot_data_access_policy
  *
@@ -117,12 +141,49 @@ void tfm_core_validate_boot_data(void)
 {
 #ifdef BOOT_DATA_AVAILABLE
     struct tfm_boot_data *boot_data;
+    struct shared_data_tlv_entry tlv_entry;
+    struct boot_data_major_index *index;
+    uint32_t tlv_end, offset, entry_size;
 
     boot_data = (struct tfm_boot_data *)BOOT_TFM_SHARED_DATA_BASE;
 
-    if (boot_data->header.tlv_magic == SHARED_DATA_TLV_INFO_MAGIC) {
-        is_boot_data_valid = BOOT_DATA_VALID;
+    if (boot_data->header.tlv_magic != SHARED_DATA_TLV_INFO_MAGIC) {
+        return;
     }
+
+    tlv_end = boot_data->header.tlv_tot_len;
+    if (tlv_end > BOOT_TFM_SHARED_DATA_SIZE) {
+        return;
+    }
+
+    /* Walk the TLV section once to index it. An entry running past the end
+     * of the section invalidates the whole shared data area.
+     */
+    for (offset = SHARED_DATA_HEADER_SIZE; offset < tlv_end;
+         offset += entry_size) {
+        if ((tlv_end - offset) < SHARED_DATA_ENTRY_HEADER_SIZE) {
+            return;
+        }
+
+        /* Create local copy to avoid unaligned access */
+        (void)spm_memcpy(&tlv_entry,
+                         (const void *)(BOOT_TFM_SHARED_DATA_BASE + offset),
+                         SHARED_DATA_ENTRY_HEADER_SIZE);
+
+        entry_size = SHARED_DATA_ENTRY_SIZE(tlv_entry.tlv_len);
+        if (entry_size > (tlv_end - offset)) {
+            return;
+        }
+
+        index = &major_index[GET_MAJOR(tlv_entry.tlv_type)];
+        if (index->size == 0) {
+            index->first = (uint16_t)offset;
+        }
+        index->end = (uint16_t)(offset + entry_size);
+        index->size += (uint16_t)entry_size;
+    }
+
+    is_boot_data_valid = BOOT_DATA_VALID;
 #else
     is_boot_data_valid = BOOT_DATA_VALID;
 #endif /* BOOT_DATA_AVAILABLE */
@@ -137,6 +198,7 @@ void tfm_core_get_boot_data_handler(uint32_t args[])
 #ifdef BOOT_DATA_AVAILABLE
     uint8_t *ptr;
     struct shared_data_tlv_entry tlv_entry;
+    const struct boot_data_major_index *index;
     uintptr_t tlv_end, offset;
     size_t next_tlv_offset;
 #endif /* BOOT_DATA_AVAILABLE */
@@ -163,10 +225,18 @@ void tfm_core_get_boot_data_handler(uint32_t args[])
     }
 
 #ifdef BOOT_DATA_AVAILABLE
-    /* Get the boundaries of TLV section */
-    boot_data = (struct tfm_boot_data *)BOOT_TFM_SHARED_DATA_BASE;
-    tlv_end = BOOT_TFM_SHARED_DATA_BASE + boot_data->header.tlv_tot_len;
-    offset  = BOOT_TFM_SHARED_DATA_BASE + SHARED_DATA_HEADER_SIZE;
+    /* Get the boundaries of the entries with requested major type, which is
+     * known to be valid as it passed the access policy check.
+     */
+    index = &major_index[tlv_major];
+    tlv_end = BOOT_TFM_SHARED_DATA_BASE + index->end;
+    offset  = BOOT_TFM_SHARED_DATA_BASE + index->first;
+
+    /* Check buffer overflow before anything is copied */
+    if ((SHARED_DATA_HEADER_SIZE + index->size) > buf_size) {
+        args[0] = (uint32_t)TFM_ERROR_INVALID_PARAMETER;
+        return;
+    }
 #endif /* BOOT_DATA_AVAILABLE */
 
     /* Add header to output buffer as well */
@@ -181,8 +251,8 @@ void tfm_core_get_boot_data_handler(uint32_t args[])
 
 #ifdef BOOT_DATA_AVAILABLE
     ptr = boot_data->data;
-    /* Iterates over the TLV section and copy TLVs with requested major
-     * type to the provided buffer.
+    /* Iterates over the indexed part of the TLV section and copy TLVs with
+     * requested major type to the provided buffer.
      */
     for (; offset < tlv_end; offset += next_tlv_offset) {
         /* Create local copy to avoid unaligned access */
@@ -192,12 +262,6 @@ void tfm_core_get_boot_data_handler(uint32_t args[])
         next_tlv_offset = SHARED_DATA_ENTRY_HEADER_SIZE + tlv_entry.tlv_len;
 
         if (GET_MAJOR(tlv_entry.tlv_type) == tlv_major) {
-            /* Check buffer overflow */
-            if (((ptr - buf_start) + next_tlv_offset) > buf_size) {
-                args[0] = (uint32_t)TFM_ERROR_INVALID_PARAMETER;
-                return;
-            }
-
             (void)spm_memcpy(ptr, (const void *)offset, next_tlv_offset);
             ptr += next_tlv_offset;
             boot_data->header.tlv_tot_len += next_tlv_offset;
@@ -17,6 +17,11 @@
 #define CONFIG_TFM_CONN_HANDLE_MAX_NUM 8
 #endif
 
+/* The number of connection handles reserved for each partition as a client */
+#ifndef CONFIG_TFM_CONN_HANDLE_RESERVED_NUM
+#define CONFIG_TFM_CONN_HANDLE_RESERVED_NUM 0
+#endif
+
 /* Set the doorbell APIs */
 #ifndef CONFIG_TFM_DOORBELL_API
 #if CONFIG_TFM_SPM_BACKEND_IPC == 1
@@ -30,4 +35,9 @@
 #error "Invalid config: CONFIG_TFM_SPM_BACKEND_SFN AND CONFIG_TFM_DOORBELL_API!"
 #endif
 
+#if (CONFIG_TFM_CONN_HANDLE_RESERVED_NUM * CONFIG_TFM_CLIENT_PARTITION_NUM) > \
+    CONFIG_TFM_CONN_HANDLE_MAX_NUM
+#error "Invalid config: CONFIG_TFM_CONN_HANDLE_RESERVED_NUM of all clients exceeds CONFIG_TFM_CONN_HANDLE_MAX_NUM!"
+#endif
+
 #endif /* __CONFIG_PARTITION_SPM_H__ */
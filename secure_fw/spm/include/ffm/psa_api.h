@@ -14,6 +14,8 @@
 #include "psa/client.h"
 #include "psa/service.h"
 
+struct conn_handle_t;
+
 /**
  * \brief This function handles the specific programmer error cases.
  *
@@ -70,6 +72,11 @@ uint32_t tfm_spm_client_psa_version(uint32_t sid);
  *                              \ref psa_invec
  * \param[in] outptr            Array of output psa_outvec structures.
  *                              \ref psa_outvec
+ * \param[in] p_stateless_handle SFN backend only. The connection handle
+ *                              storage for a call to a stateless service. It
+ *                              must be in the stack frame of the caller, which
+ *                              replies to the message before the frame is
+ *                              released.
  *
  * \retval PSA_SUCCESS          Success.
  * \retval "Does not return"    The call is invalid, one or more of the
@@ -81,10 +88,19 @@ uint32_t tfm_spm_client_psa_version(uint32_t sid);
  * \arg                           The message is unrecognized by the RoT
  *                                Service or incorrectly formatted.
  */
+#if CONFIG_TFM_SPM_BACKEND_SFN == 1
+psa_status_t tfm_spm_client_psa_call_sfn(
+                                    psa_handle_t handle,
+                                    uint32_t ctrl_param,
+                                    const psa_invec *inptr,
+                                    psa_outvec *outptr,
+                                    struct conn_handle_t *p_stateless_handle);
+#else
 psa_status_t tfm_spm_client_psa_call(psa_handle_t handle,
                                      uint32_t ctrl_param,
                                      const psa_invec *inptr,
                                      psa_outvec *outptr);
+#endif
 
 /* Following PSA APIs are only needed by connection-based services */
 #if CONFIG_TFM_CONNECTION_BASED_SERVICE_API == 1
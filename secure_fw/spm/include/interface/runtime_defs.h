@@ -23,4 +23,14 @@ struct runtime_metadata_t {
     service_fn_t    sfn_table[];    /* Secure FuNctions Table */
 };
 
+/* SPM debug defs */
+
+/* Usage statistics of the SPM connection handle pool */
+struct tfm_conn_handle_stats_t {
+    uint32_t        total;          /* Number of handles in the pool */
+    uint32_t        free;           /* Number of handles currently free */
+    uint32_t        high_watermark; /* Max number of handles in use */
+    uint32_t        alloc_fails;    /* Number of failed allocations */
+};
+
 #endif /* __RUNTIME_DEFS_H__ */
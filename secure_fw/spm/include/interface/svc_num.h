@@ -40,6 +40,7 @@
 #define TFM_SVC_GET_BOOT_DATA           (0x40)
 #define TFM_SVC_SPM_INIT                (0x41)
 #define TFM_SVC_FLIH_FUNC_RETURN        (0x42)
+#define TFM_SVC_GET_CONN_HANDLE_STATS   (0x43)
 #define TFM_SVC_THREAD_NUMBER_END       (0x7F)
 #if TFM_SP_LOG_RAW_ENABLED
 #define TFM_SVC_OUTPUT_UNPRIV_STRING    (TFM_SVC_THREAD_NUMBER_END)
@@ -244,7 +244,8 @@ def process_partition_manifests(manifest_lists, configs):
         'ipc_partitions': [],
         'mmio_region_num': 0,
         'flih_num': 0,
-        'slih_num': 0
+        'slih_num': 0,
+        'client_partition_num': 0
     }
     config_impl = {
         'CONFIG_TFM_SPM_BACKEND_SFN'              : '0',
@@ -255,7 +256,8 @@ def process_partition_manifests(manifest_lists, configs):
         'CONFIG_TFM_CONNECTION_BASED_SERVICE_API' : '0',
         'CONFIG_TFM_MMIO_REGION_ENABLE'           : '0',
         'CONFIG_TFM_FLIH_API'                     : '0',
-        'CONFIG_TFM_SLIH_API'                     : '0'
+        'CONFIG_TFM_SLIH_API'                     : '0',
+        'CONFIG_TFM_CLIENT_PARTITION_NUM'         : '0'
     }
 
     isolation_level = int(configs['TFM_ISOLATION_LEVEL'], base = 10)
@@ -335,6 +337,11 @@ def process_partition_manifests(manifest_lists, configs):
             if manifest['model'] == 'IPC':
                 partition_statistics['ipc_partitions'].append(manifest['name'])
 
+        # Count the partitions which can be clients of RoT Services
+        if manifest['ns_agent'] or manifest.get('dependencies') \
+           or manifest.get('weak_dependencies'):
+            partition_statistics['client_partition_num'] += 1
+
         # Set initial value to -1 to make (srv_idx + 1) reflect the correct
         # number (0) when there are no services.
         srv_idx = -1
@@ -438,6 +445,9 @@ def process_partition_manifests(manifest_lists, configs):
     if partition_statistics['slih_num'] > 0:
         config_impl['CONFIG_TFM_SLIH_API'] = 1
 
+    config_impl['CONFIG_TFM_CLIENT_PARTITION_NUM'] = \
+        partition_statistics['client_partition_num']
+
     context['partitions'] = partition_list
     context['config_impl'] = config_impl
     context['stateless_services'] = process_stateless_services(partition_list)
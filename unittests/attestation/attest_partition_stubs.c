@@ -0,0 +1,609 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Stubs of the platform, of the SPM and of the Crypto service used by the
+ * Initial Attestation partition. The hashes and the HMACs are computed with
+ * Mbed TLS. The ECDSA signature is stubbed: it is the hash of the
+ * to-be-signed bytes repeated to the size of a signature, so that the tests
+ * can check what was signed and measure the cost of the token encoding alone.
+ */
+
+#include <string.h>
+
+#include "attest.h"
+#include "attest_key.h"
+#include "attest_partition_stubs.h"
+#include "mbedtls/md.h"
+#include "qcbor.h"
+#include "tfm_attest_hal.h"
+#include "tfm_attest_iat_defs.h"
+#include "tfm_boot_status.h"
+#include "tfm_crypto_defs.h"
+#include "tfm_plat_boot_seed.h"
+#include "tfm_plat_device_id.h"
+
+/* Number of hash and MAC operations which can be active at the same time */
+#define STUB_OPERATION_NUM      (4u)
+
+/* Size of the boot status shared by the stubbed bootloader */
+#define STUB_BOOT_DATA_SIZE     (512u)
+
+/* Size of the encoded SW component claims of the stubbed boot records */
+#define STUB_BOOT_RECORD_SIZE   (96u)
+
+/* Key of the HMAC attestation key */
+static const uint8_t stub_hmac_key[32] = {
+    0x04, 0x9b, 0x5e, 0x12, 0xd8, 0x33, 0x6c, 0xa1,
+    0x7f, 0x20, 0x4e, 0xb9, 0x55, 0x0a, 0xc6, 0x38,
+    0x91, 0xe2, 0x6d, 0x17, 0x4a, 0xf0, 0x8c, 0x23,
+    0x5b, 0xc9, 0x06, 0x7e, 0xa4, 0x1d, 0x62, 0xff,
+};
+
+static const uint8_t stub_implementation_id[IMPLEMENTATION_ID_MAX_SIZE] = {
+    0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA,
+    0xBB, 0xBB, 0xBB, 0xBB, 0xBB, 0xBB, 0xBB, 0xBB,
+    0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC,
+    0xDD, 0xDD, 0xDD, 0xDD, 0xDD, 0xDD, 0xDD, 0xDD,
+};
+
+static const uint8_t stub_instance_id[INSTANCE_ID_MAX_SIZE] = {
+    0x01,
+    0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
+    0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF,
+    0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7,
+    0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF,
+};
+
+struct attest_stub_claims attest_stub_claims;
+struct attest_stub_crypto_stats attest_stub_crypto_stats;
+uint32_t attest_stub_static_claim_reads;
+
+static struct {
+    psa_key_type_t key_type;
+    size_t key_bits;
+    bool lifecycle_changing;
+    uint32_t lifecycle_reads;
+    mbedtls_md_context_t ops[STUB_OPERATION_NUM];
+    psa_algorithm_t op_alg[STUB_OPERATION_NUM];
+    bool op_in_use[STUB_OPERATION_NUM];
+    uint32_t boot_data_len;
+    uint8_t boot_data[STUB_BOOT_DATA_SIZE];
+    const uint8_t *raw_boot_data;
+    size_t raw_boot_data_len;
+} stub;
+
+void attest_stub_reset(void)
+{
+    attest_stub_claims.verification_service = "www.trustedfirmware.org";
+    attest_stub_claims.profile_definition = "PSA_IOT_PROFILE_1";
+    attest_stub_claims.cert_ref = "0604565272829-10010";
+    attest_stub_claims.cert_ref_in_boot_data = false;
+    attest_stub_claims.sw_component_cnt = 2;
+    attest_stub_claims.caller_id = -1;
+
+#ifdef SYMMETRIC_INITIAL_ATTESTATION
+    attest_stub_set_key(PSA_KEY_TYPE_HMAC, 256);
+#else
+    attest_stub_set_key(PSA_KEY_TYPE_ECC_KEY_PAIR(PSA_ECC_FAMILY_SECP_R1), 256);
+#endif
+    stub.lifecycle_changing = false;
+    stub.raw_boot_data = NULL;
+    stub.raw_boot_data_len = 0;
+
+    (void)memset(&attest_stub_crypto_stats, 0,
+                 sizeof(attest_stub_crypto_stats));
+    attest_stub_static_claim_reads = 0;
+}
+
+void attest_stub_set_key(psa_key_type_t type, size_t bits)
+{
+    stub.key_type = type;
+    stub.key_bits = bits;
+}
+
+void attest_stub_set_lifecycle_changing(bool changing)
+{
+    stub.lifecycle_changing = changing;
+}
+
+void attest_stub_set_boot_data(const uint8_t *data, size_t len)
+{
+    stub.raw_boot_data = data;
+    stub.raw_boot_data_len = len;
+}
+
+/*------------------------------- Platform -----------------------------------*/
+
+static enum tfm_plat_err_t copy_claim(const void *value, size_t len,
+                                      uint32_t *size, uint8_t *buf)
+{
+    attest_stub_static_claim_reads++;
+
+    if ((value == NULL) || (len > *size)) {
+        return TFM_PLAT_ERR_SYSTEM_ERR;
+    }
+
+    (void)memcpy(buf, value, len);
+    *size = (uint32_t)len;
+
+    return TFM_PLAT_ERR_SUCCESS;
+}
+
+enum tfm_plat_err_t tfm_plat_get_implementation_id(uint32_t *size,
+                                                   uint8_t *buf)
+{
+    return copy_claim(stub_implementation_id, sizeof(stub_implementation_id),
+                      size, buf);
+}
+
+enum tfm_plat_err_t tfm_plat_get_cert_ref(uint32_t *size, uint8_t *buf)
+{
+    return copy_claim(attest_stub_claims.cert_ref,
+                      strlen(attest_stub_claims.cert_ref), size, buf);
+}
+
+enum tfm_plat_err_t tfm_plat_get_boot_seed(uint32_t size, uint8_t *buf)
+{
+    uint32_t i;
+
+    attest_stub_static_claim_reads++;
+
+    for (i = 0; i < size; i++) {
+        buf[i] = (uint8_t)(0x50 + i);
+    }
+
+    return TFM_PLAT_ERR_SUCCESS;
+}
+
+enum tfm_security_lifecycle_t tfm_attest_hal_get_security_lifecycle(void)
+{
+    if (stub.lifecycle_changing && ((stub.lifecycle_reads++ & 1u) != 0)) {
+        return TFM_SLC_NON_PSA_ROT_DEBUG;
+    }
+
+    return TFM_SLC_SECURED;
+}
+
+enum tfm_plat_err_t
+tfm_attest_hal_get_verification_service(uint32_t *size, uint8_t *buf)
+{
+    return copy_claim(attest_stub_claims.verification_service,
+                      strlen(attest_stub_claims.verification_service),
+                      size, buf);
+}
+
+enum tfm_plat_err_t
+tfm_attest_hal_get_profile_definition(uint32_t *size, uint8_t *buf)
+{
+    return copy_claim(attest_stub_claims.profile_definition,
+                      strlen(attest_stub_claims.profile_definition),
+                      size, buf);
+}
+
+/*---------------------------------- SPM -------------------------------------*/
+
+static void add_boot_data(uint16_t tlv_type, const void *value, uint16_t len)
+{
+    struct shared_data_tlv_entry entry = {tlv_type, len};
+
+    if (stub.boot_data_len + SHARED_DATA_ENTRY_SIZE(len) >
+        sizeof(stub.boot_data)) {
+        return;
+    }
+
+    (void)memcpy(&stub.boot_data[stub.boot_data_len], &entry, sizeof(entry));
+    (void)memcpy(&stub.boot_data[stub.boot_data_len + sizeof(entry)],
+                 value, len);
+    stub.boot_data_len += SHARED_DATA_ENTRY_SIZE(len);
+}
+
+/* Encodes the SW component claims of a boot record as MCUboot does */
+static void add_boot_record(uint8_t module)
+{
+    uint8_t record_buf[STUB_BOOT_RECORD_SIZE];
+    struct q_useful_buf record = {record_buf, sizeof(record_buf)};
+    uint8_t hash[32];
+    QCBOREncodeContext ctx;
+    struct q_useful_buf_c encoded;
+
+    (void)memset(hash, 0x10 * module, sizeof(hash));
+
+    QCBOREncode_Init(&ctx, record);
+    QCBOREncode_OpenMap(&ctx);
+    QCBOREncode_AddSZStringToMapN(&ctx, IAT_SW_COMPONENT_MEASUREMENT_TYPE,
+                                  "SPE");
+    QCBOREncode_AddSZStringToMapN(&ctx, IAT_SW_COMPONENT_VERSION, "1.6.0");
+    QCBOREncode_AddBytesToMapN(&ctx, IAT_SW_COMPONENT_SIGNER_ID,
+                               (struct q_useful_buf_c){hash, sizeof(hash)});
+    QCBOREncode_AddBytesToMapN(&ctx, IAT_SW_COMPONENT_MEASUREMENT_VALUE,
+                               (struct q_useful_buf_c){hash, sizeof(hash)});
+    QCBOREncode_CloseMap(&ctx);
+    if (QCBOREncode_Finish(&ctx, &encoded) != QCBOR_SUCCESS) {
+        return;
+    }
+
+    add_boot_data(SET_TLV_TYPE(TLV_MAJOR_IAS,
+                               SET_IAS_MINOR(module, SW_BOOT_RECORD)),
+                  encoded.ptr, (uint16_t)encoded.len);
+}
+
+enum psa_attest_err_t
+attest_get_boot_data(uint8_t major_type,
+                     struct tfm_boot_data *boot_data,
+                     uint32_t len)
+{
+    struct shared_data_tlv_header header;
+    const char *cert_ref = attest_stub_claims.cert_ref;
+    uint32_t i;
+
+    if (major_type != TLV_MAJOR_IAS) {
+        return PSA_ATTEST_ERR_INVALID_INPUT;
+    }
+
+    if (stub.raw_boot_data != NULL) {
+        /* Shared as it is, whether it is well formed or not */
+        if (stub.raw_boot_data_len > len) {
+            return PSA_ATTEST_ERR_INIT_FAILED;
+        }
+        (void)memcpy(boot_data, stub.raw_boot_data, stub.raw_boot_data_len);
+
+        return PSA_ATTEST_ERR_SUCCESS;
+    }
+
+    /* The boot status follows the claims of the stubbed bootloader */
+    stub.boot_data_len = SHARED_DATA_HEADER_SIZE;
+    for (i = 0; (i < attest_stub_claims.sw_component_cnt) &&
+                (SW_BL2 + i < SW_MAX); i++) {
+        add_boot_record((uint8_t)(SW_BL2 + i));
+    }
+    if (attest_stub_claims.cert_ref_in_boot_data) {
+        add_boot_data(SET_TLV_TYPE(TLV_MAJOR_IAS,
+                                   SET_IAS_MINOR(SW_GENERAL, CERT_REF)),
+                      cert_ref, (uint16_t)strlen(cert_ref));
+    }
+
+    header.tlv_magic = SHARED_DATA_TLV_INFO_MAGIC;
+    header.tlv_tot_len = (uint16_t)stub.boot_data_len;
+    (void)memcpy(stub.boot_data, &header, sizeof(header));
+
+    if (stub.boot_data_len > len) {
+        return PSA_ATTEST_ERR_INIT_FAILED;
+    }
+    (void)memcpy(boot_data, stub.boot_data, stub.boot_data_len);
+
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
+enum psa_attest_err_t attest_get_caller_client_id(int32_t *caller_id)
+{
+    *caller_id = attest_stub_claims.caller_id;
+
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
+/*------------------------------ Attestation key -----------------------------*/
+
+enum psa_attest_err_t attest_get_instance_id(struct q_useful_buf_c *id_buf)
+{
+    id_buf->ptr = stub_instance_id;
+    id_buf->len = sizeof(stub_instance_id);
+
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
+/*---------------------------------- Crypto ----------------------------------*/
+
+static mbedtls_md_type_t stub_md_type(psa_algorithm_t hash_alg)
+{
+    switch (hash_alg) {
+    case PSA_ALG_SHA_256:
+        return MBEDTLS_MD_SHA256;
+    case PSA_ALG_SHA_384:
+        return MBEDTLS_MD_SHA384;
+    case PSA_ALG_SHA_512:
+        return MBEDTLS_MD_SHA512;
+    default:
+        return MBEDTLS_MD_NONE;
+    }
+}
+
+/* Operations are handles to Mbed TLS contexts, 0 being no operation */
+static psa_status_t stub_op_setup(uint32_t *handle, psa_algorithm_t hash_alg,
+                                  int hmac)
+{
+    const mbedtls_md_info_t *info;
+    uint32_t i;
+
+    info = mbedtls_md_info_from_type(stub_md_type(hash_alg));
+    if ((info == NULL) || (*handle != 0)) {
+        return (info == NULL) ? PSA_ERROR_NOT_SUPPORTED : PSA_ERROR_BAD_STATE;
+    }
+
+    for (i = 0; i < STUB_OPERATION_NUM; i++) {
+        if (!stub.op_in_use[i]) {
+            break;
+        }
+    }
+    if (i == STUB_OPERATION_NUM) {
+        return PSA_ERROR_INSUFFICIENT_MEMORY;
+    }
+
+    mbedtls_md_init(&stub.ops[i]);
+    if (mbedtls_md_setup(&stub.ops[i], info, hmac) != 0) {
+        mbedtls_md_free(&stub.ops[i]);
+        return PSA_ERROR_INSUFFICIENT_MEMORY;
+    }
+    stub.op_in_use[i] = true;
+    stub.op_alg[i] = hash_alg;
+    *handle = i + 1;
+
+    return PSA_SUCCESS;
+}
+
+static mbedtls_md_context_t *stub_op_get(uint32_t handle)
+{
+    if ((handle == 0) || (handle > STUB_OPERATION_NUM) ||
+        !stub.op_in_use[handle - 1]) {
+        return NULL;
+    }
+
+    return &stub.ops[handle - 1];
+}
+
+static void stub_op_release(uint32_t *handle)
+{
+    mbedtls_md_context_t *ctx = stub_op_get(*handle);
+
+    if (ctx != NULL) {
+        mbedtls_md_free(ctx);
+        stub.op_in_use[*handle - 1] = false;
+    }
+    *handle = 0;
+}
+
+static psa_status_t stub_op_finish(uint32_t *handle, int hmac,
+                                   uint8_t *out, size_t out_size,
+                                   size_t *out_len)
+{
+    mbedtls_md_context_t *ctx = stub_op_get(*handle);
+    size_t len;
+    int ret;
+
+    if (ctx == NULL) {
+        return PSA_ERROR_BAD_STATE;
+    }
+
+    len = mbedtls_md_get_size(ctx->md_info);
+    if (out_size < len) {
+        stub_op_release(handle);
+        return PSA_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    ret = hmac ? mbedtls_md_hmac_finish(ctx, out) : mbedtls_md_finish(ctx, out);
+    *out_len = len;
+    stub_op_release(handle);
+
+    return (ret == 0) ? PSA_SUCCESS : PSA_ERROR_GENERIC_ERROR;
+}
+
+psa_status_t psa_get_key_attributes(psa_key_id_t key,
+                                    psa_key_attributes_t *attributes)
+{
+    attest_stub_crypto_stats.get_key_attributes_calls++;
+
+    if (key != TFM_BUILTIN_KEY_ID_IAK) {
+        return PSA_ERROR_INVALID_HANDLE;
+    }
+
+    *attributes = psa_key_attributes_init();
+    psa_set_key_type(attributes, stub.key_type);
+    psa_set_key_bits(attributes, stub.key_bits);
+
+    return PSA_SUCCESS;
+}
+
+psa_status_t psa_hash_setup(psa_hash_operation_t *operation,
+                            psa_algorithm_t alg)
+{
+    psa_status_t status = stub_op_setup(&operation->handle, alg, 0);
+
+    if (status == PSA_SUCCESS &&
+        mbedtls_md_starts(stub_op_get(operation->handle)) != 0) {
+        stub_op_release(&operation->handle);
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    return status;
+}
+
+psa_status_t psa_hash_update(psa_hash_operation_t *operation,
+                             const uint8_t *input,
+                             size_t input_length)
+{
+    mbedtls_md_context_t *ctx = stub_op_get(operation->handle);
+
+    if (ctx == NULL) {
+        return PSA_ERROR_BAD_STATE;
+    }
+
+    return (mbedtls_md_update(ctx, input, input_length) == 0) ?
+           PSA_SUCCESS : PSA_ERROR_GENERIC_ERROR;
+}
+
+psa_status_t psa_hash_finish(psa_hash_operation_t *operation,
+                             uint8_t *hash,
+                             size_t hash_size,
+                             size_t *hash_length)
+{
+    return stub_op_finish(&operation->handle, 0, hash, hash_size,
+                          hash_length);
+}
+
+psa_status_t psa_hash_abort(psa_hash_operation_t *operation)
+{
+    stub_op_release(&operation->handle);
+
+    return PSA_SUCCESS;
+}
+
+psa_status_t psa_hash_clone(const psa_hash_operation_t *source_operation,
+                            psa_hash_operation_t *target_operation)
+{
+    mbedtls_md_context_t *src = stub_op_get(source_operation->handle);
+    psa_status_t status;
+
+    if (src == NULL) {
+        return PSA_ERROR_BAD_STATE;
+    }
+
+    status = stub_op_setup(&target_operation->handle,
+                           stub.op_alg[source_operation->handle - 1], 0);
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+
+    if (mbedtls_md_clone(stub_op_get(target_operation->handle), src) != 0) {
+        stub_op_release(&target_operation->handle);
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    return PSA_SUCCESS;
+}
+
+psa_status_t psa_mac_sign_setup(psa_mac_operation_t *operation,
+                                psa_key_id_t key,
+                                psa_algorithm_t alg)
+{
+    psa_status_t status;
+
+    if ((key != TFM_BUILTIN_KEY_ID_IAK) ||
+        (stub.key_type != PSA_KEY_TYPE_HMAC) || !PSA_ALG_IS_HMAC(alg)) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    status = stub_op_setup(&operation->handle, PSA_ALG_HMAC_GET_HASH(alg), 1);
+    if (status == PSA_SUCCESS &&
+        mbedtls_md_hmac_starts(stub_op_get(operation->handle), stub_hmac_key,
+                               sizeof(stub_hmac_key)) != 0) {
+        stub_op_release(&operation->handle);
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    return status;
+}
+
+psa_status_t psa_mac_verify_setup(psa_mac_operation_t *operation,
+                                  psa_key_id_t key,
+                                  psa_algorithm_t alg)
+{
+    return psa_mac_sign_setup(operation, key, alg);
+}
+
+psa_status_t psa_mac_update(psa_mac_operation_t *operation,
+                            const uint8_t *input,
+                            size_t input_length)
+{
+    mbedtls_md_context_t *ctx = stub_op_get(operation->handle);
+
+    if (ctx == NULL) {
+        return PSA_ERROR_BAD_STATE;
+    }
+
+    return (mbedtls_md_hmac_update(ctx, input, input_length) == 0) ?
+           PSA_SUCCESS : PSA_ERROR_GENERIC_ERROR;
+}
+
+psa_status_t psa_mac_sign_finish(psa_mac_operation_t *operation,
+                                 uint8_t *mac,
+                                 size_t mac_size,
+                                 size_t *mac_length)
+{
+    attest_stub_crypto_stats.mac_sign_calls++;
+
+    return stub_op_finish(&operation->handle, 1, mac, mac_size, mac_length);
+}
+
+psa_status_t psa_mac_verify_finish(psa_mac_operation_t *operation,
+                                   const uint8_t *mac,
+                                   size_t mac_length)
+{
+    uint8_t expected[PSA_HASH_LENGTH(PSA_ALG_SHA_512)];
+    size_t expected_len;
+    psa_status_t status;
+
+    status = stub_op_finish(&operation->handle, 1, expected, sizeof(expected),
+                            &expected_len);
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+
+    return ((mac_length == expected_len) &&
+            (memcmp(mac, expected, expected_len) == 0)) ?
+           PSA_SUCCESS : PSA_ERROR_INVALID_SIGNATURE;
+}
+
+psa_status_t psa_mac_abort(psa_mac_operation_t *operation)
+{
+    stub_op_release(&operation->handle);
+
+    return PSA_SUCCESS;
+}
+
+psa_status_t psa_sign_hash(psa_key_id_t key,
+                           psa_algorithm_t alg,
+                           const uint8_t *hash,
+                           size_t hash_length,
+                           uint8_t *signature,
+                           size_t signature_size,
+                           size_t *signature_length)
+{
+    size_t sig_len = PSA_ECDSA_SIGNATURE_SIZE(stub.key_bits);
+    size_t i;
+
+    attest_stub_crypto_stats.sign_hash_calls++;
+
+    if ((key != TFM_BUILTIN_KEY_ID_IAK) || !PSA_ALG_IS_ECDSA(alg) ||
+        (hash_length == 0)) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+    if (signature_size < sig_len) {
+        return PSA_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    /* The stubbed signature is the signed hash, repeated */
+    for (i = 0; i < sig_len; i++) {
+        signature[i] = hash[i % hash_length];
+    }
+    *signature_length = sig_len;
+
+    return PSA_SUCCESS;
+}
+
+psa_status_t psa_verify_hash(psa_key_id_t key,
+                             psa_algorithm_t alg,
+                             const uint8_t *hash,
+                             size_t hash_length,
+                             const uint8_t *signature,
+                             size_t signature_length)
+{
+    size_t i;
+
+    if ((key != TFM_BUILTIN_KEY_ID_IAK) || !PSA_ALG_IS_ECDSA(alg) ||
+        (hash_length == 0) ||
+        (signature_length != PSA_ECDSA_SIGNATURE_SIZE(stub.key_bits))) {
+        return PSA_ERROR_INVALID_SIGNATURE;
+    }
+
+    for (i = 0; i < signature_length; i++) {
+        if (signature[i] != hash[i % hash_length]) {
+            return PSA_ERROR_INVALID_SIGNATURE;
+        }
+    }
+
+    return PSA_SUCCESS;
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __ATTEST_PARTITION_STUBS_H__
+#define __ATTEST_PARTITION_STUBS_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "psa/crypto.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Values of the claims returned by the stubbed platform, and content
+ *        of the boot status it shares. They are read again by attest_init(),
+ *        which the tests call after changing them, as the claims which are
+ *        constant for the boot session are cached.
+ */
+struct attest_stub_claims {
+    const char *verification_service;
+    const char *profile_definition;
+    const char *cert_ref;
+    bool cert_ref_in_boot_data;
+    uint32_t sw_component_cnt;
+    int32_t caller_id;
+};
+
+/**
+ * \brief Statistics of the stubbed Crypto service.
+ */
+struct attest_stub_crypto_stats {
+    uint32_t get_key_attributes_calls;
+    uint32_t sign_hash_calls;
+    uint32_t mac_sign_calls;
+};
+
+/**
+ * \brief Claims of the stubbed platform. The defaults are restored by
+ *        attest_stub_reset().
+ */
+extern struct attest_stub_claims attest_stub_claims;
+
+/**
+ * \brief Calls served by the stubbed Crypto service.
+ */
+extern struct attest_stub_crypto_stats attest_stub_crypto_stats;
+
+/**
+ * \brief Reads of the claims constant for the boot session from the stubbed
+ *        platform.
+ */
+extern uint32_t attest_stub_static_claim_reads;
+
+/**
+ * \brief Restores the default claims, the P-256 (or HMAC-SHA256) attestation
+ *        key and the statistics.
+ */
+void attest_stub_reset(void);
+
+/**
+ * \brief Sets the type and size of the attestation key.
+ */
+void attest_stub_set_key(psa_key_type_t type, size_t bits);
+
+/**
+ * \brief Makes the security lifecycle change each time it is read, as a
+ *        lifecycle transition in the middle of a request would.
+ */
+void attest_stub_set_lifecycle_changing(bool changing);
+
+/**
+ * \brief Shares the given boot status, header included, instead of the one
+ *        built from the claims. NULL restores the built one.
+ */
+void attest_stub_set_boot_data(const uint8_t *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ATTEST_PARTITION_STUBS_H__ */
@@ -0,0 +1,430 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Checks the index of the boot status built by attest_boot_data_init()
+ * against the linear scan of the TLV section it replaces, on boot status
+ * areas of random entries, and compares the rates of both look ups.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "attest.h"
+#include "attest_boot_data.h"
+#include "attest_partition_stubs.h"
+#include "q_useful_buf.h"
+#include "qcbor.h"
+#include "tfm_boot_status.h"
+
+#include "tfm_unittest.h"
+
+/* Size of the boot status the partition gets, see attest_boot_data.c */
+#define TEST_BOOT_DATA_SIZE     (512u)
+#define TEST_AREA_NUM           (500u)
+#define TEST_MAX_VALUE_SIZE     (40u)
+#define TEST_SW_COMPONENTS_SIZE (1024u)
+#define TEST_BENCH_NS           (500000000u)
+#define TEST_BENCH_LOOKUPS      (100u)
+
+static uint8_t area[TEST_BOOT_DATA_SIZE];
+
+/*------------------------------- Helpers ------------------------------------*/
+
+static uint32_t test_rand(uint32_t *state)
+{
+    /* xorshift32 */
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+
+    return *state;
+}
+
+static void set_header(size_t tot_len)
+{
+    struct shared_data_tlv_header header = {SHARED_DATA_TLV_INFO_MAGIC,
+                                            (uint16_t)tot_len};
+
+    (void)memcpy(area, &header, sizeof(header));
+}
+
+/* Appends an entry to the area, returns the new length or 0 if it is full */
+static size_t add_entry(size_t tot_len, uint8_t module, uint8_t claim,
+                        const uint8_t *value, uint16_t len)
+{
+    struct shared_data_tlv_entry entry;
+
+    if (tot_len + SHARED_DATA_ENTRY_SIZE(len) > sizeof(area)) {
+        return 0;
+    }
+
+    entry.tlv_type = SET_TLV_TYPE(TLV_MAJOR_IAS, SET_IAS_MINOR(module, claim));
+    entry.tlv_len = len;
+    (void)memcpy(&area[tot_len], &entry, sizeof(entry));
+    (void)memcpy(&area[tot_len + sizeof(entry)], value, len);
+
+    return tot_len + SHARED_DATA_ENTRY_SIZE(len);
+}
+
+/*
+ * Fills the area with random entries: mostly SW_GENERAL claims and boot
+ * records, with repeated types and modules out of the SW_* range. The value
+ * of a boot record is a CBOR byte string, as it is added to the token as it
+ * is.
+ */
+static size_t build_area(uint32_t seed)
+{
+    uint8_t value[TEST_MAX_VALUE_SIZE];
+    uint32_t state = seed * 2654435761u + 1;
+    uint32_t num_entries = test_rand(&state) % 24;
+    size_t tot_len = SHARED_DATA_HEADER_SIZE;
+    size_t next;
+    uint32_t i, j;
+    uint16_t len;
+    uint8_t module;
+    uint8_t claim;
+
+    (void)memset(area, 0, sizeof(area));
+
+    for (i = 0; i < num_entries; i++) {
+        switch (test_rand(&state) % 4) {
+        case 0:
+            module = SW_GENERAL;
+            claim = (uint8_t)(test_rand(&state) % 2 ? BOOT_SEED : CERT_REF);
+            break;
+        case 1:
+            module = SW_GENERAL;
+            claim = (uint8_t)(test_rand(&state) & CLAIM_MASK);
+            break;
+        case 2:
+            module = (uint8_t)(1 + test_rand(&state) % (SW_MAX + 2));
+            claim = SW_BOOT_RECORD;
+            break;
+        default:
+            module = (uint8_t)(test_rand(&state) & MODULE_MASK);
+            claim = (uint8_t)(test_rand(&state) & CLAIM_MASK);
+            break;
+        }
+
+        len = (uint16_t)(test_rand(&state) % TEST_MAX_VALUE_SIZE);
+        for (j = 0; j < len; j++) {
+            value[j] = (uint8_t)test_rand(&state);
+        }
+        if ((claim == SW_BOOT_RECORD) && (len != 0)) {
+            len = (uint16_t)((len > 23) ? 23 : len);
+            value[0] = (uint8_t)(0x40 | (len - 1));
+        }
+
+        next = add_entry(tot_len, module, claim, value, len);
+        if (next == 0) {
+            break;
+        }
+        tot_len = next;
+    }
+
+    set_header(tot_len);
+
+    return tot_len;
+}
+
+static int init_boot_data(void)
+{
+    attest_stub_reset();
+    attest_stub_set_boot_data(area, sizeof(area));
+
+    return (attest_boot_data_init() == PSA_ATTEST_ERR_SUCCESS) ? 0 : 1;
+}
+
+/*
+ * Linear scan of the TLV section which the index replaces: looks up the next
+ * entry of a module, from the beginning of the section when *tlv_ptr is NULL.
+ */
+static int32_t scan_tlv_by_module(uint8_t module, uint8_t *claim,
+                                  uint16_t *tlv_len, uint8_t **tlv_ptr)
+{
+    struct shared_data_tlv_header header;
+    struct shared_data_tlv_entry tlv_entry;
+    uint8_t *tlv_end;
+    uint8_t *tlv_curr;
+
+    (void)memcpy(&header, area, sizeof(header));
+    if (header.tlv_magic != SHARED_DATA_TLV_INFO_MAGIC) {
+        return -1;
+    }
+
+    tlv_end = area + header.tlv_tot_len;
+    if (*tlv_ptr == NULL) {
+        tlv_curr = area + SHARED_DATA_HEADER_SIZE;
+    } else {
+        (void)memcpy(&tlv_entry, *tlv_ptr, SHARED_DATA_ENTRY_HEADER_SIZE);
+        tlv_curr = *tlv_ptr + SHARED_DATA_ENTRY_SIZE(tlv_entry.tlv_len);
+    }
+
+    while (tlv_curr < tlv_end) {
+        (void)memcpy(&tlv_entry, tlv_curr, SHARED_DATA_ENTRY_HEADER_SIZE);
+        if (GET_IAS_MODULE(tlv_entry.tlv_type) == module) {
+            *claim = GET_IAS_CLAIM(tlv_entry.tlv_type);
+            *tlv_ptr = tlv_curr;
+            *tlv_len = tlv_entry.tlv_len;
+            return 1;
+        }
+
+        tlv_curr += SHARED_DATA_ENTRY_SIZE(tlv_entry.tlv_len);
+    }
+
+    return 0;
+}
+
+static int32_t scan_tlv_by_id(uint8_t claim, uint16_t *tlv_len,
+                              uint8_t **tlv_ptr)
+{
+    uint8_t tlv_id;
+    int32_t found;
+
+    *tlv_ptr = NULL;
+    do {
+        found = scan_tlv_by_module(SW_GENERAL, &tlv_id, tlv_len, tlv_ptr);
+    } while ((found == 1) && (tlv_id != claim));
+
+    return found;
+}
+
+/* Encodes the SW components from the linear scan, as the index does */
+static void scan_sw_components(QCBOREncodeContext *encode_ctx, uint32_t *cnt)
+{
+    struct q_useful_buf_c encoded;
+    uint16_t tlv_len;
+    uint8_t *tlv_ptr;
+    uint8_t tlv_id;
+    uint8_t module;
+
+    *cnt = 0;
+    for (module = 0; module < SW_MAX; module++) {
+        tlv_ptr = NULL;
+        if ((scan_tlv_by_module(module, &tlv_id, &tlv_len, &tlv_ptr) == 1) &&
+            (tlv_id == SW_BOOT_RECORD)) {
+            if (++(*cnt) == 1) {
+                QCBOREncode_OpenArray(encode_ctx);
+            }
+            encoded.ptr = tlv_ptr + SHARED_DATA_ENTRY_HEADER_SIZE;
+            encoded.len = tlv_len;
+            QCBOREncode_AddEncoded(encode_ctx, encoded);
+        }
+    }
+    if (*cnt != 0) {
+        QCBOREncode_CloseArray(encode_ctx);
+    }
+}
+
+/* Compares the SW components claim built from the index and from the scan */
+static int compare_sw_components(void)
+{
+    static uint8_t index_buf[TEST_SW_COMPONENTS_SIZE];
+    static uint8_t scan_buf[TEST_SW_COMPONENTS_SIZE];
+    struct q_useful_buf index_ub = {index_buf, sizeof(index_buf)};
+    struct q_useful_buf scan_ub = {scan_buf, sizeof(scan_buf)};
+    struct q_useful_buf_c index_enc = NULL_Q_USEFUL_BUF_C;
+    struct q_useful_buf_c scan_enc = NULL_Q_USEFUL_BUF_C;
+    QCBOREncodeContext ctx;
+    uint32_t index_cnt, scan_cnt;
+
+    QCBOREncode_Init(&ctx, index_ub);
+    if (attest_encode_sw_components_array(&ctx, NULL, &index_cnt) !=
+        PSA_ATTEST_ERR_SUCCESS) {
+        return 1;
+    }
+    if ((index_cnt != 0) &&
+        (QCBOREncode_Finish(&ctx, &index_enc) != QCBOR_SUCCESS)) {
+        return 1;
+    }
+
+    QCBOREncode_Init(&ctx, scan_ub);
+    scan_sw_components(&ctx, &scan_cnt);
+    if ((scan_cnt != 0) &&
+        (QCBOREncode_Finish(&ctx, &scan_enc) != QCBOR_SUCCESS)) {
+        return 1;
+    }
+
+    return ((index_cnt == scan_cnt) && (index_enc.len == scan_enc.len) &&
+            ((index_enc.len == 0) ||
+             (memcmp(index_enc.ptr, scan_enc.ptr, index_enc.len) == 0))) ?
+           0 : 1;
+}
+
+/*------------------------------- Tests --------------------------------------*/
+
+/*
+ * Each SW_GENERAL claim and the SW components claim must be the same from the
+ * index as from the linear scan: the first entry of the claim, or of each
+ * module.
+ */
+static int test_index_matches_scan(void)
+{
+    uint16_t index_len, scan_len;
+    uint8_t *index_ptr, *scan_ptr;
+    int32_t index_found, scan_found;
+    uint32_t seed;
+    uint32_t claim;
+
+    for (seed = 0; seed < TEST_AREA_NUM; seed++) {
+        (void)build_area(seed);
+        TEST_ASSERT(init_boot_data() == 0, "Initialisation failed");
+
+        for (claim = 0; claim <= CLAIM_MASK; claim++) {
+            index_found = attest_get_tlv_by_id((uint8_t)claim, &index_len,
+                                               &index_ptr);
+            scan_found = scan_tlv_by_id((uint8_t)claim, &scan_len, &scan_ptr);
+            if ((index_found != scan_found) ||
+                ((index_found == 1) &&
+                 ((index_len != scan_len) ||
+                  (memcmp(index_ptr, scan_ptr,
+                          SHARED_DATA_ENTRY_SIZE(index_len)) != 0)))) {
+                printf("Area %u: claim %u differs from the scan\r\n",
+                       (unsigned)seed, (unsigned)claim);
+                return 1;
+            }
+        }
+
+        if (compare_sw_components() != 0) {
+            printf("Area %u: SW components differ from the scan\r\n",
+                   (unsigned)seed);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * A malformed area is rejected as a whole when it is indexed, whereas the
+ * scan only fails on the entries it reaches.
+ */
+static int test_malformed_rejected(void)
+{
+    static const uint8_t value[8] = {0x47, 1, 2, 3, 4, 5, 6, 7};
+    struct shared_data_tlv_header header;
+    uint16_t tlv_len;
+    uint8_t *tlv_ptr;
+    uint32_t cnt;
+    QCBOREncodeContext ctx;
+    uint8_t buf[16];
+    size_t tot_len;
+    size_t i;
+
+    for (i = 0; i < 4; i++) {
+        (void)memset(area, 0, sizeof(area));
+        tot_len = add_entry(SHARED_DATA_HEADER_SIZE, SW_GENERAL, CERT_REF,
+                            value, sizeof(value));
+        tot_len = add_entry(tot_len, SW_BL2, SW_BOOT_RECORD,
+                            value, sizeof(value));
+
+        switch (i) {
+        case 0:
+            /* Entry header cut by the end of the section */
+            set_header(tot_len + 2);
+            break;
+        case 1:
+            /* Entry value running past the end of the section */
+            set_header(tot_len - 1);
+            break;
+        case 2:
+            /* Section larger than the boot status */
+            set_header(TEST_BOOT_DATA_SIZE + SHARED_DATA_HEADER_SIZE + 1);
+            break;
+        default:
+            set_header(tot_len);
+            (void)memcpy(&header, area, sizeof(header));
+            header.tlv_magic ^= 1;
+            (void)memcpy(area, &header, sizeof(header));
+            break;
+        }
+
+        TEST_ASSERT(init_boot_data() == 0, "Initialisation failed");
+        TEST_ASSERT(attest_get_tlv_by_id(CERT_REF, &tlv_len, &tlv_ptr) == -1,
+                    "Malformed boot status not rejected");
+
+        QCBOREncode_Init(&ctx, (struct q_useful_buf){buf, sizeof(buf)});
+        TEST_ASSERT(attest_encode_sw_components_array(&ctx, NULL, &cnt) ==
+                    PSA_ATTEST_ERR_CLAIM_UNAVAILABLE,
+                    "SW components of a malformed boot status encoded");
+    }
+
+    return 0;
+}
+
+/*------------------------------ Benchmark -----------------------------------*/
+
+/*
+ * Look ups of the last SW_GENERAL claim of a boot status of four boot
+ * records followed by the boot seed and the certification reference, as a
+ * token creation does.
+ */
+static int bench_lookup_rate(void)
+{
+    static const char *const names[] = {"index", "linear scan"};
+    uint8_t record[TEST_MAX_VALUE_SIZE * 2];
+    uint64_t start, elapsed;
+    uint32_t count;
+    uint16_t tlv_len;
+    uint8_t *tlv_ptr;
+    int32_t found;
+    size_t tot_len = SHARED_DATA_HEADER_SIZE;
+    size_t i, j;
+
+    (void)memset(area, 0, sizeof(area));
+    (void)memset(record, 0x5A, sizeof(record));
+    record[0] = 0x58;
+    record[1] = (uint8_t)(sizeof(record) - 2);
+    for (i = 0; i < 4; i++) {
+        tot_len = add_entry(tot_len, (uint8_t)(SW_BL2 + i), SW_BOOT_RECORD,
+                            record, sizeof(record));
+    }
+    tot_len = add_entry(tot_len, SW_GENERAL, BOOT_SEED, record, 32);
+    tot_len = add_entry(tot_len, SW_GENERAL, CERT_REF, record, 19);
+    TEST_ASSERT(tot_len != 0, "Boot status too large");
+    set_header(tot_len);
+    TEST_ASSERT(init_boot_data() == 0, "Initialisation failed");
+
+    printf("%u B of boot status\r\n", (unsigned)tot_len);
+    printf("%-26s %12s\r\n", "lookup", "lookups/s");
+
+    for (i = 0; i < 2; i++) {
+        count = 0;
+        start = tfm_unittest_now_ns();
+        do {
+            /* Several look ups per reading of the clock */
+            for (j = 0; j < TEST_BENCH_LOOKUPS; j++) {
+                found = (i == 0) ?
+                        attest_get_tlv_by_id(CERT_REF, &tlv_len, &tlv_ptr) :
+                        scan_tlv_by_id(CERT_REF, &tlv_len, &tlv_ptr);
+            }
+            count += TEST_BENCH_LOOKUPS;
+            elapsed = tfm_unittest_now_ns() - start;
+        } while ((found == 1) && (elapsed < TEST_BENCH_NS));
+
+        TEST_ASSERT(found == 1, "Claim not found");
+
+        printf("%-26s %12.0f\r\n", names[i],
+               tfm_unittest_per_s(count, elapsed));
+    }
+
+    return 0;
+}
+
+int main(void)
+{
+    uint32_t failures = 0;
+
+    RUN_TEST(test_index_matches_scan, failures);
+    RUN_TEST(test_malformed_rejected, failures);
+    RUN_TEST(bench_lookup_rate, failures);
+
+    return (failures == 0) ? 0 : 1;
+}
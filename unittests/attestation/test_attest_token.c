@@ -0,0 +1,841 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Creates initial attestation tokens through the partition API, with the
+ * platform, the SPM and the Crypto service stubbed. The ECDSA signature is
+ * stubbed, so that the signing rate is the one of the token encoding alone.
+ *
+ * Usage: test_attest_token [key_bits [token_file]]
+ * key_bits is the size of the attestation key, 0 for the default size.
+ *
+ * The tokens of a fixed set of challenges and claims are written to
+ * token_file, so that the tokens of two builds can be compared byte for byte.
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "attest.h"
+#include "attest_partition_stubs.h"
+#include "attest_token.h"
+#include "config_attest.h"
+#include "psa/crypto.h"
+#include "psa/initial_attestation.h"
+#include "tfm_crypto_defs.h"
+
+#include "tfm_unittest.h"
+
+#define TEST_TOKEN_BUF_SIZE     (0x400u)
+#if ATTEST_TOKEN_BATCH_MAX > 0
+#define TEST_SINK_SIZE          (TEST_TOKEN_BUF_SIZE * ATTEST_TOKEN_BATCH_MAX)
+#else
+#define TEST_SINK_SIZE          TEST_TOKEN_BUF_SIZE
+#endif
+#define TEST_BENCH_NS           (500000000u)
+
+/*!
+ * \brief Tokens compared between the builds, each created after its claims
+ *        are set up and the partition is initialised again.
+ */
+struct token_case_t {
+    const char *name;
+    size_t challenge_size;
+    uint32_t option_flags;
+    void (*setup)(void);
+};
+
+static size_t test_key_bits;
+static const char *test_token_file;
+
+static void setup_default(void)
+{
+}
+
+static void setup_caller_id(void)
+{
+    attest_stub_claims.caller_id = 0x1234;
+}
+
+static void setup_cert_ref_in_boot_data(void)
+{
+    attest_stub_claims.cert_ref_in_boot_data = true;
+}
+
+static void setup_no_sw_components(void)
+{
+    attest_stub_claims.sw_component_cnt = 0;
+}
+
+/* The head of a text string of 24 bytes or more takes a second byte */
+static void setup_24_byte_verification_service(void)
+{
+    attest_stub_claims.verification_service = "www.trustedfirmware.org/";
+}
+
+static void setup_max_verification_service(void)
+{
+    attest_stub_claims.verification_service =
+                                        "https://www.trustedfirmware.org/";
+}
+
+static void setup_24_byte_profile(void)
+{
+    attest_stub_claims.profile_definition = "http://arm.com/psa/2.0.0";
+}
+
+static const struct token_case_t token_cases[] = {
+    {"32-byte challenge", PSA_INITIAL_ATTEST_CHALLENGE_SIZE_32, 0,
+     setup_default},
+    {"48-byte challenge", PSA_INITIAL_ATTEST_CHALLENGE_SIZE_48, 0,
+     setup_default},
+    {"64-byte challenge", PSA_INITIAL_ATTEST_CHALLENGE_SIZE_64, 0,
+     setup_default},
+    {"omit claims", PSA_INITIAL_ATTEST_CHALLENGE_SIZE_64,
+     TOKEN_OPT_OMIT_CLAIMS, setup_default},
+    {"short-circuit signature", PSA_INITIAL_ATTEST_CHALLENGE_SIZE_64,
+     TOKEN_OPT_SHORT_CIRCUIT_SIGN, setup_default},
+    {"omit claims short-circuit", PSA_INITIAL_ATTEST_CHALLENGE_SIZE_64,
+     TOKEN_OPT_OMIT_CLAIMS | TOKEN_OPT_SHORT_CIRCUIT_SIGN, setup_default},
+    {"secure caller", PSA_INITIAL_ATTEST_CHALLENGE_SIZE_32, 0,
+     setup_caller_id},
+    {"boot data cert ref", PSA_INITIAL_ATTEST_CHALLENGE_SIZE_32, 0,
+     setup_cert_ref_in_boot_data},
+    {"no SW components", PSA_INITIAL_ATTEST_CHALLENGE_SIZE_32, 0,
+     setup_no_sw_components},
+    {"24-byte verification URL", PSA_INITIAL_ATTEST_CHALLENGE_SIZE_48, 0,
+     setup_24_byte_verification_service},
+    {"32-byte verification URL", PSA_INITIAL_ATTEST_CHALLENGE_SIZE_64, 0,
+     setup_max_verification_service},
+    {"24-byte profile", PSA_INITIAL_ATTEST_CHALLENGE_SIZE_32, 0,
+     setup_24_byte_profile},
+};
+
+#define TEST_TOKEN_CASE_NUM \
+    (sizeof(token_cases) / sizeof(token_cases[0]))
+
+/*------------------------------- Helpers ------------------------------------*/
+
+static void fill_challenge(uint8_t *challenge, size_t size, uint32_t seed)
+{
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+        challenge[i] = (uint8_t)(seed * 31u + i * 7u + 1u);
+    }
+}
+
+/* Builds the challenge of a case, with its options if it selects any */
+static void case_challenge(const struct token_case_t *tc, uint32_t seed,
+                           uint8_t *challenge)
+{
+    if (tc->option_flags != 0) {
+        (void)memset(challenge, 0, tc->challenge_size);
+        challenge[0] = (uint8_t)tc->option_flags;
+        challenge[1] = (uint8_t)(tc->option_flags >> 8);
+        challenge[2] = (uint8_t)(tc->option_flags >> 16);
+        challenge[3] = (uint8_t)(tc->option_flags >> 24);
+    } else {
+        fill_challenge(challenge, tc->challenge_size, seed);
+    }
+}
+
+/* Resets the stubs to the claims of a case and initialises the partition */
+static int setup_case(const struct token_case_t *tc)
+{
+    attest_stub_reset();
+    if (test_key_bits != 0) {
+#ifdef SYMMETRIC_INITIAL_ATTESTATION
+        attest_stub_set_key(PSA_KEY_TYPE_HMAC, test_key_bits);
+#else
+        attest_stub_set_key(PSA_KEY_TYPE_ECC_KEY_PAIR(PSA_ECC_FAMILY_SECP_R1),
+                            test_key_bits);
+#endif
+    }
+    tc->setup();
+
+    return (attest_init() == PSA_SUCCESS) ? 0 : 1;
+}
+
+/* Destination of a streamed token, or of the tokens of a batch */
+struct token_sink_t {
+    uint8_t buf[TEST_SINK_SIZE];
+    size_t len;
+    bool overflow;
+};
+
+static void sink_write(void *write_ctx, const uint8_t *buf, size_t len)
+{
+    struct token_sink_t *sink = write_ctx;
+
+    if (len > sizeof(sink->buf) - sink->len) {
+        sink->overflow = true;
+        return;
+    }
+    (void)memcpy(&sink->buf[sink->len], buf, len);
+    sink->len += len;
+}
+
+/* Reads the head of a CBOR item, returns its size or 0 if it is malformed */
+static size_t cbor_head(const uint8_t *buf, size_t len, uint8_t *major,
+                        uint64_t *arg)
+{
+    uint8_t info;
+    size_t size;
+    size_t i;
+
+    if (len == 0) {
+        return 0;
+    }
+    *major = buf[0] >> 5;
+    info = buf[0] & 0x1F;
+
+    if (info < 24) {
+        *arg = info;
+        return 1;
+    } else if (info > 27) {
+        return 0;
+    }
+
+    size = 1 + (1u << (info - 24));
+    if (size > len) {
+        return 0;
+    }
+    *arg = 0;
+    for (i = 1; i < size; i++) {
+        *arg = (*arg << 8) | buf[i];
+    }
+
+    return size;
+}
+
+/* Gets the size of a CBOR item, 0 if it is malformed */
+static size_t cbor_item_size(const uint8_t *buf, size_t len)
+{
+    uint8_t major;
+    uint64_t arg;
+    uint64_t items;
+    size_t size;
+    size_t item_size;
+
+    size = cbor_head(buf, len, &major, &arg);
+    if (size == 0) {
+        return 0;
+    }
+
+    switch (major) {
+    case 2:
+    case 3:
+        return (arg > len - size) ? 0 : size + (size_t)arg;
+    case 4:
+    case 5:
+        items = (major == 5) ? arg * 2 : arg;
+        for (; items > 0; items--) {
+            item_size = cbor_item_size(buf + size, len - size);
+            if (item_size == 0) {
+                return 0;
+            }
+            size += item_size;
+        }
+        return size;
+    case 6:
+        item_size = cbor_item_size(buf + size, len - size);
+        return (item_size == 0) ? 0 : size + item_size;
+    default:
+        return size;
+    }
+}
+
+/* Gets the content of a CBOR byte string, returns its size or 0 */
+static size_t cbor_bstr(const uint8_t *buf, size_t len,
+                        const uint8_t **content, size_t *content_len)
+{
+    uint8_t major;
+    uint64_t arg;
+    size_t size = cbor_head(buf, len, &major, &arg);
+
+    if ((size == 0) || (major != 2) || (arg > len - size)) {
+        return 0;
+    }
+    *content = buf + size;
+    *content_len = (size_t)arg;
+
+    return size + (size_t)arg;
+}
+
+/* Encodes the head of a CBOR item, returns its size */
+static size_t cbor_encode_head(uint8_t major, size_t arg, uint8_t *buf)
+{
+    if (arg < 24) {
+        buf[0] = (uint8_t)((major << 5) | arg);
+        return 1;
+    } else if (arg <= UINT8_MAX) {
+        buf[0] = (uint8_t)((major << 5) | 24);
+        buf[1] = (uint8_t)arg;
+        return 2;
+    }
+    buf[0] = (uint8_t)((major << 5) | 25);
+    buf[1] = (uint8_t)(arg >> 8);
+    buf[2] = (uint8_t)arg;
+    return 3;
+}
+
+/*
+ * Checks the signature of a token against its payload, as a verifier does:
+ * the stubbed Crypto service checks it against the hash, or the HMAC, of the
+ * to-be-signed structure rebuilt from the emitted headers and payload.
+ */
+static int verify_token(const uint8_t *token, size_t len,
+                        uint32_t option_flags)
+{
+#ifdef SYMMETRIC_INITIAL_ATTESTATION
+    static const char context[] = "MAC0";
+    psa_mac_operation_t op = PSA_MAC_OPERATION_INIT;
+#else
+    static const char context[] = "Signature1";
+    psa_hash_operation_t op = PSA_HASH_OPERATION_INIT;
+    uint8_t hash[PSA_HASH_LENGTH(PSA_ALG_SHA_512)];
+    size_t hash_len;
+#endif
+    /* The test options select ES256 (or HMAC256) whatever the key */
+    psa_algorithm_t hash_alg = ((test_key_bits == 384) && (option_flags == 0)) ?
+                               PSA_ALG_SHA_384 : PSA_ALG_SHA_256;
+    const uint8_t *protected_hdr, *payload, *sig;
+    size_t protected_len, payload_len, sig_len;
+    uint8_t head[4];
+    uint8_t major;
+    uint64_t arg;
+    size_t pos;
+    size_t size;
+    psa_status_t status;
+
+    /* Tag, then the array of 4 items */
+    pos = cbor_head(token, len, &major, &arg);
+    if ((pos != 0) && (major == 6)) {
+        size = cbor_head(token + pos, len - pos, &major, &arg);
+        pos = (size == 0) ? 0 : pos + size;
+    }
+    TEST_ASSERT((pos != 0) && (major == 4) && (arg == 4), "Not a COSE array");
+
+    size = cbor_bstr(token + pos, len - pos, &protected_hdr, &protected_len);
+    TEST_ASSERT(size != 0, "Malformed protected headers");
+    pos += size;
+    size = cbor_item_size(token + pos, len - pos);
+    TEST_ASSERT(size != 0, "Malformed unprotected headers");
+    pos += size;
+    size = cbor_bstr(token + pos, len - pos, &payload, &payload_len);
+    TEST_ASSERT(size != 0, "Malformed payload");
+    pos += size;
+    size = cbor_bstr(token + pos, len - pos, &sig, &sig_len);
+    TEST_ASSERT((size != 0) && (pos + size == len), "Malformed signature");
+
+#ifdef SYMMETRIC_INITIAL_ATTESTATION
+    status = psa_mac_verify_setup(&op, TFM_BUILTIN_KEY_ID_IAK,
+                                  PSA_ALG_HMAC(hash_alg));
+#define TEST_TBS_UPDATE(ptr, n) psa_mac_update(&op, (ptr), (n))
+#else
+    status = psa_hash_setup(&op, hash_alg);
+#define TEST_TBS_UPDATE(ptr, n) psa_hash_update(&op, (ptr), (n))
+#endif
+    TEST_ASSERT(status == PSA_SUCCESS, "Cannot start the verification");
+
+    /* [context, protected headers, external AAD, payload] */
+    head[0] = 0x84;
+    status = TEST_TBS_UPDATE(head, 1);
+    if (status == PSA_SUCCESS) {
+        size = cbor_encode_head(3, sizeof(context) - 1, head);
+        status = TEST_TBS_UPDATE(head, size);
+    }
+    if (status == PSA_SUCCESS) {
+        status = TEST_TBS_UPDATE((const uint8_t *)context,
+                                 sizeof(context) - 1);
+    }
+    if (status == PSA_SUCCESS) {
+        size = cbor_encode_head(2, protected_len, head);
+        status = TEST_TBS_UPDATE(head, size);
+    }
+    if (status == PSA_SUCCESS) {
+        status = TEST_TBS_UPDATE(protected_hdr, protected_len);
+    }
+    if (status == PSA_SUCCESS) {
+        head[0] = 0x40;
+        status = TEST_TBS_UPDATE(head, 1);
+    }
+    if (status == PSA_SUCCESS) {
+        size = cbor_encode_head(2, payload_len, head);
+        status = TEST_TBS_UPDATE(head, size);
+    }
+    if (status == PSA_SUCCESS) {
+        status = TEST_TBS_UPDATE(payload, payload_len);
+    }
+#undef TEST_TBS_UPDATE
+
+#ifdef SYMMETRIC_INITIAL_ATTESTATION
+    if (status == PSA_SUCCESS) {
+        status = psa_mac_verify_finish(&op, sig, sig_len);
+    }
+    (void)psa_mac_abort(&op);
+#else
+    if (status == PSA_SUCCESS) {
+        status = psa_hash_finish(&op, hash, sizeof(hash), &hash_len);
+    }
+    if (status == PSA_SUCCESS) {
+        status = psa_verify_hash(TFM_BUILTIN_KEY_ID_IAK,
+                                 PSA_ALG_ECDSA(hash_alg), hash, hash_len,
+                                 sig, sig_len);
+    }
+    (void)psa_hash_abort(&op);
+#endif
+
+    TEST_ASSERT(status == PSA_SUCCESS, "Signature does not match the payload");
+
+    return 0;
+}
+
+/*------------------------------- Tests --------------------------------------*/
+
+/*
+ * Creates the token of each case, and writes it after its 2-byte length to
+ * the token file. The static claims must then not be read from the platform
+ * when the claim cache holds them.
+ */
+static int test_create_tokens(void)
+{
+    uint8_t challenge[PSA_INITIAL_ATTEST_CHALLENGE_SIZE_64];
+    uint8_t token[TEST_TOKEN_BUF_SIZE];
+    uint8_t len_buf[2];
+    size_t token_size;
+    FILE *file = NULL;
+    size_t i;
+    int err = 0;
+
+    if (test_token_file != NULL) {
+        file = fopen(test_token_file, "wb");
+        TEST_ASSERT(file != NULL, "Cannot open the token file");
+    }
+
+    for (i = 0; (i < TEST_TOKEN_CASE_NUM) && (err == 0); i++) {
+        if (setup_case(&token_cases[i]) != 0) {
+            printf("%s: initialisation failed\r\n", token_cases[i].name);
+            err = 1;
+            break;
+        }
+        case_challenge(&token_cases[i], (uint32_t)i, challenge);
+
+        attest_stub_static_claim_reads = 0;
+        if (initial_attest_get_token(challenge,
+                                     token_cases[i].challenge_size,
+                                     token, sizeof(token),
+                                     &token_size) != PSA_SUCCESS) {
+            printf("%s: token creation failed\r\n", token_cases[i].name);
+            err = 1;
+            break;
+        }
+
+#if ATTEST_CLAIM_CACHE_SIZE > 0
+        if (attest_stub_static_claim_reads != 0) {
+            printf("%s: %u static claims read, not cached\r\n",
+                   token_cases[i].name,
+                   (unsigned)attest_stub_static_claim_reads);
+            err = 1;
+        }
+#endif
+
+        printf("%-26s %4u B\r\n", token_cases[i].name, (unsigned)token_size);
+
+        if (file != NULL) {
+            len_buf[0] = (uint8_t)(token_size >> 8);
+            len_buf[1] = (uint8_t)token_size;
+            if ((fwrite(len_buf, 1, sizeof(len_buf), file) !=
+                 sizeof(len_buf)) ||
+                (fwrite(token, 1, token_size, file) != token_size)) {
+                printf("Cannot write the token file\r\n");
+                err = 1;
+            }
+        }
+    }
+
+    if ((file != NULL) && (fclose(file) != 0)) {
+        err = 1;
+    }
+
+    return err;
+}
+
+/*
+ * The size returned by the size request must be the size of the token. The
+ * request only gets the size of the challenge, not its value, so the test
+ * options never apply to it: a 64-byte challenge gets the size of the token
+ * with the default options, whichever options the challenge of the token
+ * selects. The size must be computed without creating the token in size
+ * calculation mode, which gets the key attributes again to size the
+ * signature.
+ */
+static int test_token_size(void)
+{
+    uint8_t challenge[PSA_INITIAL_ATTEST_CHALLENGE_SIZE_64];
+    uint8_t token[TEST_TOKEN_BUF_SIZE];
+    const struct token_case_t *tc;
+    size_t token_size;
+    size_t computed_size;
+    uint32_t key_calls;
+    size_t i;
+
+    for (i = 0; i < TEST_TOKEN_CASE_NUM; i++) {
+        tc = &token_cases[i];
+        TEST_ASSERT(setup_case(tc) == 0, "Initialisation failed");
+
+        /* The token of the case with its test options, if any */
+        case_challenge(tc, (uint32_t)i, challenge);
+        TEST_ASSERT(initial_attest_get_token(challenge, tc->challenge_size,
+                                             token, sizeof(token),
+                                             &token_size) == PSA_SUCCESS,
+                    "Token creation failed");
+
+        /* The token with the default options the size request applies */
+        if (tc->option_flags != 0) {
+            fill_challenge(challenge, tc->challenge_size, (uint32_t)i);
+            TEST_ASSERT(initial_attest_get_token(challenge,
+                                                 tc->challenge_size,
+                                                 token, sizeof(token),
+                                                 &token_size) == PSA_SUCCESS,
+                        "Token creation failed");
+        }
+
+        key_calls = attest_stub_crypto_stats.get_key_attributes_calls;
+        TEST_ASSERT(initial_attest_get_token_size(tc->challenge_size,
+                                                  &computed_size) ==
+                    PSA_SUCCESS, "Token size request failed");
+        key_calls = attest_stub_crypto_stats.get_key_attributes_calls -
+                    key_calls;
+
+        if (computed_size != token_size) {
+            printf("%s: size %u, token %u B\r\n", tc->name,
+                   (unsigned)computed_size, (unsigned)token_size);
+            return 1;
+        }
+
+        /* The envelope is measured by the first request of the process */
+        if ((i != 0) && (key_calls != 1)) {
+            printf("%s: size not computed, %u key attribute requests\r\n",
+                   tc->name, (unsigned)key_calls);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+#if ATTEST_TOKEN_STREAM_BUF_SIZE > 0
+/*
+ * A streamed token must be the token created in a buffer, byte for byte, and
+ * its signature must match its payload.
+ */
+static int test_stream_token(void)
+{
+    uint8_t challenge[PSA_INITIAL_ATTEST_CHALLENGE_SIZE_64];
+    uint8_t token[TEST_TOKEN_BUF_SIZE];
+    static struct token_sink_t sink;
+    const struct token_case_t *tc;
+    size_t token_size;
+    size_t streamed_size;
+    psa_status_t status;
+    size_t i;
+
+    for (i = 0; i < TEST_TOKEN_CASE_NUM; i++) {
+        tc = &token_cases[i];
+        TEST_ASSERT(setup_case(tc) == 0, "Initialisation failed");
+        case_challenge(tc, (uint32_t)i, challenge);
+
+        TEST_ASSERT(initial_attest_get_token(challenge, tc->challenge_size,
+                                             token, sizeof(token),
+                                             &token_size) == PSA_SUCCESS,
+                    "Token creation failed");
+
+        sink.len = 0;
+        sink.overflow = false;
+        status = initial_attest_stream_token(challenge, tc->challenge_size,
+                                             TEST_TOKEN_BUF_SIZE, sink_write,
+                                             &sink, &streamed_size);
+        if (status != PSA_SUCCESS) {
+            printf("%s: token streaming failed: %d\r\n", tc->name,
+                   (int)status);
+            return 1;
+        }
+        TEST_ASSERT(!sink.overflow && (streamed_size == sink.len),
+                    "Streamed size does not match the bytes written");
+
+        if ((sink.len != token_size) ||
+            (memcmp(sink.buf, token, token_size) != 0)) {
+            printf("%s: streamed token differs\r\n", tc->name);
+            return 1;
+        }
+
+        /* The short-circuit signature is not made with the key */
+        if (!(tc->option_flags & TOKEN_OPT_SHORT_CIRCUIT_SIGN) &&
+            (verify_token(sink.buf, sink.len, tc->option_flags) != 0)) {
+            printf("%s: streamed token not verified\r\n", tc->name);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * The payload of a streamed token is passed twice, to sign it and to write
+ * it. A claim which changes in between, as the security lifecycle does on a
+ * transition, must be read once, so that the signature matches the payload
+ * which is written.
+ */
+static int test_stream_lifecycle_change(void)
+{
+    uint8_t challenge[PSA_INITIAL_ATTEST_CHALLENGE_SIZE_32];
+    static struct token_sink_t sink;
+    size_t streamed_size;
+    uint32_t i;
+    int err = 0;
+
+    TEST_ASSERT(setup_case(&token_cases[0]) == 0, "Initialisation failed");
+    attest_stub_set_lifecycle_changing(true);
+
+    for (i = 0; (i < 4) && (err == 0); i++) {
+        fill_challenge(challenge, sizeof(challenge), i);
+        sink.len = 0;
+        sink.overflow = false;
+        if ((initial_attest_stream_token(challenge, sizeof(challenge),
+                                         TEST_TOKEN_BUF_SIZE, sink_write,
+                                         &sink, &streamed_size) !=
+             PSA_SUCCESS) ||
+            sink.overflow) {
+            printf("Token streaming failed\r\n");
+            err = 1;
+        } else {
+            err = verify_token(sink.buf, sink.len, 0);
+        }
+    }
+
+    attest_stub_set_lifecycle_changing(false);
+
+    return err;
+}
+#endif /* ATTEST_TOKEN_STREAM_BUF_SIZE > 0 */
+
+#if ATTEST_TOKEN_BATCH_MAX > 0
+/* Numbers of tokens of the batches tested and benchmarked */
+static const size_t batch_sizes[] = {1, 4, 16};
+
+#define TEST_BATCH_SIZE_NUM \
+    (sizeof(batch_sizes) / sizeof(batch_sizes[0]))
+
+/* Tells whether the nonce of a token is the given challenge */
+static bool token_has_nonce(const uint8_t *token, size_t len,
+                            const uint8_t *challenge, size_t challenge_size)
+{
+    size_t i;
+
+    for (i = 0; i + challenge_size <= len; i++) {
+        if (memcmp(&token[i], challenge, challenge_size) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Requests a batch of tokens of the default options into the sink */
+static psa_status_t create_batch(const uint8_t *challenges, size_t num_tokens,
+                                 struct token_sink_t *sink, size_t *token_size)
+{
+    static uint8_t token[TEST_TOKEN_BUF_SIZE];
+
+    sink->len = 0;
+    sink->overflow = false;
+
+    return initial_attest_get_token_batch(challenges,
+                                          PSA_INITIAL_ATTEST_CHALLENGE_SIZE_32,
+                                          num_tokens, token, sizeof(token),
+                                          num_tokens * TEST_TOKEN_BUF_SIZE,
+                                          sink_write, sink, token_size);
+}
+
+/*
+ * Each token of a batch must be signed on its own, over its own nonce, and
+ * be as large as the token of a single request.
+ */
+static int test_batch_tokens(void)
+{
+    uint8_t challenges[ATTEST_TOKEN_BATCH_MAX]
+                      [PSA_INITIAL_ATTEST_CHALLENGE_SIZE_32];
+    uint8_t token[TEST_TOKEN_BUF_SIZE];
+    static struct token_sink_t sink;
+    size_t single_size;
+    size_t token_size;
+    uint32_t signs;
+    size_t n, i;
+
+    for (n = 0; n < TEST_BATCH_SIZE_NUM; n++) {
+        if (batch_sizes[n] > ATTEST_TOKEN_BATCH_MAX) {
+            continue;
+        }
+
+        TEST_ASSERT(setup_case(&token_cases[0]) == 0,
+                    "Initialisation failed");
+        for (i = 0; i < batch_sizes[n]; i++) {
+            fill_challenge(challenges[i], sizeof(challenges[i]),
+                           (uint32_t)(n * 100 + i));
+        }
+
+        TEST_ASSERT(initial_attest_get_token(challenges[0],
+                                             sizeof(challenges[0]),
+                                             token, sizeof(token),
+                                             &single_size) == PSA_SUCCESS,
+                    "Token creation failed");
+
+        signs = attest_stub_crypto_stats.sign_hash_calls +
+                attest_stub_crypto_stats.mac_sign_calls;
+        if ((create_batch(&challenges[0][0], batch_sizes[n], &sink,
+                          &token_size) != PSA_SUCCESS) || sink.overflow) {
+            printf("batch of %u: creation failed\r\n",
+                   (unsigned)batch_sizes[n]);
+            return 1;
+        }
+        signs = attest_stub_crypto_stats.sign_hash_calls +
+                attest_stub_crypto_stats.mac_sign_calls - signs;
+
+        TEST_ASSERT((token_size == single_size) &&
+                    (sink.len == batch_sizes[n] * token_size),
+                    "Batch tokens not the size of a single token");
+        TEST_ASSERT(signs == batch_sizes[n], "Not one signature per token");
+
+        for (i = 0; i < batch_sizes[n]; i++) {
+            if (!token_has_nonce(&sink.buf[i * token_size], token_size,
+                                 challenges[i], sizeof(challenges[i])) ||
+                (verify_token(&sink.buf[i * token_size], token_size,
+                              0) != 0)) {
+                printf("batch of %u: token %u not verified\r\n",
+                       (unsigned)batch_sizes[n], (unsigned)i);
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+#endif /* ATTEST_TOKEN_BATCH_MAX > 0 */
+
+/*------------------------------ Benchmark -----------------------------------*/
+
+/* Tokens per second of the default options, each with its own challenge */
+static int bench_token_rate(void)
+{
+    uint8_t challenge[PSA_INITIAL_ATTEST_CHALLENGE_SIZE_32];
+    uint8_t token[TEST_TOKEN_BUF_SIZE];
+    size_t token_size;
+    uint64_t start, elapsed;
+    uint32_t count = 0;
+    psa_status_t status;
+
+    TEST_ASSERT(setup_case(&token_cases[0]) == 0, "Initialisation failed");
+
+    start = tfm_unittest_now_ns();
+    do {
+        fill_challenge(challenge, sizeof(challenge), count);
+        status = initial_attest_get_token(challenge, sizeof(challenge),
+                                          token, sizeof(token), &token_size);
+        count++;
+        elapsed = tfm_unittest_now_ns() - start;
+    } while ((status == PSA_SUCCESS) && (elapsed < TEST_BENCH_NS));
+
+    TEST_ASSERT(status == PSA_SUCCESS, "Token creation failed");
+
+    printf("ATTEST_CLAIM_CACHE_SIZE %d\r\n", (int)ATTEST_CLAIM_CACHE_SIZE);
+    printf("%-26s %12s\r\n", "token", "tokens/s");
+    printf("%-26s %12.0f\r\n", "signing stubbed",
+           tfm_unittest_per_s(count, elapsed));
+
+    return 0;
+}
+
+#if ATTEST_TOKEN_BATCH_MAX > 0
+/*
+ * Tokens per second of batches of the default options, each token with its
+ * own challenge. The claims are encoded once per batch.
+ */
+static int bench_batch_rate(void)
+{
+    static uint8_t challenges[ATTEST_TOKEN_BATCH_MAX]
+                             [PSA_INITIAL_ATTEST_CHALLENGE_SIZE_32];
+    static struct token_sink_t sink;
+    size_t token_size;
+    uint64_t start, elapsed;
+    uint32_t count;
+    psa_status_t status;
+    size_t n, i;
+
+    TEST_ASSERT(setup_case(&token_cases[0]) == 0, "Initialisation failed");
+
+    printf("ATTEST_TOKEN_STREAM_BUF_SIZE %d\r\n",
+           (int)ATTEST_TOKEN_STREAM_BUF_SIZE);
+    printf("%-26s %12s\r\n", "tokens per batch", "tokens/s");
+
+    for (n = 0; n < TEST_BATCH_SIZE_NUM; n++) {
+        if (batch_sizes[n] > ATTEST_TOKEN_BATCH_MAX) {
+            continue;
+        }
+
+        count = 0;
+        start = tfm_unittest_now_ns();
+        do {
+            for (i = 0; i < batch_sizes[n]; i++) {
+                fill_challenge(challenges[i], sizeof(challenges[i]),
+                               (uint32_t)(count + i));
+            }
+            status = create_batch(&challenges[0][0], batch_sizes[n], &sink,
+                                  &token_size);
+            count += (uint32_t)batch_sizes[n];
+            elapsed = tfm_unittest_now_ns() - start;
+        } while ((status == PSA_SUCCESS) && (elapsed < TEST_BENCH_NS));
+
+        TEST_ASSERT(status == PSA_SUCCESS, "Batch creation failed");
+
+        printf("%-26u %12.0f\r\n", (unsigned)batch_sizes[n],
+               tfm_unittest_per_s(count, elapsed));
+    }
+
+    return 0;
+}
+#endif /* ATTEST_TOKEN_BATCH_MAX > 0 */
+
+int main(int argc, char *argv[])
+{
+    uint32_t failures = 0;
+
+    if (argc > 1) {
+        test_key_bits = (size_t)strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2) {
+        test_token_file = argv[2];
+    }
+
+    RUN_TEST(test_create_tokens, failures);
+    RUN_TEST(test_token_size, failures);
+#if ATTEST_TOKEN_STREAM_BUF_SIZE > 0
+    RUN_TEST(test_stream_token, failures);
+    RUN_TEST(test_stream_lifecycle_change, failures);
+#endif
+#if ATTEST_TOKEN_BATCH_MAX > 0
+    RUN_TEST(test_batch_tokens, failures);
+#endif
+    RUN_TEST(bench_token_rate, failures);
+#if ATTEST_TOKEN_BATCH_MAX > 0
+    RUN_TEST(bench_batch_rate, failures);
+#endif
+
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,23 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __UNITTEST_CONFIG_ATTEST_H__
+#define __UNITTEST_CONFIG_ATTEST_H__
+
+/* The base configuration with the claim cache, streaming and batches */
+#include "config_base.h"
+
+#undef ATTEST_CLAIM_CACHE_SIZE
+#define ATTEST_CLAIM_CACHE_SIZE                512
+
+#undef ATTEST_TOKEN_STREAM_BUF_SIZE
+#define ATTEST_TOKEN_STREAM_BUF_SIZE           512
+
+#undef ATTEST_TOKEN_BATCH_MAX
+#define ATTEST_TOKEN_BATCH_MAX                 16
+
+#endif /* __UNITTEST_CONFIG_ATTEST_H__ */
@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __UNITTEST_CONFIG_ATTEST_BUFFERED_H__
+#define __UNITTEST_CONFIG_ATTEST_BUFFERED_H__
+
+/* The configuration of the attestation tests which create the tokens of a
+ * batch in a buffer, without token streaming.
+ */
+#include "unittest_config_attest.h"
+
+#undef ATTEST_TOKEN_STREAM_BUF_SIZE
+#define ATTEST_TOKEN_STREAM_BUF_SIZE           0
+
+#endif /* __UNITTEST_CONFIG_ATTEST_BUFFERED_H__ */
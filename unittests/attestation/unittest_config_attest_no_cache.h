@@ -0,0 +1,17 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __UNITTEST_CONFIG_ATTEST_NO_CACHE_H__
+#define __UNITTEST_CONFIG_ATTEST_NO_CACHE_H__
+
+/* The configuration of the attestation tests without the claim cache */
+#include "unittest_config_attest.h"
+
+#undef ATTEST_CLAIM_CACHE_SIZE
+#define ATTEST_CLAIM_CACHE_SIZE                0
+
+#endif /* __UNITTEST_CONFIG_ATTEST_NO_CACHE_H__ */
@@ -0,0 +1,17 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __UNITTEST_CONFIG_ATTEST_NO_OPTIONAL_H__
+#define __UNITTEST_CONFIG_ATTEST_NO_OPTIONAL_H__
+
+/* The configuration of the attestation tests without the optional claims */
+#include "unittest_config_attest.h"
+
+#undef ATTEST_INCLUDE_OPTIONAL_CLAIMS
+#define ATTEST_INCLUDE_OPTIONAL_CLAIMS         0
+
+#endif /* __UNITTEST_CONFIG_ATTEST_NO_OPTIONAL_H__ */
@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __UNITTEST_CONFIG_ATTEST_SMALL_WINDOW_H__
+#define __UNITTEST_CONFIG_ATTEST_SMALL_WINDOW_H__
+
+/* The configuration of the attestation tests without the claim cache, with a
+ * streaming window which cannot hold all the claims.
+ */
+#include "unittest_config_attest_no_cache.h"
+
+#undef ATTEST_TOKEN_STREAM_BUF_SIZE
+#define ATTEST_TOKEN_STREAM_BUF_SIZE           384
+
+#endif /* __UNITTEST_CONFIG_ATTEST_SMALL_WINDOW_H__ */
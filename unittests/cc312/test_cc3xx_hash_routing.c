@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Tests the routing of short single-part hash inputs away from the CC-312 by
+ * cc3xx_hash_compute(). The low-level hash driver is replaced by a simulated
+ * accelerator which computes the digest with Mbed TLS and charges a latency
+ * model: a fixed setup cost plus a cost per byte. The software fallback of the
+ * PSA driver wrappers is mirrored by route_hash_compute() and charged a cost
+ * per byte only. The model parameters are illustrative, platforms measure
+ * theirs on the target to set CC312_HASH_HW_MIN_INPUT_SIZE.
+ */
+
+#include <string.h>
+
+#include "cc3xx_psa_hash.h"
+#include "cc3xx_crypto_primitives_private.h"
+#include "hash_driver.h"
+#include "mbedtls/sha256.h"
+
+#include "tfm_unittest.h"
+
+/* Latency model, in cycles */
+#define SIM_HW_SETUP_CYCLES      (1280u)
+#define SIM_HW_CYCLES_PER_BYTE   (1u)
+#define SIM_SW_CYCLES_PER_BYTE   (21u)
+
+#define TEST_MAX_INPUT_SIZE      ((64u * 1024u) + 3u)
+
+#define HW_CYCLES(len)  (SIM_HW_SETUP_CYCLES + ((len) * SIM_HW_CYCLES_PER_BYTE))
+#define SW_CYCLES(len)  ((len) * SIM_SW_CYCLES_PER_BYTE)
+
+/* Smallest input for which the accelerator is not slower than software */
+#define SIM_CROSSOVER_SIZE                                                   \
+    ((SIM_HW_SETUP_CYCLES +                                                  \
+      (SIM_SW_CYCLES_PER_BYTE - SIM_HW_CYCLES_PER_BYTE) - 1u) /              \
+     (SIM_SW_CYCLES_PER_BYTE - SIM_HW_CYCLES_PER_BYTE))
+
+#if !defined(CC3XX_CONFIG_ENABLE_SW_FALLBACK)
+#error "The routing test needs CC3XX_CONFIG_ENABLE_SW_FALLBACK"
+#endif
+
+#if CC3XX_CONFIG_HASH_HW_MIN_INPUT_SIZE != SIM_CROSSOVER_SIZE
+#error "CC3XX_CONFIG_HASH_HW_MIN_INPUT_SIZE must be the crossover of the model"
+#endif
+
+/* State of the simulated accelerator */
+static struct {
+    mbedtls_sha256_context sha256;
+    const uint8_t *data_in;
+    uint32_t setup_calls;
+    uint64_t cycles;
+} sim;
+
+static uint8_t input[TEST_MAX_INPUT_SIZE];
+
+/*------------------------- Simulated accelerator ----------------------------*/
+
+/* The DMA address is 32 bits wide, the host pointer is kept on the side */
+drvError_t SetDataBuffersInfo(const uint8_t *pDataIn, size_t dataInSize,
+                              CCBuffInfo_t *pInputBuffInfo,
+                              const uint8_t *pDataOut, size_t dataOutSize,
+                              CCBuffInfo_t *pOutputBuffInfo)
+{
+    (void)dataInSize;
+    (void)pDataOut;
+    (void)dataOutSize;
+    (void)pOutputBuffInfo;
+
+    sim.data_in = pDataIn;
+    pInputBuffInfo->dataBuffAddr = 0;
+    pInputBuffInfo->dataBuffNs = 0;
+
+    return HASH_DRV_OK;
+}
+
+drvError_t InitHashDrv(void *pCtx)
+{
+    (void)pCtx;
+
+    mbedtls_sha256_init(&sim.sha256);
+    if (mbedtls_sha256_starts(&sim.sha256, 0) != 0) {
+        return 1;
+    }
+
+    sim.setup_calls++;
+    sim.cycles += SIM_HW_SETUP_CYCLES;
+
+    return HASH_DRV_OK;
+}
+
+drvError_t ProcessHashDrv(void *pCtx, CCBuffInfo_t *pInputBuffInfo,
+                          uint32_t dataInSize)
+{
+    (void)pCtx;
+    (void)pInputBuffInfo;
+
+    if (mbedtls_sha256_update(&sim.sha256, sim.data_in, dataInSize) != 0) {
+        return 1;
+    }
+
+    sim.cycles += (uint64_t)dataInSize * SIM_HW_CYCLES_PER_BYTE;
+
+    return HASH_DRV_OK;
+}
+
+drvError_t FinishHashDrv(void *pCtx)
+{
+    HashContext_t *ctx = (HashContext_t *)pCtx;
+
+    if (mbedtls_sha256_finish(&sim.sha256, (uint8_t *)ctx->digest) != 0) {
+        return 1;
+    }
+    mbedtls_sha256_free(&sim.sha256);
+
+    return HASH_DRV_OK;
+}
+
+/*--------------------------------- Helpers ----------------------------------*/
+
+/* Mirrors psa_driver_wrapper_hash_compute() with the software fallback */
+static psa_status_t route_hash_compute(const uint8_t *in, size_t in_len,
+                                       uint8_t *hash, size_t hash_size,
+                                       size_t *hash_length)
+{
+    psa_status_t status;
+
+    status = cc3xx_hash_compute(PSA_ALG_SHA_256, in, in_len, hash, hash_size,
+                                hash_length);
+    if (status != PSA_ERROR_NOT_SUPPORTED) {
+        return status;
+    }
+
+    if (mbedtls_sha256(in, in_len, hash, 0) != 0) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+    *hash_length = 32;
+    sim.cycles += (uint64_t)in_len * SIM_SW_CYCLES_PER_BYTE;
+
+    return PSA_SUCCESS;
+}
+
+static void reset_sim(void)
+{
+    sim.setup_calls = 0;
+    sim.cycles = 0;
+}
+
+/*---------------------------------- Tests -----------------------------------*/
+
+static int test_short_input_not_supported(void)
+{
+    uint8_t hash[32];
+    size_t hash_length = 0;
+
+    reset_sim();
+
+    TEST_ASSERT(cc3xx_hash_compute(PSA_ALG_SHA_256, input,
+                                   CC3XX_CONFIG_HASH_HW_MIN_INPUT_SIZE - 1,
+                                   hash, sizeof(hash), &hash_length) ==
+                PSA_ERROR_NOT_SUPPORTED,
+                "Input below the threshold not left to software");
+    TEST_ASSERT(sim.setup_calls == 0, "Accelerator set up for a short input");
+
+    return 0;
+}
+
+static int test_threshold_input_on_hw(void)
+{
+    uint8_t hash[32], expected[32];
+    size_t hash_length = 0;
+
+    reset_sim();
+
+    TEST_ASSERT(cc3xx_hash_compute(PSA_ALG_SHA_256, input,
+                                   CC3XX_CONFIG_HASH_HW_MIN_INPUT_SIZE,
+                                   hash, sizeof(hash), &hash_length) ==
+                PSA_SUCCESS, "Input at the threshold not accepted");
+    TEST_ASSERT(sim.setup_calls == 1, "Accelerator not used");
+
+    TEST_ASSERT(mbedtls_sha256(input, CC3XX_CONFIG_HASH_HW_MIN_INPUT_SIZE,
+                               expected, 0) == 0, "Reference hash failed");
+    TEST_ASSERT(hash_length == sizeof(expected) &&
+                memcmp(hash, expected, sizeof(expected)) == 0,
+                "Wrong digest");
+
+    return 0;
+}
+
+/* Every routed input costs no more than the faster backend of the model */
+static int test_routing_follows_latency_model(void)
+{
+    static const size_t large_sizes[] = { 4096, 0xFFFF, TEST_MAX_INPUT_SIZE };
+    uint8_t hash[32], expected[32];
+    size_t in_len, hash_length, i;
+    uint64_t best;
+
+    for (i = 0, in_len = 0; in_len < TEST_MAX_INPUT_SIZE; ) {
+        reset_sim();
+
+        TEST_ASSERT(route_hash_compute(input, in_len, hash, sizeof(hash),
+                                       &hash_length) == PSA_SUCCESS,
+                    "Routed hash failed");
+        TEST_ASSERT(mbedtls_sha256(input, in_len, expected, 0) == 0,
+                    "Reference hash failed");
+        TEST_ASSERT(hash_length == sizeof(expected) &&
+                    memcmp(hash, expected, sizeof(expected)) == 0,
+                    "Wrong digest");
+
+        best = (HW_CYCLES(in_len) < SW_CYCLES(in_len)) ?
+               HW_CYCLES(in_len) : SW_CYCLES(in_len);
+        TEST_ASSERT(sim.cycles == best, "Input routed to the slower backend");
+        TEST_ASSERT((sim.setup_calls == 1) ==
+                    (in_len >= CC3XX_CONFIG_HASH_HW_MIN_INPUT_SIZE),
+                    "Wrong backend chosen");
+
+        if (in_len < 4 * CC3XX_CONFIG_HASH_HW_MIN_INPUT_SIZE) {
+            in_len++;
+        } else if (i < sizeof(large_sizes) / sizeof(large_sizes[0])) {
+            in_len = large_sizes[i++];
+        } else {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+/*------------------------------ Benchmark -----------------------------------*/
+
+/* Modelled cycles of a request mix dominated by short inputs */
+static int bench_request_mix(void)
+{
+    static const size_t sizes[] = { 16, 20, 32, 32, 48, 64, 64, 128, 512,
+                                    4096 };
+    uint64_t routed = 0, hw_only = 0, sw_only = 0;
+    uint8_t hash[32];
+    size_t hash_length, i;
+
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        reset_sim();
+        TEST_ASSERT(route_hash_compute(input, sizes[i], hash, sizeof(hash),
+                                       &hash_length) == PSA_SUCCESS,
+                    "Routed hash failed");
+        routed += sim.cycles;
+        hw_only += HW_CYCLES(sizes[i]);
+        sw_only += SW_CYCLES(sizes[i]);
+    }
+
+    printf("%-10s %14s\r\n", "backend", "model cycles");
+    printf("%-10s %14llu\r\n", "hw only", (unsigned long long)hw_only);
+    printf("%-10s %14llu\r\n", "sw only", (unsigned long long)sw_only);
+    printf("%-10s %14llu\r\n", "routed", (unsigned long long)routed);
+
+    TEST_ASSERT(routed <= hw_only && routed <= sw_only,
+                "Routing slower than a single backend");
+
+    return 0;
+}
+
+int main(void)
+{
+    uint32_t failures = 0;
+    size_t i;
+
+    for (i = 0; i < sizeof(input); i++) {
+        input[i] = (uint8_t)((i * 31u) ^ (i >> 8));
+    }
+
+    RUN_TEST(test_short_input_not_supported, failures);
+    RUN_TEST(test_threshold_input_on_hw, failures);
+    RUN_TEST(test_routing_follows_latency_model, failures);
+    RUN_TEST(bench_request_mix, failures);
+
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "psa_msg_fake.h"
+
+#define PSA_MSG_FAKE_HANDLE    ((psa_handle_t)0x40000001)
+
+static struct psa_msg_fake_t *current_fake;
+
+static struct psa_msg_fake_t *get_fake(psa_handle_t msg_handle)
+{
+    /* A service using another handle is a programmer error, as in the SPM */
+    if ((msg_handle != PSA_MSG_FAKE_HANDLE) || (current_fake == NULL)) {
+        abort();
+    }
+
+    return current_fake;
+}
+
+void psa_msg_fake_init(psa_msg_t *msg, struct psa_msg_fake_t *fake,
+                       int32_t client_id)
+{
+    uint32_t i;
+
+    memset(msg, 0, sizeof(*msg));
+    msg->type = PSA_IPC_CALL;
+    msg->handle = PSA_MSG_FAKE_HANDLE;
+    msg->client_id = client_id;
+
+    for (i = 0; i < PSA_MAX_IOVEC; i++) {
+        msg->in_size[i] = fake->in_vec[i].len;
+        msg->out_size[i] = fake->out_vec[i].len;
+        fake->in_read[i] = 0;
+        fake->out_written[i] = 0;
+    }
+    fake->read_calls = 0;
+    fake->write_calls = 0;
+
+    current_fake = fake;
+}
+
+size_t psa_read(psa_handle_t msg_handle, uint32_t invec_idx,
+                void *buffer, size_t num_bytes)
+{
+    struct psa_msg_fake_t *fake = get_fake(msg_handle);
+    size_t remaining;
+
+    if (invec_idx >= PSA_MAX_IOVEC) {
+        abort();
+    }
+
+    remaining = fake->in_vec[invec_idx].len - fake->in_read[invec_idx];
+    if (num_bytes > remaining) {
+        num_bytes = remaining;
+    }
+
+    memcpy(buffer,
+           (const uint8_t *)fake->in_vec[invec_idx].base +
+           fake->in_read[invec_idx],
+           num_bytes);
+    fake->in_read[invec_idx] += num_bytes;
+    fake->read_calls++;
+
+    if (fake->read_hook != NULL) {
+        fake->read_hook(num_bytes);
+    }
+
+    return num_bytes;
+}
+
+size_t psa_skip(psa_handle_t msg_handle, uint32_t invec_idx, size_t num_bytes)
+{
+    struct psa_msg_fake_t *fake = get_fake(msg_handle);
+    size_t remaining;
+
+    if (invec_idx >= PSA_MAX_IOVEC) {
+        abort();
+    }
+
+    remaining = fake->in_vec[invec_idx].len - fake->in_read[invec_idx];
+    if (num_bytes > remaining) {
+        num_bytes = remaining;
+    }
+    fake->in_read[invec_idx] += num_bytes;
+
+    return num_bytes;
+}
+
+void psa_write(psa_handle_t msg_handle, uint32_t outvec_idx,
+               const void *buffer, size_t num_bytes)
+{
+    struct psa_msg_fake_t *fake = get_fake(msg_handle);
+
+    /* Writing beyond the client output is a programmer error in the SPM */
+    if ((outvec_idx >= PSA_MAX_IOVEC) ||
+        (num_bytes > (fake->out_vec[outvec_idx].len -
+                      fake->out_written[outvec_idx]))) {
+        abort();
+    }
+
+    memcpy((uint8_t *)fake->out_vec[outvec_idx].base +
+           fake->out_written[outvec_idx],
+           buffer, num_bytes);
+    fake->out_written[outvec_idx] += num_bytes;
+    fake->write_calls++;
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __PSA_MSG_FAKE_H__
+#define __PSA_MSG_FAKE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "psa/client.h"
+#include "psa/service.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Client side of a message served by the psa_read() and psa_write()
+ *        fakes. The input vectors are read in order and the output vectors
+ *        are appended to, as done by the SPM.
+ */
+struct psa_msg_fake_t {
+    psa_invec in_vec[PSA_MAX_IOVEC];
+    psa_outvec out_vec[PSA_MAX_IOVEC];
+    size_t in_read[PSA_MAX_IOVEC];     /* Bytes read from each input */
+    size_t out_written[PSA_MAX_IOVEC]; /* Bytes written to each output */
+    uint32_t read_calls;               /* Number of psa_read() calls */
+    uint32_t write_calls;              /* Number of psa_write() calls */
+    void (*read_hook)(size_t num_bytes); /* Called by psa_read(), if set */
+};
+
+/**
+ * \brief Builds the message received by a service for a client call, and
+ *        makes it the message served by the fakes.
+ *
+ * \param[out] msg        Message passed to the service
+ * \param[in]  fake       Client side of the message
+ * \param[in]  client_id  Client ID of the message
+ */
+void psa_msg_fake_init(psa_msg_t *msg, struct psa_msg_fake_t *fake,
+                       int32_t client_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PSA_MSG_FAKE_H__ */
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __TFM_UNITTEST_H__
+#define __TFM_UNITTEST_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Fails the calling test function, which returns an int, if the
+ *        condition does not hold.
+ */
+#define TEST_ASSERT(cond, msg)                                               \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            printf("FAIL %s:%d: %s\r\n", __FILE__, __LINE__, (msg));         \
+            return 1;                                                        \
+        }                                                                    \
+    } while (0)
+
+/**
+ * \brief Runs a test function and counts its failure.
+ */
+#define RUN_TEST(test, failures)                                             \
+    do {                                                                     \
+        if ((test)() != 0) {                                                 \
+            (failures)++;                                                    \
+        } else {                                                             \
+            printf("PASS %s\r\n", #test);                                    \
+        }                                                                    \
+    } while (0)
+
+/**
+ * \brief Gets a monotonic timestamp in nanoseconds for the benchmarks.
+ */
+static inline uint64_t tfm_unittest_now_ns(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000u) + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * \brief Converts a number of bytes processed in an elapsed time to MB/s.
+ */
+static inline double tfm_unittest_mb_per_s(uint64_t bytes, uint64_t elapsed_ns)
+{
+    return (elapsed_ns == 0) ? 0.0 :
+           ((double)bytes * 1000.0) / ((double)elapsed_ns * 1.048576);
+}
+
+/**
+ * \brief Converts a number of operations done in an elapsed time to a rate
+ *        per second.
+ */
+static inline double tfm_unittest_per_s(uint64_t count, uint64_t elapsed_ns)
+{
+    return (elapsed_ns == 0) ? 0.0 :
+           ((double)count * 1000000000.0) / (double)elapsed_ns;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TFM_UNITTEST_H__ */
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Stubs of the modules of the Crypto partition and of the platform which are
+ * not under test. The hash and cipher interfaces are provided by each test.
+ */
+
+#include "config_crypto.h"
+#include "tfm_mbedcrypto_include.h"
+#include "tfm_crypto_api.h"
+#include "tfm_plat_crypto_keys.h"
+#include "tfm_plat_crypto_nv_seed.h"
+
+psa_status_t tfm_crypto_key_management_interface(psa_invec in_vec[],
+                                            psa_outvec out_vec[],
+                                            mbedtls_svc_key_id_t *encoded_key)
+{
+    (void)in_vec;
+    (void)out_vec;
+    (void)encoded_key;
+    return PSA_ERROR_NOT_SUPPORTED;
+}
+
+psa_status_t tfm_crypto_mac_interface(psa_invec in_vec[],
+                                      psa_outvec out_vec[],
+                                      mbedtls_svc_key_id_t *encoded_key)
+{
+    (void)in_vec;
+    (void)out_vec;
+    (void)encoded_key;
+    return PSA_ERROR_NOT_SUPPORTED;
+}
+
+psa_status_t tfm_crypto_aead_interface(psa_invec in_vec[],
+                                       psa_outvec out_vec[],
+                                       mbedtls_svc_key_id_t *encoded_key)
+{
+    (void)in_vec;
+    (void)out_vec;
+    (void)encoded_key;
+    return PSA_ERROR_NOT_SUPPORTED;
+}
+
+psa_status_t tfm_crypto_asymmetric_sign_interface(psa_invec in_vec[],
+                                            psa_outvec out_vec[],
+                                            mbedtls_svc_key_id_t *encoded_key)
+{
+    (void)in_vec;
+    (void)out_vec;
+    (void)encoded_key;
+    return PSA_ERROR_NOT_SUPPORTED;
+}
+
+psa_status_t tfm_crypto_asymmetric_encrypt_interface(psa_invec in_vec[],
+                                            psa_outvec out_vec[],
+                                            mbedtls_svc_key_id_t *encoded_key)
+{
+    (void)in_vec;
+    (void)out_vec;
+    (void)encoded_key;
+    return PSA_ERROR_NOT_SUPPORTED;
+}
+
+psa_status_t tfm_crypto_key_derivation_interface(psa_invec in_vec[],
+                                            psa_outvec out_vec[],
+                                            mbedtls_svc_key_id_t *encoded_key)
+{
+    (void)in_vec;
+    (void)out_vec;
+    (void)encoded_key;
+    return PSA_ERROR_NOT_SUPPORTED;
+}
+
+psa_status_t tfm_crypto_random_interface(psa_invec in_vec[],
+                                         psa_outvec out_vec[])
+{
+    (void)in_vec;
+    (void)out_vec;
+    return PSA_ERROR_NOT_SUPPORTED;
+}
+
+psa_status_t tfm_crypto_init_alloc(void)
+{
+    return PSA_SUCCESS;
+}
+
+psa_status_t psa_crypto_init(void)
+{
+    return PSA_SUCCESS;
+}
+
+void mbedtls_memory_buffer_alloc_init(unsigned char *buf, size_t len)
+{
+    (void)buf;
+    (void)len;
+}
+
+int tfm_plat_crypto_provision_entropy_seed(void)
+{
+    return TFM_CRYPTO_NV_SEED_SUCCESS;
+}
+
+enum tfm_plat_err_t tfm_plat_load_builtin_keys(void)
+{
+    return TFM_PLAT_ERR_SUCCESS;
+}
@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/* Stands in for the header generated from the Crypto partition manifest */
+
+#ifndef __PSA_MANIFEST_TFM_CRYPTO_H__
+#define __PSA_MANIFEST_TFM_CRYPTO_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TFM_SP_CRYPTO_MODEL_IPC                                 0
+#define TFM_SP_CRYPTO_MODEL_SFN                                 1
+
+psa_status_t tfm_crypto_sfn(const psa_msg_t* msg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PSA_MANIFEST_TFM_CRYPTO_H__ */
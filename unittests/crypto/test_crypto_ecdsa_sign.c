@@ -0,0 +1,360 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Measures the ECDSA signing rate of the Mbed Crypto build, and the part of it
+ * which CRYPTO_ECP_FIXED_POINT_OPTIM (MBEDTLS_ECP_FIXED_POINT_OPTIM) changes:
+ * the multiplication by the generator, which uses the precomputed comb tables
+ * when the option is set. Without the option, a multiplication by the
+ * generator takes the same path as a multiplication by any other point, so
+ * the rate without the tables is estimated from the rate of multiplications
+ * by the double of the generator. The results of both paths are checked to
+ * match, and the signatures against the vectors of RFC 6979.
+ */
+
+#include <string.h>
+
+#include "mbedtls/ecdsa.h"
+#include "mbedtls/sha256.h"
+#include "mbedtls/sha512.h"
+
+#include "tfm_unittest.h"
+
+#define TEST_SCALAR_NUM         (16u)
+#define TEST_BENCH_NS           (500000000u)
+
+struct curve_vector_t {
+    const char *name;
+    mbedtls_ecp_group_id id;
+    mbedtls_md_type_t md_alg;
+    size_t hash_len;
+    /* Private key and signature of the message "sample", RFC 6979 A.2 */
+    const char *d;
+    const char *r;
+    const char *s;
+};
+
+static const struct curve_vector_t curves[] = {
+    {
+        .name = "P-256",
+        .id = MBEDTLS_ECP_DP_SECP256R1,
+        .md_alg = MBEDTLS_MD_SHA256,
+        .hash_len = 32,
+        .d = "C9AFA9D845BA75166B5C215767B1D6934E50C3DB36E89B127B8A622B120F6721",
+        .r = "EFD48B2AACB6A8FD1140DD9CD45E81D69D2C877B56AAF991C34D0EA84EAF3716",
+        .s = "F7CB1C942D657C41D436C7A1B6E29F65F3E900DBB9AFF4064DC4AB2F843ACDA8",
+    },
+    {
+        .name = "P-384",
+        .id = MBEDTLS_ECP_DP_SECP384R1,
+        .md_alg = MBEDTLS_MD_SHA384,
+        .hash_len = 48,
+        .d = "6B9D3DAD2E1B8C1C05B19875B6659F4DE23C3B667BF297BA"
+             "9AA47740787137D896D5724E4C70A825F872C9EA60D2EDF5",
+        .r = "94EDBB92A5ECB8AAD4736E56C691916B3F88140666CE9FA7"
+             "3D64C4EA95AD133C81A648152E44ACF96E36DD1E80FABE46",
+        .s = "99EF4AEB15F178CEA1FE40DB2603138F130E740A19624526"
+             "203B6351D0A3A94FA329C145786E679E7B82C71A38628AC8",
+    },
+};
+
+#define TEST_CURVE_NUM  (sizeof(curves) / sizeof(curves[0]))
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15u;
+
+/*--------------------------------- Helpers ----------------------------------*/
+
+/* Deterministic generator for the blinding and the random scalars */
+static int test_rng(void *ctx, unsigned char *buf, size_t len)
+{
+    size_t i;
+
+    (void)ctx;
+
+    for (i = 0; i < len; i++) {
+        rng_state ^= rng_state << 13;
+        rng_state ^= rng_state >> 7;
+        rng_state ^= rng_state << 17;
+        buf[i] = (unsigned char)rng_state;
+    }
+
+    return 0;
+}
+
+static int hash_sample(const struct curve_vector_t *curve, uint8_t *hash)
+{
+    static const uint8_t msg[] = "sample";
+
+    if (curve->md_alg == MBEDTLS_MD_SHA256) {
+        return mbedtls_sha256(msg, sizeof(msg) - 1, hash, 0);
+    }
+
+    return mbedtls_sha512(msg, sizeof(msg) - 1, hash, 1);
+}
+
+/* Random scalar of [2, N - 1], even */
+static int random_even_scalar(const mbedtls_ecp_group *grp, mbedtls_mpi *k)
+{
+    int ret;
+
+    ret = mbedtls_mpi_fill_random(k, (grp->nbits + 7) / 8, test_rng, NULL);
+    if (ret == 0) {
+        ret = mbedtls_mpi_mod_mpi(k, k, &grp->N);
+    }
+    if (ret == 0) {
+        ret = mbedtls_mpi_set_bit(k, 0, 0);
+    }
+    if (ret == 0) {
+        ret = mbedtls_mpi_set_bit(k, 1, 1);
+    }
+
+    return ret;
+}
+
+/*---------------------------------- Tests -----------------------------------*/
+
+static int test_rfc6979_vectors(void)
+{
+    mbedtls_ecp_group grp;
+    mbedtls_mpi d, r, s, r_exp, s_exp;
+    uint8_t hash[48];
+    size_t i;
+    int ret;
+
+    for (i = 0; i < TEST_CURVE_NUM; i++) {
+        mbedtls_ecp_group_init(&grp);
+        mbedtls_mpi_init(&d);
+        mbedtls_mpi_init(&r);
+        mbedtls_mpi_init(&s);
+        mbedtls_mpi_init(&r_exp);
+        mbedtls_mpi_init(&s_exp);
+
+        ret = mbedtls_ecp_group_load(&grp, curves[i].id);
+        if (ret == 0) {
+            ret = mbedtls_mpi_read_string(&d, 16, curves[i].d);
+        }
+        if (ret == 0) {
+            ret = mbedtls_mpi_read_string(&r_exp, 16, curves[i].r);
+        }
+        if (ret == 0) {
+            ret = mbedtls_mpi_read_string(&s_exp, 16, curves[i].s);
+        }
+        if (ret == 0) {
+            ret = hash_sample(&curves[i], hash);
+        }
+        if (ret == 0) {
+            ret = mbedtls_ecdsa_sign_det_ext(&grp, &r, &s, &d, hash,
+                                             curves[i].hash_len,
+                                             curves[i].md_alg, test_rng, NULL);
+        }
+        if (ret == 0) {
+            ret = (mbedtls_mpi_cmp_mpi(&r, &r_exp) == 0 &&
+                   mbedtls_mpi_cmp_mpi(&s, &s_exp) == 0) ? 0 : 1;
+        }
+
+        mbedtls_mpi_free(&s_exp);
+        mbedtls_mpi_free(&r_exp);
+        mbedtls_mpi_free(&s);
+        mbedtls_mpi_free(&r);
+        mbedtls_mpi_free(&d);
+        mbedtls_ecp_group_free(&grp);
+
+        TEST_ASSERT(ret == 0, "Signature differs from RFC 6979");
+    }
+
+    return 0;
+}
+
+/* k.G computed with the generator tables equals (k / 2).(2.G) without them */
+static int test_generator_matches_generic_path(void)
+{
+    mbedtls_ecp_group grp;
+    mbedtls_ecp_point g2, kg, kg_generic;
+    mbedtls_mpi two, k;
+    size_t i, n;
+    int ret;
+
+    for (i = 0; i < TEST_CURVE_NUM; i++) {
+        mbedtls_ecp_group_init(&grp);
+        mbedtls_ecp_point_init(&g2);
+        mbedtls_ecp_point_init(&kg);
+        mbedtls_ecp_point_init(&kg_generic);
+        mbedtls_mpi_init(&two);
+        mbedtls_mpi_init(&k);
+
+        ret = mbedtls_ecp_group_load(&grp, curves[i].id);
+        if (ret == 0) {
+            ret = mbedtls_mpi_lset(&two, 2);
+        }
+        if (ret == 0) {
+            ret = mbedtls_ecp_mul(&grp, &g2, &two, &grp.G, test_rng, NULL);
+        }
+
+        for (n = 0; (ret == 0) && (n < TEST_SCALAR_NUM); n++) {
+            ret = random_even_scalar(&grp, &k);
+            if (ret == 0) {
+                ret = mbedtls_ecp_mul(&grp, &kg, &k, &grp.G, test_rng, NULL);
+            }
+            if (ret == 0) {
+                ret = mbedtls_mpi_shift_r(&k, 1);
+            }
+            if (ret == 0) {
+                ret = mbedtls_ecp_mul(&grp, &kg_generic, &k, &g2, test_rng,
+                                      NULL);
+            }
+            if (ret == 0) {
+                ret = mbedtls_ecp_point_cmp(&kg, &kg_generic);
+            }
+        }
+
+        mbedtls_mpi_free(&k);
+        mbedtls_mpi_free(&two);
+        mbedtls_ecp_point_free(&kg_generic);
+        mbedtls_ecp_point_free(&kg);
+        mbedtls_ecp_point_free(&g2);
+        mbedtls_ecp_group_free(&grp);
+
+        TEST_ASSERT(ret == 0, "Generator multiplication differs");
+    }
+
+    return 0;
+}
+
+/*------------------------------ Benchmark -----------------------------------*/
+
+/* Calls per second of a multiplication of the base point by random scalars */
+static int bench_mul(mbedtls_ecp_group *grp, const mbedtls_ecp_point *base,
+                     double *rate)
+{
+    mbedtls_ecp_point r;
+    mbedtls_mpi k;
+    uint64_t start, elapsed;
+    uint32_t count = 0;
+    int ret = 0;
+
+    mbedtls_ecp_point_init(&r);
+    mbedtls_mpi_init(&k);
+
+    start = tfm_unittest_now_ns();
+    do {
+        ret = random_even_scalar(grp, &k);
+        if (ret == 0) {
+            ret = mbedtls_ecp_mul(grp, &r, &k, base, test_rng, NULL);
+        }
+        count++;
+        elapsed = tfm_unittest_now_ns() - start;
+    } while ((ret == 0) && (elapsed < TEST_BENCH_NS));
+
+    *rate = tfm_unittest_per_s(count, elapsed);
+
+    mbedtls_mpi_free(&k);
+    mbedtls_ecp_point_free(&r);
+
+    return ret;
+}
+
+static int bench_sign(mbedtls_ecp_group *grp,
+                      const struct curve_vector_t *curve, double *rate)
+{
+    mbedtls_mpi d, r, s;
+    uint8_t hash[48];
+    uint64_t start, elapsed;
+    uint32_t count = 0;
+    int ret;
+
+    mbedtls_mpi_init(&d);
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+
+    ret = mbedtls_mpi_read_string(&d, 16, curve->d);
+    if (ret == 0) {
+        ret = hash_sample(curve, hash);
+    }
+
+    start = tfm_unittest_now_ns();
+    do {
+        if (ret == 0) {
+            ret = mbedtls_ecdsa_sign(grp, &r, &s, &d, hash, curve->hash_len,
+                                     test_rng, NULL);
+        }
+        count++;
+        elapsed = tfm_unittest_now_ns() - start;
+    } while ((ret == 0) && (elapsed < TEST_BENCH_NS));
+
+    *rate = tfm_unittest_per_s(count, elapsed);
+
+    mbedtls_mpi_free(&s);
+    mbedtls_mpi_free(&r);
+    mbedtls_mpi_free(&d);
+
+    return ret;
+}
+
+static int bench_sign_rate(void)
+{
+    mbedtls_ecp_group grp;
+    mbedtls_ecp_point g2;
+    mbedtls_mpi two;
+    double sign, mul_g, mul_p, sign_no_tables;
+    size_t i;
+    int ret;
+
+    printf("MBEDTLS_ECP_FIXED_POINT_OPTIM %d\r\n",
+           (int)MBEDTLS_ECP_FIXED_POINT_OPTIM);
+    printf("%-6s %12s %12s %12s %12s\r\n", "curve", "signs/s", "k.G/s",
+           "k.P/s", "signs/s est.");
+    printf("%-6s %12s %12s %12s %12s\r\n", "", "", "", "",
+           "no tables");
+
+    for (i = 0; i < TEST_CURVE_NUM; i++) {
+        mbedtls_ecp_group_init(&grp);
+        mbedtls_ecp_point_init(&g2);
+        mbedtls_mpi_init(&two);
+
+        ret = mbedtls_ecp_group_load(&grp, curves[i].id);
+        if (ret == 0) {
+            ret = mbedtls_mpi_lset(&two, 2);
+        }
+        if (ret == 0) {
+            ret = mbedtls_ecp_mul(&grp, &g2, &two, &grp.G, test_rng, NULL);
+        }
+        if (ret == 0) {
+            ret = bench_sign(&grp, &curves[i], &sign);
+        }
+        if (ret == 0) {
+            ret = bench_mul(&grp, &grp.G, &mul_g);
+        }
+        if (ret == 0) {
+            ret = bench_mul(&grp, &g2, &mul_p);
+        }
+
+        mbedtls_mpi_free(&two);
+        mbedtls_ecp_point_free(&g2);
+        mbedtls_ecp_group_free(&grp);
+
+        TEST_ASSERT(ret == 0, "Benchmark failed");
+
+        /* The signature with k.G replaced by a generic multiplication */
+        sign_no_tables = 1.0 / ((1.0 / sign) - (1.0 / mul_g) + (1.0 / mul_p));
+
+        printf("%-6s %12.0f %12.0f %12.0f %12.0f\r\n", curves[i].name, sign,
+               mul_g, mul_p, sign_no_tables);
+    }
+
+    return 0;
+}
+
+int main(void)
+{
+    uint32_t failures = 0;
+
+    RUN_TEST(test_rfc6979_vectors, failures);
+    RUN_TEST(test_generator_matches_generic_path, failures);
+    RUN_TEST(bench_sign_rate, failures);
+
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,483 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Stresses the engine allocator of the Crypto partition by replaying traces of
+ * the calloc and free calls made by Mbed TLS during ECDSA, RSA and AEAD
+ * operations, alone and interleaved as concurrent operations would. The traces
+ * in traces/ were recorded on the build machine by interposing calloc and free
+ * around the listed Mbed TLS calls, so the sizes of the structures are the
+ * 64-bit ones. Each allocation is checked to be zeroed, is filled with a
+ * pattern of its own and is checked to still hold it when freed.
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config_crypto.h"
+#include "tfm_mbedcrypto_include.h"
+#include "tfm_crypto_api.h"
+#include "tfm_crypto_defs.h"
+#include "mbedtls/platform.h"
+
+#include "tfm_unittest.h"
+
+#if CRYPTO_ENGINE_SLAB_SIZE == 0
+#error "The allocator test needs CRYPTO_ENGINE_SLAB_SIZE"
+#endif
+
+#define TEST_REPLAY_PASSES      (100u)
+#define TEST_CONCURRENT_STEPS   (200000u)
+#define TEST_BENCH_PASSES       (1000u)
+#define TEST_MAX_LINE           (128u)
+
+/* An allocation of size bytes, or a free when size is 0 */
+struct trace_op_t {
+    uint32_t id;
+    uint32_t size;
+};
+
+struct trace_t {
+    const char *file;
+    struct trace_op_t *ops;
+    size_t op_num;
+    size_t id_num;
+};
+
+/* A replay in progress of a trace */
+struct replay_t {
+    const struct trace_t *trace;
+    size_t next;
+    uint8_t tag;
+    uint8_t **ptr;
+    size_t *size;
+};
+
+enum {
+    TRACE_ECDSA = 0,
+    TRACE_RSA,
+    TRACE_AEAD,
+    TRACE_NUM
+};
+
+static struct trace_t traces[TRACE_NUM] = {
+    [TRACE_ECDSA] = { .file = CRYPTO_MEM_TRACE_DIR "/ecdsa_p256_sign.txt" },
+    [TRACE_RSA]   = {
+        .file = CRYPTO_MEM_TRACE_DIR "/rsa_2048_sign_verify.txt"
+    },
+    [TRACE_AEAD]  = { .file = CRYPTO_MEM_TRACE_DIR "/aes_128_gcm.txt" },
+};
+
+static uint8_t engine_buf[CRYPTO_ENGINE_BUF_SIZE];
+
+static void *(*engine_calloc)(size_t n, size_t size);
+static void (*engine_free)(void *ptr);
+
+/*--------------------------- Mbed TLS dependencies --------------------------*/
+
+int mbedtls_platform_set_calloc_free(void *(*calloc_func)(size_t, size_t),
+                                     void (*free_func)(void *))
+{
+    engine_calloc = calloc_func;
+    engine_free = free_func;
+
+    return 0;
+}
+
+/*--------------------------------- Helpers ----------------------------------*/
+
+static int load_trace(struct trace_t *trace)
+{
+    char line[TEST_MAX_LINE];
+    struct trace_op_t *ops;
+    unsigned long id, size;
+    size_t cap = 0;
+    int err = 0;
+    FILE *f;
+
+    f = fopen(trace->file, "r");
+    if (f == NULL) {
+        printf("Cannot open %s\r\n", trace->file);
+        return 1;
+    }
+
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (line[0] == '#') {
+            continue;
+        }
+
+        if (trace->op_num == cap) {
+            cap = (cap == 0) ? 256 : cap * 2;
+            ops = realloc(trace->ops, cap * sizeof(ops[0]));
+            if (ops == NULL) {
+                err = 1;
+                break;
+            }
+            trace->ops = ops;
+        }
+
+        if (sscanf(line, "A %lu %lu", &id, &size) == 2 && size != 0) {
+            trace->ops[trace->op_num].size = (uint32_t)size;
+        } else if (sscanf(line, "F %lu", &id) == 1) {
+            trace->ops[trace->op_num].size = 0;
+        } else {
+            printf("Malformed line in %s: %s\r\n", trace->file, line);
+            err = 1;
+            break;
+        }
+        trace->ops[trace->op_num].id = (uint32_t)id;
+        trace->op_num++;
+        if (id >= trace->id_num) {
+            trace->id_num = id + 1;
+        }
+    }
+
+    (void)fclose(f);
+
+    return (err != 0 || trace->op_num == 0) ? 1 : 0;
+}
+
+static uint8_t fill_byte(const struct replay_t *r, uint32_t id, size_t i)
+{
+    return (uint8_t)(r->tag ^ (id * 31u) ^ i);
+}
+
+static int replay_init(struct replay_t *r, const struct trace_t *trace,
+                       uint8_t tag)
+{
+    r->trace = trace;
+    r->next = 0;
+    r->tag = tag;
+    r->ptr = calloc(trace->id_num, sizeof(r->ptr[0]));
+    r->size = calloc(trace->id_num, sizeof(r->size[0]));
+
+    return (r->ptr == NULL || r->size == NULL) ? 1 : 0;
+}
+
+static void replay_deinit(struct replay_t *r)
+{
+    free(r->ptr);
+    free(r->size);
+}
+
+/* Checks the pattern of a live allocation and frees it */
+static int replay_free(struct replay_t *r, uint32_t id)
+{
+    size_t i;
+
+    if (r->ptr[id] == NULL) {
+        return 0;
+    }
+
+    for (i = 0; i < r->size[id]; i++) {
+        if (r->ptr[id][i] != fill_byte(r, id, i)) {
+            printf("Allocation %u of %s overwritten\r\n", (unsigned)id,
+                   r->trace->file);
+            return 1;
+        }
+    }
+
+    engine_free(r->ptr[id]);
+    r->ptr[id] = NULL;
+
+    return 0;
+}
+
+/*
+ * Frees what the replay holds and restarts it, as the caller of Mbed TLS does
+ * when an operation fails.
+ */
+static int replay_abort(struct replay_t *r)
+{
+    uint32_t id;
+
+    for (id = 0; id < r->trace->id_num; id++) {
+        if (replay_free(r, id) != 0) {
+            return 1;
+        }
+    }
+    r->next = 0;
+
+    return 0;
+}
+
+/*
+ * Replays the next call of the trace. Sets out_of_memory and aborts the replay
+ * when an allocation fails.
+ */
+static int replay_step(struct replay_t *r, bool *out_of_memory)
+{
+    const struct trace_op_t *op = &r->trace->ops[r->next];
+    uint8_t *p;
+    size_t i;
+
+    *out_of_memory = false;
+
+    if (op->size == 0) {
+        if (replay_free(r, op->id) != 0) {
+            return 1;
+        }
+    } else {
+        p = engine_calloc(1, op->size);
+        if (p == NULL) {
+            *out_of_memory = true;
+            return replay_abort(r);
+        }
+
+        for (i = 0; i < op->size; i++) {
+            if (p[i] != 0) {
+                printf("Allocation not zeroed\r\n");
+                return 1;
+            }
+            p[i] = fill_byte(r, op->id, i);
+        }
+        r->ptr[op->id] = p;
+        r->size[op->id] = op->size;
+    }
+
+    r->next = (r->next + 1) % r->trace->op_num;
+
+    return 0;
+}
+
+static void engine_init(size_t size)
+{
+    engine_calloc = NULL;
+    engine_free = NULL;
+    tfm_crypto_mem_init(engine_buf, size);
+}
+
+/* Checks that the allocator is back to its state after initialisation */
+static int check_engine_idle(const struct tfm_crypto_heap_stats_t *initial)
+{
+    struct tfm_crypto_heap_stats_t stats;
+
+    tfm_crypto_mem_get_stats(&stats);
+
+    TEST_ASSERT(stats.invalid_frees == 0, "Invalid free reported");
+    TEST_ASSERT(stats.slab_used == 0, "Slab blocks leaked");
+    TEST_ASSERT(stats.heap_used == 0, "Heap blocks leaked");
+    TEST_ASSERT(stats.heap_free == initial->heap_free &&
+                stats.heap_largest_free == initial->heap_largest_free,
+                "Heap not free in a single run");
+
+    return 0;
+}
+
+/*---------------------------------- Tests -----------------------------------*/
+
+/* Each trace alone, replayed many times over */
+static int test_replay_traces(void)
+{
+    struct tfm_crypto_heap_stats_t initial, stats;
+    struct replay_t r;
+    bool out_of_memory;
+    size_t t, pass, op;
+
+    printf("%-26s %8s %12s %10s\r\n", "trace", "allocs", "slab blocks",
+           "heap peak");
+
+    for (t = 0; t < TRACE_NUM; t++) {
+        engine_init(sizeof(engine_buf));
+        TEST_ASSERT(engine_calloc != NULL && engine_free != NULL,
+                    "Allocator not set");
+        tfm_crypto_mem_get_stats(&initial);
+
+        TEST_ASSERT(replay_init(&r, &traces[t], (uint8_t)t) == 0,
+                    "Out of host memory");
+
+        for (pass = 0; pass < TEST_REPLAY_PASSES; pass++) {
+            for (op = 0; op < traces[t].op_num; op++) {
+                TEST_ASSERT(replay_step(&r, &out_of_memory) == 0,
+                            "Replay corrupted");
+                TEST_ASSERT(!out_of_memory, "Allocation failed");
+            }
+        }
+        replay_deinit(&r);
+
+        if (check_engine_idle(&initial) != 0) {
+            return 1;
+        }
+
+        tfm_crypto_mem_get_stats(&stats);
+        TEST_ASSERT(stats.failed_allocs == 0, "Failed allocation counted");
+        printf("%-26s %8u %12u %8u B\r\n", strrchr(traces[t].file, '/') + 1,
+               (unsigned)(stats.slab_allocs + stats.heap_allocs),
+               (unsigned)stats.slab_peak, (unsigned)stats.heap_peak);
+    }
+
+    return 0;
+}
+
+/* Interleaved calls of concurrent operations */
+static int test_replay_concurrent(void)
+{
+    static const size_t mix[] = { TRACE_ECDSA, TRACE_ECDSA, TRACE_RSA,
+                                  TRACE_AEAD, TRACE_AEAD };
+    struct replay_t r[sizeof(mix) / sizeof(mix[0])];
+    struct tfm_crypto_heap_stats_t initial, stats;
+    bool out_of_memory;
+    size_t i, step;
+
+    engine_init(sizeof(engine_buf));
+    tfm_crypto_mem_get_stats(&initial);
+
+    for (i = 0; i < sizeof(mix) / sizeof(mix[0]); i++) {
+        TEST_ASSERT(replay_init(&r[i], &traces[mix[i]], (uint8_t)(0x40 + i)) ==
+                    0, "Out of host memory");
+        /* Start the replays at different points of their traces */
+        for (step = 0; step < i * 97u % traces[mix[i]].op_num; step++) {
+            TEST_ASSERT(replay_step(&r[i], &out_of_memory) == 0 &&
+                        !out_of_memory, "Replay failed");
+        }
+    }
+
+    for (step = 0; step < TEST_CONCURRENT_STEPS; step++) {
+        i = step % (sizeof(mix) / sizeof(mix[0]));
+        TEST_ASSERT(replay_step(&r[i], &out_of_memory) == 0,
+                    "Replay corrupted");
+        TEST_ASSERT(!out_of_memory, "Allocation failed");
+    }
+
+    for (i = 0; i < sizeof(mix) / sizeof(mix[0]); i++) {
+        TEST_ASSERT(replay_abort(&r[i]) == 0, "Replay corrupted");
+        replay_deinit(&r[i]);
+    }
+
+    if (check_engine_idle(&initial) != 0) {
+        return 1;
+    }
+
+    tfm_crypto_mem_get_stats(&stats);
+    printf("concurrent: slab peak %u blocks, heap peak %u B of %u B\r\n",
+           (unsigned)stats.slab_peak, (unsigned)stats.heap_peak,
+           (unsigned)initial.heap_free);
+
+    return 0;
+}
+
+/*
+ * Concurrent operations in a buffer which cannot hold them: the failures are
+ * reported to the caller and leave the allocator consistent.
+ */
+static int test_replay_out_of_memory(void)
+{
+    static const size_t mix[] = { TRACE_RSA, TRACE_ECDSA, TRACE_RSA };
+    struct replay_t r[sizeof(mix) / sizeof(mix[0])];
+    struct tfm_crypto_heap_stats_t initial, stats;
+    uint32_t failures = 0;
+    bool out_of_memory;
+    size_t i, step;
+
+    engine_init(sizeof(engine_buf) / 2);
+    tfm_crypto_mem_get_stats(&initial);
+
+    for (i = 0; i < sizeof(mix) / sizeof(mix[0]); i++) {
+        TEST_ASSERT(replay_init(&r[i], &traces[mix[i]], (uint8_t)(0x80 + i)) ==
+                    0, "Out of host memory");
+    }
+
+    for (step = 0; step < TEST_CONCURRENT_STEPS; step++) {
+        i = step % (sizeof(mix) / sizeof(mix[0]));
+        TEST_ASSERT(replay_step(&r[i], &out_of_memory) == 0,
+                    "Replay corrupted");
+        failures += out_of_memory ? 1u : 0u;
+    }
+
+    for (i = 0; i < sizeof(mix) / sizeof(mix[0]); i++) {
+        TEST_ASSERT(replay_abort(&r[i]) == 0, "Replay corrupted");
+        replay_deinit(&r[i]);
+    }
+
+    if (check_engine_idle(&initial) != 0) {
+        return 1;
+    }
+
+    tfm_crypto_mem_get_stats(&stats);
+    TEST_ASSERT(failures > 0, "The buffer held the operations");
+    TEST_ASSERT(stats.failed_allocs == failures, "Failures not counted");
+
+    printf("half buffer: %u failed allocations\r\n", (unsigned)failures);
+
+    return 0;
+}
+
+/*------------------------------ Benchmark -----------------------------------*/
+
+/* Calls per second of the ECDSA trace, against the allocator of the host */
+static int bench_replay(void)
+{
+    const struct trace_t *trace = &traces[TRACE_ECDSA];
+    void **ptr;
+    uint64_t start, engine_ns, host_ns;
+    size_t pass, op;
+
+    ptr = calloc(trace->id_num, sizeof(ptr[0]));
+    TEST_ASSERT(ptr != NULL, "Out of host memory");
+
+    engine_init(sizeof(engine_buf));
+
+    start = tfm_unittest_now_ns();
+    for (pass = 0; pass < TEST_BENCH_PASSES; pass++) {
+        for (op = 0; op < trace->op_num; op++) {
+            if (trace->ops[op].size != 0) {
+                ptr[trace->ops[op].id] = engine_calloc(1, trace->ops[op].size);
+            } else {
+                engine_free(ptr[trace->ops[op].id]);
+            }
+        }
+    }
+    engine_ns = tfm_unittest_now_ns() - start;
+
+    start = tfm_unittest_now_ns();
+    for (pass = 0; pass < TEST_BENCH_PASSES; pass++) {
+        for (op = 0; op < trace->op_num; op++) {
+            if (trace->ops[op].size != 0) {
+                ptr[trace->ops[op].id] = calloc(1, trace->ops[op].size);
+            } else {
+                free(ptr[trace->ops[op].id]);
+            }
+        }
+    }
+    host_ns = tfm_unittest_now_ns() - start;
+
+    free(ptr);
+
+    printf("%-10s %14s\r\n", "allocator", "calls/s");
+    printf("%-10s %14.0f\r\n", "engine",
+           tfm_unittest_per_s((uint64_t)TEST_BENCH_PASSES * trace->op_num,
+                              engine_ns));
+    printf("%-10s %14.0f\r\n", "host",
+           tfm_unittest_per_s((uint64_t)TEST_BENCH_PASSES * trace->op_num,
+                              host_ns));
+
+    return 0;
+}
+
+int main(void)
+{
+    uint32_t failures = 0;
+    size_t t;
+
+    for (t = 0; t < TRACE_NUM; t++) {
+        if (load_trace(&traces[t]) != 0) {
+            return 1;
+        }
+    }
+
+    RUN_TEST(test_replay_traces, failures);
+    RUN_TEST(test_replay_concurrent, failures);
+    RUN_TEST(test_replay_out_of_memory, failures);
+    RUN_TEST(bench_replay, failures);
+
+    for (t = 0; t < TRACE_NUM; t++) {
+        free(traces[t].ops);
+    }
+
+    return (failures == 0) ? 0 : 1;
+}
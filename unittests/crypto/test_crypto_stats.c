@@ -0,0 +1,330 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Tests the per-function statistics recorded by the dispatcher of the Crypto
+ * partition when CRYPTO_STATS_ENABLED is set, and measures the cost of
+ * recording a call. The timer hooks are replaced by a fake cycle counter which
+ * the hash interface stub advances by a known cost for each call.
+ */
+
+#include <string.h>
+
+#include "config_crypto.h"
+#include "tfm_mbedcrypto_include.h"
+#include "tfm_crypto_api.h"
+#include "tfm_crypto_defs.h"
+
+#include "psa_msg_fake.h"
+#include "psa_manifest/tfm_crypto.h"
+#include "tfm_unittest.h"
+
+#if !CRYPTO_STATS_ENABLED
+#error "The statistics test needs CRYPTO_STATS_ENABLED"
+#endif
+
+#define TEST_NS_CLIENT_ID      (-1)
+#define TEST_S_CLIENT_ID       (3000)
+#define TEST_OP_HANDLE         (1u)
+#define TEST_MAX_INPUT_SIZE    (4u * CRYPTO_IOVEC_BUFFER_SIZE)
+#define TEST_MAX_ENTRIES       (32u)
+#define TEST_BENCH_CALLS       (1000000u)
+
+/* Cycles charged by the hash interface stub for an update of len bytes */
+#define TEST_UPDATE_CYCLES(len) (100u + (uint32_t)(len))
+
+static uint32_t fake_cycles;
+static uint32_t timer_init_calls;
+
+static uint8_t input[TEST_MAX_INPUT_SIZE];
+
+/*------------------------- Partition dependencies ---------------------------*/
+
+void tfm_crypto_stats_timer_init(void)
+{
+    timer_init_calls++;
+}
+
+uint32_t tfm_crypto_stats_get_cycles(void)
+{
+    return fake_cycles;
+}
+
+psa_status_t tfm_crypto_hash_interface(psa_invec in_vec[],
+                                       psa_outvec out_vec[])
+{
+    const struct tfm_crypto_pack_iovec *iov = in_vec[0].base;
+
+    switch (iov->function_id) {
+    case TFM_CRYPTO_HASH_UPDATE_SID:
+        fake_cycles += TEST_UPDATE_CYCLES(in_vec[1].len);
+        return PSA_SUCCESS;
+    case TFM_CRYPTO_HASH_ABORT_SID:
+        *(uint32_t *)out_vec[0].base = 0;
+        return PSA_SUCCESS;
+    default:
+        return PSA_ERROR_NOT_SUPPORTED;
+    }
+}
+
+psa_status_t tfm_crypto_cipher_interface(psa_invec in_vec[],
+                                         psa_outvec out_vec[],
+                                         mbedtls_svc_key_id_t *encoded_key)
+{
+    (void)in_vec;
+    (void)out_vec;
+    (void)encoded_key;
+    return PSA_ERROR_NOT_SUPPORTED;
+}
+
+/*------------------------------- Helpers ------------------------------------*/
+
+static void reset_stats(uint32_t cycles)
+{
+    tfm_crypto_stats_init();
+    fake_cycles = cycles;
+}
+
+static psa_status_t call_hash_update(size_t input_length)
+{
+    struct tfm_crypto_pack_iovec iov = {
+        .function_id = TFM_CRYPTO_HASH_UPDATE_SID,
+        .op_handle = TEST_OP_HANDLE,
+    };
+    struct psa_msg_fake_t fake = {0};
+    psa_msg_t msg;
+
+    fake.in_vec[0].base = &iov;
+    fake.in_vec[0].len = sizeof(iov);
+    fake.in_vec[1].base = input;
+    fake.in_vec[1].len = input_length;
+
+    psa_msg_fake_init(&msg, &fake, TEST_NS_CLIENT_ID);
+
+    return tfm_crypto_sfn(&msg);
+}
+
+static psa_status_t call_get_stats(int32_t client_id,
+                                   struct tfm_crypto_stats_entry_t *entries,
+                                   size_t max_entries, size_t *num_entries)
+{
+    struct tfm_crypto_pack_iovec iov = {
+        .function_id = TFM_CRYPTO_GET_STATS_SID,
+    };
+    struct psa_msg_fake_t fake = {0};
+    psa_msg_t msg;
+    psa_status_t status;
+
+    fake.in_vec[0].base = &iov;
+    fake.in_vec[0].len = sizeof(iov);
+    fake.out_vec[0].base = entries;
+    fake.out_vec[0].len = max_entries * sizeof(*entries);
+
+    psa_msg_fake_init(&msg, &fake, client_id);
+    status = tfm_crypto_sfn(&msg);
+
+    *num_entries = fake.out_written[0] / sizeof(*entries);
+
+    return status;
+}
+
+static const struct tfm_crypto_stats_entry_t *find_entry(
+        const struct tfm_crypto_stats_entry_t *entries, size_t num_entries,
+        uint16_t function_id)
+{
+    size_t i;
+
+    for (i = 0; i < num_entries; i++) {
+        if (entries[i].function_id == function_id) {
+            return &entries[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*-------------------------------- Tests -------------------------------------*/
+
+static int test_calls_recorded_per_function(void)
+{
+    static const size_t sizes[] = { 16, 256, 64, 1024 };
+    struct tfm_crypto_stats_entry_t entries[TEST_MAX_ENTRIES];
+    const struct tfm_crypto_stats_entry_t *entry;
+    uint64_t bytes = 0, cycles = 0;
+    size_t num_entries, i;
+
+    reset_stats(0);
+
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        TEST_ASSERT(call_hash_update(sizes[i]) == PSA_SUCCESS,
+                    "Hash update failed");
+        bytes += sizes[i];
+        cycles += TEST_UPDATE_CYCLES(sizes[i]);
+    }
+
+    TEST_ASSERT(call_get_stats(TEST_S_CLIENT_ID, entries, TEST_MAX_ENTRIES,
+                               &num_entries) == PSA_SUCCESS,
+                "Reading the statistics failed");
+    TEST_ASSERT(num_entries == 1, "Wrong number of recorded functions");
+
+    entry = find_entry(entries, num_entries, TFM_CRYPTO_HASH_UPDATE_SID);
+    TEST_ASSERT(entry != NULL, "Hash update not recorded");
+    TEST_ASSERT(entry->count == sizeof(sizes) / sizeof(sizes[0]),
+                "Wrong call count");
+    TEST_ASSERT(entry->bytes == bytes, "Wrong input bytes");
+    TEST_ASSERT(entry->cycles_total == cycles, "Wrong total cycles");
+    TEST_ASSERT(entry->cycles_min == TEST_UPDATE_CYCLES(16),
+                "Wrong minimum cycles");
+    TEST_ASSERT(entry->cycles_max == TEST_UPDATE_CYCLES(1024),
+                "Wrong maximum cycles");
+
+    /* The previous read is recorded as well */
+    TEST_ASSERT(call_get_stats(TEST_S_CLIENT_ID, entries, TEST_MAX_ENTRIES,
+                               &num_entries) == PSA_SUCCESS,
+                "Reading the statistics failed");
+    TEST_ASSERT(num_entries == 2 &&
+                find_entry(entries, num_entries,
+                           TFM_CRYPTO_GET_STATS_SID) != NULL,
+                "Statistics read not recorded");
+
+    return 0;
+}
+
+static int test_cycle_counter_wrap(void)
+{
+    struct tfm_crypto_stats_entry_t entries[TEST_MAX_ENTRIES];
+    size_t num_entries;
+
+    reset_stats(UINT32_MAX - 10u);
+
+    TEST_ASSERT(call_hash_update(64) == PSA_SUCCESS, "Hash update failed");
+    TEST_ASSERT(call_get_stats(TEST_S_CLIENT_ID, entries, TEST_MAX_ENTRIES,
+                               &num_entries) == PSA_SUCCESS,
+                "Reading the statistics failed");
+    TEST_ASSERT(num_entries == 1 &&
+                entries[0].cycles_total == TEST_UPDATE_CYCLES(64),
+                "Wrong cycles across the counter wrap");
+
+    return 0;
+}
+
+static int test_streamed_request_recorded_once(void)
+{
+    struct tfm_crypto_stats_entry_t entries[TEST_MAX_ENTRIES];
+    const struct tfm_crypto_stats_entry_t *entry;
+    size_t num_entries;
+    uint32_t start;
+
+    reset_stats(0);
+    start = fake_cycles;
+
+    TEST_ASSERT(call_hash_update(TEST_MAX_INPUT_SIZE) == PSA_SUCCESS,
+                "Streamed hash update failed");
+
+    TEST_ASSERT(call_get_stats(TEST_S_CLIENT_ID, entries, TEST_MAX_ENTRIES,
+                               &num_entries) == PSA_SUCCESS,
+                "Reading the statistics failed");
+
+    entry = find_entry(entries, num_entries, TFM_CRYPTO_HASH_UPDATE_SID);
+    TEST_ASSERT(entry != NULL, "Hash update not recorded");
+    TEST_ASSERT(entry->count == 1, "Windows recorded as separate calls");
+    TEST_ASSERT(entry->bytes == TEST_MAX_INPUT_SIZE, "Wrong input bytes");
+    TEST_ASSERT(entry->cycles_total > TEST_UPDATE_CYCLES(TEST_MAX_INPUT_SIZE),
+                "Cycles of the windows not summed");
+    TEST_ASSERT(entry->cycles_total == fake_cycles - start,
+                "Wrong total cycles");
+
+    return 0;
+}
+
+static int test_stats_not_disclosed_to_ns(void)
+{
+    struct tfm_crypto_stats_entry_t entries[TEST_MAX_ENTRIES];
+    size_t num_entries;
+
+    reset_stats(0);
+
+    TEST_ASSERT(call_hash_update(16) == PSA_SUCCESS, "Hash update failed");
+    memset(entries, 0, sizeof(entries));
+
+    TEST_ASSERT(call_get_stats(TEST_NS_CLIENT_ID, entries, TEST_MAX_ENTRIES,
+                               &num_entries) == PSA_ERROR_NOT_PERMITTED,
+                "Statistics read by a non-secure client");
+    TEST_ASSERT(num_entries == 0 && entries[0].count == 0,
+                "Statistics written to a non-secure client");
+
+    return 0;
+}
+
+static int test_table_full(void)
+{
+    struct tfm_crypto_stats_entry_t entries[TEST_MAX_ENTRIES + 1];
+    size_t num_entries;
+    uint16_t i;
+
+    reset_stats(0);
+
+    for (i = 0; i < TEST_MAX_ENTRIES + 4u; i++) {
+        tfm_crypto_stats_record(0x1000u + i, 1, 1);
+    }
+    tfm_crypto_stats_record(0x1000u, 1, 1);
+
+    TEST_ASSERT(call_get_stats(TEST_S_CLIENT_ID, entries,
+                               TEST_MAX_ENTRIES + 1, &num_entries) ==
+                PSA_SUCCESS, "Reading the statistics failed");
+    TEST_ASSERT(num_entries == TEST_MAX_ENTRIES, "Table overflowed");
+    TEST_ASSERT(find_entry(entries, num_entries, 0x1000u)->count == 2,
+                "Known function not recorded once the table is full");
+    TEST_ASSERT(find_entry(entries, num_entries,
+                           0x1000u + TEST_MAX_ENTRIES) == NULL,
+                "New function recorded in a full table");
+
+    return 0;
+}
+
+/*------------------------------ Benchmark -----------------------------------*/
+
+/* Time taken by the lookup and update of a full table */
+static int bench_record_cost(void)
+{
+    uint64_t start, elapsed;
+    uint32_t i;
+
+    reset_stats(0);
+    for (i = 0; i < TEST_MAX_ENTRIES; i++) {
+        tfm_crypto_stats_record(0x1000u + i, 1, 1);
+    }
+
+    start = tfm_unittest_now_ns();
+    for (i = 0; i < TEST_BENCH_CALLS; i++) {
+        tfm_crypto_stats_record(0x1000u + (i % TEST_MAX_ENTRIES), 64, i);
+    }
+    elapsed = tfm_unittest_now_ns() - start;
+
+    printf("%-20s %10s\r\n", "record", "ns/call");
+    printf("%-20s %10.1f\r\n", "32 entries",
+           (double)elapsed / (double)TEST_BENCH_CALLS);
+
+    return 0;
+}
+
+int main(void)
+{
+    uint32_t failures = 0;
+
+    TEST_ASSERT(tfm_crypto_init() == PSA_SUCCESS, "Init failed");
+    TEST_ASSERT(timer_init_calls == 1, "Timer not initialised");
+
+    RUN_TEST(test_calls_recorded_per_function, failures);
+    RUN_TEST(test_cycle_counter_wrap, failures);
+    RUN_TEST(test_streamed_request_recorded_once, failures);
+    RUN_TEST(test_stats_not_disclosed_to_ns, failures);
+    RUN_TEST(test_table_full, failures);
+    RUN_TEST(bench_record_cost, failures);
+
+    return (failures == 0) ? 0 : 1;
+}
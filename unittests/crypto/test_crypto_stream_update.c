@@ -0,0 +1,349 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Tests the streaming of multi-part update inputs through the scratch in
+ * crypto_init.c, and measures the throughput of SHA-256 and AES-CTR updates
+ * served through tfm_crypto_sfn(). The hash and cipher interfaces of the
+ * partition are replaced by the Mbed TLS primitives, so the numbers measure
+ * the request path and the primitives only.
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config_crypto.h"
+#include "tfm_mbedcrypto_include.h"
+#include "tfm_crypto_api.h"
+#include "tfm_crypto_defs.h"
+#include "mbedtls/aes.h"
+#include "mbedtls/sha256.h"
+
+#include "psa_msg_fake.h"
+#include "psa_manifest/tfm_crypto.h"
+#include "tfm_unittest.h"
+
+#define TEST_CLIENT_ID         (-1)
+#define TEST_OP_HANDLE         (1u)
+#define TEST_MAX_INPUT_SIZE    ((64u * 1024u) + 3u)
+#define TEST_BENCH_BYTES       (8u * 1024u * 1024u)
+
+/* State of the operations served by the interface stubs */
+static struct {
+    mbedtls_sha256_context sha256;
+    mbedtls_aes_context aes;
+    uint8_t nonce_counter[16];
+    uint8_t stream_block[16];
+    size_t nc_off;
+    uint32_t update_calls;
+    uint32_t abort_calls;
+    uint32_t fail_at_update;   /* Update call which fails, 0 for none */
+    size_t max_update_size;
+} op;
+
+static uint8_t input[TEST_MAX_INPUT_SIZE];
+static uint8_t output[TEST_MAX_INPUT_SIZE];
+static uint8_t expected[TEST_MAX_INPUT_SIZE];
+
+static const uint8_t test_key[16] = {
+    0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+    0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+
+/*------------------------- Partition dependencies ---------------------------*/
+
+static psa_status_t stub_update_status(size_t input_length)
+{
+    op.update_calls++;
+    if (input_length > op.max_update_size) {
+        op.max_update_size = input_length;
+    }
+
+    if (op.update_calls == op.fail_at_update) {
+        return PSA_ERROR_HARDWARE_FAILURE;
+    }
+
+    return PSA_SUCCESS;
+}
+
+static void stub_abort(psa_outvec out_vec[])
+{
+    op.abort_calls++;
+    *(uint32_t *)out_vec[0].base = 0;
+}
+
+psa_status_t tfm_crypto_hash_interface(psa_invec in_vec[],
+                                       psa_outvec out_vec[])
+{
+    const struct tfm_crypto_pack_iovec *iov = in_vec[0].base;
+    psa_status_t status;
+
+    switch (iov->function_id) {
+    case TFM_CRYPTO_HASH_UPDATE_SID:
+        status = stub_update_status(in_vec[1].len);
+        if (status != PSA_SUCCESS) {
+            return status;
+        }
+        if (mbedtls_sha256_update(&op.sha256, in_vec[1].base,
+                                  in_vec[1].len) != 0) {
+            return PSA_ERROR_GENERIC_ERROR;
+        }
+        return PSA_SUCCESS;
+    case TFM_CRYPTO_HASH_ABORT_SID:
+        stub_abort(out_vec);
+        return PSA_SUCCESS;
+    default:
+        return PSA_ERROR_NOT_SUPPORTED;
+    }
+}
+
+psa_status_t tfm_crypto_cipher_interface(psa_invec in_vec[],
+                                         psa_outvec out_vec[],
+                                         mbedtls_svc_key_id_t *encoded_key)
+{
+    const struct tfm_crypto_pack_iovec *iov = in_vec[0].base;
+    psa_status_t status;
+
+    (void)encoded_key;
+
+    switch (iov->function_id) {
+    case TFM_CRYPTO_CIPHER_UPDATE_SID:
+        /* As for psa_cipher_update(), the output is not written on failure */
+        status = stub_update_status(in_vec[1].len);
+        if ((status == PSA_SUCCESS) && (out_vec[0].len < in_vec[1].len)) {
+            status = PSA_ERROR_BUFFER_TOO_SMALL;
+        }
+        if ((status == PSA_SUCCESS) &&
+            (mbedtls_aes_crypt_ctr(&op.aes, in_vec[1].len, &op.nc_off,
+                                   op.nonce_counter, op.stream_block,
+                                   in_vec[1].base, out_vec[0].base) != 0)) {
+            status = PSA_ERROR_GENERIC_ERROR;
+        }
+        out_vec[0].len = (status == PSA_SUCCESS) ? in_vec[1].len : 0;
+        return status;
+    case TFM_CRYPTO_CIPHER_ABORT_SID:
+        stub_abort(out_vec);
+        return PSA_SUCCESS;
+    default:
+        return PSA_ERROR_NOT_SUPPORTED;
+    }
+}
+
+/*------------------------------- Helpers ------------------------------------*/
+
+static void reset_operations(uint32_t fail_at_update)
+{
+    mbedtls_sha256_free(&op.sha256);
+    mbedtls_aes_free(&op.aes);
+    memset(&op, 0, sizeof(op));
+
+    mbedtls_sha256_init(&op.sha256);
+    (void)mbedtls_sha256_starts(&op.sha256, 0);
+    mbedtls_aes_init(&op.aes);
+    (void)mbedtls_aes_setkey_enc(&op.aes, test_key, 128);
+    op.fail_at_update = fail_at_update;
+}
+
+static psa_status_t call_update(uint16_t function_id, size_t input_length,
+                                size_t output_size, size_t *output_length)
+{
+    struct tfm_crypto_pack_iovec iov = {
+        .function_id = function_id,
+        .op_handle = TEST_OP_HANDLE,
+    };
+    struct psa_msg_fake_t fake = {0};
+    psa_msg_t msg;
+    psa_status_t status;
+
+    fake.in_vec[0].base = &iov;
+    fake.in_vec[0].len = sizeof(iov);
+    fake.in_vec[1].base = input;
+    fake.in_vec[1].len = input_length;
+    fake.out_vec[0].base = output;
+    fake.out_vec[0].len = output_size;
+
+    psa_msg_fake_init(&msg, &fake, TEST_CLIENT_ID);
+    status = tfm_crypto_sfn(&msg);
+
+    if (output_length != NULL) {
+        *output_length = fake.out_written[0];
+    }
+
+    return status;
+}
+
+static const size_t test_sizes[] = {
+    1024, CRYPTO_IOVEC_BUFFER_SIZE, CRYPTO_IOVEC_BUFFER_SIZE + 1,
+    3 * CRYPTO_IOVEC_BUFFER_SIZE, TEST_MAX_INPUT_SIZE
+};
+
+/*-------------------------------- Tests -------------------------------------*/
+
+static int test_hash_update_matches_one_shot(void)
+{
+    uint8_t digest[32], reference[32];
+    size_t i;
+
+    for (i = 0; i < sizeof(test_sizes) / sizeof(test_sizes[0]); i++) {
+        reset_operations(0);
+
+        TEST_ASSERT(call_update(TFM_CRYPTO_HASH_UPDATE_SID, test_sizes[i], 0,
+                                NULL) == PSA_SUCCESS,
+                    "Hash update failed");
+        TEST_ASSERT(mbedtls_sha256_finish(&op.sha256, digest) == 0,
+                    "Hash finish failed");
+        TEST_ASSERT(mbedtls_sha256(input, test_sizes[i], reference, 0) == 0,
+                    "Reference hash failed");
+        TEST_ASSERT(memcmp(digest, reference, sizeof(digest)) == 0,
+                    "Streamed digest differs from the one-shot digest");
+        TEST_ASSERT(op.max_update_size <= CRYPTO_IOVEC_BUFFER_SIZE,
+                    "Window larger than the scratch");
+        TEST_ASSERT((test_sizes[i] <= CRYPTO_IOVEC_BUFFER_SIZE) ==
+                    (op.update_calls == 1),
+                    "Only inputs larger than the scratch must be streamed");
+    }
+
+    return 0;
+}
+
+static int test_cipher_update_matches_one_shot(void)
+{
+    uint8_t nonce_counter[16] = {0}, stream_block[16];
+    mbedtls_aes_context aes;
+    size_t nc_off, output_length, i;
+
+    for (i = 0; i < sizeof(test_sizes) / sizeof(test_sizes[0]); i++) {
+        reset_operations(0);
+        memset(output, 0, sizeof(output));
+
+        TEST_ASSERT(call_update(TFM_CRYPTO_CIPHER_UPDATE_SID, test_sizes[i],
+                                test_sizes[i], &output_length) == PSA_SUCCESS,
+                    "Cipher update failed");
+        TEST_ASSERT(output_length == test_sizes[i],
+                    "Wrong output length written to the client");
+
+        nc_off = 0;
+        memset(nonce_counter, 0, sizeof(nonce_counter));
+        mbedtls_aes_init(&aes);
+        (void)mbedtls_aes_setkey_enc(&aes, test_key, 128);
+        (void)mbedtls_aes_crypt_ctr(&aes, test_sizes[i], &nc_off,
+                                    nonce_counter, stream_block,
+                                    input, expected);
+        mbedtls_aes_free(&aes);
+
+        TEST_ASSERT(memcmp(output, expected, test_sizes[i]) == 0,
+                    "Streamed ciphertext differs from the one-shot one");
+        TEST_ASSERT(op.max_update_size < (CRYPTO_IOVEC_BUFFER_SIZE / 2),
+                    "Input window leaves no room for the output window");
+    }
+
+    return 0;
+}
+
+static int test_failed_window_aborts(void)
+{
+    size_t output_length;
+
+    reset_operations(2);
+    TEST_ASSERT(call_update(TFM_CRYPTO_HASH_UPDATE_SID, TEST_MAX_INPUT_SIZE, 0,
+                            NULL) == PSA_ERROR_HARDWARE_FAILURE,
+                "Hash window failure not returned");
+    TEST_ASSERT(op.abort_calls == 1, "Hash operation not aborted");
+    TEST_ASSERT(op.update_calls == 2, "Windows processed after the failure");
+
+    reset_operations(2);
+    TEST_ASSERT(call_update(TFM_CRYPTO_CIPHER_UPDATE_SID, TEST_MAX_INPUT_SIZE,
+                            TEST_MAX_INPUT_SIZE, &output_length) ==
+                PSA_ERROR_HARDWARE_FAILURE,
+                "Cipher window failure not returned");
+    TEST_ASSERT(op.abort_calls == 1, "Cipher operation not aborted");
+    TEST_ASSERT(output_length == op.max_update_size,
+                "Only the output of the first window must be written");
+
+    /* A small update is served from the scratch and not aborted here */
+    reset_operations(1);
+    TEST_ASSERT(call_update(TFM_CRYPTO_HASH_UPDATE_SID, 1024, 0, NULL) ==
+                PSA_ERROR_HARDWARE_FAILURE,
+                "Hash failure not returned");
+    TEST_ASSERT(op.abort_calls == 0, "Unstreamed update aborted");
+
+    return 0;
+}
+
+static int test_cipher_output_too_small(void)
+{
+    size_t output_length;
+
+    reset_operations(0);
+    TEST_ASSERT(call_update(TFM_CRYPTO_CIPHER_UPDATE_SID, TEST_MAX_INPUT_SIZE,
+                            TEST_MAX_INPUT_SIZE - 1, &output_length) ==
+                PSA_ERROR_BUFFER_TOO_SMALL,
+                "Short output not detected");
+    TEST_ASSERT(op.abort_calls == 1, "Cipher operation not aborted");
+    TEST_ASSERT(output_length < TEST_MAX_INPUT_SIZE,
+                "Output written beyond the client buffer");
+
+    return 0;
+}
+
+/*------------------------------ Benchmark -----------------------------------*/
+
+static int bench_update_throughput(void)
+{
+    static const uint16_t sids[] = {
+        TFM_CRYPTO_HASH_UPDATE_SID, TFM_CRYPTO_CIPHER_UPDATE_SID
+    };
+    static const char *const names[] = { "SHA-256", "AES-CTR" };
+    uint64_t start, elapsed;
+    size_t size, done, output_length;
+    uint32_t i;
+
+    printf("%-8s %8s %12s\r\n", "update", "bytes", "MB/s");
+
+    for (i = 0; i < sizeof(sids) / sizeof(sids[0]); i++) {
+        for (size = 1024; size <= (64u * 1024u); size *= 2) {
+            reset_operations(0);
+
+            start = tfm_unittest_now_ns();
+            for (done = 0; done < TEST_BENCH_BYTES; done += size) {
+                TEST_ASSERT(call_update(sids[i], size,
+                                        (sids[i] == TFM_CRYPTO_HASH_UPDATE_SID)
+                                        ? 0 : size,
+                                        &output_length) == PSA_SUCCESS,
+                            "Update failed");
+            }
+            elapsed = tfm_unittest_now_ns() - start;
+
+            printf("%-8s %8zu %12.1f\r\n", names[i], size,
+                   tfm_unittest_mb_per_s(done, elapsed));
+        }
+    }
+
+    return 0;
+}
+
+int main(void)
+{
+    uint32_t failures = 0;
+    size_t i;
+
+    for (i = 0; i < sizeof(input); i++) {
+        input[i] = (uint8_t)((i * 31u) ^ (i >> 8));
+    }
+
+    RUN_TEST(test_hash_update_matches_one_shot, failures);
+    RUN_TEST(test_cipher_update_matches_one_shot, failures);
+    RUN_TEST(test_failed_window_aborts, failures);
+    RUN_TEST(test_cipher_output_too_small, failures);
+    RUN_TEST(bench_update_throughput, failures);
+
+    mbedtls_sha256_free(&op.sha256);
+    mbedtls_aes_free(&op.aes);
+
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,14 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __UNITTEST_CONFIG_CRYPTO_H__
+#define __UNITTEST_CONFIG_CRYPTO_H__
+
+/* The Crypto partition is tested with the base configuration */
+#include "config_base.h"
+
+#endif /* __UNITTEST_CONFIG_CRYPTO_H__ */
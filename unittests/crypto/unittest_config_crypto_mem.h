@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __UNITTEST_CONFIG_CRYPTO_MEM_H__
+#define __UNITTEST_CONFIG_CRYPTO_MEM_H__
+
+/*
+ * The base configuration with the engine allocator. The buffer holds the
+ * concurrent replay of the traces, recorded on a 64-bit build machine where
+ * the Mbed TLS structures are larger than on the targets.
+ */
+#include "config_base.h"
+
+#undef CRYPTO_ENGINE_BUF_SIZE
+#define CRYPTO_ENGINE_BUF_SIZE                 0x4000
+
+#undef CRYPTO_ENGINE_SLAB_SIZE
+#define CRYPTO_ENGINE_SLAB_SIZE                0x1000
+
+#endif /* __UNITTEST_CONFIG_CRYPTO_MEM_H__ */
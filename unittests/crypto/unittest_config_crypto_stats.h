@@ -0,0 +1,17 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __UNITTEST_CONFIG_CRYPTO_STATS_H__
+#define __UNITTEST_CONFIG_CRYPTO_STATS_H__
+
+/* The base configuration with the per-function statistics */
+#include "config_base.h"
+
+#undef CRYPTO_STATS_ENABLED
+#define CRYPTO_STATS_ENABLED                   1
+
+#endif /* __UNITTEST_CONFIG_CRYPTO_STATS_H__ */
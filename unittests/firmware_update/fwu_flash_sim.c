@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * A CMSIS flash driver over a RAM copy of the flash, which counts the time
+ * spent by its operations in a simulated time instead of waiting. In the
+ * asynchronous mode, ProgramData() returns 0 once the programming is started
+ * and GetStatus() reports busy until it is done, so the partition can work
+ * while the flash programs. As with a DMA, the data is only taken from the
+ * buffer of the caller once the programming completes, so a buffer reused too
+ * early corrupts the flash content.
+ */
+
+#include <string.h>
+
+#include "flash_layout.h"
+#include "fwu_flash_sim.h"
+
+#define FLASH_SIM_DATA_WIDTH    (2u) /* 32-bit data items */
+#define FLASH_SIM_ITEM_SIZE     (4u)
+
+/* Simulated time spent by each busy status poll */
+#define FLASH_SIM_POLL_NS       (1000u)
+
+static uint8_t flash_mem[FLASH_TOTAL_SIZE];
+static struct fwu_flash_sim_timing_t sim_timing;
+static struct fwu_flash_sim_stats_t sim_stats;
+static bool sim_async;
+static uint64_t sim_now_ns;
+static uint64_t sim_busy_until_ns;
+
+/* The programming started in the asynchronous mode, 0 sized if none */
+static uint32_t pending_addr;
+static const uint8_t *pending_src;
+static uint32_t pending_len;
+
+static ARM_FLASH_INFO flash_info = {
+    .sector_info  = NULL,
+    .sector_count = FLASH_TOTAL_SIZE / FLASH_AREA_IMAGE_SECTOR_SIZE,
+    .sector_size  = FLASH_AREA_IMAGE_SECTOR_SIZE,
+    .page_size    = FLASH_AREA_IMAGE_SECTOR_SIZE,
+    .program_unit = TFM_HAL_FLASH_PROGRAM_UNIT,
+    .erased_value = 0xFF,
+};
+
+static bool is_range_valid(uint32_t addr, uint32_t len)
+{
+    return (addr <= FLASH_TOTAL_SIZE) && (len <= FLASH_TOTAL_SIZE - addr);
+}
+
+/* Programming can only clear bits. */
+static void program(uint32_t addr, const uint8_t *src, uint32_t len)
+{
+    bool unerased = false;
+    uint32_t i;
+
+    for (i = 0; i < len; i++) {
+        if (flash_mem[addr + i] != flash_info.erased_value) {
+            unerased = true;
+        }
+        flash_mem[addr + i] &= src[i];
+    }
+    if (unerased) {
+        sim_stats.unerased_programs++;
+    }
+    sim_stats.programmed_bytes += len;
+}
+
+static void complete_pending(void)
+{
+    if (pending_len != 0) {
+        program(pending_addr, pending_src, pending_len);
+        pending_len = 0;
+    }
+}
+
+/* The driver only serves one operation at a time. */
+static void wait_ready(void)
+{
+    if (sim_now_ns < sim_busy_until_ns) {
+        sim_now_ns = sim_busy_until_ns;
+    }
+    complete_pending();
+}
+
+static ARM_DRIVER_VERSION flash_sim_get_version(void)
+{
+    ARM_DRIVER_VERSION version = { ARM_FLASH_API_VERSION, 0x0100 };
+
+    return version;
+}
+
+static ARM_FLASH_CAPABILITIES flash_sim_get_capabilities(void)
+{
+    ARM_FLASH_CAPABILITIES capabilities = {
+        .event_ready = 0,
+        .data_width = FLASH_SIM_DATA_WIDTH,
+        .erase_chip = 0,
+    };
+
+    return capabilities;
+}
+
+static int32_t flash_sim_initialize(ARM_Flash_SignalEvent_t cb_event)
+{
+    (void)cb_event;
+
+    return ARM_DRIVER_OK;
+}
+
+static int32_t flash_sim_uninitialize(void)
+{
+    return ARM_DRIVER_OK;
+}
+
+static int32_t flash_sim_power_control(ARM_POWER_STATE state)
+{
+    (void)state;
+
+    return ARM_DRIVER_OK;
+}
+
+static int32_t flash_sim_read_data(uint32_t addr, void *data, uint32_t cnt)
+{
+    uint32_t len = cnt * FLASH_SIM_ITEM_SIZE;
+
+    if ((addr % FLASH_SIM_ITEM_SIZE != 0) || !is_range_valid(addr, len)) {
+        return ARM_DRIVER_ERROR_PARAMETER;
+    }
+
+    wait_ready();
+    memcpy(data, &flash_mem[addr], len);
+    sim_now_ns += (uint64_t)len * sim_timing.read_byte_ns;
+    sim_stats.read_bytes += len;
+
+    return (int32_t)cnt;
+}
+
+static int32_t flash_sim_program_data(uint32_t addr, const void *data,
+                                      uint32_t cnt)
+{
+    uint32_t len = cnt * FLASH_SIM_ITEM_SIZE;
+
+    if ((addr % TFM_HAL_FLASH_PROGRAM_UNIT != 0) ||
+        (len % TFM_HAL_FLASH_PROGRAM_UNIT != 0) ||
+        !is_range_valid(addr, len)) {
+        return ARM_DRIVER_ERROR_PARAMETER;
+    }
+
+    wait_ready();
+
+    if (sim_async) {
+        pending_addr = addr;
+        pending_src = data;
+        pending_len = len;
+        sim_busy_until_ns = sim_now_ns +
+                            ((uint64_t)len * sim_timing.program_byte_ns);
+        sim_stats.async_programs++;
+        return 0;
+    }
+
+    program(addr, data, len);
+    sim_now_ns += (uint64_t)len * sim_timing.program_byte_ns;
+    return (int32_t)cnt;
+}
+
+static int32_t flash_sim_erase_sector(uint32_t addr)
+{
+    if ((addr % flash_info.sector_size != 0) ||
+        !is_range_valid(addr, flash_info.sector_size)) {
+        return ARM_DRIVER_ERROR_PARAMETER;
+    }
+
+    wait_ready();
+    memset(&flash_mem[addr], flash_info.erased_value, flash_info.sector_size);
+    sim_now_ns += sim_timing.erase_sector_ns;
+    sim_stats.erased_sectors++;
+
+    return ARM_DRIVER_OK;
+}
+
+static int32_t flash_sim_erase_chip(void)
+{
+    return ARM_DRIVER_ERROR_UNSUPPORTED;
+}
+
+static ARM_FLASH_STATUS flash_sim_get_status(void)
+{
+    ARM_FLASH_STATUS status = { 0 };
+
+    if (sim_now_ns < sim_busy_until_ns) {
+        sim_now_ns += FLASH_SIM_POLL_NS;
+        if (sim_now_ns > sim_busy_until_ns) {
+            sim_now_ns = sim_busy_until_ns;
+        }
+    }
+    if (sim_now_ns >= sim_busy_until_ns) {
+        complete_pending();
+    }
+    status.busy = (pending_len != 0) ? 1u : 0u;
+
+    return status;
+}
+
+static ARM_FLASH_INFO *flash_sim_get_info(void)
+{
+    return &flash_info;
+}
+
+ARM_DRIVER_FLASH FLASH_DEV_NAME = {
+    .GetVersion      = flash_sim_get_version,
+    .GetCapabilities = flash_sim_get_capabilities,
+    .Initialize      = flash_sim_initialize,
+    .Uninitialize    = flash_sim_uninitialize,
+    .PowerControl    = flash_sim_power_control,
+    .ReadData        = flash_sim_read_data,
+    .ProgramData     = flash_sim_program_data,
+    .EraseSector     = flash_sim_erase_sector,
+    .EraseChip       = flash_sim_erase_chip,
+    .GetStatus       = flash_sim_get_status,
+    .GetInfo         = flash_sim_get_info,
+};
+
+void fwu_flash_sim_reset(const struct fwu_flash_sim_timing_t *timing,
+                         bool async)
+{
+    memset(flash_mem, flash_info.erased_value, sizeof(flash_mem));
+    memset(&sim_stats, 0, sizeof(sim_stats));
+    sim_timing = *timing;
+    sim_async = async;
+    sim_now_ns = 0;
+    sim_busy_until_ns = 0;
+    pending_len = 0;
+}
+
+uint64_t fwu_flash_sim_now_ns(void)
+{
+    return (sim_now_ns < sim_busy_until_ns) ? sim_busy_until_ns : sim_now_ns;
+}
+
+void fwu_flash_sim_spend_ns(uint64_t ns)
+{
+    sim_now_ns += ns;
+}
+
+const struct fwu_flash_sim_timing_t *fwu_flash_sim_timing(void)
+{
+    return &sim_timing;
+}
+
+const struct fwu_flash_sim_stats_t *fwu_flash_sim_stats(void)
+{
+    return &sim_stats;
+}
+
+const uint8_t *fwu_flash_sim_data(uint32_t addr, size_t len)
+{
+    if (!is_range_valid(addr, (uint32_t)len)) {
+        return NULL;
+    }
+
+    return &flash_mem[addr];
+}
+
+bool fwu_flash_sim_load(uint32_t addr, const void *data, size_t len)
+{
+    if (!is_range_valid(addr, (uint32_t)len)) {
+        return false;
+    }
+
+    memcpy(&flash_mem[addr], data, len);
+
+    return true;
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __FWU_FLASH_SIM_H__
+#define __FWU_FLASH_SIM_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Driver_Flash.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Costs of the operations of the simulated flash and of the partition,
+ *        in nanoseconds of the simulated time.
+ */
+struct fwu_flash_sim_timing_t {
+    uint32_t program_byte_ns;   /* Programming, per byte */
+    uint32_t erase_sector_ns;   /* Erasing, per sector */
+    uint32_t read_byte_ns;      /* Reading, per byte */
+    uint32_t copy_call_ns;      /* psa_read() from the client, per call */
+    uint32_t copy_byte_ns;      /* psa_read() from the client, per byte */
+    uint32_t hash_byte_ns;      /* SHA-256, per byte */
+};
+
+/**
+ * \brief Counters of the simulated flash.
+ */
+struct fwu_flash_sim_stats_t {
+    uint64_t programmed_bytes;
+    uint64_t read_bytes;
+    uint32_t erased_sectors;
+    uint32_t async_programs;    /* Programs which returned before completion */
+    uint32_t unerased_programs; /* Programs over bytes which were not erased */
+};
+
+/**
+ * \brief Erases the whole simulated flash and resets the simulated time and
+ *        the counters.
+ *
+ * \param[in] timing  Costs of the operations
+ * \param[in] async   The driver starts the programming of the data and
+ *                    returns, as allowed by the CMSIS interface, instead of
+ *                    returning once the data is programmed. The data is
+ *                    taken from the buffer of the caller once the
+ *                    programming completes.
+ */
+void fwu_flash_sim_reset(const struct fwu_flash_sim_timing_t *timing,
+                         bool async);
+
+/**
+ * \brief Gets the simulated time in nanoseconds at which the operations
+ *        requested so far are done. The partition and the flash work in
+ *        parallel, the driver only waits for the flash to be ready when an
+ *        operation is requested while it is busy.
+ */
+uint64_t fwu_flash_sim_now_ns(void);
+
+/**
+ * \brief Spends the simulated time of some work done by the partition.
+ */
+void fwu_flash_sim_spend_ns(uint64_t ns);
+
+/**
+ * \brief Gets the timing passed to \ref fwu_flash_sim_reset.
+ */
+const struct fwu_flash_sim_timing_t *fwu_flash_sim_timing(void);
+
+/**
+ * \brief Gets the counters of the simulated flash.
+ */
+const struct fwu_flash_sim_stats_t *fwu_flash_sim_stats(void);
+
+/**
+ * \brief Gets the content of the simulated flash at an address of the
+ *        driver, or NULL if the range is not in the flash. A programming
+ *        which has not completed is not in the content.
+ */
+const uint8_t *fwu_flash_sim_data(uint32_t addr, size_t len);
+
+/**
+ * \brief Sets the content of the simulated flash at an address of the driver,
+ *        as if it had been programmed before, without spending time.
+ *
+ * \return false if the range is not in the flash
+ */
+bool fwu_flash_sim_load(uint32_t addr, const void *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FWU_FLASH_SIM_H__ */
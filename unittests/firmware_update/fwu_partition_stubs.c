@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Stubs of the SPM, of the platform and of the Crypto service used by the
+ * Firmware Update partition. The hashes are computed with Mbed TLS, and
+ * spend the simulated time of the hash cost of the flash simulation.
+ */
+
+#include <string.h>
+
+#include "fwu_flash_sim.h"
+#include "fwu_partition_stubs.h"
+#include "mbedtls/sha256.h"
+#include "psa/crypto.h"
+#include "service_api.h"
+#include "tfm_api.h"
+#include "tfm_boot_status.h"
+#include "tfm_platform_api.h"
+
+/* Number of hash operations which can be active at the same time */
+#define STUB_OPERATION_NUM      (4u)
+
+/* The layout of struct image_version of MCUboot */
+struct stub_image_version {
+    uint8_t iv_major;
+    uint8_t iv_minor;
+    uint16_t iv_revision;
+    uint32_t iv_build_num;
+};
+
+static struct stub_image_version active_version[FWU_COMPONENT_NUMBER];
+static uint32_t reset_calls;
+
+static struct {
+    bool in_use;
+    mbedtls_sha256_context ctx;
+} hash_op[STUB_OPERATION_NUM];
+
+void fwu_stub_set_active_version(psa_fwu_component_t component,
+                                 uint8_t major, uint8_t minor,
+                                 uint16_t revision)
+{
+    active_version[component].iv_major = major;
+    active_version[component].iv_minor = minor;
+    active_version[component].iv_revision = revision;
+    active_version[component].iv_build_num = 0;
+}
+
+uint32_t fwu_stub_reset_calls(void)
+{
+    return reset_calls;
+}
+
+/*------------------------------ SPM and platform ----------------------------*/
+
+int32_t tfm_core_get_boot_data(uint8_t major_type,
+                               struct tfm_boot_data *boot_data,
+                               uint32_t len)
+{
+    struct shared_data_tlv_entry entry;
+    uint8_t *ptr = boot_data->data;
+    uint32_t size = SHARED_DATA_HEADER_SIZE +
+                    (FWU_COMPONENT_NUMBER *
+                     (SHARED_DATA_ENTRY_HEADER_SIZE +
+                      sizeof(active_version[0])));
+    psa_fwu_component_t component;
+
+    if ((major_type != TLV_MAJOR_FWU) || (len < size)) {
+        return (int32_t)TFM_ERROR_INVALID_PARAMETER;
+    }
+
+    boot_data->header.tlv_magic = SHARED_DATA_TLV_INFO_MAGIC;
+    boot_data->header.tlv_tot_len = (uint16_t)size;
+
+    for (component = 0; component < FWU_COMPONENT_NUMBER; component++) {
+        entry.tlv_type = SET_TLV_TYPE(TLV_MAJOR_FWU,
+                                      SET_FWU_MINOR(component, SW_VERSION));
+        entry.tlv_len = sizeof(active_version[component]);
+        memcpy(ptr, &entry, SHARED_DATA_ENTRY_HEADER_SIZE);
+        ptr += SHARED_DATA_ENTRY_HEADER_SIZE;
+        memcpy(ptr, &active_version[component], entry.tlv_len);
+        ptr += entry.tlv_len;
+    }
+
+    return (int32_t)TFM_SUCCESS;
+}
+
+enum tfm_platform_err_t tfm_platform_system_reset(void)
+{
+    reset_calls++;
+
+    return TFM_PLATFORM_ERR_SUCCESS;
+}
+
+/*------------------------------- Crypto service -----------------------------*/
+
+static mbedtls_sha256_context *stub_op_get(uint32_t handle)
+{
+    if ((handle == 0) || (handle > STUB_OPERATION_NUM) ||
+        !hash_op[handle - 1].in_use) {
+        return NULL;
+    }
+
+    return &hash_op[handle - 1].ctx;
+}
+
+psa_status_t psa_hash_setup(psa_hash_operation_t *operation,
+                            psa_algorithm_t alg)
+{
+    uint32_t i;
+
+    if (alg != PSA_ALG_SHA_256) {
+        return PSA_ERROR_NOT_SUPPORTED;
+    }
+    if (operation->handle != 0) {
+        return PSA_ERROR_BAD_STATE;
+    }
+
+    for (i = 0; i < STUB_OPERATION_NUM; i++) {
+        if (!hash_op[i].in_use) {
+            hash_op[i].in_use = true;
+            mbedtls_sha256_init(&hash_op[i].ctx);
+            (void)mbedtls_sha256_starts(&hash_op[i].ctx, 0);
+            operation->handle = i + 1;
+            return PSA_SUCCESS;
+        }
+    }
+
+    return PSA_ERROR_INSUFFICIENT_MEMORY;
+}
+
+psa_status_t psa_hash_update(psa_hash_operation_t *operation,
+                             const uint8_t *input,
+                             size_t input_length)
+{
+    mbedtls_sha256_context *ctx = stub_op_get(operation->handle);
+
+    if (ctx == NULL) {
+        return PSA_ERROR_BAD_STATE;
+    }
+
+    fwu_flash_sim_spend_ns((uint64_t)input_length *
+                           fwu_flash_sim_timing()->hash_byte_ns);
+
+    return (mbedtls_sha256_update(ctx, input, input_length) == 0) ?
+           PSA_SUCCESS : PSA_ERROR_GENERIC_ERROR;
+}
+
+psa_status_t psa_hash_finish(psa_hash_operation_t *operation,
+                             uint8_t *hash,
+                             size_t hash_size,
+                             size_t *hash_length)
+{
+    mbedtls_sha256_context *ctx = stub_op_get(operation->handle);
+    psa_status_t status = PSA_SUCCESS;
+
+    if (ctx == NULL) {
+        return PSA_ERROR_BAD_STATE;
+    }
+
+    if (hash_size < PSA_HASH_LENGTH(PSA_ALG_SHA_256)) {
+        status = PSA_ERROR_BUFFER_TOO_SMALL;
+    } else if (mbedtls_sha256_finish(ctx, hash) != 0) {
+        status = PSA_ERROR_GENERIC_ERROR;
+    } else {
+        *hash_length = PSA_HASH_LENGTH(PSA_ALG_SHA_256);
+    }
+
+    (void)psa_hash_abort(operation);
+    return status;
+}
+
+psa_status_t psa_hash_abort(psa_hash_operation_t *operation)
+{
+    mbedtls_sha256_context *ctx = stub_op_get(operation->handle);
+
+    if (ctx != NULL) {
+        mbedtls_sha256_free(ctx);
+        hash_op[operation->handle - 1].in_use = false;
+    }
+    operation->handle = 0;
+
+    return PSA_SUCCESS;
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __FWU_PARTITION_STUBS_H__
+#define __FWU_PARTITION_STUBS_H__
+
+#include <stdint.h>
+
+#include "psa/update.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Sets the version of the active image of a component, as shared by
+ *        the bootloader. It is read by tfm_fwu_entry().
+ */
+void fwu_stub_set_active_version(psa_fwu_component_t component,
+                                 uint8_t major, uint8_t minor,
+                                 uint16_t revision);
+
+/**
+ * \brief Gets the number of system resets requested by the partition.
+ */
+uint32_t fwu_stub_reset_calls(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FWU_PARTITION_STUBS_H__ */
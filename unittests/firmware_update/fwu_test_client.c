@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * The client side of the calls to the Firmware Update partition, made
+ * through tfm_firmware_update_service_sfn() with faked messages.
+ */
+
+#include <string.h>
+
+#include "bootutil/image.h"
+#include "mbedtls/sha256.h"
+#include "psa/service.h"
+
+#include "fwu_flash_sim.h"
+#include "fwu_test_client.h"
+#include "psa_msg_fake.h"
+#include "psa_manifest/tfm_firmware_update.h"
+#include "tfm_unittest.h"
+
+#define TEST_HDR_SIZE          (0x400u)
+
+/* The psa_read() copies from the client are counted in the simulated time. */
+static void spend_copy_time(size_t num_bytes)
+{
+    const struct fwu_flash_sim_timing_t *timing = fwu_flash_sim_timing();
+
+    fwu_flash_sim_spend_ns(timing->copy_call_ns +
+                           ((uint64_t)num_bytes * timing->copy_byte_ns));
+}
+
+psa_status_t fwu_call(int32_t client_id, int32_t type,
+                      const psa_invec *in_vec, size_t in_len,
+                      const psa_outvec *out_vec, size_t out_len)
+{
+    struct psa_msg_fake_t fake = {0};
+    psa_msg_t msg;
+    size_t i;
+
+    for (i = 0; i < in_len; i++) {
+        fake.in_vec[i] = in_vec[i];
+    }
+    for (i = 0; i < out_len; i++) {
+        fake.out_vec[i] = out_vec[i];
+    }
+    fake.read_hook = spend_copy_time;
+
+    psa_msg_fake_init(&msg, &fake, client_id);
+    msg.type = type;
+
+    return tfm_firmware_update_service_sfn(&msg);
+}
+
+psa_status_t fwu_start(psa_fwu_component_t component)
+{
+    psa_invec in_vec[] = {
+        { .base = &component, .len = sizeof(component) },
+        { .base = NULL, .len = 0 },
+    };
+
+    return fwu_call(FWU_TEST_NS_CLIENT_ID, TFM_FWU_START, in_vec, 2, NULL, 0);
+}
+
+psa_status_t fwu_write(psa_fwu_component_t component, size_t image_offset,
+                       const void *block, size_t block_size)
+{
+    psa_invec in_vec[] = {
+        { .base = &component, .len = sizeof(component) },
+        { .base = &image_offset, .len = sizeof(image_offset) },
+        { .base = block, .len = block_size },
+    };
+
+    return fwu_call(FWU_TEST_NS_CLIENT_ID, TFM_FWU_WRITE, in_vec, 3, NULL, 0);
+}
+
+psa_status_t fwu_component_call(int32_t type, psa_fwu_component_t component)
+{
+    psa_invec in_vec[] = {
+        { .base = &component, .len = sizeof(component) },
+    };
+
+    return fwu_call(FWU_TEST_NS_CLIENT_ID, type, in_vec, 1, NULL, 0);
+}
+
+psa_status_t fwu_query_as(int32_t client_id, psa_fwu_component_t component,
+                          psa_fwu_component_info_t *info)
+{
+    psa_invec in_vec[] = {
+        { .base = &component, .len = sizeof(component) },
+    };
+    psa_outvec out_vec[] = {
+        { .base = info, .len = sizeof(*info) },
+    };
+
+    return fwu_call(client_id, TFM_FWU_QUERY, in_vec, 1, out_vec, 1);
+}
+
+psa_status_t fwu_query(psa_fwu_component_t component,
+                       psa_fwu_component_info_t *info)
+{
+    return fwu_query_as(FWU_TEST_NS_CLIENT_ID, component, info);
+}
+
+psa_status_t fwu_install(void)
+{
+    return fwu_call(FWU_TEST_NS_CLIENT_ID, TFM_FWU_INSTALL, NULL, 0, NULL, 0);
+}
+
+psa_status_t fwu_reject(psa_status_t error)
+{
+    psa_invec in_vec[] = {
+        { .base = &error, .len = sizeof(error) },
+    };
+
+    return fwu_call(FWU_TEST_NS_CLIENT_ID, TFM_FWU_REJECT, in_vec, 1, NULL, 0);
+}
+
+psa_status_t fwu_prepare_staging(psa_fwu_component_t component, size_t size)
+{
+    psa_invec in_vec[] = {
+        { .base = &component, .len = sizeof(component) },
+        { .base = &size, .len = sizeof(size) },
+    };
+
+    return fwu_call(FWU_TEST_NS_CLIENT_ID, TFM_FWU_PREPARE_STAGING, in_vec, 2,
+                    NULL, 0);
+}
+
+psa_status_t fwu_write_image(psa_fwu_component_t component,
+                             const uint8_t *data, size_t size)
+{
+    psa_status_t status = PSA_SUCCESS;
+    size_t offset, block_size;
+
+    for (offset = 0; (offset < size) && (status == PSA_SUCCESS);
+         offset += block_size) {
+        block_size = size - offset;
+        if (block_size > PSA_FWU_MAX_WRITE_SIZE) {
+            block_size = PSA_FWU_MAX_WRITE_SIZE;
+        }
+        status = fwu_write(component, offset, data + offset, block_size);
+    }
+
+    return status;
+}
+
+int fwu_reset_component(psa_fwu_component_t component)
+{
+    psa_fwu_component_info_t info;
+
+    TEST_ASSERT(fwu_query(component, &info) == PSA_SUCCESS, "Query failed");
+    if (info.state == PSA_FWU_STAGED) {
+        TEST_ASSERT(fwu_reject(PSA_ERROR_GENERIC_ERROR) == PSA_SUCCESS,
+                    "Reject failed");
+        info.state = PSA_FWU_FAILED;
+    }
+    if ((info.state == PSA_FWU_WRITING) || (info.state == PSA_FWU_CANDIDATE)) {
+        TEST_ASSERT(fwu_component_call(TFM_FWU_CANCEL, component) ==
+                    PSA_SUCCESS, "Cancel failed");
+    }
+    if (info.state != PSA_FWU_READY) {
+        TEST_ASSERT(fwu_component_call(TFM_FWU_CLEAN, component) ==
+                    PSA_SUCCESS, "Clean failed");
+    }
+
+    return 0;
+}
+
+void fwu_build_image(uint8_t *buf, size_t size, uint32_t seed, uint8_t major)
+{
+    fwu_build_image_deps(buf, size, seed, major, NULL, 0);
+}
+
+void fwu_build_image_deps(uint8_t *buf, size_t size, uint32_t seed,
+                          uint8_t major, const struct image_dependency *deps,
+                          size_t dep_num)
+{
+    struct image_header hdr = {0};
+    struct image_tlv_info info;
+    struct image_tlv tlv;
+    size_t prot_size = 0;
+    size_t tlv_size = sizeof(info) + sizeof(tlv) + 32;
+    size_t i, dep;
+
+    /* The dependencies are in the protected TLV area, covered by the hash. */
+    if (dep_num != 0) {
+        prot_size = sizeof(info) + (dep_num * (sizeof(tlv) + sizeof(*deps)));
+    }
+
+    hdr.ih_magic = IMAGE_MAGIC;
+    hdr.ih_hdr_size = TEST_HDR_SIZE;
+    hdr.ih_img_size = (uint32_t)(size - TEST_HDR_SIZE - prot_size - tlv_size);
+    hdr.ih_protect_tlv_size = (uint16_t)prot_size;
+    hdr.ih_ver.iv_major = major;
+
+    memset(buf, 0, TEST_HDR_SIZE);
+    memcpy(buf, &hdr, sizeof(hdr));
+    for (i = TEST_HDR_SIZE; i < TEST_HDR_SIZE + hdr.ih_img_size; i++) {
+        seed = (seed * 1103515245u) + 12345u;
+        buf[i] = (uint8_t)(seed >> 16);
+    }
+
+    if (dep_num != 0) {
+        info.it_magic = IMAGE_TLV_PROT_INFO_MAGIC;
+        info.it_tlv_tot = (uint16_t)prot_size;
+        memcpy(&buf[i], &info, sizeof(info));
+        i += sizeof(info);
+        for (dep = 0; dep < dep_num; dep++) {
+            tlv.it_type = IMAGE_TLV_DEPENDENCY;
+            tlv.it_len = sizeof(*deps);
+            memcpy(&buf[i], &tlv, sizeof(tlv));
+            i += sizeof(tlv);
+            memcpy(&buf[i], &deps[dep], sizeof(*deps));
+            i += sizeof(*deps);
+        }
+    }
+
+    info.it_magic = IMAGE_TLV_INFO_MAGIC;
+    info.it_tlv_tot = (uint16_t)tlv_size;
+    memcpy(&buf[i], &info, sizeof(info));
+    (void)mbedtls_sha256(buf, i, &buf[i + sizeof(info) + sizeof(tlv)], 0);
+    i += sizeof(info);
+    tlv.it_type = IMAGE_TLV_SHA256;
+    tlv.it_len = 32;
+    memcpy(&buf[i], &tlv, sizeof(tlv));
+}
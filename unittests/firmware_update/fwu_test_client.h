@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __FWU_TEST_CLIENT_H__
+#define __FWU_TEST_CLIENT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bootutil/image.h"
+#include "psa/client.h"
+#include "psa/update.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The client IDs of the calls to the partition */
+#define FWU_TEST_NS_CLIENT_ID   (-1)
+#define FWU_TEST_S_CLIENT_ID    (1)
+
+/**
+ * \brief Calls tfm_firmware_update_service_sfn() with a message of the given
+ *        type from the given client. The psa_read() copies from the client
+ *        spend the simulated time of the flash simulation.
+ */
+psa_status_t fwu_call(int32_t client_id, int32_t type,
+                      const psa_invec *in_vec, size_t in_len,
+                      const psa_outvec *out_vec, size_t out_len);
+
+/**
+ * \brief The calls of the FWU API, from the Non-secure client.
+ */
+psa_status_t fwu_start(psa_fwu_component_t component);
+psa_status_t fwu_write(psa_fwu_component_t component, size_t image_offset,
+                       const void *block, size_t block_size);
+psa_status_t fwu_component_call(int32_t type, psa_fwu_component_t component);
+psa_status_t fwu_query(psa_fwu_component_t component,
+                       psa_fwu_component_info_t *info);
+
+psa_status_t fwu_install(void);
+psa_status_t fwu_reject(psa_status_t error);
+
+/**
+ * \brief Erases the staging area of a component ahead of its update, up to the
+ *        given size after the part already erased, or to its end if 0.
+ */
+psa_status_t fwu_prepare_staging(psa_fwu_component_t component, size_t size);
+
+/**
+ * \brief Queries a component from the given client.
+ */
+psa_status_t fwu_query_as(int32_t client_id, psa_fwu_component_t component,
+                          psa_fwu_component_info_t *info);
+
+/**
+ * \brief Writes data in blocks of the maximum size of psa_fwu_write().
+ */
+psa_status_t fwu_write_image(psa_fwu_component_t component,
+                             const uint8_t *data, size_t size);
+
+/**
+ * \brief Returns the component to READY, erasing its staging area. A STAGED
+ *        component is rejected first.
+ *
+ * \return 0 on success, 1 if a call failed
+ */
+int fwu_reset_component(psa_fwu_component_t component);
+
+/**
+ * \brief Builds an MCUboot image of the given total size: the header, a
+ *        pseudo-random payload and the TLV area with the hash of the image.
+ */
+void fwu_build_image(uint8_t *buf, size_t size, uint32_t seed, uint8_t major);
+
+/**
+ * \brief Builds an MCUboot image as fwu_build_image(), with the given
+ *        dependencies on the versions of other images.
+ */
+void fwu_build_image_deps(uint8_t *buf, size_t size, uint32_t seed,
+                          uint8_t major, const struct image_dependency *deps,
+                          size_t dep_num);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FWU_TEST_CLIENT_H__ */
@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Stands in for the CMSIS device header of the platform on the build machine,
+ * which has no core peripherals.
+ */
+
+#ifndef __CMSIS_H__
+#define __CMSIS_H__
+
+#include "cmsis_compiler.h"
+
+#endif /* __CMSIS_H__ */
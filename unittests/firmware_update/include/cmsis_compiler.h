@@ -0,0 +1,17 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/* Stands in for the CMSIS compiler header on the build machine */
+
+#ifndef __CMSIS_COMPILER_H
+#define __CMSIS_COMPILER_H
+
+#ifndef __WEAK
+#define __WEAK __attribute__((weak))
+#endif
+
+#endif /* __CMSIS_COMPILER_H */
@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/* Stands in for the header generated from the FWU partition manifest */
+
+#ifndef __PSA_MANIFEST_TFM_FIRMWARE_UPDATE_H__
+#define __PSA_MANIFEST_TFM_FIRMWARE_UPDATE_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TFM_SP_FWU_MODEL_IPC                                    0
+#define TFM_SP_FWU_MODEL_SFN                                    1
+
+psa_status_t tfm_firmware_update_service_sfn(const psa_msg_t* msg);
+
+psa_status_t tfm_fwu_entry(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PSA_MANIFEST_TFM_FIRMWARE_UPDATE_H__ */
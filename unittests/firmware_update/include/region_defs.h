@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/* Stands in for the memory regions of the platform */
+
+#ifndef __REGION_DEFS_H__
+#define __REGION_DEFS_H__
+
+#include "flash_layout.h"
+
+/* The boot data is read through the stubbed tfm_core_get_boot_data() */
+#define BOOT_TFM_SHARED_DATA_BASE  (0x0)
+#define BOOT_TFM_SHARED_DATA_SIZE  (0x400)
+
+#endif /* __REGION_DEFS_H__ */
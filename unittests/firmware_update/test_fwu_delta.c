@@ -0,0 +1,561 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Writes encoded image streams through tfm_firmware_update_service_sfn(), so
+ * that they are decoded by tfm_fwu_delta.c into the simulated flash. The
+ * streams are made by an encoder following encode_image_stream.py, from
+ * sample images: a compressible one, and a new version of an active image.
+ * The tests check the staged images, the disclosure of their digest and the
+ * rejection of malformed streams. The benchmark reports the compression
+ * ratio and the decode throughput.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "config_fwu.h"
+#include "flash_layout.h"
+#include "mbedtls/sha256.h"
+#include "psa/service.h"
+#include "psa/update.h"
+
+#include "fwu_flash_sim.h"
+#include "fwu_partition_stubs.h"
+#include "fwu_test_client.h"
+#include "psa_manifest/tfm_firmware_update.h"
+#include "tfm_unittest.h"
+
+#define TEST_IMAGE_SIZE        (256u * 1024u)
+#define TEST_STREAM_SIZE       (2u * TEST_IMAGE_SIZE)
+#define TEST_COMPONENT         (0u)
+#define TEST_ACTIVE_OFFSET     FLASH_AREA_0_OFFSET
+#define TEST_STAGING_OFFSET    FLASH_AREA_2_OFFSET
+
+/* The encoding of the stream, see tfm_fwu_delta.h */
+#define OP_LITERAL             0x00
+#define OP_COPY_BASE           0x01
+#define OP_COPY_OUTPUT         0x02
+
+/* The matches of the encoder, as in encode_image_stream.py */
+#define ENC_MIN_MATCH          12u
+#define ENC_KEY_SIZE           4u
+#define ENC_HASH_BITS          16u
+#define ENC_HASH_SIZE          (1u << ENC_HASH_BITS)
+
+/* Costs of the simulated flash and of the partition in the update */
+static const struct fwu_flash_sim_timing_t flash_timing = {
+    /* Embedded non-volatile memory programmed by words */
+    .program_byte_ns = 100,
+    .erase_sector_ns = 2000000,
+    .read_byte_ns = 10,
+    .copy_call_ns = 2000,
+    .copy_byte_ns = 10,
+    .hash_byte_ns = 30,
+};
+
+static uint8_t active[TEST_IMAGE_SIZE];
+static uint8_t compressible[TEST_IMAGE_SIZE];
+static uint8_t updated[TEST_IMAGE_SIZE];
+static uint8_t stream[TEST_STREAM_SIZE];
+
+/* The last position + 1 of each hashed key, 0 if none */
+static uint32_t base_head[ENC_HASH_SIZE];
+static uint32_t out_head[ENC_HASH_SIZE];
+
+/*------------------------------- Encoder ------------------------------------*/
+
+static uint32_t enc_hash(const uint8_t *key)
+{
+    uint32_t value;
+
+    memcpy(&value, key, sizeof(value));
+
+    return (value * 2654435761u) >> (32u - ENC_HASH_BITS);
+}
+
+static size_t enc_arg(uint8_t *out, uint32_t value)
+{
+    size_t len = 0;
+
+    while (value >= 0x80u) {
+        out[len++] = (uint8_t)(value | 0x80u);
+        value >>= 7;
+    }
+    out[len++] = (uint8_t)value;
+
+    return len;
+}
+
+static size_t enc_match(const uint8_t *src, size_t src_size,
+                        const uint8_t *image, size_t size)
+{
+    size_t len = 0;
+    size_t limit = (src_size < size) ? src_size : size;
+
+    while ((len < limit) && (src[len] == image[len])) {
+        len++;
+    }
+
+    return len;
+}
+
+static size_t enc_literal(uint8_t *out, const uint8_t *data, size_t len)
+{
+    size_t pos = 0;
+
+    if (len > 0) {
+        out[pos++] = OP_LITERAL;
+        pos += enc_arg(&out[pos], (uint32_t)len);
+        memcpy(&out[pos], data, len);
+        pos += len;
+    }
+
+    return pos;
+}
+
+/*
+ * Encodes the image greedily, with the longest of the matches in the base and
+ * in the output found by the last position of their key. The output is the
+ * source of the copies, so they may overlap the bytes being output.
+ */
+static size_t encode_stream(const uint8_t *image, size_t size,
+                            const uint8_t *base, size_t base_size)
+{
+    size_t out = 0, pos = 0, literal_start = 0;
+    size_t base_len, out_len, len, i;
+    uint32_t base_pos = 0, out_pos = 0, key;
+
+    memset(base_head, 0, sizeof(base_head));
+    memset(out_head, 0, sizeof(out_head));
+    for (i = 0; (base != NULL) && (i + ENC_KEY_SIZE <= base_size); i++) {
+        base_head[enc_hash(&base[i])] = (uint32_t)i + 1u;
+    }
+
+    memcpy(stream, "TFMD", 4);
+    out = 4;
+
+    while (pos < size) {
+        base_len = 0;
+        out_len = 0;
+        if (pos + ENC_KEY_SIZE <= size) {
+            key = enc_hash(&image[pos]);
+            if (base_head[key] != 0) {
+                base_pos = base_head[key] - 1u;
+                base_len = enc_match(&base[base_pos], base_size - base_pos,
+                                     &image[pos], size - pos);
+            }
+            if (out_head[key] != 0) {
+                out_pos = out_head[key] - 1u;
+                out_len = enc_match(&image[out_pos], size - out_pos,
+                                    &image[pos], size - pos);
+            }
+        }
+        len = (base_len >= out_len) ? base_len : out_len;
+
+        if (len < ENC_MIN_MATCH) {
+            if (pos + ENC_KEY_SIZE <= size) {
+                out_head[enc_hash(&image[pos])] = (uint32_t)pos + 1u;
+            }
+            pos++;
+            continue;
+        }
+
+        out += enc_literal(&stream[out], &image[literal_start],
+                           pos - literal_start);
+        if (base_len >= out_len) {
+            stream[out++] = OP_COPY_BASE;
+            out += enc_arg(&stream[out], base_pos);
+        } else {
+            stream[out++] = OP_COPY_OUTPUT;
+            out += enc_arg(&stream[out], (uint32_t)(pos - out_pos));
+        }
+        out += enc_arg(&stream[out], (uint32_t)len);
+
+        for (i = pos; (i < pos + len) && (i + ENC_KEY_SIZE <= size); i++) {
+            out_head[enc_hash(&image[i])] = (uint32_t)i + 1u;
+        }
+        pos += len;
+        literal_start = pos;
+    }
+    out += enc_literal(&stream[out], &image[literal_start],
+                       size - literal_start);
+
+    return out;
+}
+
+/*---------------------------- Sample images ---------------------------------*/
+
+static uint32_t next_random(uint32_t *seed)
+{
+    *seed = (*seed * 1103515245u) + 12345u;
+
+    return *seed >> 8;
+}
+
+/*
+ * Builds an image made of the blocks of a small vocabulary, as the recurring
+ * instruction sequences of a code, each with one of its words changed, as
+ * for the addresses it refers to. The end of each 4 KB is zero-filled.
+ */
+static void build_compressible(uint8_t *buf, size_t size, uint32_t seed)
+{
+    static uint8_t blocks[64][64];
+    size_t len, i, j;
+    uint32_t r;
+
+    for (i = 0; i < 64; i++) {
+        for (j = 0; j < sizeof(blocks[i]); j++) {
+            blocks[i][j] = (uint8_t)next_random(&seed);
+        }
+    }
+
+    memset(buf, 0, size);
+    for (i = 0; i < size; i += len) {
+        if ((i % 4096u) >= 3584u) {
+            len = 4096u - (i % 4096u);
+            continue;
+        }
+
+        r = next_random(&seed);
+        len = 16u + (((r >> 6) % 13u) * 4u);
+        if (len > 3584u - (i % 4096u)) {
+            len = 3584u - (i % 4096u);
+        }
+        memcpy(&buf[i], blocks[r % 64u], len);
+        buf[i + (((r >> 12) % (len / 4u)) * 4u)] = (uint8_t)(r >> 20);
+    }
+}
+
+/*
+ * Builds a new version of the active image: a word patched every 8 KB, as
+ * for changed addresses, bytes inserted in the middle and a rewritten region.
+ */
+static void build_updated(uint8_t *buf, const uint8_t *base, size_t size,
+                          uint32_t seed)
+{
+    const size_t insert_at = size / 3u, insert_len = 300u;
+    const size_t rewrite_at = (size * 3u) / 4u, rewrite_len = 2048u;
+    size_t i;
+
+    memcpy(buf, base, insert_at);
+    for (i = insert_at; i < insert_at + insert_len; i++) {
+        buf[i] = (uint8_t)next_random(&seed);
+    }
+    memcpy(&buf[insert_at + insert_len], &base[insert_at],
+           size - insert_at - insert_len);
+
+    for (i = 0; i < size; i += 8192u) {
+        buf[i + 4] ^= 0x5Au;
+        buf[i + 5] += 1u;
+    }
+    for (i = rewrite_at; i < rewrite_at + rewrite_len; i++) {
+        buf[i] = (uint8_t)next_random(&seed);
+    }
+}
+
+/*------------------------------- Helpers ------------------------------------*/
+
+/* Sets the flash with the active image in the primary slot. */
+static void reset_flash(void)
+{
+    fwu_flash_sim_reset(&flash_timing, false);
+    (void)fwu_flash_sim_load(TEST_ACTIVE_OFFSET, active, sizeof(active));
+}
+
+/* Writes a stream in blocks of the given size, up to the maximum one. */
+static psa_status_t write_stream(const uint8_t *data, size_t size,
+                                 size_t max_block_size)
+{
+    psa_status_t status = PSA_SUCCESS;
+    size_t offset, block_size;
+
+    if (max_block_size > PSA_FWU_MAX_WRITE_SIZE) {
+        max_block_size = PSA_FWU_MAX_WRITE_SIZE;
+    }
+
+    for (offset = 0; (offset < size) && (status == PSA_SUCCESS);
+         offset += block_size) {
+        block_size = size - offset;
+        if (block_size > max_block_size) {
+            block_size = max_block_size;
+        }
+        status = fwu_write(TEST_COMPONENT, offset, data + offset, block_size);
+    }
+
+    return status;
+}
+
+/* Writes and finishes the encoded stream of an image, and checks the image. */
+static int update_with_stream(const uint8_t *image, size_t stream_size,
+                              size_t max_block_size)
+{
+    TEST_ASSERT(fwu_start(TEST_COMPONENT) == PSA_SUCCESS, "Start failed");
+    TEST_ASSERT(write_stream(stream, stream_size, max_block_size) ==
+                PSA_SUCCESS, "Write failed");
+    TEST_ASSERT(fwu_component_call(TFM_FWU_FINISH, TEST_COMPONENT) ==
+                PSA_SUCCESS, "Finish failed");
+
+    TEST_ASSERT(memcmp(fwu_flash_sim_data(TEST_STAGING_OFFSET,
+                                          TEST_IMAGE_SIZE),
+                       image, TEST_IMAGE_SIZE) == 0,
+                "Staged image differs from the encoded one");
+
+    return 0;
+}
+
+/* Checks the digest of the candidate reported to a client. */
+static int check_digest(int32_t client_id, const uint8_t *image,
+                        bool disclosed)
+{
+    psa_fwu_component_info_t info;
+    uint8_t digest[32];
+
+    TEST_ASSERT(fwu_query_as(client_id, TEST_COMPONENT, &info) ==
+                PSA_SUCCESS, "Query failed");
+    TEST_ASSERT(info.state == PSA_FWU_CANDIDATE, "Not a candidate");
+
+    if (disclosed) {
+        (void)mbedtls_sha256(image, TEST_IMAGE_SIZE, digest, 0);
+    } else {
+        memset(digest, 0, sizeof(digest));
+    }
+    TEST_ASSERT(memcmp(info.impl.candidate_digest, digest,
+                       sizeof(digest)) == 0,
+                "Wrong candidate digest");
+
+    return 0;
+}
+
+/*-------------------------------- Tests -------------------------------------*/
+
+static int test_compressed_stream(void)
+{
+    size_t stream_size = encode_stream(compressible, TEST_IMAGE_SIZE, NULL, 0);
+
+    reset_flash();
+    TEST_ASSERT(update_with_stream(compressible, stream_size,
+                                   PSA_FWU_MAX_WRITE_SIZE) == 0,
+                "Update failed");
+
+    /* Without copies of the active image, the digest is disclosed */
+    TEST_ASSERT(check_digest(FWU_TEST_NS_CLIENT_ID, compressible, true) == 0,
+                "Digest check failed");
+    TEST_ASSERT(fwu_reset_component(TEST_COMPONENT) == 0, "Reset failed");
+
+    return 0;
+}
+
+static int test_delta_stream(void)
+{
+    size_t stream_size = encode_stream(updated, TEST_IMAGE_SIZE,
+                                       active, sizeof(active));
+
+    /* A Non-secure client can write a diff against the active image */
+    reset_flash();
+    TEST_ASSERT(update_with_stream(updated, stream_size,
+                                   PSA_FWU_MAX_WRITE_SIZE) == 0,
+                "Update failed");
+
+    /* Only Secure clients get the digest of the image */
+    TEST_ASSERT(check_digest(FWU_TEST_NS_CLIENT_ID, updated, false) == 0,
+                "Digest check failed");
+    TEST_ASSERT(check_digest(FWU_TEST_S_CLIENT_ID, updated, true) == 0,
+                "Digest check failed");
+    TEST_ASSERT(fwu_reset_component(TEST_COMPONENT) == 0, "Reset failed");
+
+    return 0;
+}
+
+static int test_stream_block_sizes(void)
+{
+    static const size_t block_sizes[] = { 5, 7, 333 };
+    size_t stream_size = encode_stream(updated, TEST_IMAGE_SIZE,
+                                       active, sizeof(active));
+    size_t i;
+
+    /* The commands and their arguments are split across the blocks. The
+     * first block holds the magic number.
+     */
+    for (i = 0; i < sizeof(block_sizes) / sizeof(block_sizes[0]); i++) {
+        reset_flash();
+        TEST_ASSERT(update_with_stream(updated, stream_size,
+                                       block_sizes[i]) == 0,
+                    "Update failed");
+        TEST_ASSERT(fwu_reset_component(TEST_COMPONENT) == 0,
+                    "Reset failed");
+    }
+
+    return 0;
+}
+
+static int test_malformed_streams(void)
+{
+    /* A literal of 8 bytes which only has 2 */
+    static const uint8_t truncated[] = {
+        'T', 'F', 'M', 'D', OP_LITERAL, 8, 0xAA, 0xBB,
+    };
+    /* A copy of 4 bytes from 3 bytes before the start of the output */
+    static const uint8_t before_start[] = {
+        'T', 'F', 'M', 'D', OP_LITERAL, 2, 0xAA, 0xBB, OP_COPY_OUTPUT, 3, 4,
+    };
+    /* A copy from the output which is empty */
+    static const uint8_t zero_distance[] = {
+        'T', 'F', 'M', 'D', OP_COPY_OUTPUT, 0, 4,
+    };
+    /* An unknown opcode */
+    static const uint8_t bad_opcode[] = {
+        'T', 'F', 'M', 'D', 0x03, 0,
+    };
+    /* A length over 32 bits */
+    static const uint8_t long_arg[] = {
+        'T', 'F', 'M', 'D', OP_LITERAL, 0xFF, 0xFF, 0xFF, 0xFF, 0x1F,
+    };
+    /* A copy beyond the primary slot */
+    static const uint8_t beyond_base[] = {
+        'T', 'F', 'M', 'D', OP_COPY_BASE, 0x80, 0x80, 0x80, 0x80, 0x0F, 16,
+    };
+    static const struct {
+        const uint8_t *data;
+        size_t size;
+    } rejected[] = {
+        { before_start, sizeof(before_start) },
+        { zero_distance, sizeof(zero_distance) },
+        { bad_opcode, sizeof(bad_opcode) },
+        { long_arg, sizeof(long_arg) },
+        { beyond_base, sizeof(beyond_base) },
+    };
+    size_t i;
+
+    reset_flash();
+
+    /* The stream ends in the middle of a command */
+    TEST_ASSERT(fwu_start(TEST_COMPONENT) == PSA_SUCCESS, "Start failed");
+    TEST_ASSERT(fwu_write(TEST_COMPONENT, 0, truncated, sizeof(truncated)) ==
+                PSA_SUCCESS, "Write failed");
+    TEST_ASSERT(fwu_component_call(TFM_FWU_FINISH, TEST_COMPONENT) ==
+                PSA_ERROR_INVALID_ARGUMENT, "Truncated stream accepted");
+    TEST_ASSERT(fwu_reset_component(TEST_COMPONENT) == 0, "Reset failed");
+
+    /* The stream is decoded in order */
+    TEST_ASSERT(fwu_start(TEST_COMPONENT) == PSA_SUCCESS, "Start failed");
+    TEST_ASSERT(fwu_write(TEST_COMPONENT, 0, truncated, 6) == PSA_SUCCESS,
+                "Write failed");
+    TEST_ASSERT(fwu_write(TEST_COMPONENT, 7, &truncated[7], 1) ==
+                PSA_ERROR_INVALID_ARGUMENT, "Gap in the stream accepted");
+    TEST_ASSERT(fwu_reset_component(TEST_COMPONENT) == 0, "Reset failed");
+
+    /* The decoder stops at the first error */
+    for (i = 0; i < sizeof(rejected) / sizeof(rejected[0]); i++) {
+        TEST_ASSERT(fwu_start(TEST_COMPONENT) == PSA_SUCCESS, "Start failed");
+        TEST_ASSERT(fwu_write(TEST_COMPONENT, 0, rejected[i].data,
+                              rejected[i].size) != PSA_SUCCESS,
+                    "Malformed stream accepted");
+        TEST_ASSERT(fwu_write(TEST_COMPONENT, rejected[i].size, truncated,
+                              1) == PSA_ERROR_BAD_STATE,
+                    "Decoded after an error");
+        TEST_ASSERT(fwu_reset_component(TEST_COMPONENT) == 0, "Reset failed");
+    }
+
+    return 0;
+}
+
+/*------------------------------ Benchmark -----------------------------------*/
+
+static int bench_delta_decode(void)
+{
+    static const struct {
+        const char *name;
+        const uint8_t *image;
+        bool encoded;
+        bool delta;
+    } samples[] = {
+        { "plain", updated, false, false },
+        { "compressed", compressible, true, false },
+        { "delta", updated, true, true },
+    };
+    const uint8_t *data;
+    size_t size, i;
+    uint64_t t0, sim_ns, host_ns;
+
+    printf("image %u KB, delta buffer %u bytes\r\n",
+           (unsigned int)(TEST_IMAGE_SIZE / 1024u),
+           (unsigned int)TFM_FWU_DELTA_BUF_SIZE);
+    printf("%-11s %10s %8s %10s %12s %12s\r\n", "stream", "stream KB",
+           "ratio", "write ms", "image MB/s", "host MB/s");
+
+    for (i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        if (samples[i].encoded) {
+            size = encode_stream(samples[i].image, TEST_IMAGE_SIZE,
+                                 samples[i].delta ? active : NULL,
+                                 samples[i].delta ? sizeof(active) : 0);
+            data = stream;
+        } else {
+            size = TEST_IMAGE_SIZE;
+            data = samples[i].image;
+        }
+
+        reset_flash();
+        TEST_ASSERT(fwu_start(TEST_COMPONENT) == PSA_SUCCESS, "Start failed");
+
+        /* The simulated time of the device, and the time of the host */
+        t0 = fwu_flash_sim_now_ns();
+        host_ns = tfm_unittest_now_ns();
+        TEST_ASSERT(write_stream(data, size, PSA_FWU_MAX_WRITE_SIZE) ==
+                    PSA_SUCCESS, "Write failed");
+        TEST_ASSERT(fwu_component_call(TFM_FWU_FINISH, TEST_COMPONENT) ==
+                    PSA_SUCCESS, "Finish failed");
+        host_ns = tfm_unittest_now_ns() - host_ns;
+        sim_ns = fwu_flash_sim_now_ns() - t0;
+
+        TEST_ASSERT(memcmp(fwu_flash_sim_data(TEST_STAGING_OFFSET,
+                                              TEST_IMAGE_SIZE),
+                           samples[i].image, TEST_IMAGE_SIZE) == 0,
+                    "Staged image differs from the encoded one");
+        TEST_ASSERT(fwu_reset_component(TEST_COMPONENT) == 0, "Reset failed");
+
+        printf("%-11s %10.1f %8.2f %10.3f %12.3f %12.1f\r\n",
+               samples[i].name, (double)size / 1024.0,
+               (double)TEST_IMAGE_SIZE / (double)size,
+               (double)sim_ns / 1000000.0,
+               tfm_unittest_mb_per_s(TEST_IMAGE_SIZE, sim_ns),
+               tfm_unittest_mb_per_s(TEST_IMAGE_SIZE, host_ns));
+
+        /* The samples are chosen to be much smaller once encoded */
+        if (samples[i].encoded) {
+            TEST_ASSERT(size < TEST_IMAGE_SIZE / 2u, "Poor compression");
+        }
+    }
+
+    return 0;
+}
+
+int main(void)
+{
+    uint32_t failures = 0;
+
+    fwu_stub_set_active_version(0, 1, 0, 0);
+#if FWU_COMPONENT_NUMBER > 1
+    fwu_stub_set_active_version(1, 1, 0, 0);
+#endif
+    if (tfm_fwu_entry() != PSA_SUCCESS) {
+        printf("FAIL: tfm_fwu_entry\r\n");
+        return 1;
+    }
+
+    fwu_build_image(active, sizeof(active), 0x5eed, 1);
+    build_updated(updated, active, sizeof(updated), 0xd17a);
+    build_compressible(compressible, sizeof(compressible), 0xc0de);
+
+    RUN_TEST(test_compressed_stream, failures);
+    RUN_TEST(test_delta_stream, failures);
+    RUN_TEST(test_stream_block_sizes, failures);
+    RUN_TEST(test_malformed_streams, failures);
+    RUN_TEST(bench_delta_decode, failures);
+
+    return (failures == 0) ? 0 : 1;
+}
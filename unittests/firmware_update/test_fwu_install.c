@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Installs candidates of the two images of the MCUboot configuration, which
+ * depend on each other, through tfm_firmware_update_service_sfn(). Checks the
+ * dependency checks of the installation and the flash data they read, and
+ * reports the latency of the installation in the simulated time.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "bootutil/image.h"
+#include "config_fwu.h"
+#include "psa/service.h"
+#include "psa/update.h"
+
+#include "fwu_flash_sim.h"
+#include "fwu_partition_stubs.h"
+#include "fwu_test_client.h"
+#include "psa_manifest/tfm_firmware_update.h"
+#include "tfm_unittest.h"
+
+#define TEST_IMAGE_SIZE        (64u * 1024u)
+
+/* External NOR flash, where the reads of the manifests are the slowest */
+static const struct fwu_flash_sim_timing_t nor_timing = {
+    .program_byte_ns = 2500,
+    .erase_sector_ns = 40000000,
+    .read_byte_ns = 50,
+    .copy_call_ns = 2000,
+    .copy_byte_ns = 10,
+    .hash_byte_ns = 30,
+};
+
+static uint8_t images[FWU_COMPONENT_NUMBER][TEST_IMAGE_SIZE];
+
+/*------------------------------- Helpers ------------------------------------*/
+
+/* Builds the image of a component, which depends on the other image. */
+static void build_image(psa_fwu_component_t component, uint8_t major,
+                        uint8_t dep_major)
+{
+    struct image_dependency dep = {0};
+
+    dep.image_id = (uint8_t)(1u - component);
+    dep.image_min_version.iv_major = dep_major;
+    fwu_build_image_deps(images[component], TEST_IMAGE_SIZE,
+                         0x1000u + component, major, &dep, 1);
+}
+
+/* Writes the image of a component and makes it a candidate. */
+static int stage_candidate(psa_fwu_component_t component)
+{
+    TEST_ASSERT(fwu_start(component) == PSA_SUCCESS, "Start failed");
+    TEST_ASSERT(fwu_write_image(component, images[component],
+                                TEST_IMAGE_SIZE) == PSA_SUCCESS,
+                "Write failed");
+    TEST_ASSERT(fwu_component_call(TFM_FWU_FINISH, component) == PSA_SUCCESS,
+                "Finish failed");
+
+    return 0;
+}
+
+/* Installs the candidates, and returns the time and flash data it took. */
+static psa_status_t install(uint64_t *install_ns, uint64_t *read_bytes)
+{
+    uint64_t t0 = fwu_flash_sim_now_ns();
+    uint64_t read0 = fwu_flash_sim_stats()->read_bytes;
+    psa_status_t status = fwu_install();
+
+    *install_ns = fwu_flash_sim_now_ns() - t0;
+    *read_bytes = fwu_flash_sim_stats()->read_bytes - read0;
+
+    return status;
+}
+
+static int check_state(psa_fwu_component_t component, uint8_t state)
+{
+    psa_fwu_component_info_t info;
+
+    TEST_ASSERT(fwu_query(component, &info) == PSA_SUCCESS, "Query failed");
+    TEST_ASSERT(info.state == state, "Wrong component state");
+
+    return 0;
+}
+
+static int reset_components(void)
+{
+    psa_fwu_component_t component;
+
+    for (component = 0; component < FWU_COMPONENT_NUMBER; component++) {
+        TEST_ASSERT(fwu_reset_component(component) == 0, "Reset failed");
+    }
+
+    return 0;
+}
+
+/*-------------------------------- Tests -------------------------------------*/
+
+/*
+ * The image 0 needs the version 2 of the image 1, which is only met by its
+ * candidate, and that one needs a version 3 of the image 0 which is not
+ * there. A retry after PSA_ERROR_DEPENDENCY_NEEDED, or after another
+ * candidate is written, doesn't read again the manifests already read.
+ */
+static int test_install_dependency_needed(void)
+{
+    uint64_t install_ns[4], read_bytes[4];
+    static const char *const steps[] = {
+        "image 0", "image 0, retry", "images 0 and 1", "images 0 and 1, retry"
+    };
+    uint32_t i;
+
+    fwu_flash_sim_reset(&nor_timing, false);
+    build_image(0, 2, 2);
+    build_image(1, 2, 3);
+
+    /* The running image 1 does not meet the dependency of the image 0. */
+    TEST_ASSERT(stage_candidate(0) == 0, "Staging failed");
+    TEST_ASSERT(install(&install_ns[0], &read_bytes[0]) ==
+                PSA_ERROR_DEPENDENCY_NEEDED, "Dependency not detected");
+    TEST_ASSERT(read_bytes[0] > 0, "Did not read the manifest");
+    TEST_ASSERT(install(&install_ns[1], &read_bytes[1]) ==
+                PSA_ERROR_DEPENDENCY_NEEDED, "Dependency not detected");
+    TEST_ASSERT(read_bytes[1] == 0, "Read the cached manifest again");
+
+    /* Only the manifest of the new candidate is read. Both images have the
+     * same layout, so their manifests have the same size.
+     */
+    TEST_ASSERT(stage_candidate(1) == 0, "Staging failed");
+    TEST_ASSERT(install(&install_ns[2], &read_bytes[2]) ==
+                PSA_ERROR_DEPENDENCY_NEEDED, "Dependency not detected");
+    TEST_ASSERT(read_bytes[2] == read_bytes[0],
+                "Read the cached manifest again");
+    TEST_ASSERT(install(&install_ns[3], &read_bytes[3]) ==
+                PSA_ERROR_DEPENDENCY_NEEDED, "Dependency not detected");
+    TEST_ASSERT(read_bytes[3] == 0, "Read the cached manifests again");
+
+    /* The candidates stay candidates. */
+    TEST_ASSERT(check_state(0, PSA_FWU_CANDIDATE) == 0, "State check failed");
+    TEST_ASSERT(check_state(1, PSA_FWU_CANDIDATE) == 0, "State check failed");
+
+    printf("%-24s %12s %10s\r\n", "install", "latency us", "read B");
+    for (i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+        printf("%-24s %12.1f %10u\r\n", steps[i],
+               (double)install_ns[i] / 1000.0, (unsigned int)read_bytes[i]);
+    }
+
+    TEST_ASSERT(reset_components() == 0, "Reset failed");
+
+    return 0;
+}
+
+/*
+ * A new image written after an installation attempt has its own manifest:
+ * once the too old candidate of the image 1 is replaced, both images are
+ * installed together.
+ */
+static int test_install_new_candidate(void)
+{
+    uint64_t install_ns, read_bytes, manifest_bytes;
+
+    fwu_flash_sim_reset(&nor_timing, false);
+    build_image(0, 2, 2);
+    build_image(1, 1, 2);
+
+    TEST_ASSERT(stage_candidate(0) == 0, "Staging failed");
+    TEST_ASSERT(stage_candidate(1) == 0, "Staging failed");
+    TEST_ASSERT(install(&install_ns, &manifest_bytes) ==
+                PSA_ERROR_DEPENDENCY_NEEDED, "Dependency not detected");
+
+    TEST_ASSERT(fwu_component_call(TFM_FWU_CANCEL, 1) == PSA_SUCCESS,
+                "Cancel failed");
+    TEST_ASSERT(fwu_component_call(TFM_FWU_CLEAN, 1) == PSA_SUCCESS,
+                "Clean failed");
+    build_image(1, 2, 2);
+    TEST_ASSERT(stage_candidate(1) == 0, "Staging failed");
+    TEST_ASSERT(install(&install_ns, &read_bytes) == PSA_SUCCESS_REBOOT,
+                "Install failed");
+    TEST_ASSERT(check_state(0, PSA_FWU_STAGED) == 0, "State check failed");
+    TEST_ASSERT(check_state(1, PSA_FWU_STAGED) == 0, "State check failed");
+
+    /* Besides the manifest of the new candidate, the installation reads the
+     * image trailers to write the boot magic into them.
+     */
+    TEST_ASSERT(read_bytes >= manifest_bytes / 2,
+                "Did not read the new manifest");
+    TEST_ASSERT(read_bytes < manifest_bytes,
+                "Read the cached manifest again");
+    printf("%-24s %12.1f %10u\r\n", "images 0 and 1, staged",
+           (double)install_ns / 1000.0, (unsigned int)read_bytes);
+
+    TEST_ASSERT(reset_components() == 0, "Reset failed");
+
+    return 0;
+}
+
+/* The dependency on the running image is met without any candidate. */
+static int test_install_running_dependency(void)
+{
+    uint64_t install_ns, read_bytes;
+
+    fwu_flash_sim_reset(&nor_timing, false);
+    build_image(0, 2, 1);
+
+    TEST_ASSERT(stage_candidate(0) == 0, "Staging failed");
+    TEST_ASSERT(install(&install_ns, &read_bytes) == PSA_SUCCESS_REBOOT,
+                "Install failed");
+    TEST_ASSERT(check_state(0, PSA_FWU_STAGED) == 0, "State check failed");
+    TEST_ASSERT(check_state(1, PSA_FWU_READY) == 0, "State check failed");
+
+    TEST_ASSERT(reset_components() == 0, "Reset failed");
+
+    return 0;
+}
+
+int main(void)
+{
+    uint32_t failures = 0;
+
+    fwu_stub_set_active_version(0, 1, 0, 0);
+    fwu_stub_set_active_version(1, 1, 0, 0);
+    if (tfm_fwu_entry() != PSA_SUCCESS) {
+        printf("FAIL: tfm_fwu_entry\r\n");
+        return 1;
+    }
+
+    RUN_TEST(test_install_dependency_needed, failures);
+    RUN_TEST(test_install_new_candidate, failures);
+    RUN_TEST(test_install_running_dependency, failures);
+
+    return (failures == 0) ? 0 : 1;
+}
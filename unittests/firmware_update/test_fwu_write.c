@@ -0,0 +1,446 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Writes MCUboot images through tfm_firmware_update_service_sfn() into a
+ * simulated slow flash, checks what is staged and its digest returned by the
+ * query of the candidate, and reports the end-to-end throughput of an update
+ * in the simulated time. The same tests are built
+ * with each FWU configuration to compare them.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "config_fwu.h"
+#include "flash_layout.h"
+#include "mbedtls/sha256.h"
+#include "psa/service.h"
+#include "psa/update.h"
+
+#include "fwu_flash_sim.h"
+#include "fwu_partition_stubs.h"
+#include "fwu_test_client.h"
+#include "psa_manifest/tfm_firmware_update.h"
+#include "tfm_unittest.h"
+
+#define TEST_IMAGE_SIZE        (512u * 1024u)
+#define TEST_COMPONENT         (0u)
+#define TEST_STAGING_OFFSET    FLASH_AREA_2_OFFSET
+
+/* The partition only supports a flash driver which programs in background
+ * with the write pipeline, which keeps the buffers until it is done.
+ */
+#if TFM_FWU_WRITE_PIPELINE
+#define TEST_DRIVER_MODE_NUM   (2u)
+#else
+#define TEST_DRIVER_MODE_NUM   (1u)
+#endif
+
+/* Costs of the simulated flash and of the partition in the update */
+struct test_flash_profile_t {
+    const char *name;
+    struct fwu_flash_sim_timing_t timing;
+};
+
+static const struct test_flash_profile_t flash_profiles[] = {
+    /* External NOR flash: 256 bytes pages, 4 KB sectors */
+    {
+        .name = "slow NOR",
+        .timing = {
+            .program_byte_ns = 2500,
+            .erase_sector_ns = 40000000,
+            .read_byte_ns = 50,
+            .copy_call_ns = 2000,
+            .copy_byte_ns = 10,
+            .hash_byte_ns = 30,
+        },
+    },
+    /* Embedded non-volatile memory programmed by words */
+    {
+        .name = "fast eNVM",
+        .timing = {
+            .program_byte_ns = 100,
+            .erase_sector_ns = 2000000,
+            .read_byte_ns = 10,
+            .copy_call_ns = 2000,
+            .copy_byte_ns = 10,
+            .hash_byte_ns = 30,
+        },
+    },
+};
+
+#define TEST_PROFILE_NUM  (sizeof(flash_profiles) / sizeof(flash_profiles[0]))
+
+static uint8_t image[TEST_IMAGE_SIZE];
+
+/*------------------------------- Helpers ------------------------------------*/
+
+/* Checks the digest of the staged data returned by the query. */
+static int check_candidate_digest(psa_fwu_component_t component,
+                                  const uint8_t *data, size_t size)
+{
+    psa_fwu_component_info_t info;
+    uint8_t digest[32];
+
+    TEST_ASSERT(fwu_query(component, &info) == PSA_SUCCESS, "Query failed");
+    TEST_ASSERT(info.state == PSA_FWU_CANDIDATE, "Not a candidate");
+
+    (void)mbedtls_sha256(data, size, digest, 0);
+    TEST_ASSERT(memcmp(info.impl.candidate_digest, digest,
+                       sizeof(digest)) == 0,
+                "Wrong candidate digest");
+
+    return 0;
+}
+
+/*
+ * Runs a whole update of the test component with the given flash profile,
+ * and returns the simulated time of each step, up to the query of the
+ * candidate, and the flash data read by the query.
+ */
+static int run_update(const struct test_flash_profile_t *profile, bool async,
+                      uint64_t *start_ns, uint64_t *write_ns,
+                      uint64_t *query_ns, uint64_t *query_read_bytes)
+{
+    uint64_t t0, t1, read_bytes;
+
+    fwu_flash_sim_reset(&profile->timing, async);
+
+    t0 = fwu_flash_sim_now_ns();
+    TEST_ASSERT(fwu_start(TEST_COMPONENT) == PSA_SUCCESS, "Start failed");
+    t1 = fwu_flash_sim_now_ns();
+    *start_ns = t1 - t0;
+
+    TEST_ASSERT(fwu_write_image(TEST_COMPONENT, image, sizeof(image)) ==
+                PSA_SUCCESS, "Write failed");
+    TEST_ASSERT(fwu_component_call(TFM_FWU_FINISH, TEST_COMPONENT) ==
+                PSA_SUCCESS, "Finish failed");
+    *write_ns = fwu_flash_sim_now_ns() - t1;
+
+    t0 = fwu_flash_sim_now_ns();
+    read_bytes = fwu_flash_sim_stats()->read_bytes;
+    TEST_ASSERT(check_candidate_digest(TEST_COMPONENT, image,
+                                       sizeof(image)) == 0,
+                "Digest check failed");
+    *query_ns = fwu_flash_sim_now_ns() - t0;
+    *query_read_bytes = fwu_flash_sim_stats()->read_bytes - read_bytes;
+
+    TEST_ASSERT(memcmp(fwu_flash_sim_data(TEST_STAGING_OFFSET, sizeof(image)),
+                       image, sizeof(image)) == 0,
+                "Staged image differs from the written one");
+    TEST_ASSERT(fwu_flash_sim_stats()->unerased_programs == 0,
+                "Programmed flash which was not erased");
+
+    return 0;
+}
+
+/*-------------------------------- Tests -------------------------------------*/
+
+static int test_write_image(void)
+{
+    uint64_t start_ns, write_ns, query_ns, query_read_bytes;
+    uint32_t mode;
+
+    /* The drivers, whether they program in background or not */
+    for (mode = 0; mode < TEST_DRIVER_MODE_NUM; mode++) {
+        TEST_ASSERT(run_update(&flash_profiles[0], mode == 1,
+                               &start_ns, &write_ns,
+                               &query_ns, &query_read_bytes) == 0,
+                    "Update failed");
+        TEST_ASSERT((mode == 1) ==
+                    (fwu_flash_sim_stats()->async_programs > 0),
+                    "Only an asynchronous driver programs in background");
+        TEST_ASSERT(fwu_reset_component(TEST_COMPONENT) == 0, "Reset failed");
+    }
+
+    return 0;
+}
+
+static int test_unaligned_blocks(void)
+{
+    static const size_t block_sizes[] = { 1, 3, 517, PSA_FWU_MAX_WRITE_SIZE };
+    const size_t size = 16u * 1024u;
+    size_t offset, block_size, i;
+
+    for (i = 0; i < sizeof(block_sizes) / sizeof(block_sizes[0]); i++) {
+        fwu_flash_sim_reset(&flash_profiles[1].timing,
+                            TEST_DRIVER_MODE_NUM > 1);
+
+        TEST_ASSERT(fwu_start(TEST_COMPONENT) == PSA_SUCCESS, "Start failed");
+        for (offset = 0; offset < size; offset += block_size) {
+            block_size = (size - offset < block_sizes[i]) ?
+                         size - offset : block_sizes[i];
+            TEST_ASSERT(fwu_write(TEST_COMPONENT, offset, image + offset,
+                                  block_size) == PSA_SUCCESS,
+                        "Write failed");
+        }
+        TEST_ASSERT(memcmp(fwu_flash_sim_data(TEST_STAGING_OFFSET, size),
+                           image, size) == 0,
+                    "Staged data differs from the written one");
+        TEST_ASSERT(fwu_reset_component(TEST_COMPONENT) == 0, "Reset failed");
+    }
+
+    return 0;
+}
+
+static int test_out_of_order_digest(void)
+{
+    const size_t size = 64u * 1024u;
+    const size_t block_size = PSA_FWU_MAX_WRITE_SIZE;
+    size_t offset;
+
+    fwu_flash_sim_reset(&flash_profiles[1].timing, false);
+
+    /* The blocks are written from the last one */
+    TEST_ASSERT(fwu_start(TEST_COMPONENT) == PSA_SUCCESS, "Start failed");
+    for (offset = size; offset > 0; offset -= block_size) {
+        TEST_ASSERT(fwu_write(TEST_COMPONENT, offset - block_size,
+                              image + offset - block_size, block_size) ==
+                    PSA_SUCCESS, "Write failed");
+    }
+    TEST_ASSERT(fwu_component_call(TFM_FWU_FINISH, TEST_COMPONENT) ==
+                PSA_SUCCESS, "Finish failed");
+
+    /* The digest is the one of the staged data */
+    TEST_ASSERT(check_candidate_digest(TEST_COMPONENT, image, size) == 0,
+                "Digest check failed");
+    TEST_ASSERT(fwu_reset_component(TEST_COMPONENT) == 0, "Reset failed");
+
+    return 0;
+}
+
+#if TFM_FWU_ERASE_AHEAD
+/*
+ * A client erases the staging area by chunks while it is idle, then writes an
+ * image longer than the erased part and prepares the rest of the staging area
+ * before the installation. After a reset the partition knows of no erased
+ * part, so this test runs first.
+ */
+static int test_idle_pre_erase(void)
+{
+    const size_t chunk_size = 64u * 1024u;
+    const size_t chunk_num = 3;
+    const size_t sector_size = FLASH_AREA_IMAGE_SECTOR_SIZE;
+    const struct fwu_flash_sim_stats_t *stats = fwu_flash_sim_stats();
+    static const uint8_t old_sector[FLASH_AREA_IMAGE_SECTOR_SIZE];
+    psa_fwu_component_info_t info;
+    uint64_t t0, start_ns, write_ns, prepare_ns, install_ns;
+    uint32_t erased_sectors;
+    size_t max_size, offset, block_size, erased_end, i;
+    bool trailer_erased = true;
+    const uint8_t *trailer;
+
+    fwu_flash_sim_reset(&flash_profiles[0].timing, false);
+
+    /* The staging area holds the image of a previous update. */
+    TEST_ASSERT(fwu_query(TEST_COMPONENT, &info) == PSA_SUCCESS,
+                "Query failed");
+    TEST_ASSERT(info.impl.staging_erased_size == 0,
+                "Erased part reported after a reset");
+    max_size = info.max_size;
+    for (offset = 0; offset < max_size; offset += sector_size) {
+        TEST_ASSERT(fwu_flash_sim_load(TEST_STAGING_OFFSET + offset,
+                                       old_sector, sector_size),
+                    "Loading the staging area failed");
+    }
+
+    printf("%-10s %12s %12s\r\n", "chunk", "erased KB", "prepare ms");
+    for (i = 1; i <= chunk_num; i++) {
+        erased_sectors = stats->erased_sectors;
+        t0 = fwu_flash_sim_now_ns();
+        TEST_ASSERT(fwu_prepare_staging(TEST_COMPONENT, chunk_size) ==
+                    PSA_SUCCESS, "Prepare failed");
+        prepare_ns = fwu_flash_sim_now_ns() - t0;
+        TEST_ASSERT(stats->erased_sectors - erased_sectors ==
+                    chunk_size / sector_size,
+                    "Erased more than the chunk");
+
+        /* The query reports the progress of the erasing */
+        TEST_ASSERT(fwu_query(TEST_COMPONENT, &info) == PSA_SUCCESS,
+                    "Query failed");
+        TEST_ASSERT(info.state == PSA_FWU_READY, "Not READY");
+        TEST_ASSERT(info.impl.staging_erased_size == i * chunk_size,
+                    "Wrong erased size");
+        printf("%-10u %12u %12.1f\r\n", (unsigned int)i,
+               (unsigned int)(info.impl.staging_erased_size / 1024u),
+               (double)prepare_ns / 1000000.0);
+    }
+
+    /* The update starts without erasing. */
+    erased_sectors = stats->erased_sectors;
+    t0 = fwu_flash_sim_now_ns();
+    TEST_ASSERT(fwu_start(TEST_COMPONENT) == PSA_SUCCESS, "Start failed");
+    start_ns = fwu_flash_sim_now_ns() - t0;
+    TEST_ASSERT(stats->erased_sectors == erased_sectors,
+                "Erased when the update started");
+
+    /* The sectors after the prepared part are erased just before the blocks
+     * written into them.
+     */
+    t0 = fwu_flash_sim_now_ns();
+    for (offset = 0; offset < sizeof(image); offset += block_size) {
+        block_size = sizeof(image) - offset;
+        if (block_size > PSA_FWU_MAX_WRITE_SIZE) {
+            block_size = PSA_FWU_MAX_WRITE_SIZE;
+        }
+        TEST_ASSERT(fwu_write(TEST_COMPONENT, offset, image + offset,
+                              block_size) == PSA_SUCCESS,
+                    "Write failed");
+
+        erased_end = ((offset + block_size + sector_size - 1) / sector_size) *
+                     sector_size;
+        if (erased_end < chunk_num * chunk_size) {
+            erased_end = chunk_num * chunk_size;
+        }
+        TEST_ASSERT(fwu_query(TEST_COMPONENT, &info) == PSA_SUCCESS,
+                    "Query failed");
+        TEST_ASSERT(info.impl.staging_erased_size == erased_end,
+                    "The erased part does not follow the writes");
+    }
+    write_ns = fwu_flash_sim_now_ns() - t0;
+    TEST_ASSERT(stats->erased_sectors - erased_sectors ==
+                (sizeof(image) - chunk_num * chunk_size) / sector_size,
+                "Erased sectors which were already erased");
+
+    /* The rest is prepared while the client waits to install. */
+    erased_sectors = stats->erased_sectors;
+    t0 = fwu_flash_sim_now_ns();
+    TEST_ASSERT(fwu_prepare_staging(TEST_COMPONENT, 0) == PSA_SUCCESS,
+                "Prepare failed");
+    prepare_ns = fwu_flash_sim_now_ns() - t0;
+    TEST_ASSERT(stats->erased_sectors - erased_sectors ==
+                (max_size - sizeof(image)) / sector_size,
+                "Did not erase the rest of the staging area");
+    TEST_ASSERT(fwu_query(TEST_COMPONENT, &info) == PSA_SUCCESS,
+                "Query failed");
+    TEST_ASSERT(info.impl.staging_erased_size == max_size,
+                "The whole staging area is not erased");
+    TEST_ASSERT(fwu_component_call(TFM_FWU_FINISH, TEST_COMPONENT) ==
+                PSA_SUCCESS, "Finish failed");
+
+    /* The boot magic is written into the erased trailer. */
+    erased_sectors = stats->erased_sectors;
+    t0 = fwu_flash_sim_now_ns();
+    TEST_ASSERT(fwu_install() == PSA_SUCCESS_REBOOT, "Install failed");
+    install_ns = fwu_flash_sim_now_ns() - t0;
+    TEST_ASSERT(stats->erased_sectors == erased_sectors,
+                "Erased when the image was installed");
+    trailer = fwu_flash_sim_data(TEST_STAGING_OFFSET + max_size - 16u, 16u);
+    for (i = 0; i < 16u; i++) {
+        if (trailer[i] != 0xFF) {
+            trailer_erased = false;
+        }
+    }
+    TEST_ASSERT(!trailer_erased, "No boot magic in the trailer");
+
+    TEST_ASSERT(memcmp(fwu_flash_sim_data(TEST_STAGING_OFFSET, sizeof(image)),
+                       image, sizeof(image)) == 0,
+                "Staged image differs from the written one");
+    TEST_ASSERT(stats->unerased_programs == 0,
+                "Programmed flash which was not erased");
+
+    printf("start %.1f ms, write %.3f MB/s, prepare rest %.1f ms, "
+           "install %.1f ms\r\n",
+           (double)start_ns / 1000000.0,
+           tfm_unittest_mb_per_s(sizeof(image), write_ns),
+           (double)prepare_ns / 1000000.0,
+           (double)install_ns / 1000000.0);
+
+    TEST_ASSERT(fwu_reset_component(TEST_COMPONENT) == 0, "Reset failed");
+
+    return 0;
+}
+#endif /* TFM_FWU_ERASE_AHEAD */
+
+/*------------------------------ Benchmark -----------------------------------*/
+
+static int bench_update_throughput(void)
+{
+    static const char *const drivers[] = { "sync", "async" };
+    uint64_t start_ns, write_ns, query_ns, query_read_bytes, sync_ns = 0;
+    uint32_t profile, mode;
+
+    printf("write pipeline %s, erase ahead %s, incremental digest %s\r\n",
+           TFM_FWU_WRITE_PIPELINE ? "on" : "off",
+           TFM_FWU_ERASE_AHEAD ? "on" : "off",
+           TFM_FWU_INCREMENTAL_DIGEST ? "on" : "off");
+    printf("%-10s %-6s %10s %11s %10s %10s %11s\r\n", "flash", "driver",
+           "start ms", "write MB/s", "query ms", "query KB", "total MB/s");
+
+    for (profile = 0; profile < TEST_PROFILE_NUM; profile++) {
+        for (mode = 0; mode < TEST_DRIVER_MODE_NUM; mode++) {
+            TEST_ASSERT(run_update(&flash_profiles[profile], mode == 1,
+                                   &start_ns, &write_ns,
+                                   &query_ns, &query_read_bytes) == 0,
+                        "Update failed");
+            TEST_ASSERT(fwu_reset_component(TEST_COMPONENT) == 0,
+                        "Reset failed");
+
+            printf("%-10s %-6s %10.1f %11.3f %10.3f %10.1f %11.3f\r\n",
+                   flash_profiles[profile].name, drivers[mode],
+                   (double)start_ns / 1000000.0,
+                   tfm_unittest_mb_per_s(sizeof(image), write_ns),
+                   (double)query_ns / 1000000.0,
+                   (double)query_read_bytes / 1024.0,
+                   tfm_unittest_mb_per_s(sizeof(image),
+                                         start_ns + write_ns + query_ns));
+
+            /* The staging area was left erased by the previous reset */
+#if TFM_FWU_ERASE_AHEAD
+            TEST_ASSERT(start_ns <
+                        flash_profiles[profile].timing.erase_sector_ns,
+                        "Erased when the update started");
+#endif
+
+            /* The incremental digest spares reading the image back */
+#if TFM_FWU_INCREMENTAL_DIGEST
+            TEST_ASSERT(query_read_bytes == 0,
+                        "Read the image back to get its digest");
+#else
+            TEST_ASSERT(query_read_bytes >= sizeof(image),
+                        "Did not read the image back to get its digest");
+#endif
+
+            /* Programming in background hides the copies from the client */
+            if (mode == 0) {
+                sync_ns = write_ns;
+            } else {
+                TEST_ASSERT(write_ns < sync_ns,
+                            "The pipeline did not overlap the copies");
+            }
+        }
+    }
+
+    return 0;
+}
+
+int main(void)
+{
+    uint32_t failures = 0;
+
+    fwu_stub_set_active_version(0, 1, 0, 0);
+#if FWU_COMPONENT_NUMBER > 1
+    fwu_stub_set_active_version(1, 1, 0, 0);
+#endif
+    if (tfm_fwu_entry() != PSA_SUCCESS) {
+        printf("FAIL: tfm_fwu_entry\r\n");
+        return 1;
+    }
+
+    fwu_build_image(image, sizeof(image), 0x5eed, 2);
+
+#if TFM_FWU_ERASE_AHEAD
+    RUN_TEST(test_idle_pre_erase, failures);
+#endif
+    RUN_TEST(test_write_image, failures);
+    RUN_TEST(test_unaligned_blocks, failures);
+    RUN_TEST(test_out_of_order_digest, failures);
+    RUN_TEST(bench_update_throughput, failures);
+
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,14 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __UNITTEST_CONFIG_FWU_H__
+#define __UNITTEST_CONFIG_FWU_H__
+
+/* The base configuration, where the FWU data is written synchronously */
+#include "config_base.h"
+
+#endif /* __UNITTEST_CONFIG_FWU_H__ */
@@ -0,0 +1,17 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __UNITTEST_CONFIG_FWU_DELTA_H__
+#define __UNITTEST_CONFIG_FWU_DELTA_H__
+
+/* The configuration of the FWU tests which accept encoded image streams */
+#include "unittest_config_fwu.h"
+
+#undef TFM_FWU_DELTA_BUF_SIZE
+#define TFM_FWU_DELTA_BUF_SIZE                 1024
+
+#endif /* __UNITTEST_CONFIG_FWU_DELTA_H__ */
@@ -0,0 +1,17 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __UNITTEST_CONFIG_FWU_DIGEST_H__
+#define __UNITTEST_CONFIG_FWU_DIGEST_H__
+
+/* The configuration of the FWU tests which hash the data as it is written */
+#include "unittest_config_fwu.h"
+
+#undef TFM_FWU_INCREMENTAL_DIGEST
+#define TFM_FWU_INCREMENTAL_DIGEST             1
+
+#endif /* __UNITTEST_CONFIG_FWU_DIGEST_H__ */
@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __UNITTEST_CONFIG_FWU_ERASE_AHEAD_H__
+#define __UNITTEST_CONFIG_FWU_ERASE_AHEAD_H__
+
+/* The configuration of the FWU tests which erase the staging area as it is
+ * written
+ */
+#include "unittest_config_fwu.h"
+
+#undef TFM_FWU_ERASE_AHEAD
+#define TFM_FWU_ERASE_AHEAD                    1
+
+#endif /* __UNITTEST_CONFIG_FWU_ERASE_AHEAD_H__ */
@@ -0,0 +1,17 @@
+/*
+ * Copyright (c) 2022, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __UNITTEST_CONFIG_FWU_PIPELINE_H__
+#define __UNITTEST_CONFIG_FWU_PIPELINE_H__
+
+/* The configuration of the FWU tests which program the data in background */
+#include "unittest_config_fwu.h"
+
+#undef TFM_FWU_WRITE_PIPELINE
+#define TFM_FWU_WRITE_PIPELINE                 1
+
+#endif /* __UNITTEST_CONFIG_FWU_PIPELINE_H__ */